@@ -0,0 +1,402 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef CYCLE_RECORDER_H_
+#define CYCLE_RECORDER_H_
+
+#include <teb_local_planner/optimal_planner.h>
+#include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/teb_config.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @brief Call visitor(name, field) for each numeric parameter of a TebConfig
+ * that influences the planning
+ *
+ * The names stay valid across versions of the planner, parameters that have
+ * been added or removed in the meantime are skipped when loading.
+ */
+template <typename Config, typename Visitor>
+void visitConfigParameters(Config &cfg, Visitor &visitor);
+
+//! Planner inputs and outputs of a planning cycle, as read from a ring file
+struct RecordedCycle {
+  ros::Time stamp;
+  std::vector<geometry_msgs::PoseStamped> plan;
+  geometry_msgs::Twist start_vel;
+  bool free_goal_vel;
+  HumanPlanVelMap human_plans;
+  ObstContainer obstacles;
+  ViaPointContainer via_points;
+  std::map<uint64_t, ViaPointContainer> humans_via_points;
+  double weight_optimaltime; //!< PlannerInterface::local_weight_optimaltime_
+
+  bool success;
+  double plan_time; //!< Duration of the plan() call [s]
+  double vx, omega; //!< First velocity command of the trajectory
+  OptimizationCostArray op_costs;
+};
+
+//! Configuration of the planner, as read from a ring file
+struct RecordedConfig {
+  ros::Time stamp;
+  std::map<std::string, double> parameters; //!< See visitConfigParameters()
+  RobotFootprintModelPtr robot_model;
+
+  /**
+   * @brief Assign the recorded parameters, the others keep their value
+   */
+  void apply(TebConfig &cfg) const;
+};
+
+/**
+ * @class CycleRecorder
+ * @brief Appends the planner inputs and outputs of each planning cycle to a
+ * memory-mapped ring file of fixed size.
+ *
+ * The oldest records are overwritten once the file is full. Records are
+ * serialized directly into the mapping, hence recording a cycle does not
+ * allocate memory. The kernel writes the mapping back to the file, the
+ * records of the last cycles are therefore available after a crash of the
+ * process as well. Use CycleReader to load them.
+ *
+ * A configuration record that is overwritten is copied into the file header
+ * first, where it remains as the configuration of the oldest cycles in the
+ * ring.
+ */
+class CycleRecorder {
+public:
+  CycleRecorder();
+  ~CycleRecorder();
+
+  /**
+   * @brief Map a ring file, records of a previous run are kept if the file has
+   * the same size
+   * @param filename path of the ring file
+   * @param capacity size of the ring file [bytes]
+   * @return \c false if the file cannot be created or mapped
+   */
+  bool open(const std::string &filename, std::size_t capacity);
+
+  /**
+   * @brief Unmap the ring file
+   */
+  void close();
+
+  bool isOpen() const { return header_ != NULL; }
+
+  //! Name of the mapped ring file
+  const std::string &filename() const { return filename_; }
+
+  /**
+   * @brief Record the configuration that applies to the following cycles
+   */
+  bool recordConfig(const ros::Time &stamp, const TebConfig &cfg,
+                    const RobotFootprintModelPtr &robot_model);
+
+  /**
+   * @brief Record the arguments and results of a PlannerInterface::plan() call
+   * @param weight_optimaltime PlannerInterface::local_weight_optimaltime_
+   * @param plan_time duration of the call [s]
+   * @param vx,omega velocity command of the planner (if \c success)
+   */
+  bool recordCycle(const ros::Time &stamp,
+                   const std::vector<geometry_msgs::PoseStamped> &plan,
+                   const geometry_msgs::Twist &start_vel, bool free_goal_vel,
+                   const HumanPlanVelMap &human_plans,
+                   const ObstContainer &obstacles,
+                   const ViaPointContainer &via_points,
+                   const std::map<uint64_t, ViaPointContainer>
+                       &humans_via_points,
+                   double weight_optimaltime, bool success, double plan_time,
+                   double vx, double omega,
+                   const OptimizationCostArray &op_costs);
+
+  /**
+   * @brief Record that the planner has been cleared after the last cycle
+   * (e.g. because the trajectory is infeasible)
+   */
+  bool recordReset(const ros::Time &stamp);
+
+  //! Number of records that did not fit into the ring file
+  uint64_t skippedRecords() const { return skipped_; }
+
+  enum RecordType { WRAP = 0, CONFIG = 1, CYCLE = 2, RESET = 3 };
+
+  //! Header at the beginning of the ring file
+  struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size; //!< Offset of the ring buffer in the file
+    uint64_t capacity;    //!< Size of the ring buffer
+    uint64_t head;        //!< Offset of the oldest record
+    uint64_t tail;        //!< Offset behind the newest record
+    uint64_t no_records;
+    uint64_t sequence;    //!< Sequence number of the next record
+    uint64_t config_size; //!< Size of the CONFIG record kept in the header
+                          //! for the oldest records (0: none)
+  };
+
+  //! Header of each record, records start at multiples of 8 bytes
+  struct RecordHeader {
+    uint32_t type;     //!< RecordType
+    uint32_t reserved;
+    uint64_t size;     //!< Size including this header
+    uint64_t sequence; //!< Increases by one with each record
+    double stamp;      //!< ROS time of the record [s]
+  };
+
+  static const char MAGIC[8];
+  static const uint32_t VERSION = 2;
+
+private:
+  //! Serialize a record with two passes of a serializer over a sink: the
+  //! first one measures it, the second one copies it into the ring
+  template <typename Serializer>
+  bool write(RecordType type, const ros::Time &stamp,
+             const Serializer &serializer);
+
+  //! Drop the oldest records that start within [begin, end)
+  void release(uint64_t begin, uint64_t end);
+
+  //! Copy the CONFIG record at \c offset into the file header
+  void keepConfig(uint64_t offset, uint64_t size);
+
+  std::string filename_;
+  int fd_;
+  std::size_t mapped_size_;
+  FileHeader *header_; //!< Start of the mapping
+  char *ring_;         //!< Start of the ring buffer within the mapping
+  uint64_t skipped_;
+};
+
+/**
+ * @class CycleReader
+ * @brief Loads the records of a ring file written by CycleRecorder, from the
+ * oldest to the newest one.
+ */
+class CycleReader {
+public:
+  /**
+   * @brief Load a ring file
+   * @return \c false if the file cannot be read or is not a ring file
+   */
+  bool open(const std::string &filename);
+
+  //! Number of records in the file
+  uint64_t size() const;
+
+  /**
+   * @brief Parse the next record
+   * @return type of the record, CycleRecorder::WRAP at the end of the file or
+   * if the record is corrupted
+   */
+  CycleRecorder::RecordType next();
+
+  //! Last configuration parsed by next(), initially the one kept in the file
+  //! header for the oldest records
+  const RecordedConfig &config() const { return config_; }
+
+  //! Whether config() holds a configuration
+  bool hasConfig() const { return has_config_; }
+
+  //! Last cycle parsed by next()
+  const RecordedCycle &cycle() const { return cycle_; }
+
+  //! Sequence number and time of the record parsed last
+  uint64_t sequence() const { return sequence_; }
+  const ros::Time &stamp() const { return stamp_; }
+
+private:
+  std::vector<char> data_; //!< Content of the file
+  CycleRecorder::FileHeader header_;
+  uint64_t offset_;    //!< Offset of the next record in the ring buffer
+  uint64_t remaining_; //!< Records not parsed yet
+  uint64_t sequence_;
+  ros::Time stamp_;
+  bool has_config_;
+  RecordedConfig config_;
+  RecordedCycle cycle_;
+};
+
+#define TEB_CONFIG_PARAMETER(field) visitor(#field, cfg.field)
+
+template <typename Config, typename Visitor>
+void visitConfigParameters(Config &cfg, Visitor &visitor) {
+  TEB_CONFIG_PARAMETER(planning_mode);
+
+  TEB_CONFIG_PARAMETER(trajectory.teb_autosize);
+  TEB_CONFIG_PARAMETER(trajectory.teb_autosize_exact_dt);
+  TEB_CONFIG_PARAMETER(trajectory.dt_ref);
+  TEB_CONFIG_PARAMETER(trajectory.dt_hysteresis);
+  TEB_CONFIG_PARAMETER(trajectory.min_samples);
+  TEB_CONFIG_PARAMETER(trajectory.human_min_samples);
+  TEB_CONFIG_PARAMETER(trajectory.global_plan_overwrite_orientation);
+  TEB_CONFIG_PARAMETER(trajectory.global_plan_viapoint_sep);
+  TEB_CONFIG_PARAMETER(trajectory.via_points_ordered);
+  TEB_CONFIG_PARAMETER(trajectory.max_global_plan_lookahead_dist);
+  TEB_CONFIG_PARAMETER(trajectory.force_reinit_new_goal_dist);
+  TEB_CONFIG_PARAMETER(trajectory.feasibility_check_no_poses);
+  TEB_CONFIG_PARAMETER(trajectory.shrink_horizon_backup);
+  TEB_CONFIG_PARAMETER(trajectory.horizon_reduction_amount);
+  TEB_CONFIG_PARAMETER(trajectory.teb_init_skip_dist);
+
+  TEB_CONFIG_PARAMETER(robot.max_vel_x);
+  TEB_CONFIG_PARAMETER(robot.min_vel_x);
+  TEB_CONFIG_PARAMETER(robot.max_vel_x_backwards);
+  TEB_CONFIG_PARAMETER(robot.min_vel_x_backwards);
+  TEB_CONFIG_PARAMETER(robot.max_vel_theta);
+  TEB_CONFIG_PARAMETER(robot.min_vel_theta);
+  TEB_CONFIG_PARAMETER(robot.acc_lim_x);
+  TEB_CONFIG_PARAMETER(robot.acc_lim_theta);
+  TEB_CONFIG_PARAMETER(robot.min_turning_radius);
+  TEB_CONFIG_PARAMETER(robot.wheelbase);
+  TEB_CONFIG_PARAMETER(robot.cmd_angle_instead_rotvel);
+
+  TEB_CONFIG_PARAMETER(human.radius);
+  TEB_CONFIG_PARAMETER(human.min_human_robot_dist);
+  TEB_CONFIG_PARAMETER(human.min_human_human_dist);
+  TEB_CONFIG_PARAMETER(human.max_vel_x);
+  TEB_CONFIG_PARAMETER(human.min_vel_x);
+  TEB_CONFIG_PARAMETER(human.nominal_vel_x);
+  TEB_CONFIG_PARAMETER(human.max_vel_x_backwards);
+  TEB_CONFIG_PARAMETER(human.min_vel_x_backwards);
+  TEB_CONFIG_PARAMETER(human.max_vel_theta);
+  TEB_CONFIG_PARAMETER(human.min_vel_theta);
+  TEB_CONFIG_PARAMETER(human.acc_lim_x);
+  TEB_CONFIG_PARAMETER(human.acc_lim_theta);
+  TEB_CONFIG_PARAMETER(human.use_external_prediction);
+  TEB_CONFIG_PARAMETER(human.predict_human_behind_robot);
+  TEB_CONFIG_PARAMETER(human.ttc_threshold);
+  TEB_CONFIG_PARAMETER(human.dir_cost_threshold);
+  TEB_CONFIG_PARAMETER(human.cull_interactions);
+  TEB_CONFIG_PARAMETER(human.interaction_margin);
+  TEB_CONFIG_PARAMETER(human.no_update_threads);
+
+  TEB_CONFIG_PARAMETER(goal_tolerance.yaw_goal_tolerance);
+  TEB_CONFIG_PARAMETER(goal_tolerance.xy_goal_tolerance);
+  TEB_CONFIG_PARAMETER(goal_tolerance.free_goal_vel);
+
+  TEB_CONFIG_PARAMETER(obstacles.min_obstacle_dist);
+  TEB_CONFIG_PARAMETER(obstacles.use_nonlinear_obstacle_penalty);
+  TEB_CONFIG_PARAMETER(obstacles.obstacle_cost_mult);
+  TEB_CONFIG_PARAMETER(obstacles.include_costmap_obstacles);
+  TEB_CONFIG_PARAMETER(obstacles.costmap_obstacles_behind_robot_dist);
+  TEB_CONFIG_PARAMETER(obstacles.obstacle_poses_affected);
+  TEB_CONFIG_PARAMETER(obstacles.obstacle_distance_field);
+  TEB_CONFIG_PARAMETER(obstacles.footprint_circles);
+
+  TEB_CONFIG_PARAMETER(optim.no_inner_iterations);
+  TEB_CONFIG_PARAMETER(optim.no_outer_iterations);
+  TEB_CONFIG_PARAMETER(optim.optimization_time_budget);
+  TEB_CONFIG_PARAMETER(optim.convergence_threshold);
+  TEB_CONFIG_PARAMETER(optim.optimization_activate);
+  TEB_CONFIG_PARAMETER(optim.penalty_epsilon);
+  TEB_CONFIG_PARAMETER(optim.time_penalty_epsilon);
+  TEB_CONFIG_PARAMETER(optim.cap_optimaltime_penalty);
+  TEB_CONFIG_PARAMETER(optim.weight_max_vel_x);
+  TEB_CONFIG_PARAMETER(optim.weight_max_human_vel_x);
+  TEB_CONFIG_PARAMETER(optim.weight_nominal_human_vel_x);
+  TEB_CONFIG_PARAMETER(optim.weight_max_vel_theta);
+  TEB_CONFIG_PARAMETER(optim.weight_max_human_vel_theta);
+  TEB_CONFIG_PARAMETER(optim.weight_acc_lim_x);
+  TEB_CONFIG_PARAMETER(optim.weight_human_acc_lim_x);
+  TEB_CONFIG_PARAMETER(optim.weight_acc_lim_theta);
+  TEB_CONFIG_PARAMETER(optim.weight_human_acc_lim_theta);
+  TEB_CONFIG_PARAMETER(optim.weight_kinematics_nh);
+  TEB_CONFIG_PARAMETER(optim.weight_kinematics_forward_drive);
+  TEB_CONFIG_PARAMETER(optim.weight_kinematics_turning_radius);
+  TEB_CONFIG_PARAMETER(optim.weight_optimaltime);
+  TEB_CONFIG_PARAMETER(optim.weight_human_optimaltime);
+  TEB_CONFIG_PARAMETER(optim.weight_obstacle);
+  TEB_CONFIG_PARAMETER(optim.weight_dynamic_obstacle);
+  TEB_CONFIG_PARAMETER(optim.weight_viapoint);
+  TEB_CONFIG_PARAMETER(optim.weight_human_viapoint);
+  TEB_CONFIG_PARAMETER(optim.weight_human_robot_safety);
+  TEB_CONFIG_PARAMETER(optim.weight_human_human_safety);
+  TEB_CONFIG_PARAMETER(optim.weight_human_robot_ttc);
+  TEB_CONFIG_PARAMETER(optim.weight_human_robot_dir);
+  TEB_CONFIG_PARAMETER(optim.human_robot_ttc_scale_alpha);
+  TEB_CONFIG_PARAMETER(optim.use_human_robot_safety_c);
+  TEB_CONFIG_PARAMETER(optim.use_human_human_safety_c);
+  TEB_CONFIG_PARAMETER(optim.use_human_robot_ttc_c);
+  TEB_CONFIG_PARAMETER(optim.scale_human_robot_ttc_c);
+  TEB_CONFIG_PARAMETER(optim.use_human_robot_dir_c);
+  TEB_CONFIG_PARAMETER(optim.use_human_elastic_vel);
+  TEB_CONFIG_PARAMETER(optim.disable_warm_start);
+  TEB_CONFIG_PARAMETER(optim.disable_rapid_omega_chage);
+  TEB_CONFIG_PARAMETER(optim.omega_chage_time_seperation);
+  TEB_CONFIG_PARAMETER(optim.persistent_graph);
+  TEB_CONFIG_PARAMETER(optim.linear_solver);
+  TEB_CONFIG_PARAMETER(optim.linear_solver_auto_vertices);
+
+  TEB_CONFIG_PARAMETER(hcp.enable_homotopy_class_planning);
+  TEB_CONFIG_PARAMETER(hcp.enable_multithreading);
+  TEB_CONFIG_PARAMETER(hcp.no_optimization_threads);
+  TEB_CONFIG_PARAMETER(hcp.cancel_cost_ratio);
+  TEB_CONFIG_PARAMETER(hcp.simple_exploration);
+  TEB_CONFIG_PARAMETER(hcp.max_number_classes);
+  TEB_CONFIG_PARAMETER(hcp.exploration_time_budget);
+  TEB_CONFIG_PARAMETER(hcp.selection_cost_hysteresis);
+  TEB_CONFIG_PARAMETER(hcp.selection_obst_cost_scale);
+  TEB_CONFIG_PARAMETER(hcp.selection_viapoint_cost_scale);
+  TEB_CONFIG_PARAMETER(hcp.selection_alternative_time_cost);
+  TEB_CONFIG_PARAMETER(hcp.roadmap_graph_no_samples);
+  TEB_CONFIG_PARAMETER(hcp.roadmap_graph_incremental);
+  TEB_CONFIG_PARAMETER(hcp.roadmap_graph_area_width);
+  TEB_CONFIG_PARAMETER(hcp.h_signature_prescaler);
+  TEB_CONFIG_PARAMETER(hcp.h_signature_threshold);
+  TEB_CONFIG_PARAMETER(hcp.obstacle_keypoint_offset);
+  TEB_CONFIG_PARAMETER(hcp.obstacle_heading_threshold);
+  TEB_CONFIG_PARAMETER(hcp.viapoints_all_candidates);
+
+  TEB_CONFIG_PARAMETER(approach.approach_id);
+  TEB_CONFIG_PARAMETER(approach.approach_dist);
+  TEB_CONFIG_PARAMETER(approach.approach_angle);
+  TEB_CONFIG_PARAMETER(approach.approach_dist_tolerance);
+  TEB_CONFIG_PARAMETER(approach.approach_angle_tolerance);
+}
+
+#undef TEB_CONFIG_PARAMETER
+
+} // namespace teb_local_planner
+
+#endif // CYCLE_RECORDER_H_
@@ -0,0 +1,109 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DISTANCE_FIELD_H_
+#define DISTANCE_FIELD_H_
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class DistanceField
+ * @brief Euclidean distance transform of an occupancy grid (e.g. the local
+ * costmap) with bilinear interpolation.
+ *
+ * The distance is stored for the center of each cell and refers to the center
+ * of the closest occupied cell, like the point obstacles created for lethal
+ * costmap cells. Positions outside of the grid are clamped to its border.
+ */
+class DistanceField {
+public:
+  DistanceField();
+
+  /**
+   * @brief Compute the distance transform of a grid
+   * @param grid row-major cell values (index = y * size_x + x)
+   * @param size_x number of cells along x
+   * @param size_y number of cells along y
+   * @param resolution edge length of the cells [m]
+   * @param origin_x x-coordinate of the lower left corner of the grid [m]
+   * @param origin_y y-coordinate of the lower left corner of the grid [m]
+   * @param occupied value of occupied cells
+   */
+  void build(const unsigned char *grid, unsigned int size_x,
+             unsigned int size_y, double resolution, double origin_x,
+             double origin_y, unsigned char occupied);
+
+  /**
+   * @brief Remove the field, empty() returns \c true afterwards
+   */
+  void clear();
+
+  /**
+   * @brief Check whether the field has been built from a grid that contains at
+   * least one occupied cell
+   */
+  bool empty() const { return !has_obstacles_; }
+
+  /**
+   * @brief Interpolated distance to the closest occupied cell
+   * @param position 2D position [m]
+   * @param[out] gradient gradient of the interpolated distance w.r.t. the
+   * position (optional)
+   * @return distance [m]
+   */
+  double distance(const Eigen::Ref<const Eigen::Vector2d> &position,
+                  Eigen::Vector2d *gradient = NULL) const;
+
+private:
+  //! 1D squared distance transform of f into d (Felzenszwalb & Huttenlocher)
+  void transform1D(const float *f, float *d, int n);
+
+  std::vector<float> distances_; //!< Distance of each cell center [m]
+  unsigned int size_x_, size_y_;
+  double resolution_, origin_x_, origin_y_;
+  bool has_obstacles_;
+
+  // buffers of transform1D()
+  std::vector<int> envelope_vertices_;
+  std::vector<float> envelope_bounds_, column_in_, column_out_;
+};
+
+} // namespace teb_local_planner
+
+#endif // DISTANCE_FIELD_H_
@@ -0,0 +1,126 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef DERIVATIVES_H_
+#define DERIVATIVES_H_
+
+#include <teb_local_planner/g2o_types/vertex_pose.h>
+#include <teb_local_planner/misc.h>
+
+#include <Eigen/Core>
+
+#include <cmath>
+
+namespace teb_local_planner {
+
+/**
+ * @brief Translational velocity between two consecutive poses and its
+ * derivatives
+ *
+ * The velocity is computed like in the velocity and acceleration edges: the
+ * distance between the poses divided by the time difference, signed by the
+ * direction of motion w.r.t. the orientation of the first pose.
+ * @param pose1 first pose
+ * @param pose2 second pose
+ * @param dt time difference between both poses
+ * @param[out] d_position2 derivative w.r.t. the position of the second pose,
+ * the one w.r.t. the position of the first pose is its negative
+ * @param[out] d_theta1 derivative w.r.t. the orientation of the first pose
+ * @param[out] d_dt derivative w.r.t. the time difference
+ * @return signed translational velocity
+ */
+inline double signedVelocity(const VertexPose *pose1, const VertexPose *pose2,
+                             double dt, Eigen::Vector2d &d_position2,
+                             double &d_theta1, double &d_dt) {
+  Eigen::Vector2d diff = pose2->position() - pose1->position();
+  double dist = diff.norm();
+  double cos_theta = std::cos(pose1->theta());
+  double sin_theta = std::sin(pose1->theta());
+
+  double direction = 100 * (diff.x() * cos_theta + diff.y() * sin_theta);
+  double sigmoid = fast_sigmoid(direction);
+  double d_sigmoid = 100 * fast_sigmoid_derivative(direction);
+  double vel = dist / dt * sigmoid;
+
+  d_position2 = d_sigmoid * dist / dt * Eigen::Vector2d(cos_theta, sin_theta);
+  if (dist > 0)
+    d_position2 += sigmoid / (dist * dt) * diff;
+  d_theta1 = d_sigmoid * dist / dt *
+             (-diff.x() * sin_theta + diff.y() * cos_theta);
+  d_dt = -vel / dt;
+  return vel;
+}
+
+/**
+ * @brief Position of a point given in the frame of a pose (e.g. the center of
+ * a footprint circle) and its derivative w.r.t. the orientation of the pose
+ * @param pose pose of the frame
+ * @param local position of the point w.r.t. the frame
+ * @param[out] d_theta derivative w.r.t. the orientation of the pose, the one
+ * w.r.t. the position of the pose is the identity
+ * @return position of the point in the world frame
+ */
+inline Eigen::Vector2d
+attachedPoint(const VertexPose *pose, const Eigen::Vector2d &local,
+              Eigen::Vector2d &d_theta) {
+  double cos_theta = std::cos(pose->theta());
+  double sin_theta = std::sin(pose->theta());
+  d_theta.x() = -sin_theta * local.x() - cos_theta * local.y();
+  d_theta.y() = cos_theta * local.x() - sin_theta * local.y();
+  return pose->position() +
+         Eigen::Vector2d(cos_theta * local.x() - sin_theta * local.y(),
+                         sin_theta * local.x() + cos_theta * local.y());
+}
+
+/**
+ * @brief Gradient of the distance between a position and its closest point on
+ * an obstacle w.r.t. the position
+ * @param position reference position
+ * @param closest_point closest point to the position
+ * @return unit vector pointing away from the closest point, zero if both
+ * points coincide
+ */
+inline Eigen::Vector2d distanceGradient(const Eigen::Vector2d &position,
+                                        const Eigen::Vector2d &closest_point) {
+  Eigen::Vector2d diff = position - closest_point;
+  double dist = diff.norm();
+  if (dist == 0)
+    return Eigen::Vector2d::Zero();
+  return diff / dist;
+}
+
+} // namespace teb_local_planner
+
+#endif // DERIVATIVES_H_
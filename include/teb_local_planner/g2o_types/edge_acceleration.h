@@ -50,6 +50,8 @@
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
+#include <teb_local_planner/g2o_types/derivatives.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -57,6 +59,178 @@
 
 namespace teb_local_planner {
 
+/**
+ * @brief Jacobi matrices of the acceleration cost of EdgeAcceleration and
+ * EdgeAccelerationHuman
+ * @param pose1 first pose
+ * @param pose2 second pose
+ * @param pose3 third pose
+ * @param dt1 time difference between the first and the second pose
+ * @param dt2 time difference between the second and the third pose
+ * @param acc_lim_x translational acceleration limit
+ * @param acc_lim_theta rotational acceleration limit
+ * @param epsilon safety margin of the penalty
+ * @param[out] jacobians derivatives w.r.t. pose1, pose2, pose3, dt1 and dt2
+ */
+template <typename JacobianVector>
+inline void accelerationJacobians(const VertexPose *pose1,
+                                  const VertexPose *pose2,
+                                  const VertexPose *pose3, double dt1,
+                                  double dt2, double acc_lim_x,
+                                  double acc_lim_theta, double epsilon,
+                                  JacobianVector &jacobians) {
+  for (int i = 0; i < 5; ++i)
+    jacobians[i].setZero();
+
+  double aux = 2 / (dt1 + dt2);
+
+  // translational acceleration
+  Eigen::Vector2d dev_vel1_pos, dev_vel2_pos;
+  double dev_vel1_angle, dev_vel2_angle, dev_vel1_dt, dev_vel2_dt;
+  double vel1 = signedVelocity(pose1, pose2, dt1, dev_vel1_pos,
+                               dev_vel1_angle, dev_vel1_dt);
+  double vel2 = signedVelocity(pose2, pose3, dt2, dev_vel2_pos,
+                               dev_vel2_angle, dev_vel2_dt);
+  double acc_lin = (vel2 - vel1) * aux;
+  double dev_acc_lin =
+      penaltyBoundToIntervalDerivative(acc_lin, acc_lim_x, epsilon);
+
+  if (dev_acc_lin != 0) {
+    double dev = dev_acc_lin * aux;
+    jacobians[0].template block<1, 2>(0, 0) = dev * dev_vel1_pos.transpose();
+    jacobians[0](0, 2) = -dev * dev_vel1_angle;
+    jacobians[1].template block<1, 2>(0, 0) =
+        -dev * (dev_vel1_pos + dev_vel2_pos).transpose();
+    jacobians[1](0, 2) = dev * dev_vel2_angle;
+    jacobians[2].template block<1, 2>(0, 0) = dev * dev_vel2_pos.transpose();
+    jacobians[3](0, 0) = -dev * dev_vel1_dt - dev_acc_lin * acc_lin * aux / 2;
+    jacobians[4](0, 0) = dev * dev_vel2_dt - dev_acc_lin * acc_lin * aux / 2;
+  }
+
+  // rotational acceleration
+  double omega1 = g2o::normalize_theta(pose2->theta() - pose1->theta()) / dt1;
+  double omega2 = g2o::normalize_theta(pose3->theta() - pose2->theta()) / dt2;
+  double acc_rot = (omega2 - omega1) * aux;
+  double dev_acc_rot =
+      penaltyBoundToIntervalDerivative(acc_rot, acc_lim_theta, epsilon);
+
+  if (dev_acc_rot != 0) {
+    double dev = dev_acc_rot * aux;
+    jacobians[0](1, 2) = dev / dt1;
+    jacobians[1](1, 2) = -dev * (1 / dt1 + 1 / dt2);
+    jacobians[2](1, 2) = dev / dt2;
+    jacobians[3](1, 0) = dev * omega1 / dt1 - dev_acc_rot * acc_rot * aux / 2;
+    jacobians[4](1, 0) = -dev * omega2 / dt2 - dev_acc_rot * acc_rot * aux / 2;
+  }
+}
+
+/**
+ * @brief Jacobi matrices of the acceleration cost of EdgeAccelerationStart and
+ * EdgeAccelerationHumanStart
+ * @param pose1 start pose
+ * @param pose2 second pose
+ * @param dt time difference between both poses
+ * @param vel_start initial translational and rotational velocity
+ * @param acc_lim_x translational acceleration limit
+ * @param acc_lim_theta rotational acceleration limit
+ * @param epsilon safety margin of the penalty
+ * @param[out] jacobians derivatives w.r.t. pose1, pose2 and dt
+ */
+template <typename JacobianVector>
+inline void accelerationStartJacobians(const VertexPose *pose1,
+                                       const VertexPose *pose2, double dt,
+                                       const Eigen::Vector2d &vel_start,
+                                       double acc_lim_x, double acc_lim_theta,
+                                       double epsilon,
+                                       JacobianVector &jacobians) {
+  for (int i = 0; i < 3; ++i)
+    jacobians[i].setZero();
+
+  // translational acceleration
+  Eigen::Vector2d dev_vel_pos;
+  double dev_vel_angle, dev_vel_dt;
+  double vel2 =
+      signedVelocity(pose1, pose2, dt, dev_vel_pos, dev_vel_angle, dev_vel_dt);
+  double acc_lin = (vel2 - vel_start.coeff(0)) / dt;
+  double dev_acc_lin =
+      penaltyBoundToIntervalDerivative(acc_lin, acc_lim_x, epsilon);
+
+  if (dev_acc_lin != 0) {
+    double dev = dev_acc_lin / dt;
+    jacobians[0].template block<1, 2>(0, 0) = -dev * dev_vel_pos.transpose();
+    jacobians[0](0, 2) = dev * dev_vel_angle;
+    jacobians[1].template block<1, 2>(0, 0) = dev * dev_vel_pos.transpose();
+    jacobians[2](0, 0) = dev * (dev_vel_dt - acc_lin);
+  }
+
+  // rotational acceleration
+  double omega2 = g2o::normalize_theta(pose2->theta() - pose1->theta()) / dt;
+  double acc_rot = (omega2 - vel_start.coeff(1)) / dt;
+  double dev_acc_rot =
+      penaltyBoundToIntervalDerivative(acc_rot, acc_lim_theta, epsilon);
+
+  if (dev_acc_rot != 0) {
+    double dev = dev_acc_rot / dt;
+    jacobians[0](1, 2) = -dev / dt;
+    jacobians[1](1, 2) = dev / dt;
+    jacobians[2](1, 0) = -dev * (omega2 / dt + acc_rot);
+  }
+}
+
+/**
+ * @brief Jacobi matrices of the acceleration cost of EdgeAccelerationGoal and
+ * EdgeAccelerationHumanGoal
+ * @param pose_pre_goal second to last pose
+ * @param pose_goal goal pose
+ * @param dt time difference between both poses
+ * @param vel_goal final translational and rotational velocity
+ * @param acc_lim_x translational acceleration limit
+ * @param acc_lim_theta rotational acceleration limit
+ * @param epsilon safety margin of the penalty
+ * @param[out] jacobians derivatives w.r.t. pose_pre_goal, pose_goal and dt
+ */
+template <typename JacobianVector>
+inline void accelerationGoalJacobians(const VertexPose *pose_pre_goal,
+                                      const VertexPose *pose_goal, double dt,
+                                      const Eigen::Vector2d &vel_goal,
+                                      double acc_lim_x, double acc_lim_theta,
+                                      double epsilon,
+                                      JacobianVector &jacobians) {
+  for (int i = 0; i < 3; ++i)
+    jacobians[i].setZero();
+
+  // translational acceleration
+  Eigen::Vector2d dev_vel_pos;
+  double dev_vel_angle, dev_vel_dt;
+  double vel1 = signedVelocity(pose_pre_goal, pose_goal, dt, dev_vel_pos,
+                               dev_vel_angle, dev_vel_dt);
+  double acc_lin = (vel_goal.coeff(0) - vel1) / dt;
+  double dev_acc_lin =
+      penaltyBoundToIntervalDerivative(acc_lin, acc_lim_x, epsilon);
+
+  if (dev_acc_lin != 0) {
+    double dev = dev_acc_lin / dt;
+    jacobians[0].template block<1, 2>(0, 0) = dev * dev_vel_pos.transpose();
+    jacobians[0](0, 2) = -dev * dev_vel_angle;
+    jacobians[1].template block<1, 2>(0, 0) = -dev * dev_vel_pos.transpose();
+    jacobians[2](0, 0) = -dev * (dev_vel_dt + acc_lin);
+  }
+
+  // rotational acceleration
+  double omega1 =
+      g2o::normalize_theta(pose_goal->theta() - pose_pre_goal->theta()) / dt;
+  double acc_rot = (vel_goal.coeff(1) - omega1) / dt;
+  double dev_acc_rot =
+      penaltyBoundToIntervalDerivative(acc_rot, acc_lim_theta, epsilon);
+
+  if (dev_acc_rot != 0) {
+    double dev = dev_acc_rot / dt;
+    jacobians[0](1, 2) = dev / dt;
+    jacobians[1](1, 2) = -dev / dt;
+    jacobians[2](1, 0) = dev * (omega1 / dt - acc_rot);
+  }
+}
+
 /**
  * @class EdgeAcceleration
  * @brief Edge defining the cost function for limiting the translational and
@@ -163,114 +337,23 @@ public:
   }
 
 #ifdef USE_ANALYTIC_JACOBI
-#if 0
-  /*
+  /**
    * @brief Jacobi matrix of the cost function specified in computeError().
    */
-  void linearizeOplus()
-  {
+  void linearizeOplus() {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeAcceleration()");
-    const VertexPointXY* conf1 = static_cast<const VertexPointXY*>(_vertices[0]);
-    const VertexPointXY* conf2 = static_cast<const VertexPointXY*>(_vertices[1]);
-    const VertexPointXY* conf3 = static_cast<const VertexPointXY*>(_vertices[2]);
-    const VertexTimeDiff* deltaT1 = static_cast<const VertexTimeDiff*>(_vertices[3]);
-    const VertexTimeDiff* deltaT2 = static_cast<const VertexTimeDiff*>(_vertices[4]);
-    const VertexOrientation* angle1 = static_cast<const VertexOrientation*>(_vertices[5]);
-    const VertexOrientation* angle2 = static_cast<const VertexOrientation*>(_vertices[6]);
-    const VertexOrientation* angle3 = static_cast<const VertexOrientation*>(_vertices[7]);
-
-    Eigen::Vector2d deltaS1 = conf2->estimate() - conf1->estimate();
-    Eigen::Vector2d deltaS2 = conf3->estimate() - conf2->estimate();
-    double dist1 = deltaS1.norm();
-    double dist2 = deltaS2.norm();
-
-    double sum_time = deltaT1->estimate() + deltaT2->estimate();
-    double sum_time_inv = 1 / sum_time;
-    double dt1_inv = 1/deltaT1->estimate();
-    double dt2_inv = 1/deltaT2->estimate();
-    double aux0 = 2/sum_time_inv;
-    double aux1 = dist1 * deltaT1->estimate();
-    double aux2 = dist2 * deltaT2->estimate();
-
-    double vel1 = dist1 * dt1_inv;
-    double vel2 = dist2 * dt2_inv;
-    double omega1 = g2o::normalize_theta( angle2->estimate() - angle1->estimate() ) * dt1_inv;
-    double omega2 = g2o::normalize_theta( angle3->estimate() - angle2->estimate() ) * dt2_inv;
-    double acc = (vel2 - vel1) * aux0;
-    double omegadot = (omega2 - omega1) * aux0;
-    double aux3 = -acc/2;
-    double aux4 = -omegadot/2;
-
-    double dev_border_acc = penaltyBoundToIntervalDerivative(acc, tebConfig.robot_acceleration_max_trans,optimizationConfig.optimization_boundaries_epsilon,optimizationConfig.optimization_boundaries_scale,optimizationConfig.optimization_boundaries_order);
-    double dev_border_omegadot = penaltyBoundToIntervalDerivative(omegadot, tebConfig.robot_acceleration_max_rot,optimizationConfig.optimization_boundaries_epsilon,optimizationConfig.optimization_boundaries_scale,optimizationConfig.optimization_boundaries_order);
-
-    _jacobianOplus[0].resize(2,2); // conf1
-    _jacobianOplus[1].resize(2,2); // conf2
-    _jacobianOplus[2].resize(2,2); // conf3
-    _jacobianOplus[3].resize(2,1); // deltaT1
-    _jacobianOplus[4].resize(2,1); // deltaT2
-    _jacobianOplus[5].resize(2,1); // angle1
-    _jacobianOplus[6].resize(2,1); // angle2
-    _jacobianOplus[7].resize(2,1); // angle3
-
-    if (aux1==0) aux1=1e-20;
-    if (aux2==0) aux2=1e-20;
-
-    if (dev_border_acc!=0)
-    {
-      // TODO: double aux = aux0 * dev_border_acc;
-      // double aux123 = aux / aux1;
-      _jacobianOplus[0](0,0) = aux0 * deltaS1[0] / aux1 * dev_border_acc; // acc x1
-      _jacobianOplus[0](0,1) = aux0 * deltaS1[1] / aux1 * dev_border_acc; // acc y1
-      _jacobianOplus[1](0,0) = -aux0 * ( deltaS1[0] / aux1 + deltaS2[0] / aux2 ) * dev_border_acc; // acc x2
-      _jacobianOplus[1](0,1) = -aux0 * ( deltaS1[1] / aux1 + deltaS2[1] / aux2 ) * dev_border_acc; // acc y2
-      _jacobianOplus[2](0,0) = aux0 * deltaS2[0] / aux2 * dev_border_acc; // acc x3
-      _jacobianOplus[2](0,1) = aux0 * deltaS2[1] / aux2 * dev_border_acc; // acc y3
-      _jacobianOplus[2](0,0) = 0;
-      _jacobianOplus[2](0,1) = 0;
-      _jacobianOplus[3](0,0) = aux0 * (aux3 + vel1 * dt1_inv) * dev_border_acc; // acc deltaT1
-      _jacobianOplus[4](0,0) = aux0 * (aux3 - vel2 * dt2_inv) * dev_border_acc; // acc deltaT2
-    }
-    else
-    {
-      _jacobianOplus[0](0,0) = 0; // acc x1
-      _jacobianOplus[0](0,1) = 0; // acc y1
-      _jacobianOplus[1](0,0) = 0; // acc x2
-      _jacobianOplus[1](0,1) = 0; // acc y2
-      _jacobianOplus[2](0,0) = 0; // acc x3
-      _jacobianOplus[2](0,1) = 0; // acc y3
-      _jacobianOplus[3](0,0) = 0; // acc deltaT1
-      _jacobianOplus[4](0,0) = 0; // acc deltaT2
-    }
-
-    if (dev_border_omegadot!=0)
-    {
-      _jacobianOplus[3](1,0) = aux0 * ( aux4 + omega1 * dt1_inv ) * dev_border_omegadot; // omegadot deltaT1
-      _jacobianOplus[4](1,0) = aux0 * ( aux4 - omega2 * dt2_inv ) * dev_border_omegadot; // omegadot deltaT2
-      _jacobianOplus[5](1,0) = aux0 * dt1_inv * dev_border_omegadot; // omegadot angle1
-      _jacobianOplus[6](1,0) = -aux0 * ( dt1_inv + dt2_inv ) * dev_border_omegadot; // omegadot angle2
-      _jacobianOplus[7](1,0) = aux0 * dt2_inv * dev_border_omegadot; // omegadot angle3
-    }
-    else
-    {
-      _jacobianOplus[3](1,0) = 0; // omegadot deltaT1
-      _jacobianOplus[4](1,0) = 0; // omegadot deltaT2
-      _jacobianOplus[5](1,0) = 0; // omegadot angle1
-      _jacobianOplus[6](1,0) = 0; // omegadot angle2
-      _jacobianOplus[7](1,0) = 0; // omegadot angle3
-    }
+    const VertexPose *pose1 = static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *pose2 = static_cast<const VertexPose *>(_vertices[1]);
+    const VertexPose *pose3 = static_cast<const VertexPose *>(_vertices[2]);
+    const VertexTimeDiff *dt1 =
+        static_cast<const VertexTimeDiff *>(_vertices[3]);
+    const VertexTimeDiff *dt2 =
+        static_cast<const VertexTimeDiff *>(_vertices[4]);
 
-    _jacobianOplus[0](1,0) = 0; // omegadot x1
-    _jacobianOplus[0](1,1) = 0; // omegadot y1
-    _jacobianOplus[1](1,0) = 0; // omegadot x2
-    _jacobianOplus[1](1,1) = 0; // omegadot y2
-    _jacobianOplus[2](1,0) = 0; // omegadot x3
-    _jacobianOplus[2](1,1) = 0; // omegadot y3
-    _jacobianOplus[5](0,0) = 0; // acc angle1
-    _jacobianOplus[6](0,0) = 0; // acc angle2
-    _jacobianOplus[7](0,0) = 0; // acc angle3
-    }
-#endif
+    accelerationJacobians(pose1, pose2, pose3, dt1->dt(), dt2->dt(),
+                          cfg_->robot.acc_lim_x, cfg_->robot.acc_lim_theta,
+                          cfg_->optim.penalty_epsilon, _jacobianOplus);
+  }
 #endif
 
   /**
@@ -314,7 +397,7 @@ protected:
   const TebConfig *cfg_; //!< Store TebConfig class for parameters
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeAcceleration)
 };
 
 class EdgeAccelerationHuman : public g2o::BaseMultiEdge<2, double> {
@@ -382,6 +465,24 @@ public:
         _error[1]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_,
+                   "You must call setTebConfig on EdgeAccelerationHuman()");
+    const VertexPose *pose1 = static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *pose2 = static_cast<const VertexPose *>(_vertices[1]);
+    const VertexPose *pose3 = static_cast<const VertexPose *>(_vertices[2]);
+    const VertexTimeDiff *dt1 =
+        static_cast<const VertexTimeDiff *>(_vertices[3]);
+    const VertexTimeDiff *dt2 =
+        static_cast<const VertexTimeDiff *>(_vertices[4]);
+
+    accelerationJacobians(pose1, pose2, pose3, dt1->dt(), dt2->dt(),
+                          cfg_->human.acc_lim_x, cfg_->human.acc_lim_theta,
+                          cfg_->optim.penalty_epsilon, _jacobianOplus);
+  }
+#endif
+
   ErrorVector &getError() {
     computeError();
     return _error;
@@ -405,7 +506,7 @@ protected:
   const TebConfig *cfg_;
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeAccelerationHuman)
 };
 
 /**
@@ -508,6 +609,25 @@ public:
         _error[1]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and "
+                                         "setInitialVelocity() on "
+                                         "EdgeAccelerationStart()");
+    const VertexPose *pose1 = static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *pose2 = static_cast<const VertexPose *>(_vertices[1]);
+    const VertexTimeDiff *dt =
+        static_cast<const VertexTimeDiff *>(_vertices[2]);
+
+    accelerationStartJacobians(pose1, pose2, dt->dt(), *_measurement,
+                               cfg_->robot.acc_lim_x, cfg_->robot.acc_lim_theta,
+                               cfg_->optim.penalty_epsilon, _jacobianOplus);
+  }
+#endif
+
   /**
    * @brief Compute and return error / cost value.
    *
@@ -557,7 +677,7 @@ protected:
   const TebConfig *cfg_; //!< Store TebConfig class for parameters
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeAccelerationStart)
 };
 
 class EdgeAccelerationHumanStart
@@ -618,6 +738,22 @@ public:
         _error[1]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and "
+                                         "setInitialVelocity() on "
+                                         "EdgeAccelerationHumanStart()");
+    const VertexPose *pose1 = static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *pose2 = static_cast<const VertexPose *>(_vertices[1]);
+    const VertexTimeDiff *dt =
+        static_cast<const VertexTimeDiff *>(_vertices[2]);
+
+    accelerationStartJacobians(pose1, pose2, dt->dt(), *_measurement,
+                               cfg_->human.acc_lim_x, cfg_->human.acc_lim_theta,
+                               cfg_->optim.penalty_epsilon, _jacobianOplus);
+  }
+#endif
+
   ErrorVector &getError() {
     computeError();
     return _error;
@@ -644,7 +780,7 @@ protected:
   const TebConfig *cfg_;
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeAccelerationHumanStart)
 };
 
 /**
@@ -750,6 +886,25 @@ public:
         _error[1]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and "
+                                         "setGoalVelocity() on "
+                                         "EdgeAccelerationGoal()");
+    const VertexPose *pose1 = static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *pose2 = static_cast<const VertexPose *>(_vertices[1]);
+    const VertexTimeDiff *dt =
+        static_cast<const VertexTimeDiff *>(_vertices[2]);
+
+    accelerationGoalJacobians(pose1, pose2, dt->dt(), *_measurement,
+                              cfg_->robot.acc_lim_x, cfg_->robot.acc_lim_theta,
+                              cfg_->optim.penalty_epsilon, _jacobianOplus);
+  }
+#endif
+
   /**
    * @brief Compute and return error / cost value.
    *
@@ -800,7 +955,7 @@ protected:
   const TebConfig *cfg_; //!< Store TebConfig class for parameters
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeAccelerationGoal)
 };
 
 class EdgeAccelerationHumanGoal
@@ -866,6 +1021,22 @@ public:
         _error[1]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig() and "
+                                         "setGoalVelocity() on "
+                                         "EdgeAccelerationHumanGoal()");
+    const VertexPose *pose1 = static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *pose2 = static_cast<const VertexPose *>(_vertices[1]);
+    const VertexTimeDiff *dt =
+        static_cast<const VertexTimeDiff *>(_vertices[2]);
+
+    accelerationGoalJacobians(pose1, pose2, dt->dt(), *_measurement,
+                              cfg_->human.acc_lim_x, cfg_->human.acc_lim_theta,
+                              cfg_->optim.penalty_epsilon, _jacobianOplus);
+  }
+#endif
+
   ErrorVector &getError() {
     computeError();
     return _error;
@@ -893,7 +1064,7 @@ protected:
   const TebConfig *cfg_;
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeAccelerationHumanGoal)
 };
 
 }; // end namespace
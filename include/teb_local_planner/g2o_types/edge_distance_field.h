@@ -0,0 +1,230 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef EDGE_DISTANCE_FIELD_H_
+#define EDGE_DISTANCE_FIELD_H_
+
+#include <teb_local_planner/distance_field.h>
+#include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/g2o_types/vertex_pose.h>
+#include <teb_local_planner/g2o_types/derivatives.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
+#include <teb_local_planner/g2o_types/penalties.h>
+#include <teb_local_planner/teb_config.h>
+
+#include "g2o/core/base_unary_edge.h"
+
+namespace teb_local_planner {
+
+/**
+ * @class EdgeDistanceField
+ * @brief Edge defining the cost function for keeping a minimum distance from
+ * all obstacles of a DistanceField.
+ *
+ * The footprint is decomposed into circles, the distance of the pose is the
+ * minimum over the circles of the interpolated distance of the circle center
+ * minus its radius. The penalties are the ones of EdgeObstacle, but a single
+ * edge per pose covers every obstacle of the field.
+ * @see TebOptimalPlanner::AddEdgesDistanceField
+ * @remarks Do not forget to call setParameters()
+ */
+class EdgeDistanceField : public g2o::BaseUnaryEdge<1, double, VertexPose> {
+public:
+  /**
+   * @brief Construct edge.
+   */
+  EdgeDistanceField() : cfg_(NULL), field_(NULL), circles_(NULL) {
+    _measurement = 0.;
+    _vertices[0] = NULL;
+  }
+
+  /**
+   * @brief Destruct edge.
+   *
+   * We need to erase vertices manually, since we want to keep them even if
+   * TebOptimalPlanner::clearGraph() is called.
+   * This is necessary since the vertices are managed by the Timed_Elastic_Band
+   * class.
+   */
+  virtual ~EdgeDistanceField() {
+    if (_vertices[0])
+      _vertices[0]->edges().erase(this);
+  }
+
+  /**
+   * @brief Actual cost function
+   */
+  void computeError() {
+    ROS_ASSERT_MSG(cfg_ && field_ && circles_,
+                   "You must call setParameters() on EdgeDistanceField()");
+    const VertexPose *bandpt = static_cast<const VertexPose *>(_vertices[0]);
+
+    double dist = closestCircleDistance(bandpt, NULL, NULL);
+
+    if (cfg_->obstacles.use_nonlinear_obstacle_penalty) {
+      _error[0] = penaltyBoundFromBelowExp(
+          dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon,
+          cfg_->obstacles.obstacle_cost_mult);
+    } else {
+      _error[0] = penaltyBoundFromBelow(dist, cfg_->obstacles.min_obstacle_dist,
+                                        cfg_->optim.penalty_epsilon);
+    }
+
+    ROS_ASSERT_MSG(std::isfinite(_error[0]),
+                   "EdgeDistanceField::computeError() _error[0]=%f\n",
+                   _error[0]);
+  }
+
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   *
+   * Chain rule through the circle with the minimum distance and the gradient
+   * of the bilinear interpolation of the field.
+   */
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ && field_ && circles_,
+                   "You must call setParameters() on EdgeDistanceField()");
+    const VertexPose *bandpt = static_cast<const VertexPose *>(_vertices[0]);
+
+    Eigen::Vector2d gradient;
+    const FootprintCircle *circle = NULL;
+    double dist = closestCircleDistance(bandpt, &gradient, &circle);
+
+    double dev_penalty;
+    if (cfg_->obstacles.use_nonlinear_obstacle_penalty) {
+      dev_penalty = penaltyBoundFromBelowExpDerivative(
+          dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon,
+          cfg_->obstacles.obstacle_cost_mult);
+    } else {
+      dev_penalty = penaltyBoundFromBelowDerivative(
+          dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon);
+    }
+
+    if (dev_penalty == 0. || !circle) {
+      _jacobianOplusXi.setZero();
+      return;
+    }
+
+    Eigen::Vector2d d_center;
+    attachedPoint(bandpt, Eigen::Vector2d(circle->x, circle->y), d_center);
+
+    _jacobianOplusXi(0, 0) = dev_penalty * gradient.x();
+    _jacobianOplusXi(0, 1) = dev_penalty * gradient.y();
+    _jacobianOplusXi(0, 2) = dev_penalty * gradient.dot(d_center);
+  }
+#endif
+
+  /**
+   * @brief Compute and return error / cost value.
+   *
+   * This method is called by TebOptimalPlanner::computeCurrentCost to obtain
+   * the current cost.
+   * @return 1D Cost / error vector
+   */
+  ErrorVector &getError() {
+    computeError();
+    return _error;
+  }
+
+  /**
+   * @brief Read values from input stream
+   */
+  virtual bool read(std::istream &is) { return true; }
+
+  /**
+   * @brief Write values to an output stream
+   */
+  virtual bool write(std::ostream &os) const { return os.good(); }
+
+  /**
+   * @brief Set all parameters at once
+   * @param cfg TebConfig class
+   * @param field distance field of the obstacles
+   * @param circles circle decomposition of the footprint
+   */
+  void setParameters(const TebConfig &cfg, const DistanceField *field,
+                     const FootprintCircles *circles) {
+    cfg_ = &cfg;
+    field_ = field;
+    circles_ = circles;
+  }
+
+protected:
+  /**
+   * @brief Minimum over the circles of the distance between the circle and the
+   * closest obstacle
+   * @param bandpt pose of the footprint
+   * @param[out] gradient gradient of the field at the center of the closest
+   * circle (optional)
+   * @param[out] closest closest circle (optional)
+   */
+  double closestCircleDistance(const VertexPose *bandpt,
+                               Eigen::Vector2d *gradient,
+                               const FootprintCircle **closest) const {
+    double sin_theta = std::sin(bandpt->theta());
+    double cos_theta = std::cos(bandpt->theta());
+
+    double dist = HUGE_VAL;
+    Eigen::Vector2d circle_gradient;
+    for (const auto &circle : *circles_) {
+      Eigen::Vector2d center(
+          bandpt->x() + cos_theta * circle.x - sin_theta * circle.y,
+          bandpt->y() + sin_theta * circle.x + cos_theta * circle.y);
+      double circle_dist =
+          field_->distance(center, gradient ? &circle_gradient : NULL) -
+          circle.radius;
+      if (circle_dist < dist) {
+        dist = circle_dist;
+        if (gradient)
+          *gradient = circle_gradient;
+        if (closest)
+          *closest = &circle;
+      }
+    }
+    return dist;
+  }
+
+  const TebConfig *cfg_;             //!< Store TebConfig class for parameters
+  const DistanceField *field_;       //!< Distance field of the obstacles
+  const FootprintCircles *circles_;  //!< Circle decomposition of the footprint
+
+public:
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeDistanceField)
+};
+
+} // end namespace
+
+#endif
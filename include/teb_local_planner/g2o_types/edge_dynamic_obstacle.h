@@ -46,6 +46,7 @@
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/obstacles.h>
 #include <teb_local_planner/teb_config.h>
@@ -132,6 +133,33 @@ public:
     ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeDynamicObstacle::computeError() _error[0]=%f _error[1]=%f\n",_error[0],_error[1]);	  
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeDynamicObstacle()");
+    const VertexPose* bandpt = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexTimeDiff* dt_vertex = static_cast<const VertexTimeDiff*>(_vertices[1]);
+    
+    Eigen::Vector2d pred_obst_point = _measurement->getCentroid() + double(vert_idx_)*dt_vertex->estimate()*_measurement->getCentroidVelocity();
+    Eigen::Vector2d deltaS = pred_obst_point - bandpt->position();
+    double dist = deltaS.norm();
+    
+    _jacobianOplusXi.setZero();
+    _jacobianOplusXj.setZero();
+    double dev_dist = penaltyBoundFromBelowDerivative(dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon);
+    if (dev_dist == 0 || dist == 0)
+      return;
+    
+    Eigen::Vector2d gradient = dev_dist / dist * deltaS; // w.r.t. the predicted obstacle position
+    _jacobianOplusXi(0,0) = -gradient[0];
+    _jacobianOplusXi(0,1) = -gradient[1];
+    _jacobianOplusXj(0,0) = double(vert_idx_) * gradient.dot(_measurement->getCentroidVelocity());
+  }
+#endif
+
   /**
    * @brief Compute and return error / cost value.
    * 
@@ -195,7 +223,7 @@ protected:
   size_t vert_idx_; //!< Store vertex index (position in the pose sequence)
   
 public: 
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeDynamicObstacle)
 
 };
     
@@ -35,6 +35,8 @@
 #ifndef EDGE_HUMAN_HUMAN_SAFETY_H_
 #define EDGE_HUMAN_HUMAN_SAFETY_H_
 
+#include <teb_local_planner/g2o_types/derivatives.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/teb_config.h>
@@ -80,6 +82,35 @@ public:
                    _error[0]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ &&
+                       human_radius_ < std::numeric_limits<double>::infinity(),
+                   "You must call setParameters() on EdgeHumanHumanSafety()");
+    const VertexPose *human1_bandpt =
+        static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *human2_bandpt =
+        static_cast<const VertexPose *>(_vertices[1]);
+
+    double dist = std::hypot(human1_bandpt->x() - human2_bandpt->x(),
+                             human1_bandpt->y() - human2_bandpt->y()) -
+                  (2 * human_radius_);
+
+    double dev_dist = penaltyBoundFromBelowDerivative(
+        dist, cfg_->human.min_human_human_dist, cfg_->optim.penalty_epsilon);
+    Eigen::Vector2d gradient =
+        dev_dist * distanceGradient(human1_bandpt->position(),
+                                    human2_bandpt->position());
+
+    _jacobianOplusXi(0, 0) = gradient.x();
+    _jacobianOplusXi(0, 1) = gradient.y();
+    _jacobianOplusXi(0, 2) = 0;
+    _jacobianOplusXj(0, 0) = -gradient.x();
+    _jacobianOplusXj(0, 1) = -gradient.y();
+    _jacobianOplusXj(0, 2) = 0;
+  }
+#endif
+
   ErrorVector &getError() {
     computeError();
     return _error;
@@ -113,7 +144,7 @@ protected:
   ;
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeHumanHumanSafety)
 };
 
 } // end namespace
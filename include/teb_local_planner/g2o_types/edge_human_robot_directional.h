@@ -37,6 +37,7 @@
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -62,8 +63,7 @@ public:
 
   void computeError() {
     ROS_ASSERT_MSG(
-        cfg_ && (radius_sum_ < std::numeric_limits<double>::infinity()),
-        "You must call setTebConfig() on EdgeHumanRobotDirectional()");
+        cfg_, "You must call setTebConfig() on EdgeHumanRobotDirectional()");
     const VertexPose *robot_bandpt =
         static_cast<const VertexPose *>(_vertices[0]);
     const VertexPose *robot_bandpt_nxt =
@@ -101,6 +101,69 @@ public:
                    "EdgeHumanRobot::computeError() _error[0]=%f\n", _error[0]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(
+        cfg_, "You must call setTebConfig() on EdgeHumanRobotDirectional()");
+    const VertexPose *robot_bandpt =
+        static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *robot_bandpt_nxt =
+        static_cast<const VertexPose *>(_vertices[1]);
+    const VertexTimeDiff *dt_robot =
+        static_cast<const VertexTimeDiff *>(_vertices[2]);
+    const VertexPose *human_bandpt =
+        static_cast<const VertexPose *>(_vertices[3]);
+    const VertexPose *human_bandpt_nxt =
+        static_cast<const VertexPose *>(_vertices[4]);
+    const VertexTimeDiff *dt_human =
+        static_cast<const VertexTimeDiff *>(_vertices[5]);
+
+    Eigen::Vector2d diff_robot =
+        robot_bandpt_nxt->position() - robot_bandpt->position();
+    Eigen::Vector2d robot_vel = diff_robot / dt_robot->dt();
+    Eigen::Vector2d diff_human =
+        human_bandpt_nxt->position() - human_bandpt->position();
+    Eigen::Vector2d human_vel = diff_human / dt_human->dt();
+
+    Eigen::Vector2d d_rtoh =
+        human_bandpt->position() - robot_bandpt->position();
+    double robot_dir = robot_vel.dot(d_rtoh);
+    double human_dir = -human_vel.dot(d_rtoh);
+    double sq_dist = d_rtoh.dot(d_rtoh);
+    double dir_cost =
+        (std::max(robot_dir, 0.0) + std::max(human_dir, 0.0)) / sq_dist;
+
+    for (int i = 0; i < 6; ++i)
+      _jacobianOplus[i].setZero();
+
+    double dev_cost = penaltyBoundFromBelowDerivative(
+        dir_cost, cfg_->human.dir_cost_threshold, cfg_->optim.penalty_epsilon);
+    if (dev_cost == 0)
+      return;
+
+    // only the positive terms of the cost contribute
+    double robot_active = robot_dir > 0 ? dev_cost / sq_dist : 0.0;
+    double human_active = human_dir > 0 ? dev_cost / sq_dist : 0.0;
+    Eigen::Vector2d dev_dist = -2 * dev_cost * dir_cost / sq_dist * d_rtoh;
+
+    Eigen::Vector2d dev_robot_pos =
+        robot_active * (-d_rtoh / dt_robot->dt() - robot_vel) +
+        human_active * human_vel - dev_dist;
+    Eigen::Vector2d dev_human_pos =
+        robot_active * robot_vel +
+        human_active * (d_rtoh / dt_human->dt() - human_vel) + dev_dist;
+
+    _jacobianOplus[0].block<1, 2>(0, 0) = dev_robot_pos.transpose();
+    _jacobianOplus[1].block<1, 2>(0, 0) =
+        robot_active / dt_robot->dt() * d_rtoh.transpose();
+    _jacobianOplus[2](0, 0) = -robot_active * robot_dir / dt_robot->dt();
+    _jacobianOplus[3].block<1, 2>(0, 0) = dev_human_pos.transpose();
+    _jacobianOplus[4].block<1, 2>(0, 0) =
+        -human_active / dt_human->dt() * d_rtoh.transpose();
+    _jacobianOplus[5](0, 0) = -human_active * human_dir / dt_human->dt();
+  }
+#endif
+
   ErrorVector &getError() {
     computeError();
     return _error;
@@ -123,7 +186,7 @@ protected:
   const TebConfig *cfg_;
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeHumanRobotDirectional)
 };
 
 } // end namespace
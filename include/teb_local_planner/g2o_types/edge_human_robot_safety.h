@@ -38,6 +38,8 @@
 #include <teb_local_planner/obstacles.h>
 #include <teb_local_planner/robot_footprint_model.h>
 #include <teb_local_planner/g2o_types/vertex_pose.h>
+#include <teb_local_planner/g2o_types/derivatives.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -83,6 +85,52 @@ public:
                    _error[0]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  // analytic for footprints composed of circles, numeric otherwise
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ && robot_model_ &&
+                       human_radius_ < std::numeric_limits<double>::infinity(),
+                   "You must call setParameters() on EdgeHumanRobotSafety()");
+    static thread_local std::vector<std::pair<double, double>> circles;
+    if (!robot_model_->getCircles(circles) || circles.empty()) {
+      g2o::BaseBinaryEdge<1, double, VertexPose, VertexPose>::linearizeOplus();
+      return;
+    }
+    const VertexPose *robot_bandpt =
+        static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *human_bandpt =
+        static_cast<const VertexPose *>(_vertices[1]);
+
+    // circle closest to the human as in calculateDistance()
+    double dist = HUGE_VAL;
+    Eigen::Vector2d center, d_center, closest_center, closest_d_center;
+    for (const auto &circle : circles) {
+      center = attachedPoint(robot_bandpt, Eigen::Vector2d(circle.first, 0.0),
+                             d_center);
+      double circle_dist =
+          (center - human_bandpt->position()).norm() - circle.second;
+      if (circle_dist < dist) {
+        dist = circle_dist;
+        closest_center = center;
+        closest_d_center = d_center;
+      }
+    }
+    dist -= human_radius_;
+
+    double dev_dist = penaltyBoundFromBelowDerivative(
+        dist, cfg_->human.min_human_robot_dist, cfg_->optim.penalty_epsilon);
+    Eigen::Vector2d gradient =
+        dev_dist * distanceGradient(closest_center, human_bandpt->position());
+
+    _jacobianOplusXi(0, 0) = gradient.x();
+    _jacobianOplusXi(0, 1) = gradient.y();
+    _jacobianOplusXi(0, 2) = gradient.dot(closest_d_center);
+    _jacobianOplusXj(0, 0) = -gradient.x();
+    _jacobianOplusXj(0, 1) = -gradient.y();
+    _jacobianOplusXj(0, 2) = 0;
+  }
+#endif
+
   ErrorVector &getError() {
     computeError();
     return _error;
@@ -125,7 +173,7 @@ protected:
   ;
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeHumanRobotSafety)
 };
 
 } // end namespace
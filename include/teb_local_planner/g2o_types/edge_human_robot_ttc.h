@@ -37,6 +37,7 @@
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -128,6 +129,87 @@ public:
                    "EdgeHumanRobot::computeError() _error[0]=%f\n", _error[0]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ &&
+                       (radius_sum_ < std::numeric_limits<double>::infinity()),
+                   "You must call setParameters() on EdgeHumanRobotTTC()");
+    const VertexPose *robot_bandpt =
+        static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *robot_bandpt_nxt =
+        static_cast<const VertexPose *>(_vertices[1]);
+    const VertexTimeDiff *dt_robot =
+        static_cast<const VertexTimeDiff *>(_vertices[2]);
+    const VertexPose *human_bandpt =
+        static_cast<const VertexPose *>(_vertices[3]);
+    const VertexPose *human_bandpt_nxt =
+        static_cast<const VertexPose *>(_vertices[4]);
+    const VertexTimeDiff *dt_human =
+        static_cast<const VertexTimeDiff *>(_vertices[5]);
+
+    Eigen::Vector2d diff_robot =
+        robot_bandpt_nxt->position() - robot_bandpt->position();
+    Eigen::Vector2d robot_vel = diff_robot / dt_robot->dt();
+    Eigen::Vector2d diff_human =
+        human_bandpt_nxt->position() - human_bandpt->position();
+    Eigen::Vector2d human_vel = diff_human / dt_human->dt();
+
+    Eigen::Vector2d C = human_bandpt->position() - robot_bandpt->position();
+    Eigen::Vector2d V = robot_vel - human_vel;
+
+    // ttc and its derivatives w.r.t. C and V
+    double ttc = std::numeric_limits<double>::infinity();
+    Eigen::Vector2d dev_ttc_C = Eigen::Vector2d::Zero();
+    Eigen::Vector2d dev_ttc_V = Eigen::Vector2d::Zero();
+    double C_sq = C.dot(C);
+    if (C_sq <= radius_sum_sq_) {
+      ttc = 0.0;
+    } else {
+      double C_dot_V = C.dot(V);
+      if (C_dot_V > 0) {
+        double V_sq = V.dot(V);
+        double C_sq_margin = C_sq - radius_sum_sq_;
+        double f = (C_dot_V * C_dot_V) - (V_sq * C_sq_margin);
+        if (f > 0) {
+          double sqrt_f = std::sqrt(f);
+          ttc = (C_dot_V - sqrt_f) / V_sq;
+          dev_ttc_C = (V - (C_dot_V * V - V_sq * C) / sqrt_f) / V_sq;
+          dev_ttc_V = (C - (C_dot_V * C - C_sq_margin * V) / sqrt_f) / V_sq -
+                      2 * ttc / V_sq * V;
+        }
+      }
+    }
+
+    for (int i = 0; i < 6; ++i)
+      _jacobianOplus[i].setZero();
+
+    if (ttc == std::numeric_limits<double>::infinity())
+      return; // no collision possible
+
+    // derivatives of the error w.r.t. C and V
+    double penalty = penaltyBoundFromBelow(ttc, cfg_->human.ttc_threshold,
+                                           cfg_->optim.penalty_epsilon);
+    double dev_penalty = penaltyBoundFromBelowDerivative(
+        ttc, cfg_->human.ttc_threshold, cfg_->optim.penalty_epsilon);
+    Eigen::Vector2d dev_C = dev_penalty * dev_ttc_C;
+    Eigen::Vector2d dev_V = dev_penalty * dev_ttc_V;
+    if (cfg_->optim.scale_human_robot_ttc_c) {
+      double scale = cfg_->optim.human_robot_ttc_scale_alpha / C_sq;
+      dev_C = scale * dev_C - 2 * scale * penalty / C_sq * C;
+      dev_V = scale * dev_V;
+    }
+
+    _jacobianOplus[0].block<1, 2>(0, 0) =
+        (-dev_C - dev_V / dt_robot->dt()).transpose();
+    _jacobianOplus[1].block<1, 2>(0, 0) = dev_V.transpose() / dt_robot->dt();
+    _jacobianOplus[2](0, 0) = -dev_V.dot(robot_vel) / dt_robot->dt();
+    _jacobianOplus[3].block<1, 2>(0, 0) =
+        (dev_C + dev_V / dt_human->dt()).transpose();
+    _jacobianOplus[4].block<1, 2>(0, 0) = -dev_V.transpose() / dt_human->dt();
+    _jacobianOplus[5](0, 0) = dev_V.dot(human_vel) / dt_human->dt();
+  }
+#endif
+
   ErrorVector &getError() {
     computeError();
     return _error;
@@ -159,7 +241,7 @@ protected:
   double radius_sum_sq_ = std::numeric_limits<double>::infinity();
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeHumanRobotTTC)
 };
 
 } // end namespace
@@ -45,6 +45,7 @@
 #define _EDGE_KINEMATICS_H
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -122,7 +123,6 @@ public:
   }
 
 #ifdef USE_ANALYTIC_JACOBI
-#if 1
   /**
    * @brief Jacobi matrix of the cost function specified in computeError().
    */
@@ -164,7 +164,6 @@ public:
     _jacobianOplusXj(0,2) = (-sin2*deltaS[1] - cos2*deltaS[0]) * dev_nh_abs; // nh angle
     _jacobianOplusXj(1,2) = 0; // drive-dir angle1					
   }
-#endif
 #endif
     
   /**
@@ -214,7 +213,7 @@ protected:
   const TebConfig* cfg_; //!< Store TebConfig class for parameters
   
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW   
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeKinematicsDiffDrive)
 };
 
 
@@ -295,6 +294,59 @@ public:
 
     ROS_ASSERT_MSG(std::isfinite(_error[0]) && std::isfinite(_error[1]), "EdgeKinematicsCarlike::computeError() _error[0]=%f _error[1]=%f\n",_error[0],_error[1]);
   }
+
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeKinematicsCarlike()");
+    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
+    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
+    
+    Eigen::Vector2d deltaS = conf2->position() - conf1->position();
+    
+    double cos1 = cos(conf1->theta());
+    double cos2 = cos(conf2->theta());
+    double sin1 = sin(conf1->theta());
+    double sin2 = sin(conf2->theta());
+    double aux1 = sin1 + sin2;
+    double aux2 = cos1 + cos2;
+    
+    double dev_nh_abs = g2o::sign( aux2 * deltaS[1] - aux1 * deltaS[0] );
+    
+    // non holonomic constraint
+    _jacobianOplusXi(0,0) = aux1 * dev_nh_abs; // nh x1
+    _jacobianOplusXi(0,1) = -aux2 * dev_nh_abs; // nh y1
+    _jacobianOplusXi(0,2) = (-sin1*deltaS[1] - cos1*deltaS[0]) * dev_nh_abs; // nh angle1
+    _jacobianOplusXj(0,0) = -aux1 * dev_nh_abs; // nh x2
+    _jacobianOplusXj(0,1) = aux2 * dev_nh_abs; // nh y2
+    _jacobianOplusXj(0,2) = (-sin2*deltaS[1] - cos2*deltaS[0]) * dev_nh_abs; // nh angle2
+    
+    // minimum turning radius
+    _jacobianOplusXi.row(1).setZero();
+    _jacobianOplusXj.row(1).setZero();
+    double omega_t = g2o::normalize_theta( conf2->theta() - conf1->theta() );
+    double dist = deltaS.norm();
+    if (omega_t == 0 || dist == 0)
+      return; // straight line motion
+    
+    double radius = dist / fabs(omega_t);
+    double dev_radius = penaltyBoundFromBelowDerivative(radius, cfg_->robot.min_turning_radius, 0.0);
+    if (dev_radius == 0)
+      return;
+    
+    Eigen::Vector2d dev_pos = dev_radius * deltaS / (dist * fabs(omega_t));
+    double dev_angle = dev_radius * radius / omega_t;
+    _jacobianOplusXi(1,0) = -dev_pos[0]; // radius x1
+    _jacobianOplusXi(1,1) = -dev_pos[1]; // radius y1
+    _jacobianOplusXi(1,2) = dev_angle; // radius angle1
+    _jacobianOplusXj(1,0) = dev_pos[0]; // radius x2
+    _jacobianOplusXj(1,1) = dev_pos[1]; // radius y2
+    _jacobianOplusXj(1,2) = -dev_angle; // radius angle2
+  }
+#endif
     
   /**
   * @brief Compute and return error / cost value.
@@ -343,7 +395,7 @@ protected:
   const TebConfig* cfg_; //!< Store TebConfig class for parameters
   
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW   
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeKinematicsCarlike)
 };
 
 
@@ -47,9 +47,12 @@
 #ifndef EDGE_OBSTACLE_H_
 #define EDGE_OBSTACLE_H_
 
+#include <teb_local_planner/obstacle_arrays.h>
 #include <teb_local_planner/obstacles.h>
 #include <teb_local_planner/robot_footprint_model.h>
 #include <teb_local_planner/g2o_types/vertex_pose.h>
+#include <teb_local_planner/g2o_types/derivatives.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -119,48 +122,58 @@ public:
   }
 
 #ifdef USE_ANALYTIC_JACOBI
-#if 0
-
   /**
    * @brief Jacobi matrix of the cost function specified in computeError().
+   *
+   * Analytic for footprints composed of circles (see
+   * BaseRobotFootprintModel::getCircles()), line and polygon footprints are
+   * differentiated numerically.
    */
-  void linearizeOplus()
-  {
-    ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgePointObstacle()");
-    const VertexPose* bandpt = static_cast<const VertexPose*>(_vertices[0]);
-
-    Eigen::Vector2d deltaS = *_measurement - bandpt->position();
-    double angdiff = atan2(deltaS[1],deltaS[0])-bandpt->theta();
-
-    double dist_squared = deltaS.squaredNorm();
-    double dist = sqrt(dist_squared);
-
-    double aux0 = sin(angdiff);
-    double dev_left_border = penaltyBoundFromBelowDerivative(dist*fabs(aux0),cfg_->obstacles.min_obstacle_dist,cfg_->optim.penalty_epsilon);
-
-    if (dev_left_border==0)
-    {
-      _jacobianOplusXi( 0 , 0 ) = 0;
-      _jacobianOplusXi( 0 , 1 ) = 0;
-      _jacobianOplusXi( 0 , 2 ) = 0;
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ && _measurement && robot_model_,
+                   "You must call setTebConfig(), setObstacle() and "
+                   "setRobotModel() on EdgeObstacle()");
+    // keeps its capacity, no allocation per linearization
+    static thread_local std::vector<std::pair<double, double>> circles;
+    if (!robot_model_->getCircles(circles) || circles.empty()) {
+      g2o::BaseUnaryEdge<1, const Obstacle *, VertexPose>::linearizeOplus();
       return;
     }
+    const VertexPose *bandpt = static_cast<const VertexPose *>(_vertices[0]);
 
-    double aux1 = -fabs(aux0) / dist;
-    double dev_norm_x = deltaS[0]*aux1;
-    double dev_norm_y = deltaS[1]*aux1;
+    // circle with the minimum distance as in calculateDistance()
+    double dist = HUGE_VAL;
+    Eigen::Vector2d center, d_center, closest_center, closest_d_center;
+    for (const auto &circle : circles) {
+      center = attachedPoint(bandpt, Eigen::Vector2d(circle.first, 0.0),
+                             d_center);
+      double circle_dist =
+          _measurement->getMinimumDistance(center) - circle.second;
+      if (circle_dist < dist) {
+        dist = circle_dist;
+        closest_center = center;
+        closest_d_center = d_center;
+      }
+    }
 
-    double aux2 = cos(angdiff) * g2o::sign(aux0);
-    double aux3 = aux2 / dist_squared;
-    double dev_proj_x = aux3 * deltaS[1] * dist;
-    double dev_proj_y = -aux3 * deltaS[0] * dist;
-    double dev_proj_angle = -aux2;
+    double dev_dist;
+    if (cfg_->obstacles.use_nonlinear_obstacle_penalty) {
+      dev_dist = penaltyBoundFromBelowExpDerivative(
+          dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon,
+          cfg_->obstacles.obstacle_cost_mult);
+    } else {
+      dev_dist = penaltyBoundFromBelowDerivative(
+          dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon);
+    }
 
-    _jacobianOplusXi( 0 , 0 ) = dev_left_border * ( dev_norm_x + dev_proj_x );
-    _jacobianOplusXi( 0 , 1 ) = dev_left_border * ( dev_norm_y + dev_proj_y );
-    _jacobianOplusXi( 0 , 2 ) = dev_left_border * dev_proj_angle;
+    Eigen::Vector2d closest_point =
+        _measurement->getClosestPoint(closest_center);
+    Eigen::Vector2d gradient =
+        dev_dist * distanceGradient(closest_center, closest_point);
+    _jacobianOplusXi(0, 0) = gradient.x();
+    _jacobianOplusXi(0, 1) = gradient.y();
+    _jacobianOplusXi(0, 2) = gradient.dot(closest_d_center);
   }
-#endif
 #endif
 
   /**
@@ -231,7 +244,182 @@ protected:
   const BaseRobotFootprintModel *robot_model_; //!< Store pointer to robot_model
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeObstacle)
+};
+
+/**
+ * @class EdgeIndexedObstacle
+ * @brief Edge defining the cost function for keeping a minimum distance from
+ * an obstacle of ObstacleArrays.
+ *
+ * Same cost as EdgeObstacle, but the obstacle is referenced by its index in
+ * the arrays and the robot footprint by its circles (see
+ * BaseRobotFootprintModel::getCircles()), hence no virtual calls are involved
+ * in the distance calculation.
+ * @see TebOptimalPlanner::AddEdgesObstacles
+ * @remarks Do not forget to call setParameters()
+ */
+class EdgeIndexedObstacle
+    : public g2o::BaseUnaryEdge<1, ObstacleArrays::Ref, VertexPose> {
+public:
+  /**
+   * @brief Construct edge.
+   */
+  EdgeIndexedObstacle() : cfg_(NULL), obstacles_(NULL), circles_(NULL) {
+    _vertices[0] = NULL;
+  }
+
+  /**
+   * @brief Destruct edge.
+   *
+   * We need to erase vertices manually, since we want to keep them even if
+   * TebOptimalPlanner::clearGraph() is called.
+   * This is necessary since the vertices are managed by the Timed_Elastic_Band
+   * class.
+   */
+  virtual ~EdgeIndexedObstacle() {
+    if (_vertices[0])
+      _vertices[0]->edges().erase(this);
+  }
+
+  /**
+   * @brief Actual cost function
+   */
+  void computeError() {
+    ROS_ASSERT_MSG(cfg_ && obstacles_ && circles_,
+                   "You must call setParameters() on EdgeIndexedObstacle()");
+    const VertexPose *bandpt = static_cast<const VertexPose *>(_vertices[0]);
+
+    const Eigen::Vector2d &position = bandpt->position();
+    Eigen::Vector2d dir;
+    bool dir_computed = false;
+
+    // minimum over the circles of the footprint
+    double dist = HUGE_VAL;
+    for (const auto &circle : *circles_) {
+      double circle_dist;
+      if (circle.first == 0) {
+        circle_dist = obstacles_->distance(_measurement, position);
+      } else {
+        if (!dir_computed) {
+          dir = bandpt->pose().orientationUnitVec();
+          dir_computed = true;
+        }
+        circle_dist =
+            obstacles_->distance(_measurement, position + circle.first * dir);
+      }
+      dist = std::min(dist, circle_dist - circle.second);
+    }
+
+    if (cfg_->obstacles.use_nonlinear_obstacle_penalty) {
+      _error[0] = penaltyBoundFromBelowExp(
+          dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon,
+          cfg_->obstacles.obstacle_cost_mult);
+    } else {
+      _error[0] = penaltyBoundFromBelow(dist, cfg_->obstacles.min_obstacle_dist,
+                                        cfg_->optim.penalty_epsilon);
+    }
+
+    ROS_ASSERT_MSG(std::isfinite(_error[0]),
+                   "EdgeIndexedObstacle::computeError() _error[0]=%f\n",
+                   _error[0]);
+  }
+
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_ && obstacles_ && circles_,
+                   "You must call setParameters() on EdgeIndexedObstacle()");
+    const VertexPose *bandpt = static_cast<const VertexPose *>(_vertices[0]);
+
+    // circle with the minimum distance as in computeError()
+    double dist = HUGE_VAL;
+    Eigen::Vector2d center, d_center, closest_center, closest_d_center;
+    for (const auto &circle : *circles_) {
+      center = attachedPoint(bandpt, Eigen::Vector2d(circle.first, 0.0),
+                             d_center);
+      double circle_dist =
+          obstacles_->distance(_measurement, center) - circle.second;
+      if (circle_dist < dist) {
+        dist = circle_dist;
+        closest_center = center;
+        closest_d_center = d_center;
+      }
+    }
+
+    _jacobianOplusXi.setZero();
+    if (dist == HUGE_VAL)
+      return;
+
+    double dev_dist;
+    if (cfg_->obstacles.use_nonlinear_obstacle_penalty) {
+      dev_dist = penaltyBoundFromBelowExpDerivative(
+          dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon,
+          cfg_->obstacles.obstacle_cost_mult);
+    } else {
+      dev_dist = penaltyBoundFromBelowDerivative(
+          dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon);
+    }
+
+    Eigen::Vector2d closest_point =
+        obstacles_->closestPoint(_measurement, closest_center);
+    Eigen::Vector2d gradient =
+        dev_dist * distanceGradient(closest_center, closest_point);
+    _jacobianOplusXi(0, 0) = gradient.x();
+    _jacobianOplusXi(0, 1) = gradient.y();
+    _jacobianOplusXi(0, 2) = gradient.dot(closest_d_center);
+  }
+#endif
+
+  /**
+   * @brief Compute and return error / cost value.
+   *
+   * This method is called by TebOptimalPlanner::computeCurrentCost to obtain
+   * the current cost.
+   * @return 1D Cost / error vector
+   */
+  ErrorVector &getError() {
+    computeError();
+    return _error;
+  }
+
+  /**
+   * @brief Read values from input stream
+   */
+  virtual bool read(std::istream &is) { return true; }
+
+  /**
+   * @brief Write values to an output stream
+   */
+  virtual bool write(std::ostream &os) const { return os.good(); }
+
+  /**
+   * @brief Set all parameters at once
+   * @param cfg TebConfig class
+   * @param circles offsets and radii of the circles of the footprint
+   * @param obstacles arrays the obstacle belongs to
+   * @param obstacle reference to the obstacle in the arrays
+   */
+  void setParameters(const TebConfig &cfg,
+                     const std::vector<std::pair<double, double>> *circles,
+                     const ObstacleArrays *obstacles,
+                     const ObstacleArrays::Ref &obstacle) {
+    cfg_ = &cfg;
+    circles_ = circles;
+    obstacles_ = obstacles;
+    _measurement = obstacle;
+  }
+
+protected:
+  const TebConfig *cfg_; //!< Store TebConfig class for parameters
+  const ObstacleArrays *obstacles_; //!< Arrays the obstacle belongs to
+  const std::vector<std::pair<double, double>>
+      *circles_; //!< Circles of the footprint (offset, radius)
+
+public:
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeIndexedObstacle)
 };
 
 } // end namespace
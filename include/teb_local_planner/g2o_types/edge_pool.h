@@ -0,0 +1,348 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef EDGE_POOL_H_
+#define EDGE_POOL_H_
+
+#include <Eigen/Core>
+
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace teb_local_planner {
+
+//! Usage counters of a single edge pool
+struct EdgePoolStatistics {
+  std::string name;     //!< Name of the pooled edge class
+  std::size_t live;     //!< Number of objects allocated or cached by threads
+  std::size_t peak;     //!< Maximum number of simultaneously allocated objects
+  std::size_t capacity; //!< Number of objects that fit without allocating
+};
+
+inline std::ostream &operator<<(std::ostream &os,
+                                const EdgePoolStatistics &stats) {
+  return os << stats.name << ": live " << stats.live << ", peak " << stats.peak
+            << ", capacity " << stats.capacity;
+}
+
+/**
+ * @class EdgePoolRegistry
+ * @brief Keeps track of all edge pools that have been used so far in order to
+ * report their statistics.
+ */
+class EdgePoolRegistry {
+public:
+  typedef boost::function<EdgePoolStatistics()> StatisticsFunction;
+
+  static EdgePoolRegistry &instance() {
+    // never destroyed, edges may still be deleted during static destruction
+    static EdgePoolRegistry *registry = new EdgePoolRegistry();
+    return *registry;
+  }
+
+  void add(const StatisticsFunction &statistics_function) {
+    boost::mutex::scoped_lock l(mutex_);
+    statistics_functions_.push_back(statistics_function);
+  }
+
+  std::vector<EdgePoolStatistics> statistics() {
+    boost::mutex::scoped_lock l(mutex_);
+    std::vector<EdgePoolStatistics> statistics;
+    for (auto &statistics_function : statistics_functions_)
+      statistics.push_back(statistics_function());
+    return statistics;
+  }
+
+  //! One line of statistics per pool, for logging
+  std::string summary() {
+    std::ostringstream os;
+    for (auto &stats : statistics())
+      os << std::endl << "  " << stats;
+    return os.str();
+  }
+
+private:
+  EdgePoolRegistry() {}
+
+  boost::mutex mutex_;
+  std::vector<StatisticsFunction> statistics_functions_;
+};
+
+/**
+ * @class EdgePool
+ * @brief Free-list allocator for g2o edges of type \c T.
+ *
+ * The graph deletes its edges on TebOptimalPlanner::clearGraph(), which returns
+ * the memory to the pool instead of the heap. Memory is requested in chunks and
+ * never released. TebOptimalPlanner::buildGraph() reserves the edges it is
+ * about to add, so a cycle allocates at most one chunk per edge type and none
+ * at all once the pool holds the peak number of edges.
+ * Objects of derived classes (size differs from \c T) bypass the pool.
+ * Enable it for an edge class with TEB_POOLED_EDGE_OPERATOR_NEW.
+ *
+ * The chunks are shared by all threads, but each thread allocates from and
+ * frees to a cache of its own without locking. The candidates of the
+ * HomotopyClassPlanner, which build their graphs concurrently, therefore only
+ * meet at the mutex of the shared pool when a cache is refilled by reserve()
+ * or when a cache returns surplus blocks, in batches of BATCH_SIZE. Edges may
+ * be deleted by another thread than the one that created them, their blocks
+ * end up in the cache of the deleting thread.
+ */
+template <typename T> class EdgePool {
+public:
+  static void *allocate(std::size_t size) {
+    if (size != sizeof(T))
+      return Eigen::internal::aligned_malloc(size);
+
+    LocalCache *cache = localCache();
+    if (!cache)
+      return instance().allocateShared();
+    if (!cache->free_list)
+      instance().refill(*cache, BATCH_SIZE);
+    FreeBlock *block = cache->free_list;
+    cache->free_list = block->next;
+    --cache->size;
+    return block;
+  }
+
+  static void deallocate(void *ptr, std::size_t size) {
+    if (!ptr)
+      return;
+    if (size != sizeof(T)) {
+      Eigen::internal::aligned_free(ptr);
+      return;
+    }
+
+    FreeBlock *block = static_cast<FreeBlock *>(ptr);
+    LocalCache *cache = localCache();
+    if (!cache) {
+      instance().deallocateShared(block);
+      return;
+    }
+    block->next = cache->free_list;
+    cache->free_list = block;
+    if (++cache->size > cache->limit + BATCH_SIZE)
+      instance().flush(*cache, cache->limit);
+  }
+
+  /**
+   * @brief Make sure that \c number objects can be allocated by the calling
+   * thread without locking
+   *
+   * Moves the blocks into the cache of the thread with a single lock and grows
+   * the pool by a single chunk if required, instead of doubling it several
+   * times while the objects are allocated one by one. The cache keeps up to
+   * \c number blocks afterwards.
+   * @param number number of objects about to be allocated
+   */
+  static void reserve(std::size_t number) {
+    LocalCache *cache = localCache();
+    if (!cache)
+      return;
+    cache->limit = std::max(cache->limit, number);
+    if (cache->size < number)
+      instance().refill(*cache, number - cache->size);
+  }
+
+  static EdgePoolStatistics statistics() {
+    EdgePool &pool = instance();
+    boost::mutex::scoped_lock l(pool.mutex_);
+    EdgePoolStatistics stats;
+    stats.name = T::poolName();
+    stats.live = pool.live_;
+    stats.peak = pool.peak_;
+    stats.capacity = pool.capacity_;
+    return stats;
+  }
+
+private:
+  union FreeBlock {
+    FreeBlock *next;
+    char data[sizeof(T)];
+  };
+
+  //! Blocks owned by a single thread
+  struct LocalCache {
+    FreeBlock *free_list;
+    std::size_t size;  //!< Number of blocks in free_list
+    std::size_t limit; //!< Number of blocks kept when returning surplus ones
+  };
+
+  //! Returns the cache of a thread to the shared pool when the thread exits
+  struct LocalCacheOwner {
+    LocalCacheOwner(LocalCache *&cache_pointer, bool &exited)
+        : cache_pointer(cache_pointer), exited(exited) {
+      LocalCache empty = {NULL, 0, 0};
+      cache = empty;
+      cache_pointer = &cache;
+    }
+    ~LocalCacheOwner() {
+      instance().flush(cache, 0);
+      cache_pointer = NULL;
+      exited = true;
+    }
+    LocalCache cache;
+    LocalCache *&cache_pointer;
+    bool &exited;
+  };
+
+  //! block size keeps the alignment of the chunks for every block
+  static const std::size_t BLOCK_ALIGNMENT = 32;
+  static const std::size_t BLOCK_SIZE =
+      (sizeof(FreeBlock) + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT *
+      BLOCK_ALIGNMENT;
+  static const std::size_t MIN_CHUNK_SIZE = 64;
+  //! Number of blocks moved between a cache and the shared pool at least
+  static const std::size_t BATCH_SIZE = 32;
+
+  EdgePool() : free_list_(NULL), live_(0), peak_(0), capacity_(0) {
+    EdgePoolRegistry::instance().add(&EdgePool::statistics);
+  }
+
+  static EdgePool &instance() {
+    // never destroyed, edges may still be deleted during static destruction
+    static EdgePool *pool = new EdgePool();
+    return *pool;
+  }
+
+  //! Cache of the calling thread, NULL once the thread is exiting
+  static LocalCache *localCache() {
+    static thread_local LocalCache *cache = NULL;
+    static thread_local bool exited = false;
+    if (!cache && !exited) {
+      static thread_local LocalCacheOwner owner(cache, exited);
+    }
+    return cache;
+  }
+
+  //! Move \c number blocks into a cache
+  void refill(LocalCache &cache, std::size_t number) {
+    boost::mutex::scoped_lock l(mutex_);
+    std::size_t available = capacity_ - live_;
+    if (number > available) {
+      // at least double the capacity
+      std::size_t missing = std::max(number - available, capacity_);
+      if (missing < MIN_CHUNK_SIZE)
+        missing = MIN_CHUNK_SIZE;
+      grow(missing);
+    }
+    for (std::size_t i = 0; i < number; ++i) {
+      FreeBlock *block = free_list_;
+      free_list_ = block->next;
+      block->next = cache.free_list;
+      cache.free_list = block;
+    }
+    cache.size += number;
+    live_ += number;
+    peak_ = std::max(peak_, live_);
+  }
+
+  //! Return the blocks of a cache beyond \c keep to the shared pool
+  void flush(LocalCache &cache, std::size_t keep) {
+    boost::mutex::scoped_lock l(mutex_);
+    while (cache.size > keep) {
+      FreeBlock *block = cache.free_list;
+      cache.free_list = block->next;
+      block->next = free_list_;
+      free_list_ = block;
+      --cache.size;
+      --live_;
+    }
+  }
+
+  void *allocateShared() {
+    LocalCache cache = {NULL, 0, 0};
+    refill(cache, 1);
+    return cache.free_list;
+  }
+
+  void deallocateShared(FreeBlock *block) {
+    LocalCache cache = {block, 1, 0};
+    block->next = NULL;
+    flush(cache, 0);
+  }
+
+  void grow(std::size_t number) {
+    char *chunk =
+        static_cast<char *>(Eigen::internal::aligned_malloc(number * BLOCK_SIZE));
+    chunks_.push_back(chunk);
+    for (std::size_t i = number; i > 0; --i) {
+      FreeBlock *block =
+          reinterpret_cast<FreeBlock *>(chunk + (i - 1) * BLOCK_SIZE);
+      block->next = free_list_;
+      free_list_ = block;
+    }
+    capacity_ += number;
+  }
+
+  boost::mutex mutex_; //!< Protects the shared pool, not the caches
+  std::vector<char *> chunks_; //!< Memory owned by the pool
+  FreeBlock *free_list_;       //!< Blocks that are not in any cache
+  std::size_t live_;           //!< Blocks in use or in a cache
+  std::size_t peak_, capacity_;
+};
+
+} // namespace teb_local_planner
+
+/**
+ * Replacement for EIGEN_MAKE_ALIGNED_OPERATOR_NEW inside edge classes, which
+ * allocates single objects from EdgePool<EdgeType>. Arrays are allocated
+ * aligned on the heap as before.
+ */
+#define TEB_POOLED_EDGE_OPERATOR_NEW(EdgeType)                                 \
+  static const char *poolName() { return #EdgeType; }                          \
+  static void *operator new(std::size_t size) {                                \
+    return teb_local_planner::EdgePool<EdgeType>::allocate(size);              \
+  }                                                                            \
+  static void operator delete(void *ptr, std::size_t size) {                   \
+    teb_local_planner::EdgePool<EdgeType>::deallocate(ptr, size);              \
+  }                                                                            \
+  static void *operator new[](std::size_t size) {                              \
+    return Eigen::internal::aligned_malloc(size);                              \
+  }                                                                            \
+  static void operator delete[](void *ptr) {                                   \
+    Eigen::internal::aligned_free(ptr);                                        \
+  }                                                                            \
+  static void *operator new(std::size_t, void *ptr) { return ptr; }            \
+  static void operator delete(void *, void *) {}
+
+#endif // EDGE_POOL_H_
@@ -54,6 +54,7 @@
 #include <base_local_planner/BaseLocalPlannerConfig.h>
 
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -123,7 +124,15 @@ public:
    */
   void linearizeOplus() {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeTimeOptimal()");
-    _jacobianOplusXi(0, 0) = 1;
+    const VertexTimeDiff *timediff =
+        static_cast<const VertexTimeDiff *>(_vertices[0]);
+
+    if (cfg_->optim.cap_optimaltime_penalty) {
+      _jacobianOplusXi(0, 0) = penaltyBoundFromAboveDerivative(
+          timediff->dt(), initial_time_, cfg_->optim.time_penalty_epsilon);
+    } else {
+      _jacobianOplusXi(0, 0) = 1;
+    }
   }
 #endif
 
@@ -171,7 +180,7 @@ protected:
   double initial_time_;
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeTimeOptimal)
 };
 
 }; // end namespace
@@ -50,6 +50,8 @@
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
 #include <teb_local_planner/g2o_types/vertex_timediff.h>
+#include <teb_local_planner/g2o_types/derivatives.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/g2o_types/penalties.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -140,78 +142,49 @@ public:
   }
 
 #ifdef USE_ANALYTIC_JACOBI
-#if 0 // TODO the hardcoded jacobian does not include the changing direction
-      // (just the absolute value)
-      // Change accordingly...
-
   /**
    * @brief Jacobi matrix of the cost function specified in computeError().
    */
-  void linearizeOplus()
-  {
+  void linearizeOplus() {
     ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeVelocity()");
-    const VertexPose* conf1 = static_cast<const VertexPose*>(_vertices[0]);
-    const VertexPose* conf2 = static_cast<const VertexPose*>(_vertices[1]);
-    const VertexTimeDiff* deltaT = static_cast<const VertexTimeDiff*>(_vertices[2]);
-
-    Eigen::Vector2d deltaS = conf2->position() - conf1->position();
-    double dist = deltaS.norm();
-    double aux1 = dist*deltaT->estimate();
-    double aux2 = 1/deltaT->estimate();
-
-    double vel = dist * aux2;
-    double omega = g2o::normalize_theta(conf2->theta() - conf1->theta()) * aux2;
-
-    double dev_border_vel = penaltyBoundToIntervalDerivative(vel, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x,cfg_->optim.penalty_epsilon);
-    double dev_border_omega = penaltyBoundToIntervalDerivative(omega, cfg_->robot.max_vel_theta,cfg_->optim.penalty_epsilon);
-
-    _jacobianOplus[0].resize(2,3); // conf1
-    _jacobianOplus[1].resize(2,3); // conf2
-    _jacobianOplus[2].resize(2,1); // deltaT
-
-//  if (aux1==0) aux1=1e-6;
-//  if (aux2==0) aux2=1e-6;
-
-    if (dev_border_vel!=0)
-    {
-      double aux3 = dev_border_vel / aux1;
-      _jacobianOplus[0](0,0) = -deltaS[0] * aux3; // vel x1
-      _jacobianOplus[0](0,1) = -deltaS[1] * aux3; // vel y1
-      _jacobianOplus[1](0,0) = deltaS[0] * aux3; // vel x2
-      _jacobianOplus[1](0,1) = deltaS[1] * aux3; // vel y2
-      _jacobianOplus[2](0,0) = -vel * aux2 * dev_border_vel; // vel deltaT
-    }
-    else
-    {
-      _jacobianOplus[0](0,0) = 0; // vel x1
-      _jacobianOplus[0](0,1) = 0; // vel y1
-      _jacobianOplus[1](0,0) = 0; // vel x2
-      _jacobianOplus[1](0,1) = 0; // vel y2
-      _jacobianOplus[2](0,0) = 0; // vel deltaT
-    }
+    const VertexPose *conf1 = static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *conf2 = static_cast<const VertexPose *>(_vertices[1]);
+    const VertexTimeDiff *deltaT =
+        static_cast<const VertexTimeDiff *>(_vertices[2]);
 
-    if (dev_border_omega!=0)
-    {
-      double aux4 = aux2 * dev_border_omega;
-      _jacobianOplus[2](1,0) = -omega * aux4; // omega deltaT
-      _jacobianOplus[0](1,2) = -aux4; // omega angle1
-      _jacobianOplus[1](1,2) = aux4; // omega angle2
-    }
-    else
-    {
-      _jacobianOplus[2](1,0) = 0; // omega deltaT
-      _jacobianOplus[0](1,2) = 0; // omega angle1
-      _jacobianOplus[1](1,2) = 0; // omega angle2
+    Eigen::Vector2d dev_vel_pos;
+    double dev_vel_angle, dev_vel_dt;
+    double vel = signedVelocity(conf1, conf2, deltaT->dt(), dev_vel_pos,
+                                dev_vel_angle, dev_vel_dt);
+    double omega =
+        g2o::normalize_theta(conf2->theta() - conf1->theta()) / deltaT->dt();
+
+    double dev_border_vel = penaltyBoundToIntervalDerivative(
+        vel, -cfg_->robot.max_vel_x_backwards, cfg_->robot.max_vel_x,
+        cfg_->optim.penalty_epsilon);
+    double dev_border_omega = penaltyBoundToIntervalDerivative(
+        omega, cfg_->robot.max_vel_theta, cfg_->optim.penalty_epsilon);
+
+    _jacobianOplus[0].setZero(); // conf1
+    _jacobianOplus[1].setZero(); // conf2
+    _jacobianOplus[2].setZero(); // deltaT
+
+    if (dev_border_vel != 0) {
+      _jacobianOplus[0].block<1, 2>(0, 0) =
+          -dev_border_vel * dev_vel_pos.transpose();
+      _jacobianOplus[0](0, 2) = dev_border_vel * dev_vel_angle;
+      _jacobianOplus[1].block<1, 2>(0, 0) =
+          dev_border_vel * dev_vel_pos.transpose();
+      _jacobianOplus[2](0, 0) = dev_border_vel * dev_vel_dt;
     }
 
-    _jacobianOplus[0](1,0) = 0; // omega x1
-    _jacobianOplus[0](1,1) = 0; // omega y1
-    _jacobianOplus[1](1,0) = 0; // omega x2
-    _jacobianOplus[1](1,1) = 0; // omega y2
-    _jacobianOplus[0](0,2) = 0; // vel angle1
-    _jacobianOplus[1](0,2) = 0; // vel angle2
+    if (dev_border_omega != 0) {
+      double aux = dev_border_omega / deltaT->dt();
+      _jacobianOplus[0](1, 2) = -aux;
+      _jacobianOplus[1](1, 2) = aux;
+      _jacobianOplus[2](1, 0) = -omega * aux;
+    }
   }
-#endif
 #endif
 
   /**
@@ -255,7 +228,7 @@ protected:
   const TebConfig *cfg_; //!< Store TebConfig class for parameters
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeVelocity)
 };
 
 class EdgeVelocityHuman : public g2o::BaseMultiEdge<3, double> {
@@ -310,6 +283,57 @@ public:
         _error[0], _error[1]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  void linearizeOplus() {
+    ROS_ASSERT_MSG(cfg_, "You must call setTebConfig on EdgeVelocityHuman()");
+    const VertexPose *conf1 = static_cast<const VertexPose *>(_vertices[0]);
+    const VertexPose *conf2 = static_cast<const VertexPose *>(_vertices[1]);
+    const VertexTimeDiff *deltaT =
+        static_cast<const VertexTimeDiff *>(_vertices[2]);
+
+    Eigen::Vector2d dev_vel_pos;
+    double dev_vel_angle, dev_vel_dt;
+    double vel = signedVelocity(conf1, conf2, deltaT->dt(), dev_vel_pos,
+                                dev_vel_angle, dev_vel_dt);
+    double omega =
+        g2o::normalize_theta(conf2->theta() - conf1->theta()) / deltaT->dt();
+
+    // both the bound and the elastic velocity cost depend on vel
+    Eigen::Vector2d dev_vel;
+    dev_vel[0] = penaltyBoundToIntervalDerivative(
+        vel, -cfg_->human.max_vel_x_backwards, cfg_->human.max_vel_x,
+        cfg_->optim.penalty_epsilon);
+    dev_vel[1] = cfg_->optim.use_human_elastic_vel
+                     ? -g2o::sign(cfg_->human.nominal_vel_x - vel)
+                     : 0.0;
+    double dev_border_omega = penaltyBoundToIntervalDerivative(
+        omega, cfg_->human.max_vel_theta, cfg_->optim.penalty_epsilon);
+
+    _jacobianOplus[0].setZero(); // conf1
+    _jacobianOplus[1].setZero(); // conf2
+    _jacobianOplus[2].setZero(); // deltaT
+
+    for (int row = 0; row < 2; ++row) {
+      int error_row = row == 0 ? 0 : 2;
+      if (dev_vel[row] == 0)
+        continue;
+      _jacobianOplus[0].block<1, 2>(error_row, 0) =
+          -dev_vel[row] * dev_vel_pos.transpose();
+      _jacobianOplus[0](error_row, 2) = dev_vel[row] * dev_vel_angle;
+      _jacobianOplus[1].block<1, 2>(error_row, 0) =
+          dev_vel[row] * dev_vel_pos.transpose();
+      _jacobianOplus[2](error_row, 0) = dev_vel[row] * dev_vel_dt;
+    }
+
+    if (dev_border_omega != 0) {
+      double aux = dev_border_omega / deltaT->dt();
+      _jacobianOplus[0](1, 2) = -aux;
+      _jacobianOplus[1](1, 2) = aux;
+      _jacobianOplus[2](1, 0) = -omega * aux;
+    }
+  }
+#endif
+
   ErrorVector &getError() {
     computeError();
     return _error;
@@ -334,7 +358,7 @@ protected:
   const TebConfig *cfg_;
 
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeVelocityHuman)
 };
 
 } // end namespace
@@ -44,6 +44,7 @@
 #define EDGE_VIA_POINT_H_
 
 #include <teb_local_planner/g2o_types/vertex_pose.h>
+#include <teb_local_planner/g2o_types/edge_pool.h>
 #include <teb_local_planner/teb_config.h>
 
 #include "g2o/core/base_unary_edge.h"
@@ -101,6 +102,24 @@ public:
     ROS_ASSERT_MSG(std::isfinite(_error[0]), "EdgeViaPoint::computeError() _error[0]=%f\n",_error[0]);
   }
 
+#ifdef USE_ANALYTIC_JACOBI
+  /**
+   * @brief Jacobi matrix of the cost function specified in computeError().
+   */
+  void linearizeOplus()
+  {
+    ROS_ASSERT_MSG(cfg_ && _measurement, "You must call setTebConfig(), setViaPoint() on EdgeViaPoint()");
+    const VertexPose* bandpt = static_cast<const VertexPose*>(_vertices[0]);
+
+    Eigen::Vector2d deltaS = bandpt->position() - *_measurement;
+    double dist = deltaS.norm();
+
+    _jacobianOplusXi.setZero();
+    if (dist > 0)
+      _jacobianOplusXi.block<1,2>(0,0) = deltaS.transpose() / dist;
+  }
+#endif
+
   
   /**
    * @brief Compute and return error / cost value.
@@ -167,7 +186,7 @@ protected:
   const TebConfig* cfg_; //!< Store TebConfig class for parameters
   
 public: 	
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TEB_POOLED_EDGE_OPERATOR_NEW(EdgeViaPoint)
 
 };
   
@@ -186,6 +186,25 @@ inline double penaltyBoundFromBelowDerivative(const double &var,
   }
 }
 
+/**
+ * @brief Derivative of the linear penalty function for bounding \c var from
+ * above: \f$ var < a \f$
+ * @param var The scalar that should be bounded
+ * @param a upper bound
+ * @param epsilon safty margin (move bound to the interior of the interval)
+ * @see penaltyBoundFromAbove
+ * @return Derivative of the penalty function w.r.t. \c var
+ */
+inline double penaltyBoundFromAboveDerivative(const double &var,
+                                              const double &a,
+                                              const double &epsilon) {
+  if (var <= (a - epsilon)) {
+    return 0.;
+  } else {
+    return 1;
+  }
+}
+
 inline double penaltyBoundFromBelowExp(const double &var, const double &a,
                                        const double &epsilon,
                                        const double &mul) {
@@ -199,6 +218,32 @@ inline double penaltyBoundFromBelowExp(const double &var, const double &a,
   }
 }
 
+/**
+ * @brief Derivative of the nonlinear penalty function for bounding \c var
+ * from below: \f$ a < var \f$
+ * @param var The scalar that should be bounded
+ * @param a lower bound
+ * @param epsilon safty margin (move bound to the interior of the interval)
+ * @param mul steepness of the penalty
+ * @see penaltyBoundFromBelowExp
+ * @return Derivative of the penalty function w.r.t. \c var
+ */
+inline double penaltyBoundFromBelowExpDerivative(const double &var,
+                                                 const double &a,
+                                                 const double &epsilon,
+                                                 const double &mul) {
+  if (var >= a + epsilon) {
+    return 0.0;
+  } else if (var < 0.0) {
+    return -1;
+  } else if ((a + epsilon - var) / (mul * var + 1.0) <= 0.00001) {
+    return 0.0; // constant for numerical stability
+  } else {
+    double aux = mul * var + 1.0;
+    return -(1.0 + mul * (a + epsilon)) / (aux * aux);
+  }
+}
+
 } // namespace teb_local_planner
 
 #endif // PENALTIES_H
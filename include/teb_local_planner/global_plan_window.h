@@ -0,0 +1,183 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef GLOBAL_PLAN_WINDOW_H_
+#define GLOBAL_PLAN_WINDOW_H_
+
+#include <geometry_msgs/PoseStamped.h>
+#include <ros/time.h>
+#include <tf/transform_datatypes.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class GlobalPlanWindow
+ * @brief Global plan with a cursor to its first pose that has not been passed
+ * yet.
+ *
+ * Besides the poses, the positions and the cumulative arc length are stored in
+ * contiguous arrays. Pruning advances the cursor instead of erasing the passed
+ * poses, and the searches for the robot start at the cursor, so a planning
+ * interval only touches the poses around the robot. Indices always refer to
+ * the complete plan.
+ */
+class GlobalPlanWindow {
+public:
+  GlobalPlanWindow();
+
+  /**
+   * @brief Store a plan, the cursor is reset to its first pose
+   */
+  void setPlan(const std::vector<geometry_msgs::PoseStamped> &plan);
+
+  /**
+   * @brief Remove all poses
+   */
+  void clear();
+
+  bool empty() const { return poses_.empty(); }
+
+  //! Number of poses of the complete plan
+  std::size_t size() const { return poses_.size(); }
+
+  //! Index of the first pose that has not been pruned
+  std::size_t cursor() const { return cursor_; }
+
+  //! Poses of the complete plan (including the pruned ones)
+  const std::vector<geometry_msgs::PoseStamped> &poses() const {
+    return poses_;
+  }
+
+  double x(std::size_t i) const { return x_[i]; }
+  double y(std::size_t i) const { return y_[i]; }
+
+  //! Arc length from the first pose of the plan to pose i [m]
+  double arcLength(std::size_t i) const { return arc_length_[i]; }
+
+  //! Arc length of all poses of the plan, see arcLength()
+  const std::vector<double> &arcLengths() const { return arc_length_; }
+
+  /**
+   * @brief Identity of the poses of the plan
+   *
+   * Changes whenever poses are set, removed or appended and is unique among
+   * all windows, advancing the cursor keeps it.
+   */
+  uint64_t revision() const { return revision_; }
+
+  /**
+   * @brief Advance the cursor to the first pose closer than \c
+   * dist_behind_robot to the robot, searching forward from the cursor
+   * @param robot_x x-coordinate of the robot in the frame of the plan
+   * @param robot_y y-coordinate of the robot in the frame of the plan
+   * @param dist_behind_robot distance threshold [m]
+   * @param max_search_length maximum arc length from the cursor to the pose
+   * [m] (<= 0: unlimited)
+   * @return \c false if no pose is close enough, the cursor is kept then
+   */
+  bool prune(double robot_x, double robot_y, double dist_behind_robot,
+             double max_search_length = 0);
+
+  /**
+   * @brief Find the poses of the plan ahead of the robot for the local
+   * planner, starting at the cursor
+   *
+   * The slice starts at the first local minimum of the distance to the robot
+   * inside \c dist_threshold and ends with the first pose outside of it or
+   * once the arc length of the slice exceeds \c max_plan_length.
+   * @param robot_x x-coordinate of the robot in the frame of the plan
+   * @param robot_y y-coordinate of the robot in the frame of the plan
+   * @param dist_threshold maximum distance of the poses to the robot [m]
+   * @param max_plan_length maximum arc length of the slice [m] (<= 0:
+   * disabled)
+   * @param[out] first index of the first pose of the slice
+   * @param[out] end index behind the last pose of the slice
+   */
+  void findSlice(double robot_x, double robot_y, double dist_threshold,
+                 double max_plan_length, std::size_t &first,
+                 std::size_t &end) const;
+
+  /**
+   * @brief Transform the poses [first,end) into another frame
+   *
+   * The poses of \c transformed are overwritten in place, so the vector does
+   * not reallocate once its capacity suffices.
+   * @param first index of the first pose
+   * @param end index behind the last pose
+   * @param plan_to_frame transformation from the frame of the plan
+   * @param stamp time stamp of the transformed poses
+   * @param frame_id frame of the transformed poses
+   * @param[out] transformed transformed poses
+   */
+  void transform(std::size_t first, std::size_t end,
+                 const tf::Transform &plan_to_frame, const ros::Time &stamp,
+                 const std::string &frame_id,
+                 std::vector<geometry_msgs::PoseStamped> &transformed) const;
+
+  /**
+   * @brief Remove the poses from index \c end on, the cursor is clamped to the
+   * last remaining pose
+   */
+  void truncate(std::size_t end);
+
+  /**
+   * @brief Append a pose to the plan
+   */
+  void append(const geometry_msgs::PoseStamped &pose);
+
+private:
+  double squaredDistance(std::size_t i, double x, double y) const {
+    double dx = x - x_[i];
+    double dy = y - y_[i];
+    return dx * dx + dy * dy;
+  }
+
+  //! Assign a new revision after the poses changed
+  void touch();
+
+  std::vector<geometry_msgs::PoseStamped> poses_;
+  std::vector<double> x_, y_, arc_length_;
+  std::size_t cursor_;
+  uint64_t revision_;
+};
+
+} // namespace teb_local_planner
+
+#endif // GLOBAL_PLAN_WINDOW_H_
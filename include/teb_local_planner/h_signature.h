@@ -0,0 +1,173 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef H_SIGNATURE_H_
+#define H_SIGNATURE_H_
+
+#include <teb_local_planner/obstacles.h>
+
+#include <ros/assert.h>
+
+#include <complex>
+#include <iterator>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class HSignatureCache
+ * @brief Computes H-signatures of paths with obstacle coefficients that are
+ * cached for the planning interval.
+ *
+ * The coefficient of each obstacle depends on all obstacles and on the map
+ * bounds guessed from the start and the end of the path (refer to S.
+ * Bhattacharya et al.: Search-based Path Planning with Homotopy Class
+ * Constraints, AAAI, 2010). They are computed in O(M^2) for M obstacles
+ * whenever the obstacles, the bounds or the prescaler change, each path then
+ * takes O(segments * M).
+ *
+ * Call invalidate() whenever the content of the obstacle container changes.
+ * An instance must not be used by several threads at the same time.
+ */
+class HSignatureCache {
+public:
+  HSignatureCache();
+
+  /**
+   * @brief Drop the coefficients, they are recomputed for the next path
+   */
+  void invalidate() { valid_ = false; }
+
+  /**
+   * @brief Calculate the H-signature of a path, equals
+   * HomotopyClassPlanner::calculateHSignature()
+   * @param path_start iterator to the first point of the path
+   * @param path_end iterator behind the last point of the path
+   * @param fun_cplx_point function returning the position of a point as
+   * complex number (Re(*)=x, Im(*)=y)
+   * @param obstacles obstacle container
+   * @param prescaler scale of the coefficients, interval (0.1,1]
+   * @return complex H-signature
+   */
+  template <typename BidirIter, typename Fun>
+  std::complex<long double> calculate(BidirIter path_start, BidirIter path_end,
+                                      Fun fun_cplx_point,
+                                      const ObstContainer *obstacles,
+                                      double prescaler);
+
+  /**
+   * @brief Prepare the coefficients for paths between two points, required by
+   * segment()
+   * @param obstacles obstacle container
+   * @param path_start first point of the paths
+   * @param path_end last point of the paths
+   * @param prescaler scale of the coefficients, interval (0.1,1]
+   */
+  void prepare(const ObstContainer &obstacles,
+               const std::complex<double> &path_start,
+               const std::complex<double> &path_end, double prescaler) {
+    ROS_ASSERT_MSG(prescaler > 0.1 && prescaler <= 1,
+                   "Only a prescaler on the interval (0.1,1] ist allowed.");
+    update(obstacles, path_start, path_end, prescaler);
+  }
+
+  /**
+   * @brief Contribution of a single segment to the H-signature of a path
+   *
+   * The H-signature of a path is the sum of the contributions of its segments,
+   * so partial paths can be accumulated incrementally. Requires prepare() for
+   * the start and the end of the path.
+   * @param from first point of the segment
+   * @param to second point of the segment
+   */
+  std::complex<long double> segment(const std::complex<double> &from,
+                                    const std::complex<double> &to) const;
+
+private:
+  //! Compute the coefficients unless they are valid for these arguments
+  void update(const ObstContainer &obstacles,
+              const std::complex<double> &path_start,
+              const std::complex<double> &path_end, double prescaler);
+
+  //! Start accumulating a path at its first point
+  void beginPath(const std::complex<double> &point);
+
+  //! Accumulate the segment from the previous to this point
+  void addPoint(const std::complex<double> &point);
+
+  //! Weight the accumulated logarithms with the coefficients
+  std::complex<long double> endPath() const;
+
+  bool valid_;
+  const ObstContainer *obstacles_; //!< Container of the cached obstacles
+  std::complex<double> path_start_;
+  double map_size_, prescaler_;
+
+  std::vector<double> obstacle_x_, obstacle_y_; //!< Centroids
+  std::vector<std::complex<long double>> coefficients_;
+
+  // per obstacle: distance, log distance and angle of the previous point,
+  // and sums of the log values of the segments
+  std::vector<double> dist_, log_dist_, angle_, sum_real_, sum_imag_;
+};
+
+template <typename BidirIter, typename Fun>
+std::complex<long double>
+HSignatureCache::calculate(BidirIter path_start, BidirIter path_end,
+                           Fun fun_cplx_point, const ObstContainer *obstacles,
+                           double prescaler) {
+  if (obstacles->empty())
+    return std::complex<long double>(0, 0);
+
+  ROS_ASSERT_MSG(prescaler > 0.1 && prescaler <= 1,
+                 "Only a prescaler on the interval (0.1,1] ist allowed.");
+
+  std::advance(path_end, -1); // points to the last point now
+  std::complex<long double> start = fun_cplx_point(*path_start);
+  std::complex<long double> end = fun_cplx_point(*path_end);
+  update(*obstacles, std::complex<double>(start), std::complex<double>(end),
+         prescaler);
+
+  beginPath(std::complex<double>(start));
+  while (path_start != path_end) {
+    ++path_start;
+    addPoint(std::complex<double>(fun_cplx_point(*path_start)));
+  }
+  return endPath();
+}
+
+} // namespace teb_local_planner
+
+#endif // H_SIGNATURE_H_
@@ -59,6 +59,7 @@
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/depth_first_search.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/random.hpp>
 #include <boost/utility.hpp>
 
@@ -76,6 +77,9 @@
 #include <teb_local_planner/optimal_planner.h>
 #include <teb_local_planner/visualization.h>
 #include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/thread_pool.h>
+#include <teb_local_planner/h_signature.h>
+#include <teb_local_planner/homotopy_roadmap.h>
 
 
 namespace teb_local_planner
@@ -222,6 +226,20 @@ public:
    */
   virtual bool getVelocityCommand(double& v, double& omega) const;
 
+  /**
+   * @brief Set the deadline of the following plan() calls, it is passed to each candidate before optimizing.
+   * @see TebOptimalPlanner::setDeadline
+   * @param deadline wall clock deadline, a zero time disables the deadline
+   */
+  virtual void setDeadline(const ros::WallTime& deadline) {deadline_ = deadline;}
+
+  /**
+   * @brief Assign the IDs of the via-points, they are passed to the candidates together with the via-points.
+   * @see TebOptimalPlanner::setViaPointIds
+   * @param via_point_ids pointer to the ascending IDs of the via-points (can also be a nullptr)
+   */
+  virtual void setViaPointIds(const std::vector<uint64_t>* via_point_ids) {via_point_ids_ = via_point_ids;}
+
   /**
    * @brief Access current best trajectory candidate (that relates to the "best" homotopy class).
    *
@@ -344,6 +362,9 @@ public:
    * @brief Optimize all available trajectories by invoking the optimizer on each one.
    * 
    * Depending on the configuration parameters, the optimization is performed either single or multi threaded.
+   * The candidates are processed in the order of their cost in the last cycle, the multi threaded optimization
+   * uses a persistent pool of worker threads (see ThreadPool). Candidates that are clearly outperformed by a
+   * converged one are cancelled if \c cancel_cost_ratio is set, see optimizeCandidate().
    * @param iter_innerloop Number of inner iterations (see TebOptimalPlanner::optimizeTEB())
    * @param iter_outerloop Number of outer iterations (see TebOptimalPlanner::optimizeTEB())
    */
@@ -365,7 +386,7 @@ public:
     * 
     * Clear all previously found H-signatures, paths, tebs and the hcgraph.
     */
-  void clearPlanner() {graph_.clear(); h_signatures_.clear(); tebs_.clear(); initial_plan_ = NULL;}
+  void clearPlanner() {graph_.clear(); roadmap_.clear(); h_signatures_.clear(); tebs_.clear(); initial_plan_ = NULL;}
   
   /**
    * @brief Check if the planner suggests a shorter horizon (e.g. to resolve problems)
@@ -393,6 +414,8 @@ public:
    * 
    * T could also be a pointer type, if the passed function also accepts a const T* point_Type.
    * 
+   * The obstacle coefficients are taken from the h-signature cache of the current planning interval.
+   * 
    * @param path_start Iterator to the first element in the path
    * @param path_end Iterator to the last element in the path
    * @param obstacles obstacle container
@@ -403,7 +426,7 @@ public:
    * @return complex H-Signature value
    */  
   template<typename BidirIter, typename Fun>
-  static std::complex<long double> calculateHSignature(BidirIter path_start, BidirIter path_end, Fun fun_cplx_point, const ObstContainer* obstacles = NULL, double prescaler = 1);
+  std::complex<long double> calculateHSignature(BidirIter path_start, BidirIter path_end, Fun fun_cplx_point, const ObstContainer* obstacles = NULL, double prescaler = 1);
   
   /**
    * @brief Read-only access to the internal trajectory container.
@@ -467,6 +490,7 @@ protected:
    * This version of the graph samples keypoints in a predefined area (config) in the current frame between start and goal. \n
    * Afterwards all feasible paths between start and goal point are extracted using a Depth First Search. \n
    * Use the sampling method for complex, non-point or huge obstacles. \n
+   * If hcp.roadmap_graph_incremental is enabled, samples and edge collision states are kept between planning intervals (see HomotopyRoadmap). \n
    * You may call createGraph() instead.
    * 
    * @see createGraph
@@ -516,18 +540,19 @@ protected:
   void updateReferenceTrajectoryViaPoints(bool all_trajectories);
   
   /**
-   * @brief Depth First Search implementation to find all paths between the start and the specified goal vertex.
+   * @brief Depth First Search implementation to find paths of distinct homotopy classes between the start and the specified goal vertex.
    * 
-   * Complete paths are stored to the internal path container.
-   * @sa http://www.technical-recipes.com/2011/a-recursive-algorithm-to-find-all-paths-between-two-given-nodes/
-   * @param g Graph on which the depth first should be performed
-   * @param visited A container that stores visited vertices (pass an empty container, it will be filled inside during recursion).
+   * The search is iterative on a compact copy of the adjacency of graph_ and accumulates the H-signature along the current path.
+   * Partial paths that are homotopic to one that has already been expanded at the same vertex are pruned.
+   * The search stops once cfg_->hcp.max_number_classes trajectories exist or the exploration time budget is exceeded.
+   * New homotopy classes are stored to the internal TEB container.
+   * @param start Start vertex
    * @param goal Desired goal vertex
    * @param start_orientation Orientation of the first trajectory pose, required to initialize the trajectory/TEB
    * @param goal_orientation Orientation of the goal trajectory pose, required to initialize the trajectory/TEB
    * @param start_velocity start velocity (optional)
    */
-  void DepthFirst(HcGraph& g, std::vector<HcGraphVertexType>& visited, const HcGraphVertexType& goal,
+  void DepthFirst(const HcGraphVertexType& start, const HcGraphVertexType& goal,
                   double start_orientation, double goal_orientation, boost::optional<const Eigen::Vector2d&> start_velocity);
  
   /**
@@ -541,6 +566,19 @@ protected:
    * @return index of the best TEB obtained with bestTEB(), if no TEB is avaiable, it returns -1.
    */
   int bestTebIdx() const;
+
+  /**
+   * @brief Optimize a single candidate and cancel the candidates it clearly outperforms.
+   *
+   * If the candidate converged (TebOptimalPlanner::STOP_CONVERGED, requires \c convergence_threshold) with a
+   * cost that is lower by at least \c cancel_cost_ratio than the cost of
+   * another candidate in the last cycle, the optimization of the latter is cancelled (see TebOptimalPlanner::cancelOptimization()).
+   * The currently selected candidate and candidates without a cost of the last cycle are never cancelled.
+   * @param idx index of the candidate in tebs_
+   * @param iter_innerloop Number of inner iterations (see TebOptimalPlanner::optimizeTEB())
+   * @param iter_outerloop Number of outer iterations (see TebOptimalPlanner::optimizeTEB())
+   */
+  void optimizeCandidate(std::size_t idx, unsigned int iter_innerloop, unsigned int iter_outerloop);
   
   //@}
   
@@ -548,6 +586,7 @@ protected:
   // external objects (store weak pointers)
   ObstContainer* obstacles_; //!< Store obstacles that are relevant for planning
   const ViaPointContainer* via_points_; //!< Store the current list of via-points
+  const std::vector<uint64_t>* via_point_ids_; //!< IDs of the via-points, see setViaPointIds()
   const TebConfig* cfg_; //!< Config class that stores and manages all related parameters
   
   // internal objects (memory management owned)
@@ -559,12 +598,17 @@ protected:
   std::complex<long double> initial_plan_h_sig_; //!< Store the h_signature of the initial plan
   
   TebOptPlannerContainer tebs_; //!< Container that stores multiple local teb planners (for alternative homotopy classes) and their corresponding costs
+  std::vector<double> last_costs_; //!< Cost of each candidate in tebs_ before the current optimization (HUGE_VAL if unknown)
+  boost::scoped_ptr<ThreadPool> thread_pool_; //!< Worker threads for the multi threaded optimization of the candidates
+  ros::WallTime deadline_; //!< Deadline of the optimization of the candidates, see setDeadline()
   
   HcGraph graph_; //!< Store the graph that is utilized to find alternative homotopy classes.
  
   std::vector< std::pair<std::complex<long double>, bool> > h_signatures_; //!< Store all known h-signatures to allow checking for duplicates after finding and adding new ones. 
 									  //   The second parameter denotes whether to exclude the h-signature from detour deletion or not (true: keep).
+  HSignatureCache h_signature_cache_; //!< Obstacle coefficients of the h-signatures, invalidated at the beginning of each planning interval
   
+  HomotopyRoadmap roadmap_; //!< Samples of createProbRoadmapGraph and the collision states of the edges between them, kept between planning intervals
   boost::random::mt19937 rnd_generator_; //!< Random number generator used by createProbRoadmapGraph to sample graph keypoints.   
       
   bool initialized_; //!< Keeps track about the correct initialization of this class
@@ -0,0 +1,184 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef HOMOTOPY_ROADMAP_H_
+#define HOMOTOPY_ROADMAP_H_
+
+#include <teb_local_planner/distance_calculations.h>
+#include <teb_local_planner/obstacles.h>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <boost/random.hpp>
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class HomotopyRoadmap
+ * @brief Samples of the probabilistic roadmap for the homotopy class
+ * exploration and the collision states of the segments between them, kept
+ * between planning intervals.
+ *
+ * Samples and states are stored in the planning frame, in which the obstacles
+ * barely move between two intervals. updateObstacles() compares the obstacles
+ * with those of the previous interval: samples colliding with new obstacles
+ * are dropped, free segments are only checked against new obstacles and
+ * blocked segments are only checked again once the obstacle blocking them is
+ * gone. Obstacles are identified by their type, centroid and shape, with the
+ * coordinates rounded to KEY_RESOLUTION.
+ */
+class HomotopyRoadmap {
+public:
+  HomotopyRoadmap();
+
+  /**
+   * @brief Remove all samples and collision states
+   */
+  void clear();
+
+  /**
+   * @brief Update the samples and the collision states for the current
+   * obstacles
+   * @param obstacles obstacle container
+   * @param dist_to_obst required distance of samples and segments to the
+   * obstacles, changing it clears the roadmap
+   */
+  void updateObstacles(const ObstContainer &obstacles, double dist_to_obst);
+
+  /**
+   * @brief Drop the samples outside of the sampling area and sample new ones
+   * until there are \c no_samples
+   *
+   * The area is the rectangle [0,length]x[0,width] in the frame given by \c
+   * origin and \c rotation. Of \c candidates random positions for each new
+   * sample, the one farthest from the existing samples is taken, such that
+   * samples are added where the coverage is thin.
+   * @param origin corner of the area
+   * @param rotation orientation of the area
+   * @param length length of the area (start-goal distance)
+   * @param width width of the area
+   * @param no_samples number of samples
+   * @param obstacles obstacle container, updateObstacles() must have been
+   * called for it
+   * @param generator random number generator
+   * @param candidates number of random candidates for each new sample
+   */
+  void updateSamples(const Eigen::Vector2d &origin,
+                     const Eigen::Rotation2D<double> &rotation, double length,
+                     double width, int no_samples,
+                     const ObstContainer &obstacles,
+                     boost::random::mt19937 &generator, int candidates);
+
+  //! Collision-free samples
+  const Point2dContainer &samples() const { return samples_; }
+
+  /**
+   * @brief Check whether the segment between two samples is collision free
+   *
+   * The state is computed on first use and kept until the obstacles change.
+   * @param i index of the first sample
+   * @param j index of the second sample
+   * @param obstacles obstacle container, updateObstacles() must have been
+   * called for it
+   */
+  bool segmentFree(std::size_t i, std::size_t j,
+                   const ObstContainer &obstacles);
+
+private:
+  enum SegmentState { UNKNOWN, FREE, BLOCKED };
+
+  //! Resolution of the obstacle coordinates in the keys [m]
+  static constexpr double KEY_RESOLUTION = 1e-3;
+
+  //! Identity of an obstacle between planning intervals
+  struct ObstacleKey {
+    long x, y;            //!< Quantized centroid
+    std::size_t type;     //!< Hash of the obstacle class
+    std::size_t geometry; //!< Hash of the quantized vertices
+
+    bool operator<(const ObstacleKey &other) const {
+      return std::tie(x, y, type, geometry) <
+             std::tie(other.x, other.y, other.type, other.geometry);
+    }
+    bool operator==(const ObstacleKey &other) const {
+      return x == other.x && y == other.y && type == other.type &&
+             geometry == other.geometry;
+    }
+  };
+
+  static long quantize(double coordinate);
+  static void hashPoint(std::size_t &seed, const Eigen::Vector2d &point);
+  static ObstacleKey key(const Obstacle &obstacle);
+
+  //! Index of the state of the segment between samples i and j out of \c size
+  static std::size_t segmentIndex(std::size_t i, std::size_t j,
+                                  std::size_t size) {
+    return i < j ? i * size + j : j * size + i;
+  }
+
+  //! Remove the samples with keep[i] == false and their states
+  void removeSamples(const std::vector<bool> &keep);
+
+  //! Reorder the states of \c old_size samples such that new sample a takes
+  //! the states of sample old_index[a], or unknown states if old_index[a] is
+  //! not one of them
+  void remapStates(const std::vector<std::size_t> &old_index,
+                   std::size_t old_size);
+
+  Point2dContainer samples_;
+  std::vector<unsigned char> states_; //!< SegmentState of each sample pair
+  std::vector<ObstacleKey> blockers_; //!< Obstacle blocking each pair
+  std::vector<ObstacleKey> obstacle_keys_; //!< Sorted keys of the obstacles
+                                           //! the states are valid for
+  double dist_to_obst_;
+
+  // buffers of updateObstacles()
+  std::vector<std::pair<ObstacleKey, std::size_t>> keys_;
+  std::vector<std::size_t> added_;
+  std::vector<ObstacleKey> removed_;
+
+  // buffers of remapStates(), swapped with states_ and blockers_
+  std::vector<unsigned char> states_buffer_;
+  std::vector<ObstacleKey> blockers_buffer_;
+};
+
+} // namespace teb_local_planner
+
+#endif // HOMOTOPY_ROADMAP_H_
@@ -0,0 +1,165 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef HUMAN_PREDICTION_CLIENT_H_
+#define HUMAN_PREDICTION_CLIENT_H_
+
+#include <hanp_prediction/HumanPosePredict.h>
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <string>
+#include <vector>
+
+#define PREDICT_SERVICE_NAME "/human_pose_prediction/predict_human_poses"
+#define RESET_PREDICTION_SERVICE_NAME                                          \
+  "/human_pose_prediction/reset_external_paths"
+#define PUBLISH_MARKERS_SRV_NAME                                               \
+  "/human_pose_prediction/publish_prediction_markers"
+
+namespace teb_local_planner {
+
+/**
+ * @class HumanPredictionClient
+ * @brief Requests the predicted human plans from the prediction server in a
+ * background thread.
+ *
+ * The responses are double buffered: the thread fills the back buffer and
+ * swaps it with the front buffer, which latest() copies without waiting for
+ * the server. Resetting the prediction and enabling its markers are also
+ * requested from the background thread.
+ */
+class HumanPredictionClient {
+public:
+  typedef std::vector<hanp_prediction::PredictedPoses> Predictions;
+
+  //! Predicted plans of the humans
+  struct Snapshot {
+    ros::Time stamp;    //!< Time at which the request has been sent
+    Predictions humans; //!< Plans and start velocities of the humans
+  };
+
+  HumanPredictionClient();
+
+  /**
+   * @brief Stop the background thread
+   */
+  ~HumanPredictionClient();
+
+  /**
+   * @brief Start the background thread
+   * @param rate frequency of the prediction requests [Hz]
+   */
+  void start(double rate);
+
+  /**
+   * @brief Stop and join the background thread
+   */
+  void stop();
+
+  /**
+   * @brief Set the frequency of the prediction requests [Hz]
+   */
+  void setRate(double rate);
+
+  /**
+   * @brief Set the request sent to the prediction server
+   *
+   * The current snapshot is discarded if the type or the prediction times of
+   * the request changed.
+   */
+  void setRequest(const hanp_prediction::HumanPosePredict::Request &request);
+
+  /**
+   * @brief Enable or disable the markers of the prediction server
+   */
+  void setPublishMarkers(bool publish_markers);
+
+  /**
+   * @brief Reset the prediction server before the next request and discard
+   * the current snapshot
+   */
+  void reset();
+
+  /**
+   * @brief Copy the latest prediction for the current request
+   * @param[out] snapshot latest prediction
+   * @return \c false if no prediction has been received since the last reset
+   * or change of the request
+   */
+  bool latest(Snapshot &snapshot) const;
+
+  /**
+   * @brief Move the predicted poses of each human with its start velocity
+   *
+   * The velocity is rotated into the frame of the poses first. Humans whose
+   * velocity cannot be transformed are left as they are.
+   * @param tf transform listener
+   * @param humans predicted plans
+   * @param dt extrapolation time [s]
+   */
+  static void extrapolate(const tf::TransformListener &tf, Predictions &humans,
+                          double dt);
+
+private:
+  //! Main loop of the background thread
+  void work();
+
+  boost::thread thread_;
+
+  mutable boost::mutex mutex_; //!< Protects the members below
+  boost::condition_variable wake_up_; //!< Notified on changes of the request
+                                      //! and on stop
+  hanp_prediction::HumanPosePredict::Request request_;
+  unsigned long request_id_; //!< Incremented on changes of the request and on
+                             //! reset
+  double rate_;
+  bool publish_markers_;
+  bool reset_requested_;
+  bool stop_;
+
+  Snapshot buffers_[2];
+  int front_; //!< Buffer copied by latest(), the other one is only accessed
+              //! by the background thread
+  unsigned long front_request_id_; //!< Request answered by the front buffer
+};
+
+} // namespace teb_local_planner
+
+#endif // HUMAN_PREDICTION_CLIENT_H_
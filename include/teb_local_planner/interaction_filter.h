@@ -0,0 +1,135 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef INTERACTION_FILTER_H_
+#define INTERACTION_FILTER_H_
+
+#include <teb_local_planner/timed_elastic_band.h>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include <vector>
+
+namespace teb_local_planner {
+
+//! Pairs of pose indices (first trajectory, second trajectory)
+typedef std::vector<std::pair<unsigned int, unsigned int>> PosePairs;
+
+/**
+ * @class TrajectorySweep
+ * @brief Snapshot of the poses of a trajectory for the association of poses
+ * between trajectories: swept bounding box, start position and time of each
+ * pose.
+ *
+ * Like PoseGridIndex, the sweep has to be rebuilt whenever the poses of the
+ * trajectory have been changed (e.g. once per outer optimization iteration).
+ */
+class TrajectorySweep {
+public:
+  TrajectorySweep();
+
+  /**
+   * @brief Build the sweep from the current poses of a trajectory
+   * @param teb trajectory
+   * @param max_vel upper bound of the translational velocity [m/s]
+   * @param margin distance the poses may be moved by the optimization until
+   * the sweep is rebuilt [m]
+   */
+  void build(const TimedElasticBand &teb, double max_vel, double margin);
+
+  std::size_t size() const { return positions_.size(); }
+
+  //! Time of the i-th pose since the start of the trajectory [s]
+  double time(std::size_t i) const { return times_[i]; }
+
+private:
+  friend void filterInteractingPoses(const TrajectorySweep &a,
+                                     const TrajectorySweep &b, double range,
+                                     PosePairs &pairs);
+
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d>>
+      positions_;
+  std::vector<double> times_; //!< Cumulative time of each pose [s]
+  Eigen::Vector2d box_min_, box_max_; //!< Bounding box of the positions
+  double max_vel_, margin_;
+};
+
+/**
+ * @brief Pair the poses of two trajectories with the same index
+ * @param a first trajectory
+ * @param b second trajectory
+ * @param[out] pairs pairs (k, k) for all indices of the shorter trajectory
+ */
+void associatePosesByIndex(const TrajectorySweep &a, const TrajectorySweep &b,
+                           PosePairs &pairs);
+
+/**
+ * @brief Pair the poses of a trajectory with the poses of another one at the
+ * same time.
+ *
+ * The sorted pose times of both trajectories are merged, hence the
+ * association is linear in their sizes. Poses of \c a after the last pose of
+ * \c b are not associated.
+ * @param a first trajectory
+ * @param b second trajectory
+ * @param segments if \c true, pair each segment (i, i+1) of \c a with the
+ * segment (j, j+1) of \c b during which it starts, otherwise pair each pose
+ * i of \c a with the pose j of \c b that is closest in time
+ * @param[out] pairs pairs (i, j) in ascending order of i
+ */
+void associatePosesByTime(const TrajectorySweep &a, const TrajectorySweep &b,
+                          bool segments, PosePairs &pairs);
+
+/**
+ * @brief Remove the pose pairs of two trajectories that cannot come within a
+ * range of each other.
+ *
+ * All pairs are removed at once if the swept bounding boxes, inflated by the
+ * margins, are further apart than the range. Otherwise a pair (i, j) is
+ * removed if the poses are further apart than the range plus both margins, or
+ * if they cannot reach each other from their start positions at the velocity
+ * bounds: \f$ |s_a - s_b| > range + v_a t_a(i) + v_b t_b(j) \f$.
+ * @param a first trajectory
+ * @param b second trajectory
+ * @param range distance below which the poses interact [m]
+ * @param[in,out] pairs pose pairs to filter
+ */
+void filterInteractingPoses(const TrajectorySweep &a, const TrajectorySweep &b,
+                            double range, PosePairs &pairs);
+
+} // namespace teb_local_planner
+
+#endif // INTERACTION_FILTER_H_
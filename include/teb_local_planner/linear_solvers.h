@@ -0,0 +1,203 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef LINEAR_SOLVERS_H_
+#define LINEAR_SOLVERS_H_
+
+#include <g2o/core/linear_solver.h>
+#include <g2o/core/sparse_block_matrix.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class BandedLinearSolver
+ * @brief Cholesky factorization of the system matrix in band storage.
+ *
+ * The vertices of a TEB get consecutive ids (pose, time difference, pose, ...)
+ * and its edges connect a few consecutive vertices only, hence the Hessian of
+ * the robot-only graph is a narrow band. The band is factorized in
+ * O(n b^2) for n rows and the half-bandwidth b, without the ordering and the
+ * symbolic analysis of the general sparse solvers. Edges between distant
+ * vertices (e.g. human-robot edges) widen the band up to a dense
+ * factorization, the solution stays exact.
+ */
+template <typename MatrixType>
+class BandedLinearSolver : public g2o::LinearSolver<MatrixType> {
+public:
+  BandedLinearSolver() : size_(0), bandwidth_(0), write_debug_(false) {}
+
+  virtual bool init() { return true; }
+
+  virtual bool solve(const g2o::SparseBlockMatrix<MatrixType> &A, double *x,
+                     double *b) {
+    if (!factorize(A))
+      return false;
+
+    // L y = b
+    std::copy(b, b + size_, x);
+    for (int i = 0; i < size_; ++i) {
+      const double *li = row(i);
+      for (int k = std::max(0, i - bandwidth_); k < i; ++k)
+        x[i] -= li[k] * x[k];
+      x[i] /= li[i];
+    }
+    // L^T x = y, column-wise to walk along the rows of the band
+    for (int i = size_ - 1; i >= 0; --i) {
+      const double *li = row(i);
+      x[i] /= li[i];
+      for (int k = std::max(0, i - bandwidth_); k < i; ++k)
+        x[k] -= li[k] * x[i];
+    }
+    return true;
+  }
+
+  virtual bool writeDebug() const { return write_debug_; }
+  virtual void setWriteDebug(bool write_debug) { write_debug_ = write_debug; }
+
+  //! Half-bandwidth of the last system matrix
+  int bandwidth() const { return bandwidth_; }
+
+private:
+  //! Row i of the lower band, indexed by the column: row(i)[j] = L(i, j)
+  double *row(int i) { return &band_[i * (bandwidth_ + 1) + bandwidth_ - i]; }
+
+  //! Copy the upper triangular blocks of A into the lower band and factorize
+  //! it in place, returns false if A is not positive definite
+  bool factorize(const g2o::SparseBlockMatrix<MatrixType> &A) {
+    int size = A.rows(), bandwidth = 0;
+    for (int c = 0; c < (int)A.blockCols().size(); ++c) {
+      int last_col = A.colBaseOfBlock(c) + A.colsOfBlock(c) - 1;
+      for (const auto &block : A.blockCols()[c])
+        bandwidth =
+            std::max(bandwidth, last_col - A.rowBaseOfBlock(block.first));
+    }
+
+    // the band is only resized if the shape changed, otherwise the fill-in of
+    // the previous factorization is cleared in place
+    if (size != size_ || bandwidth != bandwidth_) {
+      size_ = size;
+      bandwidth_ = bandwidth;
+      band_.resize(size_ * (bandwidth_ + 1));
+    }
+    std::fill(band_.begin(), band_.end(), 0.0);
+    for (int c = 0; c < (int)A.blockCols().size(); ++c) {
+      int col_base = A.colBaseOfBlock(c);
+      for (const auto &block : A.blockCols()[c]) {
+        int row_base = A.rowBaseOfBlock(block.first);
+        const MatrixType &m = *block.second;
+        for (int jj = 0; jj < m.cols(); ++jj) {
+          double *lj = row(col_base + jj);
+          for (int ii = 0; ii < m.rows() && row_base + ii <= col_base + jj;
+               ++ii)
+            lj[row_base + ii] = m(ii, jj);
+        }
+      }
+    }
+
+    for (int i = 0; i < size_; ++i) {
+      double *li = row(i);
+      int first = std::max(0, i - bandwidth_);
+      for (int j = first; j <= i; ++j) {
+        const double *lj = row(j);
+        double sum = li[j];
+        for (int k = first; k < j; ++k)
+          sum -= li[k] * lj[k];
+        if (j < i) {
+          li[j] = sum / lj[j];
+        } else {
+          if (sum <= 0.0)
+            return false;
+          li[i] = std::sqrt(sum);
+        }
+      }
+    }
+    return true;
+  }
+
+  int size_, bandwidth_;
+  std::vector<double> band_; //!< Rows of the lower band, row-major
+  bool write_debug_;
+};
+
+/**
+ * @class TimedLinearSolver
+ * @brief Forwards to another linear solver and accumulates the time spent in
+ * its solve() calls.
+ */
+template <typename MatrixType>
+class TimedLinearSolver : public g2o::LinearSolver<MatrixType> {
+public:
+  //! Takes the ownership of \c solver
+  explicit TimedLinearSolver(g2o::LinearSolver<MatrixType> *solver)
+      : solver_(solver), time_(0.0) {}
+
+  virtual bool init() { return solver_->init(); }
+
+  virtual bool solve(const g2o::SparseBlockMatrix<MatrixType> &A, double *x,
+                     double *b) {
+    auto start = std::chrono::steady_clock::now();
+    bool success = solver_->solve(A, x, b);
+    time_ += std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+                 .count();
+    return success;
+  }
+
+  virtual bool writeDebug() const { return solver_->writeDebug(); }
+  virtual void setWriteDebug(bool write_debug) {
+    solver_->setWriteDebug(write_debug);
+  }
+
+  //! Time spent in solve() since the last reset() [s]
+  double time() const { return time_; }
+
+  //! Restart the accumulation from \c time [s]
+  void reset(double time = 0.0) { time_ = time; }
+
+private:
+  boost::scoped_ptr<g2o::LinearSolver<MatrixType>> solver_;
+  double time_;
+};
+
+} // namespace teb_local_planner
+
+#endif // LINEAR_SOLVERS_H_
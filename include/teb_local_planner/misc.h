@@ -42,6 +42,7 @@
 #include <Eigen/Core>
 #include <boost/utility.hpp>
 #include <boost/type_traits.hpp>
+#include <vector>
 
 
 namespace teb_local_planner
@@ -97,6 +98,17 @@ inline double fast_sigmoid(double x)
   return x / (1 + fabs(x));
 }
 
+/**
+ * @brief Derivative of fast_sigmoid()
+ * @details The following function is implemented: \f$ 1 / (1 + |x|)^2 \f$
+ * @param x the argument of the function
+*/
+inline double fast_sigmoid_derivative(double x)
+{
+  double aux = 1 + fabs(x);
+  return 1 / (aux * aux);
+}
+
 /**
  * @brief Calculate Euclidean distance between two 2D point datatypes
  * @param point1 object containing fields x and y
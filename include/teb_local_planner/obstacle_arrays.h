@@ -0,0 +1,179 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef OBSTACLE_ARRAYS_H_
+#define OBSTACLE_ARRAYS_H_
+
+#include <teb_local_planner/distance_calculations.h>
+#include <teb_local_planner/obstacles.h>
+
+#include <Eigen/Core>
+
+#include <cmath>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class ObstacleArrays
+ * @brief Static point, line and polygon obstacles in contiguous per-type
+ * arrays of coordinates.
+ *
+ * This is a second representation of an ObstContainer for the optimization:
+ * obstacles are referenced by type and index and the distance kernels are not
+ * virtual. The container the arrays have been built from stays the reference
+ * for everything else (e.g. TebVisualization::publishObstacles).
+ */
+class ObstacleArrays {
+public:
+  enum Type { NONE, POINT, LINE, POLYGON };
+
+  //! Reference to an obstacle in the arrays
+  struct Ref {
+    Ref() : type(NONE), index(-1) {}
+    Ref(Type type, int index) : type(type), index(index) {}
+
+    Type type;
+    int index;
+  };
+
+  /**
+   * @brief Rebuild the arrays from the static obstacles of a container
+   *
+   * Dynamic obstacles and obstacles of unknown types are skipped, their
+   * reference is of type NONE.
+   * @param obstacles obstacle container
+   */
+  void fromContainer(const ObstContainer &obstacles);
+
+  /**
+   * @brief Remove all obstacles
+   */
+  void clear();
+
+  /**
+   * @brief Reference to the i-th obstacle of the container the arrays have been
+   * built from
+   */
+  const Ref &ref(std::size_t i) const { return refs_[i]; }
+
+  //! Number of obstacles of the container the arrays have been built from
+  std::size_t size() const { return refs_.size(); }
+
+  std::size_t sizePoints() const { return point_x_.size(); }
+  std::size_t sizeLines() const { return line_start_x_.size(); }
+  std::size_t sizePolygons() const { return polygon_start_.size() - 1; }
+
+  /**
+   * @brief Minimum distance between a position and an obstacle, equals
+   * Obstacle::getMinimumDistance(position) of the original obstacle
+   * @param ref obstacle
+   * @param position 2D reference position
+   */
+  double distance(const Ref &ref, const Eigen::Vector2d &position) const {
+    switch (ref.type) {
+    case POINT:
+      return pointDistance(ref.index, position);
+    case LINE:
+      return lineDistance(ref.index, position);
+    case POLYGON:
+      return polygonDistance(ref.index, position);
+    default:
+      return HUGE_VAL;
+    }
+  }
+
+  double pointDistance(int i, const Eigen::Vector2d &position) const {
+    double dx = position.x() - point_x_[i];
+    double dy = position.y() - point_y_[i];
+    return std::sqrt(dx * dx + dy * dy);
+  }
+
+  double lineDistance(int i, const Eigen::Vector2d &position) const {
+    return distance_point_to_segment_2d(
+        position, Eigen::Vector2d(line_start_x_[i], line_start_y_[i]),
+        Eigen::Vector2d(line_end_x_[i], line_end_y_[i]));
+  }
+
+  double polygonDistance(int i, const Eigen::Vector2d &position) const;
+
+  /**
+   * @brief Closest point of an obstacle to a position, equals
+   * Obstacle::getClosestPoint(position) of the original obstacle
+   * @param ref obstacle
+   * @param position 2D reference position
+   * @return closest point, \c position itself for obstacles of type NONE
+   */
+  Eigen::Vector2d closestPoint(const Ref &ref,
+                               const Eigen::Vector2d &position) const {
+    switch (ref.type) {
+    case POINT:
+      return Eigen::Vector2d(point_x_[ref.index], point_y_[ref.index]);
+    case LINE:
+      return closest_point_on_line_segment_2d(
+          position,
+          Eigen::Vector2d(line_start_x_[ref.index], line_start_y_[ref.index]),
+          Eigen::Vector2d(line_end_x_[ref.index], line_end_y_[ref.index]));
+    case POLYGON:
+      return polygonClosestPoint(ref.index, position);
+    default:
+      return position;
+    }
+  }
+
+  Eigen::Vector2d polygonClosestPoint(int i,
+                                      const Eigen::Vector2d &position) const;
+
+private:
+  //! Distance between a position and the segment between two polygon vertices
+  double segmentDistance(int start, int end,
+                         const Eigen::Vector2d &position) const {
+    return distance_point_to_segment_2d(
+        position, Eigen::Vector2d(vertex_x_[start], vertex_y_[start]),
+        Eigen::Vector2d(vertex_x_[end], vertex_y_[end]));
+  }
+
+  std::vector<Ref> refs_; //!< Reference of each obstacle of the container
+
+  std::vector<double> point_x_, point_y_;
+  std::vector<double> line_start_x_, line_start_y_, line_end_x_, line_end_y_;
+  std::vector<double> vertex_x_, vertex_y_; //!< Vertices of all polygons
+  std::vector<int> polygon_start_ = {0}; //!< Index of the first vertex of each
+                                         //! polygon, followed by the total
+};
+
+} // namespace teb_local_planner
+
+#endif // OBSTACLE_ARRAYS_H_
@@ -332,6 +332,9 @@ public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+//! Abbrev. for contiguous storage of many point obstacles (e.g. costmap cells)
+typedef std::vector<PointObstacle, Eigen::aligned_allocator<PointObstacle> > PointObstacleStore;
+
 
 
 /**
@@ -45,25 +45,38 @@
 
 #include <math.h>
 
+#include <atomic>
+
+#include <boost/scoped_ptr.hpp>
+
 // teb stuff
+#include <teb_local_planner/distance_field.h>
+#include <teb_local_planner/interaction_filter.h>
 #include <teb_local_planner/misc.h>
 #include <teb_local_planner/planner_interface.h>
+#include <teb_local_planner/pose_grid_index.h>
+#include <teb_local_planner/profiler.h>
 #include <teb_local_planner/robot_footprint_model.h>
 #include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/thread_pool.h>
 #include <teb_local_planner/timed_elastic_band.h>
 #include <teb_local_planner/visualization.h>
 
 // g2o lib stuff
 #include "g2o/core/block_solver.h"
 #include "g2o/core/factory.h"
+#include "g2o/core/hyper_graph_action.h"
 #include "g2o/core/optimization_algorithm_gauss_newton.h"
 #include "g2o/core/optimization_algorithm_levenberg.h"
 #include "g2o/core/sparse_optimizer.h"
 #include "g2o/solvers/cholmod/linear_solver_cholmod.h"
 #include "g2o/solvers/csparse/linear_solver_csparse.h"
+#include "g2o/solvers/eigen/linear_solver_eigen.h"
+#include <teb_local_planner/linear_solvers.h>
 
 // g2o custom edges and vertices for the TEB planner
 #include <teb_local_planner/g2o_types/edge_acceleration.h>
+#include <teb_local_planner/g2o_types/edge_distance_field.h>
 #include <teb_local_planner/g2o_types/edge_dynamic_obstacle.h>
 #include <teb_local_planner/g2o_types/edge_human_human_safety.h>
 #include <teb_local_planner/g2o_types/edge_human_robot_directional.h>
@@ -89,11 +102,9 @@ namespace teb_local_planner {
 //! Typedef for the block solver utilized for optimization
 typedef g2o::BlockSolver<g2o::BlockSolverTraits<-1, -1>> TEBBlockSolver;
 
-//! Typedef for the linear solver utilized for optimization
-// typedef g2o::LinearSolverCSparse<TEBBlockSolver::PoseMatrixType>
-// TEBLinearSolver;
-typedef g2o::LinearSolverCholmod<TEBBlockSolver::PoseMatrixType>
-    TEBLinearSolver;
+//! Typedef for the linear solver utilized for optimization, the backend is
+//! selected at runtime (see TebOptimalPlanner::LinearSolverType)
+typedef TimedLinearSolver<TEBBlockSolver::PoseMatrixType> TEBLinearSolver;
 
 //! Typedef for a container storing via-points
 typedef std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d>>
@@ -113,11 +124,30 @@ typedef std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d>>
  * 	- R. Kümmerle et al.: G2o: A general framework for graph optimization,
  * ICRA, 2011.
  *
- * @todo: Call buildGraph() only if the teb structure has been modified to speed
- * up hot-starting from previous solutions.
+ * With TebConfig::Optimization::persistent_graph enabled, the hyper-graph is
+ * kept between outer iterations and planning cycles and rebuilt only if the
+ * teb structure has been modified (see updateGraph()).
  */
 class TebOptimalPlanner : public PlannerInterface {
 public:
+  //! Reason for which an optimizeTEB() call stopped
+  enum StopReason {
+    STOP_COMPLETED = 0, //!< All outer iterations have been performed
+    STOP_CONVERGED = 1, //!< The cost decrease fell below convergence_threshold
+    STOP_DEADLINE = 2,  //!< The next iteration would exceed the deadline
+    STOP_CANCELLED = 3, //!< Stopped by cancelOptimization()
+    STOP_FAILED = 4     //!< The graph could not be built or optimized
+  };
+
+  //! Sparse linear solver backend, see TebConfig::Optimization::linear_solver
+  enum LinearSolverType {
+    SOLVER_AUTO = 0,    //!< Selected for each graph by selectLinearSolver()
+    SOLVER_CHOLMOD = 1, //!< g2o::LinearSolverCholmod
+    SOLVER_CSPARSE = 2, //!< g2o::LinearSolverCSparse
+    SOLVER_EIGEN = 3,   //!< g2o::LinearSolverEigen (sparse LDLT)
+    SOLVER_BANDED = 4   //!< BandedLinearSolver
+  };
+
   /**
    * @brief Default constructor
    */
@@ -282,7 +312,8 @@ public:
    * The number of outer loop iterations should be determined by considering the
    * maximum CPU time required to match the control rate. \n
    * Optionally, the cost vector can be calculated by specifying \c
-   * compute_cost_afterwards, see computeCurrentCost().
+   * compute_cost_afterwards, see computeCurrentCost(). \n
+   * The outer loop stops early on a request by cancelOptimization().
    * @remarks This method is usually called from a plan() method
    * @param iterations_innerloop Number of iterations for the actual solver loop
    * @param iterations_outerloop Specifies how often the trajectory should be
@@ -369,6 +400,19 @@ public:
    */
   const ObstContainer &getObstVector() const { return *obstacles_; }
 
+  /**
+   * @brief Assign the distance field of the static obstacles
+   *
+   * If obstacles.obstacle_distance_field is enabled and the field is not empty,
+   * each pose gets a single EdgeDistanceField instead of one edge per static
+   * obstacle of the obstacle container.
+   * @param distance_field pointer to a distance field (can also be a nullptr),
+   * must stay valid as long as the planner is used
+   */
+  void setDistanceField(const DistanceField *distance_field) {
+    distance_field_ = distance_field;
+  }
+
   //@}
 
   /** @name Take via-points into account */
@@ -389,6 +433,18 @@ public:
    */
   const ViaPointContainer &getViaPoints() const { return *via_points_; }
 
+  /**
+   * @brief Assign the IDs of the via-points
+   *
+   * With a persistent graph, the edges of via-points whose ID is known from
+   * the previous graph stay attached to their pose, see UpdateEdgesViaPoints().
+   * @param via_point_ids pointer to the ascending IDs of the via-points, in the
+   * order of the via-point container (can also be a nullptr)
+   */
+  virtual void setViaPointIds(const std::vector<uint64_t> *via_point_ids) {
+    via_point_ids_ = via_point_ids;
+  }
+
   //@}
 
   /** @name Visualization */
@@ -473,6 +529,68 @@ public:
    */
   bool isOptimized() const { return optimized_; };
 
+  /**
+   * @brief Request (or revoke the request) to stop a running or upcoming
+   * optimizeTEB() call early.
+   *
+   * The request is checked before each outer iteration and may be issued from
+   * another thread. It stays active until it is revoked.
+   * @param cancel \c true to request the cancellation, \c false to revoke it
+   */
+  void cancelOptimization(bool cancel = true) { cancel_optimization_ = cancel; }
+
+  /**
+   * @brief Check if the last optimizeTEB() call has been stopped by
+   * cancelOptimization().
+   *
+   * The cost is not updated by a cancelled call. If it was cancelled before
+   * the first outer iteration, the trajectory is left untouched.
+   */
+  bool isOptimizationCancelled() const {
+    return stop_reason_ == STOP_CANCELLED;
+  }
+
+  /**
+   * @brief Set the deadline of the following optimizeTEB() calls.
+   *
+   * The solver stops between two iterations, and the outer loop between two
+   * outer iterations, once the next one is not expected to finish before the
+   * deadline. The trajectory is left at the last iterate accepted by the
+   * solver, i.e. the best one so far.
+   * @param deadline wall clock deadline, a zero time disables the deadline
+   */
+  virtual void setDeadline(const ros::WallTime &deadline) {
+    deadline_ = deadline;
+  }
+
+  /**
+   * @brief Wall time spent in the last optimizeTEB() call [s]
+   */
+  double getOptimizationTime() const { return optimization_time_; }
+
+  /**
+   * @brief Time left before the deadline at the beginning of the last
+   * optimizeTEB() call [s] (0 if no deadline has been set)
+   */
+  double getTimeBudget() const { return time_budget_; }
+
+  //! Number of outer iterations performed by the last optimizeTEB() call
+  unsigned int getOuterIterations() const { return outer_iterations_; }
+
+  //! Number of solver iterations performed by the last optimizeTEB() call
+  unsigned int getInnerIterations() const { return inner_iterations_; }
+
+  //! Reason for which the last optimizeTEB() call stopped
+  StopReason getStopReason() const { return stop_reason_; }
+
+  //! Linear solver backend used by the last optimizeTEB() call
+  LinearSolverType getLinearSolver() const { return linear_solver_type_; }
+
+  //! Time spent in the linear solver by the last optimizeTEB() call [s]
+  double getLinearSolverTime() const {
+    return linear_solver_ ? linear_solver_->time() : 0.0;
+  }
+
   /**
    * @brief Compute the cost vector of a given optimization problen (hyper-graph
    * must exist).
@@ -686,13 +804,91 @@ protected:
    */
   bool optimizeGraph(int no_iterations, bool clear_after = true);
 
+  /**
+   * @class SolverDeadline
+   * @brief Post-iteration action that raises the force stop flag of the
+   * solver once another iteration is not expected to finish before the
+   * deadline.
+   *
+   * The expected duration of an iteration is the mean duration of the
+   * iterations since start().
+   */
+  class SolverDeadline : public g2o::HyperGraphAction {
+  public:
+    SolverDeadline() : iterations_(0), stop_(false) {}
+
+    //! Reset the flag and the iteration count before invoking the solver
+    void start(const ros::WallTime &deadline) {
+      deadline_ = deadline;
+      start_ = ros::WallTime::now();
+      iterations_ = 0;
+      stop_ = false;
+    }
+
+    virtual g2o::HyperGraphAction *
+    operator()(const g2o::HyperGraph *graph,
+               g2o::HyperGraphAction::Parameters *parameters = 0) {
+      ++iterations_;
+      if (!deadline_.isZero()) {
+        ros::WallTime now = ros::WallTime::now();
+        if (now + (now - start_) * (1.0 / iterations_) > deadline_)
+          stop_ = true;
+      }
+      return this;
+    }
+
+    //! Flag that is passed to g2o::SparseOptimizer::setForceStopFlag()
+    bool *stopFlag() { return &stop_; }
+    bool stopped() const { return stop_; }
+    unsigned int iterations() const { return iterations_; }
+
+  private:
+    ros::WallTime deadline_, start_;
+    unsigned int iterations_;
+    bool stop_;
+  };
+
   /**
    * @brief Clear an existing internal hyper-graph.
+   *
+   * The edges are detached from their vertices before they are deleted, hence
+   * it is safe to call this method after the TEBs deleted some of the vertices
+   * that are still part of the graph (persistent graph mode).
    * @see buildGraph
    * @see optimizeGraph
    */
   void clearGraph();
 
+  /**
+   * @brief Bring the hyper-graph up to date with the current trajectories,
+   * obstacles and via-points.
+   *
+   * Without persistent graph mode (or in approach mode) the graph is cleared and
+   * built from scratch. Otherwise the existing graph is kept as long as the
+   * vertex structure of all TEBs, the start/goal velocity flags and the
+   * configuration are unchanged. If only the obstacles or the via-points
+   * changed, just the corresponding edges are replaced.
+   * @remarks Obstacle and via-point edges keep their association to the TEB
+   * poses until their inputs change, instead of being re-associated in every
+   * outer iteration. Likewise, time-optimal edges keep the initial time
+   * differences of the last rebuild.
+   * @see buildGraph
+   * @see clearGraph
+   * @return \c true, if the graph is ready for optimization, \c false
+   * otherwise.
+   */
+  bool updateGraph();
+
+  /**
+   * @brief Remove a set of edges from the hyper-graph and delete them.
+   * @param edges edges to remove, the container is cleared afterwards
+   */
+  template <typename EdgeT> void removeEdges(std::vector<EdgeT *> &edges) {
+    for (auto *edge : edges)
+      optimizer_->removeEdge(edge); // also deletes the edge
+    edges.clear();
+  }
+
   /**
    * @brief Add all relevant vertices to the hyper-graph as optimizable
    * variables.
@@ -711,6 +907,17 @@ protected:
    */
   void AddTEBVertices();
 
+  /**
+   * @brief Reserve the edge pools for the edges that scale with the number of
+   * poses of the robot and the humans.
+   *
+   * Called by buildGraph() before adding the edges, such that each pool grows
+   * at most once per cycle.
+   * @see EdgePool
+   * @see buildGraph
+   */
+  void ReserveEdgePools();
+
   /**
    * @brief Add all edges (local cost functions) for limiting the translational
    * and angular velocity.
@@ -747,12 +954,48 @@ protected:
    * @brief Add all edges (local cost functions) related to keeping a distance
    * from static obstacles
    * @see EdgeObstacle
+   * @see EdgeIndexedObstacle
    * @see buildGraph
    * @see optimizeGraph
    */
   void AddEdgesObstacles();
   void AddEdgesObstaclesForHumans();
 
+  /**
+   * @brief Check whether the static obstacles are taken into account through
+   * the distance field
+   */
+  bool useDistanceField() const {
+    return cfg_->obstacles.obstacle_distance_field && distance_field_ &&
+           !distance_field_->empty();
+  }
+
+  /**
+   * @brief Add an EdgeDistanceField to each pose of a trajectory that is not
+   * fixed
+   * @param teb trajectory of the robot or a human
+   * @param circles circle decomposition of the footprint
+   * @see useDistanceField
+   */
+  void AddEdgesDistanceField(TimedElasticBand &teb,
+                             const FootprintCircles *circles);
+
+  /**
+   * @brief Add a single edge keeping a pose away from a static obstacle
+   *
+   * An EdgeIndexedObstacle is used if the footprint is composed of circles and
+   * the obstacle is part of the obstacle arrays, an EdgeObstacle otherwise.
+   * @param pose pose vertex
+   * @param obstacle_idx index of the obstacle in the obstacle container
+   * @param model footprint model of the robot or human
+   * @param circles circles of the footprint, \c NULL if not composed of circles
+   * @param information weight of the edge
+   */
+  void AddEdgeObstacle(VertexPose *pose, std::size_t obstacle_idx,
+                       const BaseRobotFootprintModel *model,
+                       const std::vector<std::pair<double, double>> *circles,
+                       const Eigen::Matrix<double, 1, 1> &information);
+
   /**
    * @brief Add all edges (local cost functions) related to minimizing the
    * distance to via-points
@@ -763,6 +1006,25 @@ protected:
   void AddEdgesViaPoints();
   void AddEdgesViaPointsForHumans();
 
+  /**
+   * @brief Add the edge of the i-th via-point
+   * @param i index of the via-point in the container
+   * @param[in,out] start_pose_idx first pose the via-point may be attached to,
+   * advanced if the via-points are ordered
+   */
+  void AddEdgeViaPoint(std::size_t i, int &start_pose_idx);
+
+  /**
+   * @brief Update the via-point edges of a persistent graph
+   *
+   * Edges of via-points that kept their ID stay attached to their pose and
+   * only refer to the current container, edges of vanished via-points are
+   * removed and new via-points get new edges. Without IDs all edges are
+   * rebuilt.
+   * @see setViaPointIds
+   */
+  void UpdateEdgesViaPoints();
+
   /**
    * @brief Add all edges (local cost functions) related to keeping a distance
    * from dynamic (moving) obstacles.
@@ -793,26 +1055,116 @@ protected:
    */
   void AddEdgesKinematicsCarlike();
 
+  /**
+   * @brief Add the enabled pairwise edges between the robot and the humans
+   * and between the humans for the poses in interactions_.
+   * @see findInteractions
+   */
+  void AddEdgesHumanInteractions();
+
   void AddEdgesHumanRobotSafety();
   void AddEdgesHumanHumanSafety();
   void AddEdgesHumanRobotTTC();
   void AddEdgesHumanRobotDirectional();
 
+  //! Pose pairs of trajectory pairs that get pairwise human edges
+  struct Interactions {
+    Interactions() : culled_directional(0) {}
+
+    std::map<uint64_t, PosePairs> robot_safety; //!< Robot and each human
+    std::map<uint64_t, PosePairs>
+        robot_ttc; //!< Robot and each human (TTC and directional edges)
+    std::map<std::pair<uint64_t, uint64_t>, PosePairs>
+        human_safety; //!< Each pair of humans
+    std::size_t culled_directional; //!< Robot and human segment pairs whose
+                                    //! directional edges have been culled
+
+    bool operator==(const Interactions &other) const {
+      return robot_safety == other.robot_safety &&
+             robot_ttc == other.robot_ttc &&
+             human_safety == other.human_safety &&
+             culled_directional == other.culled_directional;
+    }
+    bool operator!=(const Interactions &other) const {
+      return !(*this == other);
+    }
+  };
+
+  /**
+   * @brief Find the poses of the robot and the humans that can come within
+   * the range of the enabled pairwise edges.
+   *
+   * Robot poses are associated with the human poses at the same time (see
+   * associatePosesByTime()), human poses with each other by index. All
+   * associated poses are returned if the culling is disabled. The number of
+   * culled directional pairs is kept for computeCurrentCost().
+   * @see filterInteractingPoses
+   */
+  void findInteractions(Interactions &interactions) const;
+
   void AddVertexEdgesApproach();
 
   //@}
 
+  /**
+   * @brief Warm start a human trajectory with the new plan or initialize it
+   * (again) if it is empty, the goal moved too far or warm starting is
+   * disabled.
+   *
+   * Only modifies \c human_teb, the trajectories of different humans are
+   * updated in parallel.
+   * @param human_teb trajectory of the human
+   * @param initial_human_plan predicted plan of the human
+   */
+  void updateHumanTEB(
+      TimedElasticBand &human_teb,
+      const std::vector<geometry_msgs::PoseStamped> &initial_human_plan) const;
+
   /**
    * @brief Initialize and configure the g2o sparse optimizer.
    * @return shared pointer to the g2o::SparseOptimizer instance
    */
   boost::shared_ptr<g2o::SparseOptimizer> initOptimizer();
 
+  /**
+   * @brief Create the optimization algorithm with a linear solver backend
+   *
+   * The linear solver is stored in linear_solver_, the algorithm is owned by
+   * the optimizer it is passed to.
+   * @param type backend, not SOLVER_AUTO
+   * @return Levenberg-Marquardt algorithm
+   */
+  g2o::OptimizationAlgorithm *createAlgorithm(LinearSolverType type);
+
+  /**
+   * @brief Backend for the current graph
+   *
+   * Returns TebConfig::Optimization::linear_solver unless it is SOLVER_AUTO.
+   * Otherwise graphs whose edges only connect vertices with close ids (the
+   * robot-only graph) are banded, coupled graphs (e.g. human-robot edges) are
+   * solved with the Eigen LDLT up to linear_solver_auto_vertices free
+   * vertices and with Cholmod beyond.
+   */
+  LinearSolverType selectLinearSolver() const;
+
+  //! Widest vertex id span of the edges of a graph that is solved banded by
+  //! selectLinearSolver() (robot-only edges span up to 4 ids)
+  static constexpr int BANDED_SOLVER_MAX_ID_SPAN = 8;
+
+  /**
+   * @brief Replace the algorithm of the optimizer if the backend changed
+   * @param type backend, not SOLVER_AUTO
+   */
+  void setLinearSolver(LinearSolverType type);
+
   // external objects (store weak pointers)
   const TebConfig
       *cfg_; //!< Config class that stores and manages all related parameters
   ObstContainer *obstacles_; //!< Store obstacles that are relevant for planning
+  const DistanceField
+      *distance_field_; //!< Distance field of the static obstacles
   const ViaPointContainer *via_points_; //!< Store via points for planning
+  const std::vector<uint64_t> *via_point_ids_; //!< IDs of the via-points
   const std::map<uint64_t, ViaPointContainer> *humans_via_points_map_;
 
   double cost_; //!< Store cost value of the current hyper-graph
@@ -821,6 +1173,8 @@ protected:
   TebVisualizationPtr visualization_; //!< Instance of the visualization class
   TimedElasticBand teb_;              //!< Actual trajectory object
   std::map<uint64_t, TimedElasticBand> humans_tebs_map_;
+  boost::scoped_ptr<ThreadPool>
+      human_thread_pool_; //!< Worker threads updating the human trajectories
   geometry_msgs::PoseStamped approach_pose_;
   VertexPose *approach_pose_vertex;
 
@@ -839,9 +1193,117 @@ protected:
                      //!class
   bool optimized_;   //!< This variable is \c true as long as the last
                      //!optimization has been completed successful
+  std::atomic<bool> cancel_optimization_; //!< Cancellation request, see
+                                          //! cancelOptimization()
+  double optimization_time_;    //!< Duration of the last optimizeTEB() call
+  ros::WallTime deadline_;      //!< Deadline, see setDeadline()
+  SolverDeadline solver_deadline_; //!< Stops the solver at the deadline
+  double time_budget_; //!< Time left at the beginning of optimizeTEB()
+  unsigned int outer_iterations_, inner_iterations_; //!< Iterations performed
+                                                     //! by optimizeTEB()
+  StopReason stop_reason_; //!< Why the last optimizeTEB() call stopped
+  LinearSolverType linear_solver_type_; //!< Backend of the optimizer
+  TEBLinearSolver *linear_solver_; //!< Linear solver of the optimizer (owned
+                                   //! by its algorithm)
+  double cost_decrease_; //!< Relative decrease of the cost by the last
+                         //! optimizeGraph() call, if convergence is checked
 
   double human_radius_, robot_radius_;
 
+  Interactions interactions_; //!< Poses of the pairwise human edges
+  ObstacleArrays obstacle_arrays_; //!< Static obstacles for the indexed
+                                   //! obstacle edges
+  std::vector<std::pair<double, double>> robot_circles_,
+      human_circles_; //!< Circles of the footprints (offset, radius)
+  FootprintCircles robot_field_circles_,
+      human_field_circles_; //!< Footprints decomposed for the distance field
+
+  PoseGridIndex robot_pose_grid_; //!< Index of the robot poses for obstacles
+  std::map<uint64_t, PoseGridIndex>
+      human_pose_grids_; //!< Index of the human poses for obstacles
+
+  //! Inputs from which a (part of the) hyper-graph has been built
+  struct GraphSignature {
+    std::vector<unsigned long> ids; //!< Structure revisions and flags
+    std::vector<const void *> addresses; //!< Objects referenced by edges
+    std::vector<double> values;          //!< Values the edges depend on
+
+    bool operator==(const GraphSignature &other) const {
+      return ids == other.ids && addresses == other.addresses &&
+             values == other.values;
+    }
+    bool operator!=(const GraphSignature &other) const {
+      return !(*this == other);
+    }
+    void clear() {
+      ids.clear();
+      addresses.clear();
+      values.clear();
+    }
+  };
+
+  /**
+   * @brief Collect the inputs of the vertex structure, the obstacle edges and
+   * the robot and human via-point edges of the hyper-graph.
+   */
+  void getGraphSignatures(GraphSignature &structure, GraphSignature &obstacles,
+                          GraphSignature &via_points,
+                          GraphSignature &human_via_points) const;
+
+  //! Edges of the hyper-graph sorted by type, filled while building the graph
+  struct GraphEdges {
+    std::vector<EdgeTimeOptimal *> time_optimal;
+    std::vector<EdgeKinematicsDiffDrive *> kinematics_dd;
+    std::vector<EdgeKinematicsCarlike *> kinematics_cl;
+    std::vector<EdgeVelocity *> robot_velocity;
+    std::vector<EdgeVelocityHuman *> human_velocity;
+    std::vector<EdgeAcceleration *> robot_acceleration;
+    std::vector<EdgeAccelerationHuman *> human_acceleration;
+    std::vector<EdgeObstacle *> obstacle;
+    std::vector<EdgeIndexedObstacle *> indexed_obstacle;
+    std::vector<EdgeDistanceField *> distance_field;
+    std::vector<EdgeDynamicObstacle *> dynamic_obstacle;
+    std::vector<EdgeViaPoint *> via_point;
+    std::vector<uint64_t> via_point_id;  //!< Via-point ID of each edge
+    std::vector<int> via_point_pose;     //!< Pose index of each edge
+    std::vector<EdgeViaPoint *> human_via_point;
+    std::vector<EdgeHumanRobotSafety *> human_robot_safety;
+    std::vector<EdgeHumanHumanSafety *> human_human_safety;
+    std::vector<EdgeHumanRobotTTC *> human_robot_ttc;
+    std::vector<EdgeHumanRobotDirectional *> human_robot_directional;
+
+    void clear() {
+      time_optimal.clear();
+      kinematics_dd.clear();
+      kinematics_cl.clear();
+      robot_velocity.clear();
+      human_velocity.clear();
+      robot_acceleration.clear();
+      human_acceleration.clear();
+      obstacle.clear();
+      indexed_obstacle.clear();
+      distance_field.clear();
+      dynamic_obstacle.clear();
+      via_point.clear();
+      via_point_id.clear();
+      via_point_pose.clear();
+      human_via_point.clear();
+      human_robot_safety.clear();
+      human_human_safety.clear();
+      human_robot_ttc.clear();
+      human_robot_directional.clear();
+    }
+  };
+
+  GraphEdges graph_edges_; //!< Typed access to the edges of the hyper-graph
+  GraphSignature graph_structure_;  //!< Inputs of the vertices and edges
+  GraphSignature graph_obstacles_;  //!< Inputs of the obstacle edges
+  GraphSignature graph_via_points_; //!< Inputs of the via-point edges
+  GraphSignature
+      graph_human_via_points_; //!< Inputs of the human via-point edges
+  bool graph_modified_; //!< Graph changed since the last initialization of
+                        //! the optimizer
+
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
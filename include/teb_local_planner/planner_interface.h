@@ -47,6 +47,7 @@
 #include <boost/shared_ptr.hpp>
 
 // ros
+#include <ros/time.h>
 #include <tf/transform_datatypes.h>
 #include <base_local_planner/costmap_model.h>
 
@@ -156,6 +157,26 @@ public:
    */
   virtual bool getVelocityCommand(double &v, double &omega) const = 0;
 
+  /**
+   * @brief Set the deadline of the following plan() calls.
+   *
+   * Planners that support it stop optimizing early to return before the
+   * deadline. The default implementation ignores the deadline.
+   * @param deadline wall clock deadline, a zero time disables the deadline
+   */
+  virtual void setDeadline(const ros::WallTime &deadline) {}
+
+  /**
+   * @brief Assign the IDs of the via-points.
+   *
+   * Via-points with an ID that has been assigned before are the same points
+   * of the reference plan, planners may keep their edges attached then. The
+   * default implementation ignores the IDs.
+   * @param via_point_ids pointer to the ascending IDs of the via-points, in the
+   * order of the via-point container (can also be a nullptr)
+   */
+  virtual void setViaPointIds(const std::vector<uint64_t> *via_point_ids) {}
+
   //@}
 
   /**
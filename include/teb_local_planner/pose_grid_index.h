@@ -0,0 +1,120 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef POSE_GRID_INDEX_H_
+#define POSE_GRID_INDEX_H_
+
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/timed_elastic_band.h>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class PoseGridIndex
+ * @brief Uniform grid over the positions of the poses of a trajectory for
+ * nearest pose queries.
+ *
+ * The index is a snapshot: it has to be rebuilt whenever the poses of the
+ * trajectory have been changed (e.g. once per outer optimization iteration).
+ * Queries return the same pose as
+ * TimedElasticBand::findClosestTrajectoryPose() in expected constant time.
+ */
+class PoseGridIndex {
+public:
+  PoseGridIndex();
+
+  /**
+   * @brief Build the index from the current poses of a trajectory
+   * @param teb trajectory to index
+   */
+  void build(const TimedElasticBand &teb);
+
+  /**
+   * @brief Remove all poses from the index
+   */
+  void clear();
+
+  /**
+   * @brief Check whether the index contains any poses
+   */
+  bool empty() const { return positions_.empty(); }
+
+  /**
+   * @brief Find the closest pose of the indexed trajectory to a point
+   * @param ref_point reference point
+   * @param[out] distance distance to the closest pose (optional)
+   * @return index of the closest pose, -1 if the index is empty
+   */
+  int findClosestPose(const Eigen::Ref<const Eigen::Vector2d> &ref_point,
+                      double *distance = NULL) const;
+
+  /**
+   * @brief Find the closest pose of a trajectory to an obstacle
+   *
+   * Point obstacles are looked up in the index, other obstacle types fall back
+   * to the linear search of TimedElasticBand::findClosestTrajectoryPose().
+   * @param obstacle obstacle
+   * @param teb trajectory this index has been built from
+   * @param[out] distance distance to the closest pose (optional)
+   * @return index of the closest pose
+   */
+  int findClosestPose(const Obstacle &obstacle, const TimedElasticBand &teb,
+                      double *distance = NULL) const;
+
+private:
+  //! Index of the cell that contains a point, clamped to the grid
+  void cellOf(const Eigen::Ref<const Eigen::Vector2d> &point, int &cx,
+              int &cy) const;
+
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d>>
+      positions_;                //!< Positions of the indexed poses
+  std::vector<int> cell_start_;  //!< Offset of each cell into cell_poses_
+  std::vector<int> cell_poses_;  //!< Pose indices sorted by cell
+  Eigen::Vector2d origin_;       //!< Lower left corner of the grid
+  double cell_size_;             //!< Edge length of the square cells
+  int cols_, rows_;              //!< Number of cells along x and y
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace teb_local_planner
+
+#endif // POSE_GRID_INDEX_H_
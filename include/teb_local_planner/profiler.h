@@ -0,0 +1,230 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <boost/thread/mutex.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class Histogram
+ * @brief Thread-safe histogram of durations or counts with logarithmic
+ * buckets (four per power of two, i.e. a relative resolution of 25%).
+ */
+class Histogram {
+public:
+  enum Unit { SECONDS, COUNT };
+
+  //! Statistics of the values added since the last reset
+  struct Summary {
+    std::string name;
+    Unit unit;
+    uint64_t count;
+    double mean, p50, p95, p99, max; //!< In seconds or as counts
+  };
+
+  Histogram(const std::string &name, Unit unit);
+
+  /**
+   * @brief Add a value, in nanoseconds for durations
+   */
+  void add(uint64_t value) {
+    buckets_[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max &&
+           !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+      ;
+  }
+
+  /**
+   * @brief Statistics of the values added since the last reset, the
+   * percentiles refer to the centers of the buckets
+   * @param reset start a new period afterwards
+   */
+  Summary summarize(bool reset);
+
+  const std::string &name() const { return name_; }
+  Unit unit() const { return unit_; }
+
+private:
+  static const int NO_BUCKETS = 256;
+
+  //! Bucket of a value: the values 0-3 have their own, larger values are
+  //! split by their highest bit and the two bits below
+  static int bucket(uint64_t value) {
+    if (value < 4)
+      return static_cast<int>(value);
+    int octave = 63 - __builtin_clzll(value);
+    return 4 * (octave - 1) + static_cast<int>((value >> (octave - 2)) & 3);
+  }
+
+  //! Center of the range of values of a bucket
+  static double bucketCenter(int bucket);
+
+  std::string name_;
+  Unit unit_;
+  std::atomic<uint64_t> buckets_[NO_BUCKETS];
+  std::atomic<uint64_t> count_, sum_, max_;
+};
+
+/**
+ * @class Profiler
+ * @brief Registry of the histograms of the instrumented phases.
+ *
+ * Instrumentation only reads the clock if profiling is enabled, otherwise a
+ * timer costs a relaxed atomic load. Use the TEB_PROFILE_* macros, they look
+ * up the histogram of a call site once.
+ */
+class Profiler {
+public:
+  static Profiler &instance();
+
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+  static void setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Histogram of a phase, created on the first call
+   *
+   * The reference stays valid for the lifetime of the program.
+   */
+  Histogram &histogram(const std::string &name,
+                       Histogram::Unit unit = Histogram::SECONDS);
+
+  /**
+   * @brief Statistics of all histograms with values since the last reset,
+   * sorted by name
+   * @param reset start a new period afterwards
+   */
+  std::vector<Histogram::Summary> summarize(bool reset);
+
+private:
+  Profiler() {}
+
+  static std::atomic<bool> enabled_;
+
+  boost::mutex mutex_; //!< Protects histograms_
+  std::map<std::string, std::unique_ptr<Histogram>> histograms_;
+};
+
+/**
+ * @class ScopedTimer
+ * @brief Adds the time until stop() or the end of the scope to a histogram
+ */
+class ScopedTimer {
+public:
+  /**
+   * @param histogram histogram the duration is added to if profiling is
+   * enabled
+   * @param measure measure the duration even if profiling is disabled, for
+   * the return value of stop()
+   */
+  explicit ScopedTimer(Histogram &histogram, bool measure = false)
+      : histogram_(Profiler::enabled() ? &histogram : NULL),
+        measure_(measure || histogram_), stopped_(false), elapsed_(0.0) {
+    if (measure_)
+      start_ = std::chrono::steady_clock::now();
+  }
+
+  ~ScopedTimer() { stop(); }
+
+  /**
+   * @brief Stop the timer (only the first call has an effect)
+   * @return duration [s], 0 if it has not been measured
+   */
+  double stop() {
+    if (stopped_)
+      return elapsed_;
+    stopped_ = true;
+    if (!measure_)
+      return elapsed_ = 0.0;
+    std::chrono::nanoseconds duration =
+        std::chrono::steady_clock::now() - start_;
+    if (histogram_)
+      histogram_->add(duration.count());
+    return elapsed_ = duration.count() * 1e-9;
+  }
+
+private:
+  Histogram *histogram_;
+  bool measure_, stopped_;
+  double elapsed_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace teb_local_planner
+
+#define TEB_PROFILE_CONCAT_(a, b) a##b
+#define TEB_PROFILE_CONCAT(a, b) TEB_PROFILE_CONCAT_(a, b)
+
+//! Histogram of a phase, looked up once per call site
+#define TEB_PROFILE_HISTOGRAM(name, unit)                                      \
+  ([]() -> teb_local_planner::Histogram & {                                    \
+    static teb_local_planner::Histogram &histogram =                           \
+        teb_local_planner::Profiler::instance().histogram(name, unit);         \
+    return histogram;                                                          \
+  }())
+
+//! Timer of a phase, e.g. ScopedTimer timer(TEB_PROFILE_TIMING("name"))
+#define TEB_PROFILE_TIMING(name)                                               \
+  TEB_PROFILE_HISTOGRAM(name, teb_local_planner::Histogram::SECONDS)
+
+//! Time the rest of the enclosing scope
+#define TEB_PROFILE_SCOPE(name)                                                \
+  teb_local_planner::ScopedTimer TEB_PROFILE_CONCAT(profile_timer_, __LINE__)( \
+      TEB_PROFILE_TIMING(name))
+
+//! Add a count (e.g. of iterations) to the histogram of a phase
+#define TEB_PROFILE_COUNT(name, value)                                         \
+  do {                                                                         \
+    if (teb_local_planner::Profiler::enabled())                                \
+      TEB_PROFILE_HISTOGRAM(name, teb_local_planner::Histogram::COUNT)         \
+          .add(value);                                                         \
+  } while (0)
+
+#endif // PROFILER_H_
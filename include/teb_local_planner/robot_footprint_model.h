@@ -51,6 +51,21 @@
 namespace teb_local_planner
 {
 
+/**
+ * @brief Circle covering a part of a footprint
+ */
+struct FootprintCircle
+{
+  FootprintCircle(double x, double y, double radius) : x(x), y(y), radius(radius) {}
+
+  double x; //!< x-coordinate of the center w.r.t. the robot center (0,0)
+  double y; //!< y-coordinate of the center w.r.t. the robot center (0,0)
+  double radius; //!< radius of the circle
+};
+
+//! Abbrev. for a container storing circles of a footprint
+typedef std::vector<FootprintCircle> FootprintCircles;
+
 /**
  * @class BaseRobotFootprintModel
  * @brief Abstract class that defines the interface for robot footprint/contour models
@@ -104,6 +119,37 @@ public:
 
   virtual double getCircumscribedRadius() const = 0;
 
+  /**
+    * @brief Get the circles the footprint is composed of (if it is)
+    *
+    * Each circle is given by the offset of its center along the robot orientation and its radius.
+    * calculateDistance() equals the minimum over the circles of the distance to the center minus the radius.
+    * @param[out] circles offsets and radii of the circles
+    * @return \c true if the footprint is composed of circles, \c false otherwise
+    */
+  virtual bool getCircles(std::vector<std::pair<double, double> >& circles) const {return false;}
+
+  /**
+    * @brief Cover the footprint by circles
+    *
+    * Footprints composed of circles (see getCircles()) are represented exactly,
+    * otherwise the circumscribed circle is used unless the model provides a finer decomposition.
+    * @param[out] circles circles whose union covers the footprint
+    * @param no_circles number of circles for footprints that are not composed of circles
+    */
+  virtual void getCircleDecomposition(FootprintCircles& circles, int no_circles) const
+  {
+    circles.clear();
+    std::vector<std::pair<double, double> > exact_circles;
+    if (getCircles(exact_circles))
+    {
+      for (std::size_t i=0; i<exact_circles.size(); ++i)
+        circles.push_back(FootprintCircle(exact_circles[i].first, 0, exact_circles[i].second));
+    }
+    else
+      circles.push_back(FootprintCircle(0, 0, getCircumscribedRadius()));
+  }
+
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -153,6 +199,13 @@ public:
     return 0.0;
   }
 
+  // implements getCircles() of the base class
+  virtual bool getCircles(std::vector<std::pair<double, double> >& circles) const
+  {
+    circles.assign(1, std::make_pair(0.0, 0.0));
+    return true;
+  }
+
 };
 
 
@@ -182,6 +235,11 @@ public:
     */
   void setRadius(double radius) {radius_ = radius;}
 
+  /**
+    * @brief Get the radius of the circular robot
+    */
+  double radius() const {return radius_;}
+
   /**
     * @brief Calculate the distance between the robot and an obstacle
     * @param current_pose Current robot pose
@@ -219,6 +277,13 @@ public:
       return radius_;
   }
 
+  // implements getCircles() of the base class
+  virtual bool getCircles(std::vector<std::pair<double, double> >& circles) const
+  {
+    circles.assign(1, std::make_pair(0.0, radius_));
+    return true;
+  }
+
 private:
 
   double radius_;
@@ -258,6 +323,11 @@ public:
   void setParameters(double front_offset, double front_radius, double rear_offset, double rear_radius)
   {front_offset_=front_offset; front_radius_=front_radius; rear_offset_=rear_offset; rear_radius_=rear_radius;}
 
+  double frontOffset() const {return front_offset_;} //!< Get the offset of the front circle
+  double frontRadius() const {return front_radius_;} //!< Get the radius of the front circle
+  double rearOffset() const {return rear_offset_;} //!< Get the offset of the rear circle
+  double rearRadius() const {return rear_radius_;} //!< Get the radius of the rear circle
+
   /**
     * @brief Calculate the distance between the robot and an obstacle
     * @param current_pose Current robot pose
@@ -321,6 +391,15 @@ public:
     return std::max(front_offset_ + front_radius_, rear_offset_ + rear_radius_);
   }
 
+  // implements getCircles() of the base class
+  virtual bool getCircles(std::vector<std::pair<double, double> >& circles) const
+  {
+    circles.clear();
+    circles.push_back(std::make_pair(front_offset_, front_radius_));
+    circles.push_back(std::make_pair(-rear_offset_, rear_radius_));
+    return true;
+  }
+
 private:
 
   double front_offset_;
@@ -387,6 +466,9 @@ public:
     line_end_ = line_end;
   }
 
+  const Eigen::Vector2d& lineStart() const {return line_start_;} //!< Get the start of the line (w.r.t. robot center at (0,0))
+  const Eigen::Vector2d& lineEnd() const {return line_end_;} //!< Get the end of the line (w.r.t. robot center at (0,0))
+
   /**
     * @brief Calculate the distance between the robot and an obstacle
     * @param current_pose Current robot pose
@@ -450,6 +532,23 @@ public:
                     std::hypot(line_end_.x(), line_end_.y()));
   }
 
+  /**
+    * @brief Cover the line by circles centered on equally long pieces of it
+    * @param[out] circles circles whose union covers the line
+    * @param no_circles number of circles
+    */
+  virtual void getCircleDecomposition(FootprintCircles& circles, int no_circles) const
+  {
+    circles.clear();
+    no_circles = std::max(no_circles, 1);
+    Eigen::Vector2d piece = (line_end_ - line_start_) / no_circles;
+    for (int i=0; i<no_circles; ++i)
+    {
+      Eigen::Vector2d center = line_start_ + (i + 0.5) * piece;
+      circles.push_back(FootprintCircle(center.x(), center.y(), 0.5 * piece.norm()));
+    }
+  }
+
 private:
 
   Eigen::Vector2d line_start_;
@@ -489,6 +588,11 @@ public:
    */
   void setVertices(const Point2dContainer& vertices) {vertices_ = vertices;}
 
+  /**
+   * @brief Get the vertices of the contour/footprint
+   */
+  const Point2dContainer& vertices() const {return vertices_;}
+
   /**
     * @brief Calculate the distance between the robot and an obstacle
     * @param current_pose Current robot pose
@@ -564,6 +668,33 @@ public:
     return radius;
   }
 
+  /**
+    * @brief Cover the polygon by circles circumscribing equally long slices of its bounding box along the x-axis
+    * @param[out] circles circles whose union covers the polygon
+    * @param no_circles number of circles
+    */
+  virtual void getCircleDecomposition(FootprintCircles& circles, int no_circles) const
+  {
+    circles.clear();
+    if (vertices_.empty())
+      return;
+    no_circles = std::max(no_circles, 1);
+
+    Eigen::Vector2d min_corner = vertices_.front();
+    Eigen::Vector2d max_corner = vertices_.front();
+    for (std::size_t i=1; i<vertices_.size(); ++i)
+    {
+      min_corner = min_corner.cwiseMin(vertices_[i]);
+      max_corner = max_corner.cwiseMax(vertices_[i]);
+    }
+
+    double slice = (max_corner.x() - min_corner.x()) / no_circles;
+    double center_y = 0.5 * (min_corner.y() + max_corner.y());
+    double radius = std::hypot(0.5 * slice, 0.5 * (max_corner.y() - min_corner.y()));
+    for (int i=0; i<no_circles; ++i)
+      circles.push_back(FootprintCircle(min_corner.x() + (i + 0.5) * slice, center_y, radius));
+  }
+
 private:
 
   Point2dContainer vertices_;
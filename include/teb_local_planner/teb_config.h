@@ -72,6 +72,9 @@ public:
   struct Trajectory {
     double teb_autosize; //!< Enable automatic resizing of the trajectory w.r.t
                          //! to the temporal resolution (recommended)
+    bool teb_autosize_exact_dt; //!< Resample the trajectory uniformly with
+                                //! timediffs close to dt_ref instead of
+                                //! inserting/removing single samples
     double dt_ref; //!< Desired temporal resolution of the trajectory (should be
                    //! in the magniture of the underlying control rate)
     double dt_hysteresis; //!< Hysteresis for automatic resizing depending on
@@ -154,7 +157,19 @@ public:
     bool predict_human_behind_robot;
     double ttc_threshold;
     double dir_cost_threshold;
-    double pose_prediction_reset_time;
+    double pose_prediction_reset_time; //!< Time after which the prediction
+                                       //! is reset (without planner calls)
+                                       //! or ignored (without responses) [s]
+    double prediction_rate; //!< Frequency of the background requests to the
+                            //! prediction server [Hz]
+    bool cull_interactions; //!< Add the pairwise human edges only for poses
+                            //! that can come within their range at maximum
+                            //! velocity (soft limits, hence opt-in)
+    double interaction_margin; //!< Distance each pose may move before the
+                               //! culling is updated [m]
+    int no_update_threads; //!< Number of worker threads initializing and
+                           //! updating the human trajectories (0: number of
+                           //! hardware threads, 1: sequential).
   } human;
 
   //! Goal tolerance related parameters
@@ -183,6 +198,11 @@ public:
                                  //! closest pose on the trajectory to reduce
     //! computational effort, but take a number of
     //! neighbors into account as well
+    bool obstacle_distance_field; //!< Take the costmap into account through
+                                  //! its distance transform (one edge per
+    //! pose) instead of point obstacles
+    int footprint_circles; //!< Number of circles that cover line and polygon
+                           //! footprints in the distance field mode
     std::string costmap_converter_plugin; //!< Define a plugin name of the
                                           //! costmap_converter package (costmap
     //! cells are converted to
@@ -203,6 +223,14 @@ public:
     int no_outer_iterations; //!< Each outerloop iteration automatically resizes
                              //! the trajectory and invokes the internal
     //! optimizer with no_inner_iterations
+    double optimization_time_budget; //!< Wall time available for computing a
+                                     //! velocity command [s], counted from the
+    //! start of the control cycle and capped at the controller period of
+    //! move_base; the optimization stops early to meet it (0: unlimited,
+    //! < 0: the controller period)
+    double convergence_threshold; //!< Stop the outer loop once an outer
+                                  //! iteration decreases the cost by less than
+    //! this fraction (0: disabled)
 
     bool optimization_activate; //!< Activate the optimization
     bool optimization_verbose;  //!< Print verbose information
@@ -269,6 +297,14 @@ public:
     bool disable_warm_start;
     bool disable_rapid_omega_chage;
     double omega_chage_time_seperation;
+    bool persistent_graph; //!< Keep the hyper-graph alive between outer
+                           //! iterations and planning cycles and rebuild only
+                           //! the parts whose structure changed
+    int linear_solver; //!< Sparse linear solver backend (0: auto, 1: Cholmod,
+                       //! 2: CSparse, 3: Eigen LDLT, 4: banded Cholesky)
+    int linear_solver_auto_vertices; //!< Auto-selection: coupled graphs with
+                                     //! less free vertices are solved with
+                                     //! the Eigen LDLT, larger with Cholmod
   } optim;                     //!< Optimization related parameters
 
   struct HomotopyClasses {
@@ -278,6 +314,14 @@ public:
     //! trajectories are optimized at once).
     bool enable_multithreading; //!< Activate multiple threading for planning
                                 //! multiple trajectories in parallel.
+    int no_optimization_threads; //!< Number of worker threads optimizing the
+                                 //! candidates if multithreading is enabled
+                                 //! (0: number of hardware threads).
+    double cancel_cost_ratio; //!< Cancel the optimization of a candidate once
+                              //! another one converged with a cost that is
+    //! lower by this factor than the cost of the
+    //! candidate in the last cycle (<= 1: disabled,
+    //! requires convergence_threshold > 0).
     bool simple_exploration; //!< If true, distinctive trajectories are explored
                              //! using a simple left-right approach (pass each
     //! obstacle on the left or right side) for path
@@ -287,6 +331,9 @@ public:
     int max_number_classes; //!< Specify the maximum number of allowed
                             //! alternative homotopy classes (limits
     //! computational effort)
+    double exploration_time_budget; //!< Wall time available for exploring the
+                                    //! graph for new homotopy classes [s]
+                                    //! (0: unlimited, deterministic).
     double selection_cost_hysteresis; //!< Specify how much trajectory cost must
                                       //! a new candidate have w.r.t. a
     //! previously selected trajectory in order
@@ -304,6 +351,11 @@ public:
     int roadmap_graph_no_samples; //! < Specify the number of samples generated
                                   //! for creating the roadmap graph, if
                                   //! simple_exploration is turend off.
+    bool roadmap_graph_incremental; //!< Keep the samples of the roadmap and
+                                    //! the collision states of the edges
+                                    //! between them across planning
+                                    //! intervals and only revalidate them
+                                    //! against changed obstacles.
     double roadmap_graph_area_width; //!< Random keypoints/waypoints are sampled
                                      //! in a rectangular region between start
     //! and goal. Specify the width of that
@@ -360,6 +412,21 @@ public:
     double approach_angle_tolerance;
   } approach;
 
+  //! Profiling related parameters
+  struct Profiling {
+    bool enable; //!< Collect timing histograms of the planner phases
+    double publish_period; //!< Period of the diagnostics with the histograms
+                           //! [s]
+  } profiling;
+
+  //! Recording of the planner inputs and outputs of each cycle
+  struct Recorder {
+    bool enable;      //!< Append each planning cycle to the ring file
+    std::string file; //!< Ring file, relative to the working directory of
+                      //! the node (the ROS home by default)
+    int size;         //!< Size of the ring file [MB]
+  } recorder;
+
   /**
    * @brief Construct the TebConfig using default values.
    * @warning If the \b rosparam server or/and \b dynamic_reconfigure
@@ -392,6 +459,7 @@ public:
     // Trajectory
 
     trajectory.teb_autosize = true;
+    trajectory.teb_autosize_exact_dt = false;
     trajectory.dt_ref = 0.3;
     trajectory.dt_hysteresis = 0.1;
     trajectory.min_samples = 3;
@@ -435,6 +503,10 @@ public:
     human.predict_human_behind_robot = false;
     human.ttc_threshold = 5.0;
     human.pose_prediction_reset_time = 2.0;
+    human.prediction_rate = 10.0;
+    human.cull_interactions = false;
+    human.interaction_margin = 0.5;
+    human.no_update_threads = 0;
 
     // GoalTolerance
 
@@ -450,6 +522,8 @@ public:
     obstacles.include_costmap_obstacles = true;
     obstacles.costmap_obstacles_behind_robot_dist = 0.5;
     obstacles.obstacle_poses_affected = 25;
+    obstacles.obstacle_distance_field = false;
+    obstacles.footprint_circles = 3;
     obstacles.costmap_converter_plugin = "";
     obstacles.costmap_converter_spin_thread = true;
     obstacles.costmap_converter_rate = 5;
@@ -458,6 +532,8 @@ public:
 
     optim.no_inner_iterations = 5;
     optim.no_outer_iterations = 4;
+    optim.optimization_time_budget = -1.0;
+    optim.convergence_threshold = 0.0;
     optim.optimization_activate = true;
     optim.optimization_verbose = false;
     optim.penalty_epsilon = 0.1;
@@ -495,13 +571,19 @@ public:
     optim.disable_warm_start = false;
     optim.disable_rapid_omega_chage = true;
     optim.omega_chage_time_seperation = 1.0;
+    optim.persistent_graph = false;
+    optim.linear_solver = 1;
+    optim.linear_solver_auto_vertices = 300;
 
     // Homotopy Class Planner
 
     hcp.enable_homotopy_class_planning = true;
     hcp.enable_multithreading = true;
+    hcp.no_optimization_threads = 0;
+    hcp.cancel_cost_ratio = 0.0;
     hcp.simple_exploration = false;
     hcp.max_number_classes = 5;
+    hcp.exploration_time_budget = 0;
     hcp.selection_cost_hysteresis = 1.0;
     hcp.selection_obst_cost_scale = 100.0;
     hcp.selection_viapoint_cost_scale = 1.0;
@@ -510,6 +592,7 @@ public:
     hcp.obstacle_keypoint_offset = 0.1;
     hcp.obstacle_heading_threshold = 0.45;
     hcp.roadmap_graph_no_samples = 15;
+    hcp.roadmap_graph_incremental = false;
     hcp.roadmap_graph_area_width = 6; // [m]
     hcp.h_signature_prescaler = 1;
     hcp.h_signature_threshold = 0.1;
@@ -535,6 +618,15 @@ public:
     approach.approach_angle = 3.14;
     approach.approach_dist_tolerance = 0.2;
     approach.approach_angle_tolerance = 0.3;
+
+    // profiling
+    profiling.enable = false;
+    profiling.publish_period = 5.0;
+
+    // recorder
+    recorder.enable = false;
+    recorder.file = "teb_local_planner_cycles.ring";
+    recorder.size = 64;
   }
 
   /**
@@ -576,8 +668,15 @@ public:
    */
   boost::mutex &configMutex() { return config_mutex_; }
 
+  /**
+   * @brief Return a counter that is incremented whenever parameters are
+   * (re)loaded, e.g. to invalidate data derived from the configuration
+   */
+  unsigned int revision() const { return revision_; }
+
 private:
   boost::mutex config_mutex_; //!< Mutex for config accesses and changes
+  unsigned int revision_ = 0; //!< Incremented on every parameter update
 };
 
 } // namespace teb_local_planner
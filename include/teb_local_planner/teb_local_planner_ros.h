@@ -54,6 +54,10 @@
 // timed-elastic-band related classes
 #include <teb_local_planner/optimal_planner.h>
 #include <teb_local_planner/homotopy_class_planner.h>
+#include <teb_local_planner/cycle_recorder.h>
+#include <teb_local_planner/global_plan_window.h>
+#include <teb_local_planner/profiler.h>
+#include <teb_local_planner/via_point_generator.h>
 #include <teb_local_planner/visualization.h>
 
 // message types
@@ -62,12 +66,14 @@
 #include <geometry_msgs/PoseStamped.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <visualization_msgs/Marker.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <teb_local_planner/ObstacleMsg.h>
 #include <teb_local_planner/Optimize.h>
 #include <teb_local_planner/Approach.h>
 
 // human data
 #include <hanp_prediction/HumanPosePredict.h>
+#include <teb_local_planner/human_prediction_client.h>
 #include <std_srvs/SetBool.h>
 #include <std_srvs/Empty.h>
 
@@ -236,14 +242,20 @@ protected:
   /**
    * @brief Update internal via-point container based on the current reference
    * plan
-   * @remarks All previous via-points will be cleared.
+   *
+   * The via-points are selected by the arc length of the plan, see
+   * ViaPointGenerator. If the transformed plan is a slice of \c plan, the
+   * selection of the previous call is updated and via-points keep their IDs.
    * @param transformed_plan (local) portion of the global plan (which is
    * already transformed to the planning frame)
+   * @param plan plan the transformed plan has been taken from, NULL if it has
+   * been modified since
+   * @param first index of the first pose of the transformed plan in \c plan
    * @param min_separation minimum separation between two consecutive via-points
    */
   void updateViaPointsContainer(
       const std::vector<geometry_msgs::PoseStamped> &transformed_plan,
-      double min_separation);
+      const GlobalPlanWindow *plan, std::size_t first, double min_separation);
 
   void updateHumanViaPointsContainers(
       const HumanPlanVelMap &transformed_human_plan_vel_map,
@@ -274,23 +286,26 @@ protected:
    * taking the most recent tf transform.
    * If no valid transformation can be found, the method returns \c false.
    * The global plan is pruned until the distance to the robot is at least \c
-   * dist_behind_robot.
+   * dist_behind_robot, by advancing its cursor.
    * If no pose within the specified treshold \c dist_behind_robot can be found,
    * nothing will be pruned and the method returns \c false.
    * @remarks Do not choose \c dist_behind_robot too small (not smaller the
    * cellsize of the map), otherwise nothing will be pruned.
    * @param tf A reference to a transform listener
    * @param global_pose The global pose of the robot
-   * @param[in,out] global_plan The plan to be transformed
+   * @param[in,out] global_plan The plan to be pruned
    * @param dist_behind_robot Distance behind the robot that should be kept
    * [meters]
+   * @param max_search_length Poses farther along the plan from the last
+   * pruned one are not searched [meters] (<= 0: unlimited)
    * @return \c true if the plan is pruned, \c false in case of a transform
    * exception or if no pose cannot be found inside the threshold
    */
   bool pruneGlobalPlan(const tf::TransformListener &tf,
                        const tf::Stamped<tf::Pose> &global_pose,
-                       std::vector<geometry_msgs::PoseStamped> &global_plan,
-                       double dist_behind_robot = 1);
+                       GlobalPlanWindow &global_plan,
+                       double dist_behind_robot = 1,
+                       double max_search_length = 0);
 
   /**
     * @brief  Transforms the global plan of the robot from the planner frame to
@@ -300,6 +315,7 @@ protected:
    * base_local_planner/goal_functions.h
     * such that the index of the current goal pose is returned as well as
     * the transformation between the global plan and the planning frame.
+    * Only the poses from the cursor of the plan on are considered.
     * @param tf A reference to a transform listener
     * @param global_plan The plan to be transformed
     * @param global_pose The global pose of the robot
@@ -309,22 +325,26 @@ protected:
     * @param max_plan_length Specify maximum length (cumulative Euclidean
    * distances) of the transformed plan [if <=0: disabled; the length is also
    * bounded by the local costmap size!]
-    * @param[out] transformed_plan Populated with the transformed plan
+    * @param[out] transformed_plan Populated with the transformed plan (its
+   * poses are overwritten in place)
     * @param[out] current_goal_idx Index of the current (local) goal pose in the
    * global plan
     * @param[out] tf_plan_to_global Transformation between the global plan and
    * the global planning frame
+    * @param[out] first_idx Index of the first transformed pose in the global
+   * plan
     * @return \c true if the global plan is transformed, \c false otherwise
     */
   bool transformGlobalPlan(
       const tf::TransformListener &tf,
-      const std::vector<geometry_msgs::PoseStamped> &global_plan,
+      const GlobalPlanWindow &global_plan,
       const tf::Stamped<tf::Pose> &global_pose,
       const costmap_2d::Costmap2D &costmap, const std::string &global_frame,
       double max_plan_length,
       std::vector<geometry_msgs::PoseStamped> &transformed_plan,
       int *current_goal_idx = NULL,
-      tf::StampedTransform *tf_plan_to_global = NULL) const;
+      tf::StampedTransform *tf_plan_to_global = NULL,
+      std::size_t *first_idx = NULL) const;
 
   /**
     * @brief  Transforms the human plan from the tracker frame to the local
@@ -348,6 +368,49 @@ protected:
       HumanPlanCombined &transformed_human_plan_combined,
       geometry_msgs::TwistStamped &transformed_human_twist,
       tf::StampedTransform *tf_human_plan_to_global = NULL) const;
+
+  /**
+   * @brief Transforms the predicted plans of all humans to the local frame
+   *
+   * The transformation (and twist) from each source frame is looked up only
+   * once for all plans and the poses are transformed directly into the parts
+   * of the split plans. Plans that cannot be transformed are skipped.
+   * @param tf A reference to a transform listener
+   * @param robot_pose The global pose of the robot
+   * @param costmap A reference to the costmap being used so the window size
+   * for transforming can be computed
+   * @param global_frame The frame to transform the plans to
+   * @param[in,out] predicted_humans Predicted plans, the start velocities are
+   * transformed in place
+   * @param[out] transformed_human_plans Transformed plans
+   * @param[out] transformed_human_plan_vel_map Transformed plans to optimize
+   * with their velocities, by human id
+   */
+  void transformHumanPlans(
+      const tf::TransformListener &tf, const tf::Stamped<tf::Pose> &robot_pose,
+      const costmap_2d::Costmap2D &costmap, const std::string &global_frame,
+      std::vector<hanp_prediction::PredictedPoses> &predicted_humans,
+      std::vector<HumanPlanCombined> &transformed_human_plans,
+      HumanPlanVelMap &transformed_human_plan_vel_map);
+
+  /**
+   * @brief Transforms a human plan with a known transformation and splits it
+   * into the parts before, within and after the local costmap window
+   * @param plan_to_global Transformation from the plan frame to global_frame
+   * @param robot_pose The global pose of the robot
+   * @param costmap A reference to the costmap being used so the window size
+   * for transforming can be computed
+   * @param global_frame The frame to transform the plan to
+   * @param human_plan The plan to be transformed
+   * @param[out] transformed_human_plan_combined Populated with the split plan
+   */
+  void transformHumanPlanPoses(
+      const tf::StampedTransform &plan_to_global,
+      const tf::Stamped<tf::Pose> &robot_pose,
+      const costmap_2d::Costmap2D &costmap, const std::string &global_frame,
+      const std::vector<geometry_msgs::PoseWithCovarianceStamped> &human_plan,
+      HumanPlanCombined &transformed_human_plan_combined) const;
+
   bool
   transformHumanPose(const tf::TransformListener &tf,
                      const std::string &global_frame,
@@ -376,7 +439,7 @@ protected:
     * @return orientation (yaw-angle) estimate
     */
   double estimateLocalGoalOrientation(
-      const std::vector<geometry_msgs::PoseStamped> &global_plan,
+      const GlobalPlanWindow &global_plan,
       const tf::Stamped<tf::Pose> &local_goal, int current_goal_idx,
       const tf::StampedTransform &tf_plan_to_global,
       int moving_average_length = 3) const;
@@ -446,9 +509,21 @@ private:
       planner_; //!< Instance of the underlying optimal planner class
   ObstContainer obstacles_;      //!< Obstacle vector that should be considered
                                  //!during local trajectory optimization
+  boost::shared_ptr<PointObstacleStore>
+      costmap_obstacles_; //!< Storage of the obstacles of lethal costmap
+                          //! cells, referenced by obstacles_
+  DistanceField distance_field_; //!< Distance transform of the costmap
+                                 //! (obstacle_distance_field mode)
+  std::vector<unsigned char>
+      distance_field_grid_; //!< Costmap without the lethal cells far behind
+                            //! the robot, input of distance_field_
   ViaPointContainer via_points_; //!< Container of via-points that should be
                                  //!considered during local trajectory
                                  //!optimization
+  std::vector<uint64_t> via_point_ids_; //!< IDs of the via-points
+  ViaPointGenerator via_point_generator_; //!< Selection of the via-points
+  std::vector<double> via_point_arc_length_; //!< Arc length of a plan that is
+                                             //! not a slice of a window
   std::map<uint64_t, ViaPointContainer> humans_via_points_map_;
   TebVisualizationPtr visualization_; //!< Instance of the visualization class
                                       //!(local/global plan, obstacles, ...)
@@ -456,8 +531,10 @@ private:
   TebConfig
       cfg_; //!< Config class that stores and manages all related parameters
 
+  GlobalPlanWindow global_plan_; //!< Store the current global plan
   std::vector<geometry_msgs::PoseStamped>
-      global_plan_; //!< Store the current global plan
+      transformed_plan_; //!< Transformed slice of the global plan, reused
+                         //! between planning intervals
 
   base_local_planner::OdometryHelperRos odom_helper_; //!< Provides an interface
                                                       //!to receive the current
@@ -503,9 +580,8 @@ private:
   bool initialized_; //!< Keeps track about the correct initialization of this
                      //!class
 
-  // human perdiction service
-  ros::ServiceClient predict_humans_client_, reset_humans_prediction_client_,
-      publish_predicted_markers_client_;
+  // human prediction, requested in the background
+  HumanPredictionClient prediction_client_;
 
   // optimize service
   ros::ServiceServer optimize_server_, approach_server_;
@@ -517,13 +593,49 @@ private:
   bool publish_predicted_human_markers_ = true;
 
   void resetHumansPrediction();
+
+  /**
+   * @brief Request a human prediction and get the latest one, extrapolated to
+   * the current time
+   * @param request request for the prediction server
+   * @param[out] predicted_humans predicted plans of the humans
+   * @return \c false if no prediction has been received for the request or
+   * if it is older than pose_prediction_reset_time
+   */
+  bool getHumansPrediction(
+      const hanp_prediction::HumanPosePredict::Request &request,
+      HumanPredictionClient::Predictions &predicted_humans);
+  double prediction_age_ = -1.0; //!< Age of the human prediction used in the
+                                 //! last cycle [s] (-1: none)
   ros::Time last_call_time_;
+  double controller_period_ = 0.0; //!< Period of the control loop of
+                                   //! move_base [s] (0: unknown)
 
   ros::Time last_omega_sign_change_;
   double last_omega_;
 
   ros::Publisher op_costs_pub_;
 
+  /**
+   * @brief Publish the timing histograms of the last period as diagnostics
+   * (if profiling is enabled and the period elapsed) and start a new period
+   */
+  void publishProfiling();
+  ros::Publisher profiling_pub_;
+  ros::WallTime last_profiling_publish_;
+
+  /**
+   * @brief Open, reopen or close the ring file of the recorder as configured
+   * and record the configuration whenever it changes (call with the config
+   * mutex locked)
+   */
+  void updateCycleRecorder();
+  CycleRecorder cycle_recorder_;
+  RobotFootprintModelPtr robot_model_; //!< Footprint model of the planner
+  std::string recorder_file_; //!< Ring file the recorder has been opened with
+  int recorder_size_;         //!< Ring size the recorder has been opened with
+  unsigned int recorded_config_revision_;
+
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
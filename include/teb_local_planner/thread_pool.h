@@ -0,0 +1,108 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <exception>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class ThreadPool
+ * @brief Persistent worker threads that process batches of independent tasks.
+ *
+ * The workers are started once and wait for the next batch afterwards, instead
+ * of creating a thread per task and planning cycle. The tasks of a batch are
+ * taken by the idle workers in the order of the batch, hence a worker that
+ * finished a short task immediately continues with the next pending one.
+ */
+class ThreadPool {
+public:
+  typedef boost::function<void()> Task;
+
+  /**
+   * @brief Start the workers
+   * @param no_threads number of worker threads (at least one is started)
+   */
+  explicit ThreadPool(unsigned int no_threads);
+
+  /**
+   * @brief Stop and join the workers
+   */
+  ~ThreadPool();
+
+  /**
+   * @brief Process a batch of tasks and block until all of them are done
+   *
+   * Batches must not be submitted concurrently from different threads. A task
+   * that throws counts as done, the remaining tasks are still processed and
+   * the first exception is rethrown once the batch is done.
+   * @param tasks tasks of the batch, processed in the given order
+   */
+  void run(const std::vector<Task> &tasks);
+
+  //! Number of worker threads
+  unsigned int size() const { return no_threads_; }
+
+private:
+  //! Main loop of the workers
+  void work();
+
+  boost::thread_group threads_;
+  unsigned int no_threads_;
+
+  boost::mutex mutex_; //!< Protects the members below
+  boost::condition_variable work_available_; //!< Notified on a new batch or
+                                             //! on stop
+  boost::condition_variable batch_done_; //!< Notified when the last task of
+                                         //! the batch finished
+  const std::vector<Task> *tasks_;       //!< Current batch (or NULL)
+  std::size_t next_task_;                //!< Index of the next pending task
+  unsigned int no_running_;              //!< Tasks currently being processed
+  std::exception_ptr error_;             //!< First exception thrown by a
+                                         //! task of the batch
+  bool stop_;
+};
+
+} // namespace teb_local_planner
+
+#endif // THREAD_POOL_H_
@@ -50,6 +50,7 @@
 #include <iterator>
 
 #include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/vertex_pool.h>
 
 // G2O Types
 #include <teb_local_planner/g2o_types/vertex_pose.h>
@@ -59,7 +60,7 @@
 namespace teb_local_planner
 {
 
-//! Container of poses that represent the spatial part of the trajectory
+//! Container of poses that represent the spatial part of the trajectory (the vertices are owned by the trajectory)
 typedef std::vector<VertexPose*> PoseSequence;
 //! Container of time differences that define the temporal of the trajectory
 typedef std::vector<VertexTimeDiff*> TimeDiffSequence;
@@ -79,7 +80,9 @@ typedef std::vector<VertexTimeDiff*> TimeDiffSequence;
  * The tuple of both sequences defines the underlying trajectory.
  *
  * Poses and time differences are wrapped into a g2o::Vertex class in order to enable the efficient optimization in TebOptimalPlanner. \n
- * TebOptimalPlanner utilizes this Timed_Elastic_band class for representing an optimizable trajectory.
+ * TebOptimalPlanner utilizes this Timed_Elastic_band class for representing an optimizable trajectory. \n
+ * The vertices are stored in pools owned by the trajectory (see VertexPool): their addresses remain valid until they are deleted,
+ * and inserting or deleting states only moves pointers and reuses the slots of deleted vertices instead of allocating.
  *
  * @todo Move decision if the start or goal state should be marked as fixed or unfixed for the optimization to the TebOptimalPlanner class.
  */
@@ -468,11 +471,17 @@ public:
    *    - removes a sample if \f$ \Delta T_i < \Delta T_{ref} - \Delta T_{hyst} \f$
    *
    * Each call only one new sample (pose-dt-pair) is inserted or removed.
+   * The new sequences are built in a single pass and the vertices are taken from (and returned to) the vertex pools,
+   * hence the effort is linear in the number of samples, regardless of how many of them are inserted or removed.
+   *
+   * If \c exact_dt is \c true and any timediff violates the hysteresis, the trajectory is resampled uniformly in time instead:
+   * the total transition time is kept and divided into the number of intervals that is closest to \c dt_ref.
    * @param dt_ref reference temporal resolution
    * @param dt_hysteresis hysteresis to avoid oscillations
 	 * @param min_samples minimum number of samples that should be remain in the trajectory after resizing
+   * @param exact_dt resample uniformly instead of inserting and removing single samples
    */
-  void autoResize(double dt_ref, double dt_hysteresis, int min_samples = 3);
+  void autoResize(double dt_ref, double dt_hysteresis, int min_samples = 3, bool exact_dt = false);
 
 
   /**
@@ -577,6 +586,16 @@ public:
    */
   bool isInit() const {return !timediff_vec_.empty() && !pose_vec_.empty();}
 
+  /**
+   * @brief Get an identifier of the current vertex structure of the trajectory
+   *
+   * The revision changes whenever pose or timediff vertices are added, inserted, deleted or (un)fixed.
+   * Revisions are unique among all TimedElasticBand instances, hence two equal revisions refer to the same,
+   * unmodified vertex sequence. Changing only the values of poses and timediffs does not touch the revision.
+   * @return structure revision of the trajectory
+   */
+  unsigned long structureRevision() const {return structure_revision_;}
+
   /**
    * @brief Calculate the total transition time (sum over all time intervals of the timediff sequence)
    */
@@ -607,8 +626,31 @@ public:
   //@}
 
 protected:
+  /**
+   * @brief Assign a new structure revision after the vertex sequences have been modified
+   * @see structureRevision
+   */
+  void markStructureModified();
+
+  /**
+   * @brief Resample the trajectory with equal timediffs close to \c dt_ref, keeping the total transition time
+   *
+   * Start and goal vertices are kept, intermediate poses are interpolated linearly at the new sample times.
+   * @see autoResize
+   */
+  void resampleUniformly(double dt_ref, int min_samples);
+
+  VertexPool<VertexPose> pose_pool_; //!< Storage of the pose vertices
+  VertexPool<VertexTimeDiff> timediff_pool_; //!< Storage of the timediff vertices
   PoseSequence pose_vec_; //!< Internal container storing the sequence of optimzable pose vertices
   TimeDiffSequence timediff_vec_;  //!< Internal container storing the sequence of optimzable timediff vertices
+  unsigned long structure_revision_; //!< Identifier of the current vertex structure (see structureRevision())
+
+  // buffers of autoResize(), kept to avoid allocations
+  PoseSequence resize_poses_;
+  TimeDiffSequence resize_timediffs_;
+  std::vector<PoseSE2, Eigen::aligned_allocator<PoseSE2> > resample_poses_;
+  std::vector<double> resample_times_;
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -0,0 +1,121 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef VERTEX_POOL_H_
+#define VERTEX_POOL_H_
+
+#include <Eigen/Core>
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class VertexPool
+ * @brief Storage of vertices in chunks of contiguous, aligned memory with a
+ * free list.
+ *
+ * Vertices never move, so pointers to them stay valid until they are
+ * destroyed. Destroyed slots are reused by the next vertices, hence a
+ * trajectory that is resized every planning interval stops allocating once
+ * its pool is large enough. Slots of a new chunk are handed out in ascending
+ * order, so vertices created one after another are adjacent in memory.
+ */
+template <typename VertexT, std::size_t ChunkSize = 64> class VertexPool {
+public:
+  VertexPool() : live_(0) {}
+
+  //! All vertices must have been destroyed before
+  ~VertexPool() {
+    assert(live_ == 0);
+    for (VertexT *chunk : chunks_)
+      allocator_.deallocate(chunk, ChunkSize);
+  }
+
+  VertexPool(const VertexPool &) = delete;
+  VertexPool &operator=(const VertexPool &) = delete;
+
+  /**
+   * @brief Construct a vertex in a free slot
+   * @param args arguments of the constructor of the vertex
+   */
+  template <typename... Args> VertexT *create(Args &&... args) {
+    if (free_.empty())
+      addChunk();
+    VertexT *vertex = free_.back();
+    free_.pop_back();
+    new (vertex) VertexT(std::forward<Args>(args)...);
+    ++live_;
+    return vertex;
+  }
+
+  /**
+   * @brief Destruct a vertex created by this pool, its slot is reused by the
+   * next create()
+   */
+  void destroy(VertexT *vertex) {
+    vertex->~VertexT();
+    free_.push_back(vertex);
+    --live_;
+  }
+
+  //! Number of vertices that have not been destroyed
+  std::size_t size() const { return live_; }
+
+  //! Number of slots of all chunks
+  std::size_t capacity() const { return chunks_.size() * ChunkSize; }
+
+private:
+  void addChunk() {
+    VertexT *chunk = allocator_.allocate(ChunkSize);
+    chunks_.push_back(chunk);
+    // free_ is used as a stack, push in reverse to hand out ascending slots
+    for (std::size_t i = ChunkSize; i > 0; --i)
+      free_.push_back(chunk + i - 1);
+  }
+
+  Eigen::aligned_allocator<VertexT> allocator_;
+  std::vector<VertexT *> chunks_; //!< Raw memory of ChunkSize slots each
+  std::vector<VertexT *> free_;   //!< Unconstructed slots
+  std::size_t live_;
+};
+
+} // namespace teb_local_planner
+
+#endif // VERTEX_POOL_H_
@@ -0,0 +1,106 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef VIA_POINT_GENERATOR_H_
+#define VIA_POINT_GENERATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace teb_local_planner {
+
+/**
+ * @class ViaPointGenerator
+ * @brief Selection of via-points on a plan by arc length, cached across
+ * planning intervals.
+ *
+ * A pose of the plan is a via-point if it is the first one whose distance
+ * along the plan from the previous via-point (or from the first pose of the
+ * slice) reaches the minimum separation. The via-points of a slice [first,end)
+ * of an unchanged plan are updated by evicting the ones that fell behind and
+ * scanning the poses added at the end of the slice from the last via-point.
+ * Each via-point keeps its ID as long as it is selected, the IDs are
+ * ascending along the plan.
+ */
+class ViaPointGenerator {
+public:
+  ViaPointGenerator();
+
+  /**
+   * @brief Remove all via-points, the next update() starts from scratch
+   */
+  void clear();
+
+  /**
+   * @brief Update the via-points for a slice of a plan
+   *
+   * Via-points closer than \c min_separation to the first pose of the slice
+   * (along the plan) are skipped. The cache is reset if the key or the
+   * separation changed or if the slice moved backwards.
+   * @param key identity of the plan, must change whenever the plan changes
+   * @param arc_length cumulative arc length of each pose of the plan [m]
+   * @param first index of the first pose of the slice
+   * @param end index behind the last pose of the slice
+   * @param min_separation minimum separation between two consecutive
+   * via-points [m] (0: every pose, < 0: no via-points)
+   */
+  void update(uint64_t key, const std::vector<double> &arc_length,
+              std::size_t first, std::size_t end, double min_separation);
+
+  //! Number of via-points
+  std::size_t size() const { return indices_.size(); }
+
+  //! Index of the pose of the i-th via-point in the plan
+  std::size_t index(std::size_t i) const { return indices_[i]; }
+
+  //! ID of the i-th via-point
+  uint64_t id(std::size_t i) const { return ids_[i]; }
+
+private:
+  std::deque<std::size_t> indices_;
+  std::deque<uint64_t> ids_;
+  uint64_t key_;
+  double min_separation_;
+  std::size_t first_;   //!< First pose of the slice of the last update
+  std::size_t scanned_; //!< Poses before this index have been scanned
+  bool valid_;          //!< Cache refers to key_ and min_separation_
+  uint64_t next_id_;
+};
+
+} // namespace teb_local_planner
+
+#endif // VIA_POINT_GENERATOR_H_
@@ -124,9 +124,11 @@ public:
   /**
    * @brief Publish a given global plan to the ros topic \e ../../global_plan
    * @param global_plan Pose array describing the global plan
+   * @param first index of the first pose to publish
    */
   void publishGlobalPlan(
-      const std::vector<geometry_msgs::PoseStamped> &global_plan) const;
+      const std::vector<geometry_msgs::PoseStamped> &global_plan,
+      std::size_t first = 0) const;
 
   /**
    * @brief Publish a given local plan to the ros topic \e ../../local_plan
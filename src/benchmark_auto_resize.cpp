@@ -0,0 +1,170 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Compares TimedElasticBand::autoResize with the previous algorithm, which
+// inserted and deleted one sample at a time in the middle of the sequences
+// (replayed on plain arrays of poses and time differences, i.e. without its
+// vertex allocations), for trajectories that are stretched (e.g. after a
+// reinitialization), contracted or only slightly off the reference
+// resolution. The exact_dt column resamples the trajectory uniformly.
+// Runs without a ROS master: benchmark_auto_resize [no_runs]
+
+#include <teb_local_planner/timed_elastic_band.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace teb_local_planner;
+
+#define DT_REF 0.3
+#define DT_HYSTERESIS 0.03
+#define MIN_SAMPLES 3
+
+namespace {
+typedef std::vector<PoseSE2, Eigen::aligned_allocator<PoseSE2>> PoseVector;
+
+double elapsedMs(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// previous implementation of TimedElasticBand::autoResize on plain sequences
+void autoResizeSequential(PoseVector &poses, std::vector<double> &dts) {
+  for (unsigned int i = 0; i < dts.size(); ++i) {
+    if (dts[i] > DT_REF + DT_HYSTERESIS) {
+      double newtime = 0.5 * dts[i];
+      dts[i] = newtime;
+      poses.insert(poses.begin() + i + 1,
+                   PoseSE2::average(poses[i], poses[i + 1]));
+      dts.insert(dts.begin() + i + 1, newtime);
+      ++i;
+    } else if (dts[i] < DT_REF - DT_HYSTERESIS &&
+               (int)dts.size() > MIN_SAMPLES) {
+      if (i < dts.size() - 1) {
+        dts[i + 1] = dts[i + 1] + dts[i];
+        dts.erase(dts.begin() + i);
+        poses.erase(poses.begin() + i + 1);
+      }
+    }
+  }
+}
+
+void fill(TimedElasticBand &teb, const PoseVector &poses,
+          const std::vector<double> &dts) {
+  teb.clearTimedElasticBand();
+  teb.addPose(poses[0], true);
+  for (std::size_t i = 0; i < dts.size(); ++i)
+    teb.addPoseAndTimeDiff(poses[i + 1], dts[i]);
+  teb.setPoseVertexFixed(dts.size(), true);
+}
+
+bool equal(const TimedElasticBand &teb, const PoseVector &poses,
+           const std::vector<double> &dts) {
+  if (teb.sizePoses() != poses.size() || teb.sizeTimeDiffs() != dts.size())
+    return false;
+  for (std::size_t i = 0; i < dts.size(); ++i)
+    if (std::abs(teb.TimeDiff(i) - dts[i]) > 1e-9)
+      return false;
+  for (std::size_t i = 0; i < poses.size(); ++i)
+    if ((teb.Pose(i).position() - poses[i].position()).norm() > 1e-9)
+      return false;
+  return true;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  int no_runs = argc > 1 ? std::atoi(argv[1]) : 200;
+  if (no_runs < 1)
+    no_runs = 1;
+
+  std::mt19937 generator(42);
+  const char *scenarios[] = {"stretched", "contracted", "jitter"};
+  const double dt_min[] = {2.0 * DT_REF, 0.2 * DT_REF, DT_REF - 0.05};
+  const double dt_max[] = {3.0 * DT_REF, 0.5 * DT_REF, DT_REF + 0.05};
+
+  std::printf("mean of %d runs, dt_ref %.2f, dt_hysteresis %.2f\n", no_runs,
+              DT_REF, DT_HYSTERESIS);
+  std::printf("%10s %6s %16s %14s %9s %15s %11s\n", "scenario", "poses",
+              "sequential [us]", "single [us]", "speedup", "exact_dt [us]",
+              "mismatches");
+
+  const int no_poses[] = {20, 50, 100, 200, 500};
+  for (int s = 0; s < 3; ++s) {
+    std::uniform_real_distribution<double> dt_dist(dt_min[s], dt_max[s]);
+    for (int n : no_poses) {
+      double sequential_time = 0, single_time = 0, exact_time = 0;
+      int mismatches = 0;
+      TimedElasticBand teb;
+      for (int run = 0; run < no_runs; ++run) {
+        // straight line along x with the sampled time differences
+        PoseVector poses(1, PoseSE2(0, 0, 0));
+        std::vector<double> dts;
+        for (int i = 1; i < n; ++i) {
+          dts.push_back(dt_dist(generator));
+          poses.push_back(PoseSE2(poses.back().x() + dts.back(), 0, 0));
+        }
+
+        fill(teb, poses, dts);
+        auto start = std::chrono::steady_clock::now();
+        teb.autoResize(DT_REF, DT_HYSTERESIS, MIN_SAMPLES);
+        single_time += elapsedMs(start);
+
+        PoseVector sequential_poses = poses;
+        std::vector<double> sequential_dts = dts;
+        start = std::chrono::steady_clock::now();
+        autoResizeSequential(sequential_poses, sequential_dts);
+        sequential_time += elapsedMs(start);
+        if (!equal(teb, sequential_poses, sequential_dts))
+          ++mismatches;
+
+        fill(teb, poses, dts);
+        start = std::chrono::steady_clock::now();
+        teb.autoResize(DT_REF, DT_HYSTERESIS, MIN_SAMPLES, true);
+        exact_time += elapsedMs(start);
+      }
+      std::printf("%10s %6d %16.2f %14.2f %8.1fx %15.2f %11d\n", scenarios[s],
+                  n, 1e3 * sequential_time / no_runs,
+                  1e3 * single_time / no_runs, sequential_time / single_time,
+                  1e3 * exact_time / no_runs, mismatches);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Compares the association of obstacles to their closest trajectory pose by
+// linear search (TimedElasticBand::findClosestTrajectoryPose) and by the pose
+// grid index used in TebOptimalPlanner::AddEdgesObstacles.
+// Runs without a ROS master: benchmark_obstacle_association [no_poses]
+
+#include <teb_local_planner/pose_grid_index.h>
+
+#include <boost/make_shared.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace teb_local_planner;
+
+#define NO_RUNS 20
+#define LOCAL_MAP_SIZE 6.0 // meters
+
+namespace {
+double elapsedMs(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  int no_poses = argc > 1 ? std::atoi(argv[1]) : 100;
+  if (no_poses < 2)
+    no_poses = 2;
+
+  // quarter circle through the local costmap window
+  TimedElasticBand teb;
+  double radius = LOCAL_MAP_SIZE / 2.0;
+  for (int i = 0; i < no_poses; ++i) {
+    double phi = M_PI_2 * i / (no_poses - 1);
+    teb.addPose(radius * std::sin(phi), radius * (1.0 - std::cos(phi)), phi);
+    if (i > 0)
+      teb.addTimeDiff(0.1);
+  }
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> coordinate(-LOCAL_MAP_SIZE / 2.0,
+                                                    LOCAL_MAP_SIZE / 2.0);
+
+  std::printf("%d poses, mean of %d runs\n", no_poses, NO_RUNS);
+  std::printf("%10s %14s %14s %10s %12s\n", "obstacles", "linear [ms]",
+              "grid [ms]", "speedup", "mismatches");
+
+  const int no_obstacles[] = {1000, 5000, 20000};
+  for (int no_obst : no_obstacles) {
+    ObstContainer obstacles;
+    obstacles.reserve(no_obst);
+    for (int i = 0; i < no_obst; ++i)
+      obstacles.push_back(boost::make_shared<PointObstacle>(
+          coordinate(generator) + radius / 2.0, coordinate(generator)));
+
+    std::vector<int> linear_idx(no_obst), grid_idx(no_obst);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < NO_RUNS; ++run)
+      for (int i = 0; i < no_obst; ++i)
+        linear_idx[i] = teb.findClosestTrajectoryPose(*obstacles[i]);
+    double linear_time = elapsedMs(start) / NO_RUNS;
+
+    PoseGridIndex grid;
+    start = std::chrono::steady_clock::now();
+    for (int run = 0; run < NO_RUNS; ++run) {
+      grid.build(teb); // rebuilt once per outer iteration in the planner
+      for (int i = 0; i < no_obst; ++i)
+        grid_idx[i] = grid.findClosestPose(*obstacles[i], teb);
+    }
+    double grid_time = elapsedMs(start) / NO_RUNS;
+
+    int mismatches = 0;
+    for (int i = 0; i < no_obst; ++i)
+      if (linear_idx[i] != grid_idx[i])
+        ++mismatches;
+
+    std::printf("%10d %14.3f %14.3f %9.1fx %12d\n", no_obst, linear_time,
+                grid_time, linear_time / grid_time, mismatches);
+  }
+
+  return 0;
+}
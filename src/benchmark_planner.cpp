@@ -0,0 +1,599 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Offline benchmark of TebOptimalPlanner and HomotopyClassPlanner on recorded
+// or synthetic scenarios (robot plan, human paths, obstacles, parameters).
+// Runs without a ROS master, the planners are driven directly instead of
+// through the tf and costmap lookups of the ROS wrapper.
+//
+// Usage: benchmark_planner [options] [scenario files]
+//   --sweep          run the synthetic sweep (0-20 humans, 0-5k obstacles)
+//   --runs N         warm-started plan calls per scenario (default 10)
+//   --hcp            use the HomotopyClassPlanner
+//   --solvers        run each scenario with each linear solver backend
+//   --write DIR      write the synthetic scenarios to DIR
+//   --csv FILE       write the results to FILE
+//   --baseline FILE  compare the mean plan time with a previous csv
+//   --tolerance X    allowed relative slowdown w.r.t. the baseline (0.2)
+// Returns 1 if a scenario is slower than allowed by the baseline.
+//
+// Scenario files contain one entry per line ('#' starts a comment):
+//   name <name>
+//   param <name> <value>          (see setParameter())
+//   robot_radius <r>              (0: point robot)
+//   robot_vel <v> <omega>
+//   robot_pose <x> <y> <theta>    (global plan of the robot)
+//   human <id> <v> <omega>        (starts a new human path)
+//   human_pose <x> <y> <theta>    (pose of the last human path)
+//   point <x> <y>
+//   line <x1> <y1> <x2> <y2>
+//   polygon <x1> <y1> <x2> <y2> ...
+
+#include <teb_local_planner/homotopy_class_planner.h>
+#include <teb_local_planner/optimal_planner.h>
+
+#include <boost/make_shared.hpp>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace teb_local_planner;
+
+#define NO_COST_TYPES 15 // see OptimizationCost.msg
+
+namespace {
+
+const char *COST_NAMES[NO_COST_TYPES] = {
+    "time_optimality", "kinematic_dd",   "kinematic_cl",
+    "robot_vel",       "human_vel",      "robot_acc",
+    "human_acc",       "obstacle",       "dynamic_obstacle",
+    "via_point",       "hr_safety",      "hh_safety",
+    "hr_ttc",          "hr_dir",         "hr_min_dist"};
+
+// see TebOptimalPlanner::LinearSolverType
+const char *SOLVER_NAMES[] = {"auto", "cholmod", "csparse", "eigen", "banded"};
+
+struct Scenario {
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> params;
+  double robot_radius = 0.3;
+  geometry_msgs::Twist robot_vel;
+  std::vector<geometry_msgs::PoseStamped> robot_plan;
+  HumanPlanVelMap humans;
+  ObstContainer obstacles;
+};
+
+struct Result {
+  std::string name;
+  std::size_t no_humans = 0, no_obstacles = 0;
+  bool success = true;
+  double cold_ms = 0.0, warm_ms = 0.0, warm_max_ms = 0.0;
+  unsigned int outer_iterations = 0, inner_iterations = 0;
+  int linear_solver = 0;
+  double solve_ms = 0.0; //!< Time spent in the linear solver per warm plan
+  double costs[NO_COST_TYPES] = {};
+  long rss_delta_kib = 0, peak_rss_kib = 0;
+};
+
+double elapsedMs(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+long residentKiB() {
+  long pages = 0, resident = 0;
+  FILE *statm = std::fopen("/proc/self/statm", "r");
+  if (!statm)
+    return 0;
+  if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+    resident = 0;
+  std::fclose(statm);
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+long peakResidentKiB() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+geometry_msgs::PoseStamped makePose(double x, double y, double theta) {
+  geometry_msgs::PoseStamped pose;
+  pose.header.frame_id = "map";
+  PoseSE2(x, y, theta).toPoseMsg(pose.pose);
+  return pose;
+}
+
+bool setParameter(TebConfig &cfg, const std::string &name,
+                  const std::string &value) {
+  std::map<std::string, double *> doubles = {
+      {"dt_ref", &cfg.trajectory.dt_ref},
+      {"dt_hysteresis", &cfg.trajectory.dt_hysteresis},
+      {"max_vel_x", &cfg.robot.max_vel_x},
+      {"max_vel_theta", &cfg.robot.max_vel_theta},
+      {"acc_lim_x", &cfg.robot.acc_lim_x},
+      {"acc_lim_theta", &cfg.robot.acc_lim_theta},
+      {"human_radius", &cfg.human.radius},
+      {"min_human_robot_dist", &cfg.human.min_human_robot_dist},
+      {"min_human_human_dist", &cfg.human.min_human_human_dist},
+      {"human_max_vel_x", &cfg.human.max_vel_x},
+      {"min_obstacle_dist", &cfg.obstacles.min_obstacle_dist},
+      {"weight_obstacle", &cfg.optim.weight_obstacle},
+      {"weight_human_robot_safety", &cfg.optim.weight_human_robot_safety},
+      {"weight_human_human_safety", &cfg.optim.weight_human_human_safety},
+      {"weight_human_robot_ttc", &cfg.optim.weight_human_robot_ttc},
+      {"weight_human_robot_dir", &cfg.optim.weight_human_robot_dir},
+      {"exploration_time_budget", &cfg.hcp.exploration_time_budget}};
+  std::map<std::string, int *> ints = {
+      {"planning_mode", &cfg.planning_mode},
+      {"min_samples", &cfg.trajectory.min_samples},
+      {"no_inner_iterations", &cfg.optim.no_inner_iterations},
+      {"no_outer_iterations", &cfg.optim.no_outer_iterations},
+      {"linear_solver", &cfg.optim.linear_solver},
+      {"linear_solver_auto_vertices", &cfg.optim.linear_solver_auto_vertices},
+      {"obstacle_poses_affected", &cfg.obstacles.obstacle_poses_affected},
+      {"max_number_classes", &cfg.hcp.max_number_classes},
+      {"roadmap_graph_no_samples", &cfg.hcp.roadmap_graph_no_samples},
+      {"no_human_update_threads", &cfg.human.no_update_threads}};
+  std::map<std::string, bool *> bools = {
+      {"teb_autosize_exact_dt", &cfg.trajectory.teb_autosize_exact_dt},
+      {"persistent_graph", &cfg.optim.persistent_graph},
+      {"cull_interactions", &cfg.human.cull_interactions},
+      {"use_human_robot_safety_c", &cfg.optim.use_human_robot_safety_c},
+      {"use_human_human_safety_c", &cfg.optim.use_human_human_safety_c},
+      {"use_human_robot_ttc_c", &cfg.optim.use_human_robot_ttc_c},
+      {"use_human_robot_dir_c", &cfg.optim.use_human_robot_dir_c},
+      {"enable_multithreading", &cfg.hcp.enable_multithreading},
+      {"simple_exploration", &cfg.hcp.simple_exploration},
+      {"roadmap_graph_incremental", &cfg.hcp.roadmap_graph_incremental}};
+
+  if (doubles.count(name))
+    *doubles[name] = std::atof(value.c_str());
+  else if (ints.count(name))
+    *ints[name] = std::atoi(value.c_str());
+  else if (bools.count(name))
+    *bools[name] = value == "true" || value == "1";
+  else
+    return false;
+  return true;
+}
+
+bool loadScenario(const std::string &filename, Scenario &scenario) {
+  std::ifstream file(filename.c_str());
+  if (!file) {
+    std::fprintf(stderr, "cannot open %s\n", filename.c_str());
+    return false;
+  }
+  scenario = Scenario();
+  scenario.name = filename;
+  PlanStartVelGoalVel *human = NULL;
+  std::string line;
+  for (int line_no = 1; std::getline(file, line); ++line_no) {
+    std::istringstream in(line.substr(0, line.find('#')));
+    std::string key;
+    if (!(in >> key))
+      continue;
+
+    bool ok = true;
+    if (key == "name") {
+      ok = static_cast<bool>(in >> scenario.name);
+    } else if (key == "param") {
+      std::string name, value;
+      ok = static_cast<bool>(in >> name >> value);
+      if (ok)
+        scenario.params.emplace_back(name, value);
+    } else if (key == "robot_radius") {
+      ok = static_cast<bool>(in >> scenario.robot_radius);
+    } else if (key == "robot_vel") {
+      ok = static_cast<bool>(in >> scenario.robot_vel.linear.x >>
+                             scenario.robot_vel.angular.z);
+    } else if (key == "robot_pose" || key == "human_pose") {
+      double x, y, theta;
+      ok = static_cast<bool>(in >> x >> y >> theta);
+      if (ok && key == "robot_pose")
+        scenario.robot_plan.push_back(makePose(x, y, theta));
+      else if (ok && human)
+        human->plan.push_back(makePose(x, y, theta));
+      else
+        ok = false;
+    } else if (key == "human") {
+      uint64_t id;
+      double v, omega;
+      ok = static_cast<bool>(in >> id >> v >> omega);
+      if (ok) {
+        human = &scenario.humans[id];
+        human->start_vel.linear.x = v;
+        human->start_vel.angular.z = omega;
+      }
+    } else if (key == "point") {
+      double x, y;
+      ok = static_cast<bool>(in >> x >> y);
+      if (ok)
+        scenario.obstacles.push_back(boost::make_shared<PointObstacle>(x, y));
+    } else if (key == "line") {
+      double x1, y1, x2, y2;
+      ok = static_cast<bool>(in >> x1 >> y1 >> x2 >> y2);
+      if (ok)
+        scenario.obstacles.push_back(
+            boost::make_shared<LineObstacle>(x1, y1, x2, y2));
+    } else if (key == "polygon") {
+      boost::shared_ptr<PolygonObstacle> polygon =
+          boost::make_shared<PolygonObstacle>();
+      double x, y;
+      while (in >> x >> y)
+        polygon->pushBackVertex(x, y);
+      polygon->finalizePolygon();
+      scenario.obstacles.push_back(polygon);
+    } else {
+      ok = false;
+    }
+
+    if (!ok) {
+      std::fprintf(stderr, "%s:%d: invalid entry '%s'\n", filename.c_str(),
+                   line_no, line.c_str());
+      return false;
+    }
+  }
+
+  if (scenario.robot_plan.size() < 2) {
+    std::fprintf(stderr, "%s: the robot plan needs at least two poses\n",
+                 filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+void writePose(std::ostream &out, const char *key,
+               const geometry_msgs::PoseStamped &pose) {
+  PoseSE2 pose2d(pose.pose);
+  out << key << " " << pose2d.x() << " " << pose2d.y() << " "
+      << pose2d.theta() << "\n";
+}
+
+bool writeScenario(const std::string &filename, const Scenario &scenario) {
+  std::ofstream file(filename.c_str());
+  if (!file)
+    return false;
+  file.precision(9);
+  file << "name " << scenario.name << "\n";
+  for (const auto &param : scenario.params)
+    file << "param " << param.first << " " << param.second << "\n";
+  file << "robot_radius " << scenario.robot_radius << "\n";
+  file << "robot_vel " << scenario.robot_vel.linear.x << " "
+       << scenario.robot_vel.angular.z << "\n";
+  for (const auto &pose : scenario.robot_plan)
+    writePose(file, "robot_pose", pose);
+  for (const auto &human : scenario.humans) {
+    file << "human " << human.first << " "
+         << human.second.start_vel.linear.x << " "
+         << human.second.start_vel.angular.z << "\n";
+    for (const auto &pose : human.second.plan)
+      writePose(file, "human_pose", pose);
+  }
+  for (const ObstaclePtr &obst : scenario.obstacles) {
+    if (auto point = boost::dynamic_pointer_cast<PointObstacle>(obst)) {
+      file << "point " << point->x() << " " << point->y() << "\n";
+    } else if (auto line = boost::dynamic_pointer_cast<LineObstacle>(obst)) {
+      file << "line " << line->start().x() << " " << line->start().y() << " "
+           << line->end().x() << " " << line->end().y() << "\n";
+    } else if (auto polygon =
+                   boost::dynamic_pointer_cast<PolygonObstacle>(obst)) {
+      file << "polygon";
+      for (const Eigen::Vector2d &vertex : polygon->vertices())
+        file << " " << vertex.x() << " " << vertex.y();
+      file << "\n";
+    }
+  }
+  return static_cast<bool>(file);
+}
+
+// Straight robot plan along x, humans crossing it and point obstacles (like
+// the lethal cells of a costmap) outside of a corridor around the plan.
+Scenario syntheticScenario(int no_humans, int no_obstacles) {
+  Scenario scenario;
+  std::ostringstream name;
+  name << "h" << no_humans << "_o" << no_obstacles;
+  scenario.name = name.str();
+  scenario.params.emplace_back("planning_mode", "1");
+  scenario.robot_vel.linear.x = 0.3;
+
+  for (int i = 0; i <= 80; ++i)
+    scenario.robot_plan.push_back(makePose(0.1 * i, 0.0, 0.0));
+
+  std::mt19937 generator(no_humans * 10007 + no_obstacles);
+  std::uniform_real_distribution<double> along(1.0, 7.0), side(1.5, 3.0),
+      unit(0.0, 1.0);
+  for (int h = 0; h < no_humans; ++h) {
+    double x = along(generator);
+    double y = unit(generator) < 0.5 ? -side(generator) : side(generator);
+    double theta = y > 0.0 ? -M_PI_2 : M_PI_2;
+    PlanStartVelGoalVel &human = scenario.humans[h + 1];
+    human.start_vel.linear.x = 0.5 + 0.5 * unit(generator);
+    for (int i = 0; i <= 20; ++i) {
+      double y_i = y * (1.0 - 0.1 * i); // crosses the robot plan at i = 10
+      human.plan.push_back(makePose(x, y_i, theta));
+    }
+  }
+
+  std::uniform_real_distribution<double> x_coord(-1.0, 9.0),
+      y_coord(0.6, 4.0);
+  scenario.obstacles.reserve(no_obstacles);
+  for (int i = 0; i < no_obstacles; ++i) {
+    double y = y_coord(generator);
+    scenario.obstacles.push_back(boost::make_shared<PointObstacle>(
+        x_coord(generator), unit(generator) < 0.5 ? -y : y));
+  }
+  return scenario;
+}
+
+// linear_solver < 0: backend of the scenario parameters
+Result runScenario(const Scenario &scenario, bool use_hcp, int no_runs,
+                   int linear_solver) {
+  Result result;
+  result.name = scenario.name;
+  result.no_humans = scenario.humans.size();
+  result.no_obstacles = scenario.obstacles.size();
+
+  TebConfig cfg;
+  cfg.hcp.enable_homotopy_class_planning = use_hcp;
+  for (const auto &param : scenario.params)
+    if (!setParameter(cfg, param.first, param.second))
+      std::fprintf(stderr, "%s: unknown parameter '%s'\n",
+                   scenario.name.c_str(), param.first.c_str());
+  if (linear_solver >= 0) {
+    cfg.optim.linear_solver = linear_solver;
+    result.name += std::string("/") + SOLVER_NAMES[linear_solver];
+  }
+
+  RobotFootprintModelPtr robot_model;
+  if (scenario.robot_radius > 0.0)
+    robot_model =
+        boost::make_shared<CircularRobotFootprint>(scenario.robot_radius);
+  else
+    robot_model = boost::make_shared<PointRobotFootprint>();
+
+  ObstContainer obstacles = scenario.obstacles;
+  ViaPointContainer via_points;
+  std::map<uint64_t, ViaPointContainer> humans_via_points;
+  for (const auto &human : scenario.humans)
+    humans_via_points[human.first];
+
+  long rss_before = residentKiB();
+  boost::shared_ptr<TebOptimalPlanner> teb_planner;
+  boost::shared_ptr<HomotopyClassPlanner> hcp_planner;
+  PlannerInterface *planner;
+  if (use_hcp) {
+    hcp_planner = boost::make_shared<HomotopyClassPlanner>(
+        cfg, &obstacles, robot_model, TebVisualizationPtr(), &via_points);
+    planner = hcp_planner.get();
+  } else {
+    teb_planner = boost::make_shared<TebOptimalPlanner>(
+        cfg, &obstacles, robot_model, TebVisualizationPtr(), &via_points,
+        boost::make_shared<CircularRobotFootprint>(cfg.human.radius),
+        &humans_via_points);
+    planner = teb_planner.get();
+  }
+
+  OptimizationCostArray op_costs;
+  for (int run = 0; run <= no_runs; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    result.success &=
+        planner->plan(scenario.robot_plan, &scenario.robot_vel, false,
+                      &scenario.humans, &op_costs);
+    double time = elapsedMs(start);
+    if (run == 0) {
+      result.cold_ms = time;
+    } else {
+      result.warm_ms += time / no_runs;
+      result.warm_max_ms = std::max(result.warm_max_ms, time);
+      TebOptimalPlannerPtr best =
+          use_hcp ? hcp_planner->bestTeb() : teb_planner;
+      if (best)
+        result.solve_ms += 1e3 * best->getLinearSolverTime() / no_runs;
+    }
+  }
+  result.rss_delta_kib = residentKiB() - rss_before;
+  result.peak_rss_kib = peakResidentKiB();
+
+  TebOptimalPlannerPtr best =
+      use_hcp ? hcp_planner->bestTeb() : teb_planner;
+  if (best) {
+    result.outer_iterations = best->getOuterIterations();
+    result.inner_iterations = best->getInnerIterations();
+    result.linear_solver = best->getLinearSolver();
+  }
+  for (const OptimizationCost &cost : op_costs.costs)
+    if (cost.type >= 0 && cost.type < NO_COST_TYPES)
+      result.costs[cost.type] = cost.cost;
+  return result;
+}
+
+void writeCsv(std::ostream &out, const std::vector<Result> &results) {
+  out << "name,humans,obstacles,success,cold_ms,warm_ms,warm_max_ms,"
+         "outer_iterations,inner_iterations,linear_solver,solve_ms";
+  for (const char *cost : COST_NAMES)
+    out << "," << cost;
+  out << ",rss_delta_kib,peak_rss_kib\n";
+  for (const Result &r : results) {
+    out << r.name << "," << r.no_humans << "," << r.no_obstacles << ","
+        << r.success << "," << r.cold_ms << "," << r.warm_ms << ","
+        << r.warm_max_ms << "," << r.outer_iterations << ","
+        << r.inner_iterations << "," << SOLVER_NAMES[r.linear_solver] << ","
+        << r.solve_ms;
+    for (double cost : r.costs)
+      out << "," << cost;
+    out << "," << r.rss_delta_kib << "," << r.peak_rss_kib << "\n";
+  }
+}
+
+// mean warm plan time of each scenario of a csv written by writeCsv()
+std::map<std::string, double> readBaseline(const std::string &filename) {
+  std::map<std::string, double> baseline;
+  std::ifstream file(filename.c_str());
+  std::string line;
+  std::getline(file, line); // header
+  while (std::getline(file, line)) {
+    std::vector<std::string> fields;
+    std::istringstream in(line);
+    std::string field;
+    while (std::getline(in, field, ','))
+      fields.push_back(field);
+    if (fields.size() > 5)
+      baseline[fields[0]] = std::atof(fields[5].c_str());
+  }
+  return baseline;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ros::Time::init(); // the planners use ros::Time without a master
+
+  bool sweep = false, use_hcp = false, all_solvers = false;
+  int no_runs = 10;
+  double tolerance = 0.2;
+  std::string write_dir, csv_file, baseline_file;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--sweep")
+      sweep = true;
+    else if (arg == "--hcp")
+      use_hcp = true;
+    else if (arg == "--solvers")
+      all_solvers = true;
+    else if (arg == "--runs" && has_value)
+      no_runs = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--tolerance" && has_value)
+      tolerance = std::atof(argv[++i]);
+    else if (arg == "--write" && has_value)
+      write_dir = argv[++i];
+    else if (arg == "--csv" && has_value)
+      csv_file = argv[++i];
+    else if (arg == "--baseline" && has_value)
+      baseline_file = argv[++i];
+    else if (arg.compare(0, 2, "--") != 0)
+      files.push_back(arg);
+    else {
+      std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+      return 2;
+    }
+  }
+
+  std::vector<Scenario> scenarios;
+  for (const std::string &file : files) {
+    scenarios.emplace_back();
+    if (!loadScenario(file, scenarios.back()))
+      return 2;
+  }
+  if (sweep || files.empty()) {
+    const int no_humans[] = {0, 5, 10, 20};
+    const int no_obstacles[] = {0, 500, 5000};
+    for (int humans : no_humans)
+      for (int obstacles : no_obstacles)
+        scenarios.push_back(syntheticScenario(humans, obstacles));
+  }
+
+  if (!write_dir.empty())
+    for (const Scenario &scenario : scenarios)
+      if (!writeScenario(write_dir + "/" + scenario.name + ".txt", scenario))
+        std::fprintf(stderr, "cannot write %s\n", scenario.name.c_str());
+
+  std::printf("%s, 1 cold + %d warm-started plans per scenario\n",
+              use_hcp ? "HomotopyClassPlanner" : "TebOptimalPlanner",
+              no_runs);
+  std::printf("%-24s %6s %9s %10s %10s %10s %7s %8s %10s %12s %10s\n",
+              "scenario", "humans", "obstacles", "cold [ms]", "warm [ms]",
+              "max [ms]", "iters", "solver", "solve [ms]", "cost",
+              "rss [KiB]");
+
+  // all backends, the explicit ones first and the auto-selection last
+  std::vector<int> solvers = {-1};
+  if (all_solvers)
+    solvers = {1, 2, 3, 4, 0};
+  std::vector<Result> results;
+  for (const Scenario &scenario : scenarios) {
+    for (int solver : solvers) {
+      results.push_back(runScenario(scenario, use_hcp, no_runs, solver));
+      const Result &r = results.back();
+      double total_cost = 0.0;
+      for (int i = 0; i < NO_COST_TYPES - 1; ++i) // min dist is not a cost
+        total_cost += r.costs[i];
+      std::printf("%-24s %6zu %9zu %10.3f %10.3f %10.3f %3u/%-3u %8s %10.3f"
+                  " %12.4f %10ld%s\n",
+                  r.name.c_str(), r.no_humans, r.no_obstacles, r.cold_ms,
+                  r.warm_ms, r.warm_max_ms, r.outer_iterations,
+                  r.inner_iterations, SOLVER_NAMES[r.linear_solver],
+                  r.solve_ms, total_cost, r.rss_delta_kib,
+                  r.success ? "" : " (failed)");
+    }
+  }
+
+  if (!csv_file.empty()) {
+    std::ofstream csv(csv_file.c_str());
+    writeCsv(csv, results);
+  }
+
+  int status = 0;
+  if (!baseline_file.empty()) {
+    std::map<std::string, double> baseline = readBaseline(baseline_file);
+    for (const Result &r : results) {
+      auto it = baseline.find(r.name);
+      if (it == baseline.end() || it->second <= 0.0)
+        continue;
+      double ratio = r.warm_ms / it->second;
+      if (ratio > 1.0 + tolerance) {
+        std::printf("regression: %s %.3f ms (baseline %.3f ms, %+.0f%%)\n",
+                    r.name.c_str(), r.warm_ms, it->second,
+                    100.0 * (ratio - 1.0));
+        status = 1;
+      }
+    }
+  }
+  return status;
+}
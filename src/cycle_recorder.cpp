@@ -0,0 +1,764 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/cycle_recorder.h>
+
+#include <boost/make_shared.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+
+namespace teb_local_planner {
+
+const char CycleRecorder::MAGIC[8] = {'T', 'E', 'B', 'R', 'I', 'N', 'G', '\0'};
+
+namespace {
+
+// the pages of the file header keep the ring aligned, behind the FileHeader
+// they hold the configuration of the oldest records
+const std::size_t FILE_HEADER_SIZE = 64 * 1024;
+const std::size_t CONFIG_OFFSET = 512;
+static_assert(sizeof(CycleRecorder::FileHeader) <= CONFIG_OFFSET,
+              "the configuration overlaps the file header");
+
+enum ObstacleType : uint8_t {
+  UNKNOWN_OBSTACLE,
+  POINT_OBSTACLE,
+  LINE_OBSTACLE,
+  POLYGON_OBSTACLE
+};
+
+enum FootprintType : uint8_t {
+  POINT_FOOTPRINT,
+  CIRCULAR_FOOTPRINT,
+  TWO_CIRCLES_FOOTPRINT,
+  LINE_FOOTPRINT,
+  POLYGON_FOOTPRINT
+};
+
+//! First pass of the serialization: measures the size of a record
+struct SizeSink {
+  uint64_t size = 0;
+  void put(const void *, std::size_t n) { size += n; }
+};
+
+//! Second pass of the serialization: copies a record into the ring
+struct MemorySink {
+  explicit MemorySink(char *data) : data(data) {}
+  void put(const void *src, std::size_t n) {
+    std::memcpy(data, src, n);
+    data += n;
+  }
+  char *data;
+};
+
+//! Reads a record, fails (instead of reading beyond) if it is truncated
+struct Source {
+  Source(const char *data, std::size_t size) : data(data), end(data + size) {}
+  bool get(void *dst, std::size_t n) {
+    if (!ok || static_cast<std::size_t>(end - data) < n) {
+      ok = false;
+      std::memset(dst, 0, n);
+      return false;
+    }
+    std::memcpy(dst, data, n);
+    data += n;
+    return true;
+  }
+  const char *data, *end;
+  bool ok = true;
+};
+
+template <typename Sink, typename T> void put(Sink &sink, const T &value) {
+  sink.put(&value, sizeof(T));
+}
+
+template <typename T> T get(Source &source) {
+  T value;
+  source.get(&value, sizeof(T));
+  return value;
+}
+
+template <typename Sink>
+void putString(Sink &sink, const char *str, std::size_t size) {
+  put(sink, static_cast<uint32_t>(size));
+  sink.put(str, size);
+}
+
+template <typename Sink> void putString(Sink &sink, const std::string &str) {
+  putString(sink, str.data(), str.size());
+}
+
+std::string getString(Source &source) {
+  uint32_t size = get<uint32_t>(source);
+  if (static_cast<std::size_t>(source.end - source.data) < size) {
+    source.ok = false;
+    return std::string();
+  }
+  std::string str(source.data, size);
+  source.data += size;
+  return str;
+}
+
+template <typename Sink>
+void putPose(Sink &sink, const geometry_msgs::Pose &pose) {
+  put(sink, pose.position.x);
+  put(sink, pose.position.y);
+  put(sink, pose.position.z);
+  put(sink, pose.orientation.x);
+  put(sink, pose.orientation.y);
+  put(sink, pose.orientation.z);
+  put(sink, pose.orientation.w);
+}
+
+void getPose(Source &source, geometry_msgs::Pose &pose) {
+  pose.position.x = get<double>(source);
+  pose.position.y = get<double>(source);
+  pose.position.z = get<double>(source);
+  pose.orientation.x = get<double>(source);
+  pose.orientation.y = get<double>(source);
+  pose.orientation.z = get<double>(source);
+  pose.orientation.w = get<double>(source);
+}
+
+template <typename Sink>
+void putTwist(Sink &sink, const geometry_msgs::Twist &twist) {
+  put(sink, twist.linear.x);
+  put(sink, twist.linear.y);
+  put(sink, twist.linear.z);
+  put(sink, twist.angular.x);
+  put(sink, twist.angular.y);
+  put(sink, twist.angular.z);
+}
+
+void getTwist(Source &source, geometry_msgs::Twist &twist) {
+  twist.linear.x = get<double>(source);
+  twist.linear.y = get<double>(source);
+  twist.linear.z = get<double>(source);
+  twist.angular.x = get<double>(source);
+  twist.angular.y = get<double>(source);
+  twist.angular.z = get<double>(source);
+}
+
+template <typename Sink>
+void putPlan(Sink &sink, const std::vector<geometry_msgs::PoseStamped> &plan) {
+  put(sink, static_cast<uint32_t>(plan.size()));
+  if (plan.empty())
+    putString(sink, "", 0);
+  else
+    putString(sink, plan.front().header.frame_id);
+  for (const geometry_msgs::PoseStamped &pose : plan)
+    putPose(sink, pose.pose);
+}
+
+void getPlan(Source &source, std::vector<geometry_msgs::PoseStamped> &plan) {
+  plan.resize(get<uint32_t>(source));
+  std::string frame_id = getString(source);
+  for (geometry_msgs::PoseStamped &pose : plan) {
+    pose.header.frame_id = frame_id;
+    getPose(source, pose.pose);
+    if (!source.ok)
+      break;
+  }
+}
+
+template <typename Sink>
+void putPoints(Sink &sink, const Point2dContainer &points) {
+  put(sink, static_cast<uint32_t>(points.size()));
+  for (const Eigen::Vector2d &point : points) {
+    put(sink, point.x());
+    put(sink, point.y());
+  }
+}
+
+void getPoints(Source &source, Point2dContainer &points) {
+  points.resize(get<uint32_t>(source));
+  for (Eigen::Vector2d &point : points) {
+    point.x() = get<double>(source);
+    point.y() = get<double>(source);
+  }
+}
+
+template <typename Sink>
+void putObstacle(Sink &sink, const Obstacle &obstacle) {
+  if (const PointObstacle *point =
+          dynamic_cast<const PointObstacle *>(&obstacle)) {
+    put(sink, POINT_OBSTACLE);
+    put(sink, point->x());
+    put(sink, point->y());
+  } else if (const LineObstacle *line =
+                 dynamic_cast<const LineObstacle *>(&obstacle)) {
+    put(sink, LINE_OBSTACLE);
+    put(sink, line->start().x());
+    put(sink, line->start().y());
+    put(sink, line->end().x());
+    put(sink, line->end().y());
+  } else if (const PolygonObstacle *polygon =
+                 dynamic_cast<const PolygonObstacle *>(&obstacle)) {
+    put(sink, POLYGON_OBSTACLE);
+    putPoints(sink, polygon->vertices());
+  } else {
+    put(sink, UNKNOWN_OBSTACLE);
+    return;
+  }
+  put(sink, static_cast<uint8_t>(obstacle.isDynamic()));
+  if (obstacle.isDynamic()) {
+    put(sink, obstacle.getCentroidVelocity().x());
+    put(sink, obstacle.getCentroidVelocity().y());
+  }
+}
+
+ObstaclePtr getObstacle(Source &source) {
+  ObstaclePtr obstacle;
+  switch (get<uint8_t>(source)) {
+  case POINT_OBSTACLE: {
+    double x = get<double>(source);
+    double y = get<double>(source);
+    obstacle = boost::make_shared<PointObstacle>(x, y);
+    break;
+  }
+  case LINE_OBSTACLE: {
+    double x1 = get<double>(source);
+    double y1 = get<double>(source);
+    double x2 = get<double>(source);
+    double y2 = get<double>(source);
+    obstacle = boost::make_shared<LineObstacle>(x1, y1, x2, y2);
+    break;
+  }
+  case POLYGON_OBSTACLE: {
+    Point2dContainer vertices;
+    getPoints(source, vertices);
+    boost::shared_ptr<PolygonObstacle> polygon =
+        boost::make_shared<PolygonObstacle>();
+    for (const Eigen::Vector2d &vertex : vertices)
+      polygon->pushBackVertex(vertex);
+    polygon->finalizePolygon();
+    obstacle = polygon;
+    break;
+  }
+  default:
+    return obstacle;
+  }
+  if (get<uint8_t>(source)) {
+    double vx = get<double>(source);
+    double vy = get<double>(source);
+    obstacle->setCentroidVelocity(Eigen::Vector2d(vx, vy));
+  }
+  return obstacle;
+}
+
+template <typename Sink>
+void putFootprint(Sink &sink, const RobotFootprintModelPtr &model) {
+  if (auto circular =
+          boost::dynamic_pointer_cast<const CircularRobotFootprint>(model)) {
+    put(sink, CIRCULAR_FOOTPRINT);
+    put(sink, circular->radius());
+  } else if (auto circles = boost::dynamic_pointer_cast<
+                 const TwoCirclesRobotFootprint>(model)) {
+    put(sink, TWO_CIRCLES_FOOTPRINT);
+    put(sink, circles->frontOffset());
+    put(sink, circles->frontRadius());
+    put(sink, circles->rearOffset());
+    put(sink, circles->rearRadius());
+  } else if (auto line =
+                 boost::dynamic_pointer_cast<const LineRobotFootprint>(model)) {
+    put(sink, LINE_FOOTPRINT);
+    put(sink, line->lineStart().x());
+    put(sink, line->lineStart().y());
+    put(sink, line->lineEnd().x());
+    put(sink, line->lineEnd().y());
+  } else if (auto polygon = boost::dynamic_pointer_cast<
+                 const PolygonRobotFootprint>(model)) {
+    put(sink, POLYGON_FOOTPRINT);
+    putPoints(sink, polygon->vertices());
+  } else {
+    put(sink, POINT_FOOTPRINT);
+  }
+}
+
+RobotFootprintModelPtr getFootprint(Source &source) {
+  switch (get<uint8_t>(source)) {
+  case CIRCULAR_FOOTPRINT:
+    return boost::make_shared<CircularRobotFootprint>(get<double>(source));
+  case TWO_CIRCLES_FOOTPRINT: {
+    double front_offset = get<double>(source);
+    double front_radius = get<double>(source);
+    double rear_offset = get<double>(source);
+    double rear_radius = get<double>(source);
+    return boost::make_shared<TwoCirclesRobotFootprint>(
+        front_offset, front_radius, rear_offset, rear_radius);
+  }
+  case LINE_FOOTPRINT: {
+    Eigen::Vector2d start, end;
+    start.x() = get<double>(source);
+    start.y() = get<double>(source);
+    end.x() = get<double>(source);
+    end.y() = get<double>(source);
+    return boost::make_shared<LineRobotFootprint>(start, end);
+  }
+  case POLYGON_FOOTPRINT: {
+    Point2dContainer vertices;
+    getPoints(source, vertices);
+    return boost::make_shared<PolygonRobotFootprint>(vertices);
+  }
+  default:
+    return boost::make_shared<PointRobotFootprint>();
+  }
+}
+
+//! Writes the parameters as (name, value) pairs, an empty name terminates
+template <typename Sink> struct ParameterWriter {
+  explicit ParameterWriter(Sink &sink) : sink(sink) {}
+  template <typename T> void operator()(const char *name, const T &value) {
+    putString(sink, name, std::strlen(name));
+    put(sink, static_cast<double>(value));
+  }
+  Sink &sink;
+};
+
+//! Assigns the parameters read from a ParameterWriter
+struct ParameterReader {
+  explicit ParameterReader(const std::map<std::string, double> &values)
+      : values(values) {}
+  void operator()(const char *name, double &value) {
+    auto it = values.find(name);
+    if (it != values.end())
+      value = it->second;
+  }
+  void operator()(const char *name, int &value) {
+    auto it = values.find(name);
+    if (it != values.end())
+      value = static_cast<int>(it->second);
+  }
+  void operator()(const char *name, bool &value) {
+    auto it = values.find(name);
+    if (it != values.end())
+      value = it->second != 0.0;
+  }
+  const std::map<std::string, double> &values;
+};
+
+struct ConfigSerializer {
+  const TebConfig &cfg;
+  const RobotFootprintModelPtr &robot_model;
+
+  template <typename Sink> void operator()(Sink &sink) const {
+    ParameterWriter<Sink> writer(sink);
+    visitConfigParameters(cfg, writer);
+    putString(sink, "", 0);
+    putFootprint(sink, robot_model);
+  }
+};
+
+struct CycleSerializer {
+  const std::vector<geometry_msgs::PoseStamped> &plan;
+  const geometry_msgs::Twist &start_vel;
+  bool free_goal_vel;
+  const HumanPlanVelMap &human_plans;
+  const ObstContainer &obstacles;
+  const ViaPointContainer &via_points;
+  const std::map<uint64_t, ViaPointContainer> &humans_via_points;
+  double weight_optimaltime;
+  bool success;
+  double plan_time, vx, omega;
+  const OptimizationCostArray &op_costs;
+
+  template <typename Sink> void operator()(Sink &sink) const {
+    putPlan(sink, plan);
+    putTwist(sink, start_vel);
+    put(sink, static_cast<uint8_t>(free_goal_vel));
+
+    put(sink, static_cast<uint32_t>(human_plans.size()));
+    for (const auto &human : human_plans) {
+      put(sink, human.first);
+      putPlan(sink, human.second.plan);
+      putTwist(sink, human.second.start_vel);
+      putTwist(sink, human.second.goal_vel);
+    }
+
+    put(sink, static_cast<uint32_t>(obstacles.size()));
+    for (const ObstaclePtr &obstacle : obstacles)
+      putObstacle(sink, *obstacle);
+
+    putPoints(sink, via_points);
+    put(sink, static_cast<uint32_t>(humans_via_points.size()));
+    for (const auto &human : humans_via_points) {
+      put(sink, human.first);
+      putPoints(sink, human.second);
+    }
+    put(sink, weight_optimaltime);
+
+    put(sink, static_cast<uint8_t>(success));
+    put(sink, plan_time);
+    put(sink, vx);
+    put(sink, omega);
+    put(sink, static_cast<uint32_t>(op_costs.costs.size()));
+    for (const OptimizationCost &cost : op_costs.costs) {
+      put(sink, cost.type);
+      put(sink, cost.cost);
+    }
+  }
+};
+
+struct EmptySerializer {
+  template <typename Sink> void operator()(Sink &) const {}
+};
+
+bool readConfig(Source &source, RecordedConfig &config) {
+  config.parameters.clear();
+  for (std::string name = getString(source); !name.empty() && source.ok;
+       name = getString(source))
+    config.parameters[name] = get<double>(source);
+  config.robot_model = getFootprint(source);
+  return source.ok;
+}
+
+bool readCycle(Source &source, RecordedCycle &cycle) {
+  getPlan(source, cycle.plan);
+  getTwist(source, cycle.start_vel);
+  cycle.free_goal_vel = get<uint8_t>(source);
+
+  cycle.human_plans.clear();
+  for (uint32_t i = get<uint32_t>(source); i > 0 && source.ok; --i) {
+    PlanStartVelGoalVel &human = cycle.human_plans[get<uint64_t>(source)];
+    getPlan(source, human.plan);
+    getTwist(source, human.start_vel);
+    getTwist(source, human.goal_vel);
+  }
+
+  cycle.obstacles.clear();
+  for (uint32_t i = get<uint32_t>(source); i > 0 && source.ok; --i) {
+    ObstaclePtr obstacle = getObstacle(source);
+    if (obstacle)
+      cycle.obstacles.push_back(obstacle);
+  }
+
+  getPoints(source, cycle.via_points);
+  cycle.humans_via_points.clear();
+  for (uint32_t i = get<uint32_t>(source); i > 0 && source.ok; --i) {
+    uint64_t id = get<uint64_t>(source);
+    getPoints(source, cycle.humans_via_points[id]);
+  }
+  cycle.weight_optimaltime = get<double>(source);
+
+  cycle.success = get<uint8_t>(source);
+  cycle.plan_time = get<double>(source);
+  cycle.vx = get<double>(source);
+  cycle.omega = get<double>(source);
+  cycle.op_costs.costs.resize(get<uint32_t>(source));
+  for (OptimizationCost &cost : cycle.op_costs.costs) {
+    cost.type = get<decltype(cost.type)>(source);
+    cost.cost = get<double>(source);
+  }
+  return source.ok;
+}
+
+} // namespace
+
+void RecordedConfig::apply(TebConfig &cfg) const {
+  ParameterReader reader(parameters);
+  visitConfigParameters(cfg, reader);
+}
+
+CycleRecorder::CycleRecorder()
+    : fd_(-1), mapped_size_(0), header_(NULL), ring_(NULL), skipped_(0) {}
+
+CycleRecorder::~CycleRecorder() { close(); }
+
+bool CycleRecorder::open(const std::string &filename, std::size_t capacity) {
+  close();
+  capacity &= ~static_cast<std::size_t>(7);
+  if (capacity < sizeof(RecordHeader))
+    return false;
+
+  int fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+    return false;
+  std::size_t size = FILE_HEADER_SIZE + capacity;
+  struct stat file_stat;
+  bool reuse =
+      fstat(fd, &file_stat) == 0 && std::size_t(file_stat.st_size) == size;
+  if (!reuse && ftruncate(fd, size) != 0) {
+    ::close(fd);
+    return false;
+  }
+  void *mapping =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    ::close(fd);
+    return false;
+  }
+
+  filename_ = filename;
+  fd_ = fd;
+  mapped_size_ = size;
+  header_ = static_cast<FileHeader *>(mapping);
+  ring_ = static_cast<char *>(mapping) + FILE_HEADER_SIZE;
+  skipped_ = 0;
+
+  // start a new ring unless the file holds a valid one
+  if (!reuse || std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header_->version != VERSION ||
+      header_->header_size != FILE_HEADER_SIZE ||
+      header_->capacity != capacity || header_->head >= capacity ||
+      header_->tail > capacity) {
+    std::memset(header_, 0, FILE_HEADER_SIZE);
+    std::memcpy(header_->magic, MAGIC, sizeof(MAGIC));
+    header_->version = VERSION;
+    header_->header_size = FILE_HEADER_SIZE;
+    header_->capacity = capacity;
+  }
+  return true;
+}
+
+void CycleRecorder::close() {
+  if (header_) {
+    munmap(header_, mapped_size_);
+    ::close(fd_);
+  }
+  fd_ = -1;
+  mapped_size_ = 0;
+  header_ = NULL;
+  ring_ = NULL;
+}
+
+template <typename Serializer>
+bool CycleRecorder::write(RecordType type, const ros::Time &stamp,
+                          const Serializer &serializer) {
+  if (!header_)
+    return false;
+
+  SizeSink sizer;
+  serializer(sizer);
+  uint64_t size = (sizeof(RecordHeader) + sizer.size + 7) & ~uint64_t(7);
+  uint64_t capacity = header_->capacity;
+  if (size > capacity) {
+    ++skipped_;
+    return false;
+  }
+
+  // records are contiguous, continue at the beginning if the end is too close
+  uint64_t pos = header_->tail;
+  if (pos + size > capacity) {
+    release(pos, capacity);
+    if (pos + sizeof(RecordHeader) <= capacity) {
+      RecordHeader wrap = RecordHeader();
+      wrap.type = WRAP;
+      std::memcpy(ring_ + pos, &wrap, sizeof(wrap));
+    }
+    pos = 0;
+  }
+  release(pos, pos + size);
+
+  RecordHeader record = RecordHeader();
+  record.type = type;
+  record.size = size;
+  record.sequence = header_->sequence;
+  record.stamp = stamp.toSec();
+  std::memcpy(ring_ + pos, &record, sizeof(record));
+  MemorySink sink(ring_ + pos + sizeof(record));
+  serializer(sink);
+
+  // publish the record only after it has been written completely
+  if (header_->no_records == 0)
+    header_->head = pos;
+  header_->tail = pos + size;
+  ++header_->no_records;
+  ++header_->sequence;
+  return true;
+}
+
+void CycleRecorder::release(uint64_t begin, uint64_t end) {
+  while (header_->no_records > 0 && header_->head >= begin &&
+         header_->head < end) {
+    uint64_t head = header_->head;
+    RecordHeader record;
+    if (head + sizeof(RecordHeader) > header_->capacity) {
+      header_->head = 0;
+      continue;
+    }
+    std::memcpy(&record, ring_ + head, sizeof(record));
+    if (record.type == WRAP) {
+      header_->head = 0;
+    } else {
+      if (record.type == CONFIG)
+        keepConfig(head, record.size);
+      header_->head = head + record.size;
+      --header_->no_records;
+    }
+  }
+}
+
+void CycleRecorder::keepConfig(uint64_t offset, uint64_t size) {
+  // the cycles up to the next CONFIG record would be replayed with a wrong
+  // configuration without it
+  header_->config_size = 0; // invalid while it is copied
+  if (size > FILE_HEADER_SIZE - CONFIG_OFFSET)
+    return;
+  std::memcpy(reinterpret_cast<char *>(header_) + CONFIG_OFFSET,
+              ring_ + offset, size);
+  header_->config_size = size;
+}
+
+bool CycleRecorder::recordConfig(const ros::Time &stamp, const TebConfig &cfg,
+                                 const RobotFootprintModelPtr &robot_model) {
+  ConfigSerializer serializer = {cfg, robot_model};
+  return write(CONFIG, stamp, serializer);
+}
+
+bool CycleRecorder::recordCycle(
+    const ros::Time &stamp, const std::vector<geometry_msgs::PoseStamped> &plan,
+    const geometry_msgs::Twist &start_vel, bool free_goal_vel,
+    const HumanPlanVelMap &human_plans, const ObstContainer &obstacles,
+    const ViaPointContainer &via_points,
+    const std::map<uint64_t, ViaPointContainer> &humans_via_points,
+    double weight_optimaltime, bool success, double plan_time, double vx,
+    double omega, const OptimizationCostArray &op_costs) {
+  CycleSerializer serializer = {plan,
+                                start_vel,
+                                free_goal_vel,
+                                human_plans,
+                                obstacles,
+                                via_points,
+                                humans_via_points,
+                                weight_optimaltime,
+                                success,
+                                plan_time,
+                                vx,
+                                omega,
+                                op_costs};
+  return write(CYCLE, stamp, serializer);
+}
+
+bool CycleRecorder::recordReset(const ros::Time &stamp) {
+  return write(RESET, stamp, EmptySerializer());
+}
+
+bool CycleReader::open(const std::string &filename) {
+  std::ifstream file(filename.c_str(), std::ios::binary);
+  if (!file)
+    return false;
+  data_.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  remaining_ = 0;
+  has_config_ = false;
+  if (data_.size() < sizeof(header_))
+    return false;
+  std::memcpy(&header_, data_.data(), sizeof(header_));
+  if (std::memcmp(header_.magic, CycleRecorder::MAGIC,
+                  sizeof(header_.magic)) != 0 ||
+      header_.version != CycleRecorder::VERSION ||
+      data_.size() < header_.header_size + header_.capacity ||
+      header_.head >= header_.capacity)
+    return false;
+  offset_ = header_.head;
+  remaining_ = header_.no_records;
+
+  // configuration of the records preceding the first CONFIG record
+  CycleRecorder::RecordHeader record;
+  if (header_.config_size >= sizeof(record) &&
+      CONFIG_OFFSET + header_.config_size <= header_.header_size) {
+    const char *config = data_.data() + CONFIG_OFFSET;
+    std::memcpy(&record, config, sizeof(record));
+    Source source(config + sizeof(record),
+                  header_.config_size - sizeof(record));
+    has_config_ = record.type == CycleRecorder::CONFIG &&
+                  readConfig(source, config_);
+    config_.stamp.fromSec(record.stamp);
+  }
+  return true;
+}
+
+uint64_t CycleReader::size() const { return header_.no_records; }
+
+CycleRecorder::RecordType CycleReader::next() {
+  const char *ring = data_.data() + header_.header_size;
+  int wraps = 0;
+  while (remaining_ > 0) {
+    if (offset_ + sizeof(CycleRecorder::RecordHeader) > header_.capacity) {
+      offset_ = 0;
+      if (++wraps > 1)
+        break;
+      continue;
+    }
+    CycleRecorder::RecordHeader record;
+    std::memcpy(&record, ring + offset_, sizeof(record));
+    if (record.type == CycleRecorder::WRAP) {
+      offset_ = 0;
+      if (++wraps > 1)
+        break;
+      continue;
+    }
+    if (record.size < sizeof(record) ||
+        offset_ + record.size > header_.capacity)
+      break; // corrupted
+
+    Source source(ring + offset_ + sizeof(record),
+                  record.size - sizeof(record));
+    offset_ += record.size;
+    --remaining_;
+    sequence_ = record.sequence;
+    stamp_.fromSec(record.stamp);
+
+    bool ok = true;
+    switch (record.type) {
+    case CycleRecorder::CONFIG:
+      ok = readConfig(source, config_);
+      config_.stamp = stamp_;
+      has_config_ = ok;
+      break;
+    case CycleRecorder::CYCLE:
+      ok = readCycle(source, cycle_);
+      cycle_.stamp = stamp_;
+      break;
+    case CycleRecorder::RESET:
+      break;
+    default:
+      continue; // written by a newer version
+    }
+    if (!ok)
+      break;
+    return static_cast<CycleRecorder::RecordType>(record.type);
+  }
+  remaining_ = 0;
+  return CycleRecorder::WRAP;
+}
+
+} // namespace teb_local_planner
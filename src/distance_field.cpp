@@ -0,0 +1,182 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/distance_field.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace teb_local_planner {
+
+DistanceField::DistanceField()
+    : size_x_(0), size_y_(0), resolution_(1.0), origin_x_(0.0), origin_y_(0.0),
+      has_obstacles_(false) {}
+
+void DistanceField::clear() {
+  distances_.clear();
+  size_x_ = size_y_ = 0;
+  has_obstacles_ = false;
+}
+
+void DistanceField::build(const unsigned char *grid, unsigned int size_x,
+                          unsigned int size_y, double resolution,
+                          double origin_x, double origin_y,
+                          unsigned char occupied) {
+  size_x_ = size_x;
+  size_y_ = size_y;
+  resolution_ = resolution;
+  origin_x_ = origin_x;
+  origin_y_ = origin_y;
+  has_obstacles_ = false;
+
+  const float inf = std::numeric_limits<float>::max();
+  std::size_t size = (std::size_t)size_x * size_y;
+  distances_.resize(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    if (grid[i] == occupied) {
+      distances_[i] = 0;
+      has_obstacles_ = true;
+    } else {
+      distances_[i] = inf;
+    }
+  }
+  if (!has_obstacles_ || size_x < 2 || size_y < 2) {
+    has_obstacles_ = false;
+    return;
+  }
+
+  unsigned int n = std::max(size_x, size_y);
+  column_in_.resize(n);
+  column_out_.resize(n);
+  envelope_vertices_.resize(n);
+  envelope_bounds_.resize(n + 1);
+
+  // squared distances in cells, first along the columns, then along the rows
+  for (unsigned int x = 0; x < size_x; ++x) {
+    for (unsigned int y = 0; y < size_y; ++y)
+      column_in_[y] = distances_[y * size_x + x];
+    transform1D(column_in_.data(), column_out_.data(), size_y);
+    for (unsigned int y = 0; y < size_y; ++y)
+      distances_[y * size_x + x] = column_out_[y];
+  }
+  for (unsigned int y = 0; y < size_y; ++y) {
+    float *row = &distances_[y * size_x];
+    std::copy(row, row + size_x, column_in_.begin());
+    transform1D(column_in_.data(), row, size_x);
+  }
+
+  for (auto &distance : distances_)
+    distance = std::sqrt(distance) * resolution;
+}
+
+void DistanceField::transform1D(const float *f, float *d, int n) {
+  // lower envelope of the parabolas rooted at (q, f(q))
+  const float inf = std::numeric_limits<float>::max();
+  int *v = envelope_vertices_.data();
+  float *z = envelope_bounds_.data();
+
+  int k = -1;
+  for (int q = 0; q < n; ++q) {
+    if (f[q] == inf)
+      continue;
+    float s = 0;
+    while (k >= 0) {
+      s = ((f[q] + (float)q * q) - (f[v[k]] + (float)v[k] * v[k])) /
+          (2.0f * (q - v[k]));
+      if (s > z[k])
+        break;
+      --k;
+    }
+    ++k;
+    v[k] = q;
+    z[k] = k == 0 ? -inf : s;
+    z[k + 1] = inf;
+  }
+
+  if (k < 0) { // no finite value
+    std::fill(d, d + n, inf);
+    return;
+  }
+
+  k = 0;
+  for (int q = 0; q < n; ++q) {
+    while (z[k + 1] < q)
+      ++k;
+    d[q] = (float)(q - v[k]) * (q - v[k]) + f[v[k]];
+  }
+}
+
+double DistanceField::distance(
+    const Eigen::Ref<const Eigen::Vector2d> &position,
+    Eigen::Vector2d *gradient) const {
+  if (distances_.empty()) {
+    if (gradient)
+      gradient->setZero();
+    return std::numeric_limits<double>::infinity();
+  }
+
+  // continuous cell coordinates w.r.t. the cell centers
+  double gx = (position.x() - origin_x_) / resolution_ - 0.5;
+  double gy = (position.y() - origin_y_) / resolution_ - 0.5;
+  int ix = std::min(std::max((int)std::floor(gx), 0), (int)size_x_ - 2);
+  int iy = std::min(std::max((int)std::floor(gy), 0), (int)size_y_ - 2);
+  double tx = gx - ix;
+  double ty = gy - iy;
+  bool clamped_x = tx < 0 || tx > 1;
+  bool clamped_y = ty < 0 || ty > 1;
+  tx = std::min(std::max(tx, 0.0), 1.0);
+  ty = std::min(std::max(ty, 0.0), 1.0);
+
+  const float *cell = &distances_[iy * size_x_ + ix];
+  double d00 = cell[0];
+  double d10 = cell[1];
+  double d01 = cell[size_x_];
+  double d11 = cell[size_x_ + 1];
+
+  if (gradient) {
+    gradient->x() =
+        clamped_x ? 0.0
+                  : ((1 - ty) * (d10 - d00) + ty * (d11 - d01)) / resolution_;
+    gradient->y() =
+        clamped_y ? 0.0
+                  : ((1 - tx) * (d01 - d00) + tx * (d11 - d10)) / resolution_;
+  }
+
+  return (1 - tx) * (1 - ty) * d00 + tx * (1 - ty) * d10 +
+         (1 - tx) * ty * d01 + tx * ty * d11;
+}
+
+} // namespace teb_local_planner
@@ -0,0 +1,170 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/global_plan_window.h>
+
+#include <atomic>
+#include <cmath>
+
+namespace teb_local_planner {
+
+namespace {
+std::atomic<uint64_t> last_revision(0);
+} // namespace
+
+GlobalPlanWindow::GlobalPlanWindow() : cursor_(0), revision_(0) {}
+
+void GlobalPlanWindow::setPlan(
+    const std::vector<geometry_msgs::PoseStamped> &plan) {
+  clear();
+  poses_.reserve(plan.size());
+  x_.reserve(plan.size());
+  y_.reserve(plan.size());
+  arc_length_.reserve(plan.size());
+  for (std::size_t i = 0; i < plan.size(); ++i)
+    append(plan[i]);
+}
+
+void GlobalPlanWindow::clear() {
+  poses_.clear();
+  x_.clear();
+  y_.clear();
+  arc_length_.clear();
+  cursor_ = 0;
+  touch();
+}
+
+bool GlobalPlanWindow::prune(double robot_x, double robot_y,
+                             double dist_behind_robot,
+                             double max_search_length) {
+  double dist_thresh_sq = dist_behind_robot * dist_behind_robot;
+
+  // iterate plan until a pose close the robot is found, but not beyond the
+  // local window ahead of the cursor
+  for (std::size_t i = cursor_; i < x_.size(); ++i) {
+    if (max_search_length > 0 &&
+        arc_length_[i] - arc_length_[cursor_] > max_search_length)
+      break;
+    if (squaredDistance(i, robot_x, robot_y) < dist_thresh_sq) {
+      cursor_ = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+void GlobalPlanWindow::findSlice(double robot_x, double robot_y,
+                                 double dist_threshold, double max_plan_length,
+                                 std::size_t &first, std::size_t &end) const {
+  std::size_t i = cursor_;
+  double sq_dist_threshold = dist_threshold * dist_threshold;
+  double sq_dist = 1e10;
+
+  // we need to loop to a point on the plan that is within a certain
+  // distance of the robot
+  while (i < x_.size()) {
+    double new_sq_dist = squaredDistance(i, robot_x, robot_y);
+    if (new_sq_dist > sq_dist &&
+        sq_dist < sq_dist_threshold) // find first distance that is greater
+    {
+      sq_dist = new_sq_dist;
+      break;
+    }
+    sq_dist = new_sq_dist;
+    ++i;
+  }
+  first = i;
+
+  // check cumulative Euclidean distance along the plan
+  double plan_length = 0;
+
+  // now we'll take poses until they are outside of our distance threshold
+  while (i < x_.size() && sq_dist <= sq_dist_threshold &&
+         (max_plan_length <= 0 || plan_length <= max_plan_length)) {
+    sq_dist = squaredDistance(i, robot_x, robot_y);
+
+    // distance to previous pose
+    if (i > cursor_ && max_plan_length > 0)
+      plan_length += arc_length_[i] - arc_length_[i - 1];
+
+    ++i;
+  }
+  end = i;
+}
+
+void GlobalPlanWindow::transform(
+    std::size_t first, std::size_t end, const tf::Transform &plan_to_frame,
+    const ros::Time &stamp, const std::string &frame_id,
+    std::vector<geometry_msgs::PoseStamped> &transformed) const {
+  transformed.resize(end - first);
+  tf::Pose tf_pose;
+  for (std::size_t i = first; i < end; ++i) {
+    geometry_msgs::PoseStamped &pose = transformed[i - first];
+    tf::poseMsgToTF(poses_[i].pose, tf_pose);
+    tf::poseTFToMsg(plan_to_frame * tf_pose, pose.pose);
+    pose.header.stamp = stamp;
+    pose.header.frame_id = frame_id;
+  }
+}
+
+void GlobalPlanWindow::truncate(std::size_t end) {
+  if (end >= poses_.size())
+    return;
+  poses_.resize(end);
+  x_.resize(end);
+  y_.resize(end);
+  arc_length_.resize(end);
+  if (cursor_ > 0 && cursor_ >= end)
+    cursor_ = end > 0 ? end - 1 : 0;
+  touch();
+}
+
+void GlobalPlanWindow::append(const geometry_msgs::PoseStamped &pose) {
+  double x = pose.pose.position.x;
+  double y = pose.pose.position.y;
+  double arc_length = 0.0;
+  if (!x_.empty())
+    arc_length = arc_length_.back() + std::sqrt(squaredDistance(x_.size() - 1,
+                                                                x, y));
+  poses_.push_back(pose);
+  x_.push_back(x);
+  y_.push_back(y);
+  arc_length_.push_back(arc_length);
+  touch();
+}
+
+void GlobalPlanWindow::touch() { revision_ = ++last_revision; }
+
+} // namespace teb_local_planner
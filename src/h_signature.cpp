@@ -0,0 +1,181 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/h_signature.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace teb_local_planner {
+
+HSignatureCache::HSignatureCache()
+    : valid_(false), obstacles_(NULL), map_size_(0.0), prescaler_(0.0) {}
+
+void HSignatureCache::update(const ObstContainer &obstacles,
+                             const std::complex<double> &path_start,
+                             const std::complex<double> &path_end,
+                             double prescaler) {
+  // guess the map size (only a really coarse guess is required): distance
+  // from start to goal in each direction, but at least 3 m to avoid numerical
+  // instabilities
+  double map_size = std::max(std::sqrt(std::norm(path_end - path_start)), 3.0);
+  if (valid_ && obstacles_ == &obstacles &&
+      coefficients_.size() == obstacles.size() && path_start == path_start_ &&
+      map_size == map_size_ && prescaler == prescaler_)
+    return;
+
+  valid_ = true;
+  obstacles_ = &obstacles;
+  path_start_ = path_start;
+  map_size_ = map_size;
+  prescaler_ = prescaler;
+
+  std::size_t no_obstacles = obstacles.size();
+  obstacle_x_.resize(no_obstacles);
+  obstacle_y_.resize(no_obstacles);
+  for (std::size_t l = 0; l < no_obstacles; ++l) {
+    std::complex<double> centroid = obstacles[l]->getCentroidCplx();
+    obstacle_x_[l] = centroid.real();
+    obstacle_y_[l] = centroid.imag();
+  }
+  dist_.resize(no_obstacles);
+  log_dist_.resize(no_obstacles);
+  angle_.resize(no_obstacles);
+  sum_real_.resize(no_obstacles);
+  sum_imag_.resize(no_obstacles);
+
+  // guess values for f0
+  // paper proposes a+b=N-1 && |a-b|<=1, 1...N obstacles
+  int m = std::min(static_cast<int>(no_obstacles) - 1, 5);
+  int a = static_cast<int>(std::ceil(double(m) / 2.0));
+  int b = m - a;
+
+  typedef std::complex<long double> cplx;
+  cplx map_bottom_left(path_start.real(), path_start.imag() - map_size);
+  cplx map_top_right(path_start.real() + map_size,
+                     path_start.imag() + map_size);
+
+  coefficients_.resize(no_obstacles);
+  for (std::size_t l = 0; l < no_obstacles; ++l) {
+    cplx obst_l(obstacle_x_[l], obstacle_y_[l]);
+    cplx coefficient = (long double)prescaler *
+                       std::pow(obst_l - map_bottom_left, a) *
+                       std::pow(obst_l - map_top_right, b);
+    // divided by the differences to all other obstacles
+    for (std::size_t j = 0; j < no_obstacles; ++j) {
+      cplx diff = obst_l - cplx(obstacle_x_[j], obstacle_y_[j]);
+      if (j != l && (diff.real() != 0 || diff.imag() != 0))
+        coefficient /= diff;
+    }
+    coefficients_[l] = coefficient;
+  }
+}
+
+void HSignatureCache::beginPath(const std::complex<double> &point) {
+  for (std::size_t l = 0; l < obstacle_x_.size(); ++l) {
+    double dx = point.real() - obstacle_x_[l];
+    double dy = point.imag() - obstacle_y_[l];
+    dist_[l] = std::sqrt(dx * dx + dy * dy);
+    log_dist_[l] = std::log(dist_[l]);
+    angle_[l] = std::atan2(dy, dx);
+    sum_real_[l] = 0.0;
+    sum_imag_[l] = 0.0;
+  }
+}
+
+void HSignatureCache::addPoint(const std::complex<double> &point) {
+  const double x = point.real(), y = point.imag();
+  const double *obstacle_x = obstacle_x_.data();
+  const double *obstacle_y = obstacle_y_.data();
+  double *dist = dist_.data(), *log_dist = log_dist_.data();
+  double *angle = angle_.data();
+  double *sum_real = sum_real_.data(), *sum_imag = sum_imag_.data();
+
+  // branch-free over the obstacles
+  for (std::size_t l = 0, n = obstacle_x_.size(); l < n; ++l) {
+    double dx = x - obstacle_x[l];
+    double dy = y - obstacle_y[l];
+    double d = std::sqrt(dx * dx + dy * dy);
+    double log_d = std::log(d);
+    double phi = std::atan2(dy, dx);
+
+    // complex ln has more than one solution -> choose minimum abs angle
+    double delta = phi - angle[l];
+    delta += delta > M_PI ? -2 * M_PI : (delta < -M_PI ? 2 * M_PI : 0.0);
+
+    // segments touching the obstacle do not contribute
+    bool valid = d != 0.0 && dist[l] != 0.0;
+    sum_real[l] += valid ? log_d - log_dist[l] : 0.0;
+    sum_imag[l] += valid ? delta : 0.0;
+
+    dist[l] = d;
+    log_dist[l] = log_d;
+    angle[l] = phi;
+  }
+}
+
+std::complex<long double>
+HSignatureCache::segment(const std::complex<double> &from,
+                         const std::complex<double> &to) const {
+  std::complex<long double> H = 0;
+  for (std::size_t l = 0; l < coefficients_.size(); ++l) {
+    double dx_from = from.real() - obstacle_x_[l];
+    double dy_from = from.imag() - obstacle_y_[l];
+    double dx_to = to.real() - obstacle_x_[l];
+    double dy_to = to.imag() - obstacle_y_[l];
+    double d_from = std::sqrt(dx_from * dx_from + dy_from * dy_from);
+    double d_to = std::sqrt(dx_to * dx_to + dy_to * dy_to);
+    if (d_from == 0.0 || d_to == 0.0)
+      continue; // segments touching the obstacle do not contribute
+
+    // complex ln has more than one solution -> choose minimum abs angle
+    double delta = std::atan2(dy_to, dx_to) - std::atan2(dy_from, dx_from);
+    delta += delta > M_PI ? -2 * M_PI : (delta < -M_PI ? 2 * M_PI : 0.0);
+
+    H += coefficients_[l] * std::complex<long double>(
+                                std::log(d_to) - std::log(d_from), delta);
+  }
+  return H;
+}
+
+std::complex<long double> HSignatureCache::endPath() const {
+  std::complex<long double> H = 0;
+  for (std::size_t l = 0; l < coefficients_.size(); ++l)
+    H += coefficients_[l] *
+         std::complex<long double>(sum_real_[l], sum_imag_[l]);
+  return H;
+}
+
+} // namespace teb_local_planner
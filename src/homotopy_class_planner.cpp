@@ -66,13 +66,13 @@ inline std::complex<long double> getCplxFromMsgPoseStamped(const geometry_msgs::
 };
 
 
-HomotopyClassPlanner::HomotopyClassPlanner() : obstacles_(NULL), via_points_(NULL),  cfg_(NULL), robot_model_(new PointRobotFootprint()),
+HomotopyClassPlanner::HomotopyClassPlanner() : obstacles_(NULL), via_points_(NULL), via_point_ids_(NULL), cfg_(NULL), robot_model_(new PointRobotFootprint()),
                                                initial_plan_(NULL), initialized_(false)
 {
 }
 
 HomotopyClassPlanner::HomotopyClassPlanner(const TebConfig& cfg, ObstContainer* obstacles, RobotFootprintModelPtr robot_model,
-                                           TebVisualizationPtr visual, const ViaPointContainer* via_points) : initial_plan_(NULL)
+                                           TebVisualizationPtr visual, const ViaPointContainer* via_points) : via_point_ids_(NULL), initial_plan_(NULL)
 {
   initialize(cfg, obstacles, robot_model, visual, via_points);
 }
@@ -112,8 +112,6 @@ bool HomotopyClassPlanner::plan(const std::vector<geometry_msgs::PoseStamped>& i
 
   // store initial plan for further initializations (must be valid for the lifetime of this object or clearPlanner() is called!)
   initial_plan_ = &initial_plan;
-  // store the h signature of the initial plan to enable searching a matching teb later.
-  initial_plan_h_sig_ = calculateHSignature(initial_plan.begin(), initial_plan.end(), getCplxFromMsgPoseStamped, obstacles_, cfg_->hcp.h_signature_prescaler);
 
   PoseSE2 start(initial_plan.front().pose);
   PoseSE2 goal(initial_plan.back().pose);
@@ -137,6 +135,13 @@ bool HomotopyClassPlanner::plan(const PoseSE2& start, const PoseSE2& goal, const
   ROS_ASSERT_MSG(initialized_, "Call initialize() first.");
   auto start_time = ros::Time::now();
 
+  // the obstacles have been updated since the last planning interval
+  h_signature_cache_.invalidate();
+  
+  // store the h signature of the initial plan to enable searching a matching teb later.
+  if (initial_plan_)
+    initial_plan_h_sig_ = calculateHSignature(initial_plan_->begin(), initial_plan_->end(), getCplxFromMsgPoseStamped, obstacles_, cfg_->hcp.h_signature_prescaler);
+
   // Update old TEBs with new start, goal and velocity
   auto teb_update_start_time = ros::Time::now();
   updateAllTEBs(start, goal, start_vel);
@@ -231,6 +236,7 @@ void HomotopyClassPlanner::visualize()
 
 void HomotopyClassPlanner::createGraph(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst, double obstacle_heading_threshold, boost::optional<const Eigen::Vector2d&> start_velocity)
 {
+  TEB_PROFILE_SCOPE("hcp/explore/create_graph");
   // Clear existing graph and paths
   clearGraph();
 
@@ -348,15 +354,14 @@ void HomotopyClassPlanner::createGraph(const PoseSE2& start, const PoseSE2& goal
 
 
   // Find all paths between start and goal!
-  std::vector<HcGraphVertexType> visited;
-  visited.push_back(start_vtx);
-  DepthFirst(graph_,visited,goal_vtx, start.theta(), goal.theta(), start_velocity);
+  DepthFirst(start_vtx, goal_vtx, start.theta(), goal.theta(), start_velocity);
 }
 
 
 void HomotopyClassPlanner::createProbRoadmapGraph(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst, int no_samples,
                                                   double obstacle_heading_threshold, boost::optional<const Eigen::Vector2d&> start_velocity)
 {
+  TEB_PROFILE_SCOPE("hcp/explore/create_roadmap_graph");
   // Clear existing graph and paths
   clearGraph();
 
@@ -382,46 +387,30 @@ void HomotopyClassPlanner::createProbRoadmapGraph(const PoseSE2& start, const Po
 
   double area_width = cfg_->hcp.roadmap_graph_area_width;
 
-  boost::random::uniform_real_distribution<double> distribution_x(0, start_goal_dist);
-  boost::random::uniform_real_distribution<double> distribution_y(0, area_width);
-
   double phi = atan2(diff.coeffRef(1),diff.coeffRef(0)); // rotate area by this angle
   Eigen::Rotation2D<double> rot_phi(phi);
 
   Eigen::Vector2d area_origin = start.position() - 0.5*area_width*normal; // bottom left corner of the origin
 
+  // Keep the samples of the previous planning interval that are still inside the area and collision free (if enabled)
+  // and add new ones where the coverage is thin
+  if (!cfg_->hcp.roadmap_graph_incremental)
+    roadmap_.clear();
+  roadmap_.updateObstacles(*obstacles_, dist_to_obst);
+  roadmap_.updateSamples(area_origin, rot_phi, start_goal_dist, area_width, no_samples, *obstacles_, rnd_generator_,
+                         cfg_->hcp.roadmap_graph_incremental ? 8 : 1);
+
   // Insert Vertices
   HcGraphVertexType start_vtx = boost::add_vertex(graph_); // start vertex
   graph_[start_vtx].pos = start.position();
   diff.normalize(); // normalize in place
 
-
-  // Start sampling
-  for (int i=0; i < no_samples; ++i)
+  const Point2dContainer& samples = roadmap_.samples();
+  for (std::size_t i=0; i < samples.size(); ++i)
   {
-    Eigen::Vector2d sample;
-    bool coll_free;
-    do // sample as long as a collision free sample is found
-    {
-      // Sample coordinates
-      sample = area_origin + rot_phi*Eigen::Vector2d(distribution_x(rnd_generator_), distribution_y(rnd_generator_));
-
-      // Test for collision
-      coll_free = true;
-      for (ObstContainer::const_iterator it_obst = obstacles_->begin(); it_obst != obstacles_->end(); ++it_obst)
-      {
-        if ( (*it_obst)->checkCollision(sample, dist_to_obst)) // TODO really keep dist_to_obst here?
-        {
-          coll_free = false;
-          break;
-        }
-      }
-
-    } while (!coll_free && ros::ok());
-
     // Add new vertex
     HcGraphVertexType v = boost::add_vertex(graph_);
-    graph_[v].pos = sample;
+    graph_[v].pos = samples[i];
   }
 
   // Now add goal vertex
@@ -446,14 +435,21 @@ void HomotopyClassPlanner::createProbRoadmapGraph(const PoseSE2& start, const Po
           continue; // diff is already normalized
 
 
-      // Collision Check
+      // Collision Check (states of edges between samples are kept by the roadmap)
       bool collision = false;
-      for (ObstContainer::const_iterator it_obst = obstacles_->begin(); it_obst != obstacles_->end(); ++it_obst)
+      if (*it_i!=start_vtx && *it_j!=start_vtx && *it_j!=goal_vtx)
       {
-        if ( (*it_obst)->checkLineIntersection(graph_[*it_i].pos,graph_[*it_j].pos, dist_to_obst) )
+        collision = !roadmap_.segmentFree(*it_i-1, *it_j-1, *obstacles_);
+      }
+      else
+      {
+        for (ObstContainer::const_iterator it_obst = obstacles_->begin(); it_obst != obstacles_->end(); ++it_obst)
         {
-          collision = true;
-          break;
+          if ( (*it_obst)->checkLineIntersection(graph_[*it_i].pos,graph_[*it_j].pos, dist_to_obst) )
+          {
+            collision = true;
+            break;
+          }
         }
       }
       if (collision)
@@ -465,63 +461,131 @@ void HomotopyClassPlanner::createProbRoadmapGraph(const PoseSE2& start, const Po
   }
 
   /// Find all paths between start and goal!
-  std::vector<HcGraphVertexType> visited;
-  visited.push_back(start_vtx);
-  DepthFirst(graph_,visited,goal_vtx, start.theta(), goal.theta(), start_velocity);
+  DepthFirst(start_vtx, goal_vtx, start.theta(), goal.theta(), start_velocity);
 }
 
 
-void HomotopyClassPlanner::DepthFirst(HcGraph& g, std::vector<HcGraphVertexType>& visited, const HcGraphVertexType& goal,
+void HomotopyClassPlanner::DepthFirst(const HcGraphVertexType& start, const HcGraphVertexType& goal,
                                       double start_orientation, double goal_orientation, boost::optional<const Eigen::Vector2d&> start_velocity)
 {
-  // see http://www.technical-recipes.com/2011/a-recursive-algorithm-to-find-all-paths-between-two-given-nodes/ for details on finding all simple paths
+  TEB_PROFILE_SCOPE("hcp/explore/depth_first");
 
   if ((int)tebs_.size() >= cfg_->hcp.max_number_classes)
     return; // We do not need to search for further possible alternative homotopy classes.
 
-  HcGraphVertexType back = visited.back();
-
-  /// Examine adjacent nodes
-  HcGraphAdjecencyIterator it, end;
-  for ( boost::tie(it,end) = boost::adjacent_vertices(back,g); it!=end; ++it)
+  // compact adjacency (CSR) of the graph: the targets of the edges of vertex v are targets[offsets[v]...offsets[v+1]-1]
+  const int no_vertices = (int)boost::num_vertices(graph_);
+  std::vector<int> offsets(no_vertices+1, 0);
+  std::vector<int> targets;
+  targets.reserve(boost::num_edges(graph_));
+  for (int v = 0; v < no_vertices; ++v)
   {
-    if ( std::find(visited.begin(), visited.end(), *it)!=visited.end() )
-      continue; // already visited
+    HcGraphAdjecencyIterator it, end;
+    for (boost::tie(it,end) = boost::adjacent_vertices(v,graph_); it!=end; ++it)
+      targets.push_back((int)*it);
+    offsets[v+1] = (int)targets.size();
+  }
 
-    if ( *it == goal ) // goal reached
+  // the H-signature of a path is the sum of the contributions of its edges, which are computed on first use
+  h_signature_cache_.prepare(*obstacles_, std::complex<double>(getCplxFromHcGraph(start, graph_)), std::complex<double>(getCplxFromHcGraph(goal, graph_)),
+                             cfg_->hcp.h_signature_prescaler);
+  std::vector< std::complex<long double> > edge_h(targets.size());
+  std::vector<char> edge_h_valid(targets.size(), 0);
+  auto edgeHSignature = [&](int edge, int from) -> const std::complex<long double>&
+  {
+    if (!edge_h_valid[edge])
     {
-      visited.push_back(*it);
+      edge_h[edge] = h_signature_cache_.segment(std::complex<double>(getCplxFromHcGraph(from, graph_)), std::complex<double>(getCplxFromHcGraph(targets[edge], graph_)));
+      edge_h_valid[edge] = 1;
+    }
+    return edge_h[edge];
+  };
+
+  // vertices on the current path
+  std::vector<uint64_t> visited((no_vertices+63)/64, 0);
 
+  // H-signatures of the partial paths that have been expanded at each vertex.
+  // Any path continuing a partial path shares its homotopy class with the same continuation of a homotopic partial path,
+  // hence the latter is pruned. Continuations blocked by the vertices of the first partial path may be missed,
+  // which is rare since the edges of both graphs lead towards the goal.
+  std::vector< std::vector< std::complex<long double> > > expanded(no_vertices);
+
+  struct Frame
+  {
+    int vertex;
+    int next_edge; // next edge of the vertex to be examined
+    std::complex<long double> H; // H-signature of the path from the start to the vertex
+  };
+  std::vector<Frame> stack;
+  std::vector<HcGraphVertexType> path; // vertices of the stack, followed by the goal while a TEB is initialized
+
+  // wall time available for the search
+  ros::WallTime deadline;
+  if (cfg_->hcp.exploration_time_budget > 0)
+    deadline = ros::WallTime::now() + ros::WallDuration(cfg_->hcp.exploration_time_budget);
+  if (!deadline_.isZero() && (deadline.isZero() || deadline_ < deadline))
+    deadline = deadline_;
+
+  // push a vertex and check whether the goal is adjacent
+  auto expand = [&](int vertex, const std::complex<long double>& H)
+  {
+    Frame frame = {vertex, offsets[vertex], H};
+    stack.push_back(frame);
+    path.push_back(vertex);
+    visited[vertex/64] |= uint64_t(1) << (vertex%64);
 
-      // check H-Signature
-      std::complex<long double> H = calculateHSignature(visited.begin(), visited.end(), boost::bind(getCplxFromHcGraph, _1, boost::cref(graph_)), obstacles_, cfg_->hcp.h_signature_prescaler);
+    for (int edge = offsets[vertex]; edge < offsets[vertex+1]; ++edge)
+    {
+      if (targets[edge] != (int)goal)
+        continue;
 
       // check if H-Signature is already known
       // and init new TEB if no duplicate was found
-      if ( addHSignatureIfNew(H) )
+      path.push_back(goal);
+      if ( addHSignatureIfNew(H + edgeHSignature(edge, vertex)) )
       {
-        addAndInitNewTeb(visited.begin(), visited.end(), boost::bind(getVector2dFromHcGraph, _1, boost::cref(graph_)), start_orientation, goal_orientation, start_velocity);
+        addAndInitNewTeb(path.begin(), path.end(), boost::bind(getVector2dFromHcGraph, _1, boost::cref(graph_)), start_orientation, goal_orientation, start_velocity);
       }
-
-      visited.pop_back();
+      path.pop_back();
       break;
     }
-}
+  };
 
-/// Recursion for all adjacent vertices
-for ( boost::tie(it,end) = boost::adjacent_vertices(back,g); it!=end; ++it)
-{
-  if ( std::find(visited.begin(), visited.end(), *it)!=visited.end() || *it == goal)
-    continue; // already visited || goal reached
-
-
-  visited.push_back(*it);
+  expand(start, std::complex<long double>(0,0));
+  unsigned int iterations = 0;
+  while (!stack.empty() && (int)tebs_.size() < cfg_->hcp.max_number_classes)
+  {
+    if (!deadline.isZero() && (++iterations % 64) == 0 && ros::WallTime::now() > deadline)
+    {
+      ROS_DEBUG("HomotopyClassPlanner::DepthFirst(): time budget exceeded, stopping the exploration with %u candidates.", (unsigned int)tebs_.size());
+      break;
+    }
 
-  // recursion step
-  DepthFirst(g, visited, goal, start_orientation, goal_orientation, start_velocity);
+    Frame& top = stack.back();
+    if (top.next_edge == offsets[top.vertex+1]) // all adjacent vertices examined
+    {
+      visited[top.vertex/64] &= ~(uint64_t(1) << (top.vertex%64));
+      stack.pop_back();
+      path.pop_back();
+      continue;
+    }
 
-  visited.pop_back();
-}
+    int edge = top.next_edge++;
+    int next = targets[edge];
+    if ( next == (int)goal || (visited[next/64] >> (next%64)) & 1 )
+      continue; // goal reached (handled in expand) || already visited
+
+    std::complex<long double> H = top.H + edgeHSignature(edge, top.vertex);
+    std::vector< std::complex<long double> >& expanded_next = expanded[next];
+    bool homotopic = false;
+    for (std::size_t i = 0; i < expanded_next.size() && !homotopic; ++i)
+      homotopic = isHSignatureSimilar(expanded_next[i], H, cfg_->hcp.h_signature_threshold);
+    if (homotopic)
+      continue; // a homotopic partial path has already been expanded at this vertex
+
+    expanded_next.push_back(H);
+    expand(next, H);
+  }
 }
 
 
@@ -561,6 +625,7 @@ inline bool compareH( std::pair<TebOptPlannerContainer::iterator, std::complex<l
 
 void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
 {
+  TEB_PROFILE_SCOPE("hcp/renew_tebs");
   // clear old h-signatures (since they could be changed due to new obstacle positions.
   h_signatures_.clear();
 
@@ -659,6 +724,7 @@ void HomotopyClassPlanner::updateReferenceTrajectoryViaPoints(bool all_trajector
     for (std::size_t i=0; i < h_signatures_.size(); ++i)
     {
         tebs_[i]->setViaPoints(via_points_);
+        tebs_[i]->setViaPointIds(via_point_ids_);
     }
   }
   else
@@ -667,9 +733,15 @@ void HomotopyClassPlanner::updateReferenceTrajectoryViaPoints(bool all_trajector
     for (std::size_t i=0; i < h_signatures_.size(); ++i)
     {
       if (isHSignatureSimilar(h_signatures_[i].first, initial_plan_h_sig_, cfg_->hcp.h_signature_threshold))
+      {
         tebs_[i]->setViaPoints(via_points_);
+        tebs_[i]->setViaPointIds(via_point_ids_);
+      }
       else
+      {
         tebs_[i]->setViaPoints(NULL);
+        tebs_[i]->setViaPointIds(NULL);
+      }
     }
   }
 }
@@ -677,6 +749,7 @@ void HomotopyClassPlanner::updateReferenceTrajectoryViaPoints(bool all_trajector
 
 void HomotopyClassPlanner::exploreHomotopyClassesAndInitTebs(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst, boost::optional<const Eigen::Vector2d&> start_vel)
 {
+  TEB_PROFILE_SCOPE("hcp/explore");
   // first process old trajectories
   renewAndAnalyzeOldTebs(false);
 
@@ -712,6 +785,7 @@ void HomotopyClassPlanner::addAndInitNewTeb(const std::vector<geometry_msgs::Pos
 
 void HomotopyClassPlanner::updateAllTEBs(boost::optional<const PoseSE2&> start, boost::optional<const PoseSE2&> goal,  boost::optional<const Eigen::Vector2d&> start_velocity)
 {
+  TEB_PROFILE_SCOPE("hcp/update_all_tebs");
   // If new goal is too far away, clear all existing trajectories to let them reinitialize later.
   // Since all Tebs are sharing the same fixed goal pose, just take the first candidate:
   if (!tebs_.empty() && (goal->position() - tebs_.front()->teb().BackPose().position()).norm() >= cfg_->trajectory.force_reinit_new_goal_dist)
@@ -733,27 +807,59 @@ void HomotopyClassPlanner::updateAllTEBs(boost::optional<const PoseSE2&> start,
 
 void HomotopyClassPlanner::optimizeAllTEBs(unsigned int iter_innerloop, unsigned int iter_outerloop)
 {
-  teb_local_planner::OptimizationCostArray *op_costs = NULL;
+  TEB_PROFILE_SCOPE("hcp/optimize_all_tebs");
+  // rank the candidates by their last cost, such that the promising ones finish first and may cancel the others
+  std::vector<std::size_t> order(tebs_.size());
+  last_costs_.resize(tebs_.size());
+  for (std::size_t i = 0; i < tebs_.size(); ++i)
+  {
+    order[i] = i;
+    last_costs_[i] = tebs_[i]->isOptimized() ? tebs_[i]->getCurrentCost() : HUGE_VAL;
+    tebs_[i]->cancelOptimization(false);
+    tebs_[i]->setDeadline(deadline_);
+  }
+  std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) { return last_costs_[a] < last_costs_[b]; });
 
   // optimize TEBs in parallel since they are independend of each other
   if (cfg_->hcp.enable_multithreading)
   {
-    boost::thread_group teb_threads;
-    for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
-    {
-      teb_threads.create_thread( boost::bind(&TebOptimalPlanner::optimizeTEB, it_teb->get(), iter_innerloop, iter_outerloop,
-                                             true, cfg_->hcp.selection_obst_cost_scale, cfg_->hcp.selection_viapoint_cost_scale,
-                                             cfg_->hcp.selection_alternative_time_cost, op_costs) );
-    }
-    teb_threads.join_all();
+    unsigned int no_threads = cfg_->hcp.no_optimization_threads > 0 ? cfg_->hcp.no_optimization_threads
+                                                                    : boost::thread::hardware_concurrency();
+    no_threads = std::max(no_threads, 1u);
+    if (!thread_pool_ || thread_pool_->size() != no_threads)
+      thread_pool_.reset(new ThreadPool(no_threads));
+
+    std::vector<ThreadPool::Task> tasks;
+    tasks.reserve(order.size());
+    for (std::size_t idx : order)
+      tasks.push_back(boost::bind(&HomotopyClassPlanner::optimizeCandidate, this, idx, iter_innerloop, iter_outerloop));
+    thread_pool_->run(tasks);
   }
   else
   {
-    for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
-    {
-      it_teb->get()->optimizeTEB(iter_innerloop,iter_outerloop, true, cfg_->hcp.selection_obst_cost_scale,
-                                 cfg_->hcp.selection_viapoint_cost_scale, cfg_->hcp.selection_alternative_time_cost, op_costs); // compute cost as well inside optimizeTEB (last argument = true)
-    }
+    for (std::size_t idx : order)
+      optimizeCandidate(idx, iter_innerloop, iter_outerloop);
+  }
+}
+
+void HomotopyClassPlanner::optimizeCandidate(std::size_t idx, unsigned int iter_innerloop, unsigned int iter_outerloop)
+{
+  teb_local_planner::OptimizationCostArray *op_costs = NULL;
+  TebOptimalPlanner* teb = tebs_[idx].get();
+
+  // compute cost as well inside optimizeTEB (third argument = true)
+  bool success = teb->optimizeTEB(iter_innerloop, iter_outerloop, true, cfg_->hcp.selection_obst_cost_scale,
+                                  cfg_->hcp.selection_viapoint_cost_scale, cfg_->hcp.selection_alternative_time_cost, op_costs);
+  // only a converged cost is a reliable bound, the cost of a candidate that merely did not fail may still drop
+  if (!success || teb->getStopReason() != TebOptimalPlanner::STOP_CONVERGED || cfg_->hcp.cancel_cost_ratio <= 1.0)
+    return;
+
+  // the cancellation requests are atomic and all other members are only read here
+  double scaled_cost = teb->getCurrentCost() * cfg_->hcp.cancel_cost_ratio;
+  for (std::size_t i = 0; i < tebs_.size(); ++i)
+  {
+    if (i != idx && tebs_[i] != best_teb_ && last_costs_[i] != HUGE_VAL && scaled_cost < last_costs_[i])
+      tebs_[i]->cancelOptimization();
   }
 }
 
@@ -794,6 +900,7 @@ void HomotopyClassPlanner::deleteTebDetours(double threshold)
 
 TebOptimalPlannerPtr HomotopyClassPlanner::selectBestTeb()
 {
+  TEB_PROFILE_SCOPE("hcp/select_best_teb");
   double min_cost = std::numeric_limits<double>::max(); // maximum cost
 
   // check if last best_teb is still a valid candidate
@@ -810,6 +917,9 @@ TebOptimalPlannerPtr HomotopyClassPlanner::selectBestTeb()
     if (*it_teb == best_teb_)
       continue; // skip already known cost value of the last best_teb
 
+    if (it_teb->get()->isOptimizationCancelled())
+      continue; // the cost has not been updated in this cycle
+
     double teb_cost = it_teb->get()->getCurrentCost();
 
     if (teb_cost < min_cost)
@@ -819,6 +929,20 @@ TebOptimalPlannerPtr HomotopyClassPlanner::selectBestTeb()
       min_cost = teb_cost;
     }
   }
+
+  // the candidate that caused the cancellations might have been deleted as a detour
+  if (!best_teb_)
+  {
+    for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
+    {
+      double teb_cost = it_teb->get()->getCurrentCost();
+      if (teb_cost < min_cost)
+      {
+        best_teb_ = *it_teb;
+        min_cost = teb_cost;
+      }
+    }
+  }
   return best_teb_;
 }
 
@@ -0,0 +1,283 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/homotopy_roadmap.h>
+
+#include <ros/ros.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+
+namespace teb_local_planner {
+
+HomotopyRoadmap::HomotopyRoadmap() : dist_to_obst_(0.0) {}
+
+void HomotopyRoadmap::clear() {
+  samples_.clear();
+  states_.clear();
+  blockers_.clear();
+  obstacle_keys_.clear();
+}
+
+long HomotopyRoadmap::quantize(double coordinate) {
+  return std::lround(coordinate / KEY_RESOLUTION);
+}
+
+void HomotopyRoadmap::hashPoint(std::size_t &seed,
+                                const Eigen::Vector2d &point) {
+  boost::hash_combine(seed, quantize(point.x()));
+  boost::hash_combine(seed, quantize(point.y()));
+}
+
+HomotopyRoadmap::ObstacleKey HomotopyRoadmap::key(const Obstacle &obstacle) {
+  const Eigen::Vector2d &centroid = obstacle.getCentroid();
+  ObstacleKey key;
+  key.x = quantize(centroid.x());
+  key.y = quantize(centroid.y());
+  key.type = typeid(obstacle).hash_code();
+
+  // obstacles with the same centroid may differ in shape
+  key.geometry = 0;
+  if (const LineObstacle *line =
+          dynamic_cast<const LineObstacle *>(&obstacle)) {
+    hashPoint(key.geometry, line->start());
+    hashPoint(key.geometry, line->end());
+  } else if (const PolygonObstacle *polygon =
+                 dynamic_cast<const PolygonObstacle *>(&obstacle)) {
+    boost::hash_combine(key.geometry, polygon->vertices().size());
+    for (const Eigen::Vector2d &vertex : polygon->vertices())
+      hashPoint(key.geometry, vertex);
+  }
+  return key;
+}
+
+void HomotopyRoadmap::updateObstacles(const ObstContainer &obstacles,
+                                      double dist_to_obst) {
+  if (dist_to_obst != dist_to_obst_) {
+    clear();
+    dist_to_obst_ = dist_to_obst;
+  }
+
+  keys_.clear();
+  for (std::size_t i = 0; i < obstacles.size(); ++i)
+    keys_.push_back(std::make_pair(key(*obstacles[i]), i));
+  std::sort(keys_.begin(), keys_.end(),
+            [](const std::pair<ObstacleKey, std::size_t> &a,
+               const std::pair<ObstacleKey, std::size_t> &b) {
+              return a.first < b.first;
+            });
+
+  // merge with the sorted keys of the previous interval
+  added_.clear();
+  removed_.clear();
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < keys_.size(); ++i) {
+    while (k < obstacle_keys_.size() && obstacle_keys_[k] < keys_[i].first)
+      removed_.push_back(obstacle_keys_[k++]);
+    if (k < obstacle_keys_.size() && obstacle_keys_[k] == keys_[i].first)
+      ++k;
+    else
+      added_.push_back(keys_[i].second);
+  }
+  removed_.insert(removed_.end(), obstacle_keys_.begin() + k,
+                  obstacle_keys_.end());
+
+  obstacle_keys_.resize(keys_.size());
+  for (std::size_t i = 0; i < keys_.size(); ++i)
+    obstacle_keys_[i] = keys_[i].first;
+
+  if (samples_.empty() || (added_.empty() && removed_.empty()))
+    return;
+
+  // samples colliding with new obstacles are dropped
+  std::vector<bool> keep(samples_.size(), true);
+  for (std::size_t i = 0; i < samples_.size(); ++i) {
+    for (std::size_t a = 0; a < added_.size() && keep[i]; ++a)
+      keep[i] = !obstacles[added_[a]]->checkCollision(samples_[i],
+                                                       dist_to_obst_);
+  }
+
+  // free segments may be blocked by new obstacles, blocked ones may be free
+  // once the obstacle blocking them is gone
+  for (std::size_t i = 0; i < samples_.size(); ++i) {
+    if (!keep[i])
+      continue;
+    for (std::size_t j = i + 1; j < samples_.size(); ++j) {
+      if (!keep[j])
+        continue;
+      std::size_t index = segmentIndex(i, j, samples_.size());
+      if (states_[index] == FREE) {
+        for (std::size_t a = 0; a < added_.size(); ++a) {
+          const Obstacle &obstacle = *obstacles[added_[a]];
+          if (obstacle.checkLineIntersection(samples_[i], samples_[j],
+                                             dist_to_obst_)) {
+            states_[index] = BLOCKED;
+            blockers_[index] = key(obstacle);
+            break;
+          }
+        }
+      } else if (states_[index] == BLOCKED &&
+                 std::binary_search(removed_.begin(), removed_.end(),
+                                    blockers_[index])) {
+        states_[index] = UNKNOWN;
+      }
+    }
+  }
+
+  removeSamples(keep);
+}
+
+void HomotopyRoadmap::updateSamples(const Eigen::Vector2d &origin,
+                                    const Eigen::Rotation2D<double> &rotation,
+                                    double length, double width,
+                                    int no_samples,
+                                    const ObstContainer &obstacles,
+                                    boost::random::mt19937 &generator,
+                                    int candidates) {
+  // drop the samples outside of the area and surplus ones
+  Eigen::Rotation2D<double> inverse = rotation.inverse();
+  std::vector<bool> keep(samples_.size());
+  int no_kept = 0;
+  for (std::size_t i = 0; i < samples_.size(); ++i) {
+    Eigen::Vector2d local = inverse * (samples_[i] - origin);
+    keep[i] = no_kept < no_samples && local.x() >= 0 && local.x() <= length &&
+              local.y() >= 0 && local.y() <= width;
+    if (keep[i])
+      ++no_kept;
+  }
+  removeSamples(keep);
+
+  // new samples are appended, their states are added once all are sampled
+  const std::size_t no_old_samples = samples_.size();
+  boost::random::uniform_real_distribution<double> distribution_x(0, length);
+  boost::random::uniform_real_distribution<double> distribution_y(0, width);
+  while (static_cast<int>(samples_.size()) < no_samples) {
+    Eigen::Vector2d sample;
+    bool coll_free;
+    do // sample as long as a collision free sample is found
+    {
+      // candidate farthest from the existing samples
+      double best_dist = -1;
+      for (int c = 0; c < std::max(candidates, 1); ++c) {
+        Eigen::Vector2d candidate =
+            origin + rotation * Eigen::Vector2d(distribution_x(generator),
+                                                distribution_y(generator));
+        double dist = HUGE_VAL;
+        for (std::size_t i = 0; i < samples_.size(); ++i)
+          dist = std::min(dist, (samples_[i] - candidate).squaredNorm());
+        if (dist > best_dist) {
+          best_dist = dist;
+          sample = candidate;
+        }
+      }
+
+      coll_free = true;
+      for (ObstContainer::const_iterator it_obst = obstacles.begin();
+           it_obst != obstacles.end(); ++it_obst) {
+        if ((*it_obst)->checkCollision(sample, dist_to_obst_)) {
+          coll_free = false;
+          break;
+        }
+      }
+    } while (!coll_free && ros::ok());
+
+    samples_.push_back(sample);
+  }
+
+  if (samples_.size() > no_old_samples) {
+    std::vector<std::size_t> old_index(samples_.size());
+    for (std::size_t a = 0; a < old_index.size(); ++a)
+      old_index[a] = a;
+    remapStates(old_index, no_old_samples);
+  }
+}
+
+bool HomotopyRoadmap::segmentFree(std::size_t i, std::size_t j,
+                                  const ObstContainer &obstacles) {
+  std::size_t index = segmentIndex(i, j, samples_.size());
+  if (states_[index] == UNKNOWN) {
+    states_[index] = FREE;
+    for (ObstContainer::const_iterator it_obst = obstacles.begin();
+         it_obst != obstacles.end(); ++it_obst) {
+      if ((*it_obst)->checkLineIntersection(samples_[i], samples_[j],
+                                            dist_to_obst_)) {
+        states_[index] = BLOCKED;
+        blockers_[index] = key(**it_obst);
+        break;
+      }
+    }
+  }
+  return states_[index] == FREE;
+}
+
+void HomotopyRoadmap::removeSamples(const std::vector<bool> &keep) {
+  std::vector<std::size_t> old_index;
+  for (std::size_t i = 0; i < samples_.size(); ++i)
+    if (keep[i])
+      old_index.push_back(i);
+  if (old_index.size() == samples_.size())
+    return;
+
+  remapStates(old_index, samples_.size());
+  for (std::size_t a = 0; a < old_index.size(); ++a)
+    samples_[a] = samples_[old_index[a]];
+  samples_.resize(old_index.size());
+}
+
+void HomotopyRoadmap::remapStates(const std::vector<std::size_t> &old_index,
+                                  std::size_t old_size) {
+  const std::size_t size = old_index.size();
+  // the blockers are only read for blocked segments, so stale ones are fine
+  states_buffer_.assign(size * size, UNKNOWN);
+  blockers_buffer_.resize(size * size);
+  for (std::size_t a = 0; a < size; ++a) {
+    if (old_index[a] >= old_size)
+      continue;
+    for (std::size_t b = a + 1; b < size; ++b) {
+      if (old_index[b] >= old_size)
+        continue;
+      std::size_t index = segmentIndex(old_index[a], old_index[b], old_size);
+      states_buffer_[a * size + b] = states_[index];
+      blockers_buffer_[a * size + b] = blockers_[index];
+    }
+  }
+  states_.swap(states_buffer_);
+  blockers_.swap(blockers_buffer_);
+}
+
+} // namespace teb_local_planner
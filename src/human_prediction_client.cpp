@@ -0,0 +1,219 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/human_prediction_client.h>
+
+#include <std_srvs/Empty.h>
+#include <std_srvs/SetBool.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+
+#define THROTTLE_RATE 5.0 // seconds
+
+namespace teb_local_planner {
+
+HumanPredictionClient::HumanPredictionClient()
+    : request_id_(1), rate_(10.0), publish_markers_(true),
+      reset_requested_(false), stop_(false), front_(0), front_request_id_(0) {}
+
+HumanPredictionClient::~HumanPredictionClient() { stop(); }
+
+void HumanPredictionClient::start(double rate) {
+  stop();
+  setRate(rate);
+  stop_ = false;
+  thread_ = boost::thread(boost::bind(&HumanPredictionClient::work, this));
+}
+
+void HumanPredictionClient::stop() {
+  {
+    boost::mutex::scoped_lock l(mutex_);
+    stop_ = true;
+  }
+  wake_up_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void HumanPredictionClient::setRate(double rate) {
+  boost::mutex::scoped_lock l(mutex_);
+  rate_ = rate;
+}
+
+void HumanPredictionClient::setRequest(
+    const hanp_prediction::HumanPosePredict::Request &request) {
+  boost::mutex::scoped_lock l(mutex_);
+  if (request.type == request_.type &&
+      request.predict_times == request_.predict_times)
+    return;
+  request_ = request;
+  ++request_id_;
+  wake_up_.notify_all();
+}
+
+void HumanPredictionClient::setPublishMarkers(bool publish_markers) {
+  boost::mutex::scoped_lock l(mutex_);
+  publish_markers_ = publish_markers;
+}
+
+void HumanPredictionClient::reset() {
+  boost::mutex::scoped_lock l(mutex_);
+  reset_requested_ = true;
+  ++request_id_;
+  wake_up_.notify_all();
+}
+
+bool HumanPredictionClient::latest(Snapshot &snapshot) const {
+  boost::mutex::scoped_lock l(mutex_);
+  if (front_request_id_ != request_id_)
+    return false;
+  snapshot = buffers_[front_];
+  return true;
+}
+
+void HumanPredictionClient::extrapolate(const tf::TransformListener &tf,
+                                        Predictions &humans, double dt) {
+  for (auto &human : humans) {
+    if (human.poses.empty())
+      continue;
+
+    // the velocity may be given in another frame than the poses
+    const std::string &pose_frame = human.poses.front().header.frame_id;
+    const std::string &twist_frame = human.start_velocity.header.frame_id;
+    tf::Vector3 velocity(human.start_velocity.twist.linear.x,
+                         human.start_velocity.twist.linear.y, 0.0);
+    if (!twist_frame.empty() && twist_frame != pose_frame) {
+      try {
+        tf::StampedTransform twist_to_pose;
+        tf.lookupTransform(pose_frame, twist_frame, ros::Time(0),
+                           twist_to_pose);
+        velocity = twist_to_pose.getBasis() * velocity;
+      } catch (tf::TransformException &ex) {
+        ROS_WARN_THROTTLE(THROTTLE_RATE,
+                          "Not extrapolating the human %ld prediction, could "
+                          "not look up the transformation from %s to %s: %s",
+                          human.id, twist_frame.c_str(), pose_frame.c_str(),
+                          ex.what());
+        continue;
+      }
+    }
+
+    double dx = velocity.x() * dt;
+    double dy = velocity.y() * dt;
+    for (auto &pose : human.poses) {
+      pose.pose.pose.position.x += dx;
+      pose.pose.pose.position.y += dy;
+    }
+  }
+}
+
+void HumanPredictionClient::work() {
+  // persistent connections, created again after the server went down
+  ros::NodeHandle nh;
+  ros::ServiceClient predict_client, reset_client, markers_client;
+  int markers_state = -1; // last state set on the server (-1: unknown)
+
+  boost::mutex::scoped_lock l(mutex_);
+  while (!stop_) {
+    hanp_prediction::HumanPosePredict predict_srv;
+    predict_srv.request = request_;
+    unsigned long request_id = request_id_;
+    bool reset = reset_requested_;
+    reset_requested_ = false;
+    bool publish_markers = publish_markers_;
+    boost::posix_time::ptime next_request =
+        boost::posix_time::microsec_clock::universal_time() +
+        boost::posix_time::microseconds(
+            static_cast<long>(1e6 / std::max(rate_, 0.1)));
+    l.unlock();
+
+    if (reset) {
+      ROS_INFO("Resetting human pose prediction");
+      if (!reset_client.isValid())
+        reset_client = nh.serviceClient<std_srvs::Empty>(
+            RESET_PREDICTION_SERVICE_NAME, true);
+      std_srvs::Empty empty_srv;
+      if (!reset_client.call(empty_srv))
+        ROS_WARN_THROTTLE(
+            THROTTLE_RATE,
+            "Failed to call %s service, is human prediction server running?",
+            RESET_PREDICTION_SERVICE_NAME);
+    }
+
+    if (markers_state != static_cast<int>(publish_markers)) {
+      if (!markers_client.isValid())
+        markers_client = nh.serviceClient<std_srvs::SetBool>(
+            PUBLISH_MARKERS_SRV_NAME, true);
+      std_srvs::SetBool markers_srv;
+      markers_srv.request.data = publish_markers;
+      if (markers_client.call(markers_srv))
+        markers_state = publish_markers;
+      else
+        ROS_WARN_THROTTLE(
+            THROTTLE_RATE,
+            "Failed to call %s service, is human prediction server running?",
+            PUBLISH_MARKERS_SRV_NAME);
+    }
+
+    if (!predict_client.isValid())
+      predict_client = nh.serviceClient<hanp_prediction::HumanPosePredict>(
+          PREDICT_SERVICE_NAME, true);
+    ros::Time stamp = ros::Time::now();
+    bool received = predict_client.call(predict_srv);
+    if (received) {
+      Snapshot &back = buffers_[1 - front_];
+      back.stamp = stamp;
+      back.humans.swap(predict_srv.response.predicted_humans_poses);
+    } else {
+      ROS_WARN_THROTTLE(
+          THROTTLE_RATE,
+          "Failed to call %s service, is human prediction server running?",
+          PREDICT_SERVICE_NAME);
+    }
+
+    l.lock();
+    // responses to an outdated request or from before a reset are dropped
+    if (received && request_id == request_id_) {
+      front_ = 1 - front_;
+      front_request_id_ = request_id;
+    }
+    if (!stop_ && request_id == request_id_ && !reset_requested_)
+      wake_up_.timed_wait(l, next_request);
+  }
+}
+
+} // namespace teb_local_planner
@@ -0,0 +1,141 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/interaction_filter.h>
+
+#include <algorithm>
+
+namespace teb_local_planner {
+
+TrajectorySweep::TrajectorySweep()
+    : box_min_(Eigen::Vector2d::Zero()), box_max_(Eigen::Vector2d::Zero()),
+      max_vel_(0.0), margin_(0.0) {}
+
+void TrajectorySweep::build(const TimedElasticBand &teb, double max_vel,
+                            double margin) {
+  max_vel_ = max_vel;
+  margin_ = margin;
+  positions_.resize(teb.sizePoses());
+  times_.resize(teb.sizePoses());
+
+  double time = 0.0;
+  for (unsigned int i = 0; i < teb.sizePoses(); ++i) {
+    positions_[i] = teb.Pose(i).position();
+    times_[i] = time;
+    if (i < teb.sizeTimeDiffs())
+      time += teb.TimeDiff(i);
+  }
+
+  if (positions_.empty()) {
+    box_min_.setZero();
+    box_max_.setZero();
+    return;
+  }
+  box_min_ = box_max_ = positions_.front();
+  for (const Eigen::Vector2d &position : positions_) {
+    box_min_ = box_min_.cwiseMin(position);
+    box_max_ = box_max_.cwiseMax(position);
+  }
+}
+
+void associatePosesByIndex(const TrajectorySweep &a, const TrajectorySweep &b,
+                           PosePairs &pairs) {
+  std::size_t size = std::min(a.size(), b.size());
+  pairs.resize(size);
+  for (std::size_t k = 0; k < size; ++k)
+    pairs[k] = std::make_pair(k, k);
+}
+
+void associatePosesByTime(const TrajectorySweep &a, const TrajectorySweep &b,
+                          bool segments, PosePairs &pairs) {
+  pairs.clear();
+  // number of poses, resp. segments
+  std::size_t size_a = a.size(), size_b = b.size();
+  if (segments && size_a > 0 && size_b > 0) {
+    --size_a;
+    --size_b;
+  }
+  if (size_a == 0 || size_b == 0)
+    return;
+
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < size_a; ++i) {
+    double time = a.time(i);
+    if (time > b.time(b.size() - 1))
+      break; // beyond the end of b
+
+    // last pose of b that is not later
+    while (j + 1 < b.size() && b.time(j + 1) <= time)
+      ++j;
+
+    std::size_t match = j;
+    if (segments)
+      match = std::min(j, size_b - 1);
+    else if (j + 1 < b.size() && b.time(j + 1) - time < time - b.time(j))
+      match = j + 1;
+    pairs.push_back(std::make_pair(i, match));
+  }
+}
+
+void filterInteractingPoses(const TrajectorySweep &a, const TrajectorySweep &b,
+                            double range, PosePairs &pairs) {
+  if (pairs.empty())
+    return;
+
+  // broad phase: gap between the inflated boxes
+  double inflation = a.margin_ + b.margin_;
+  Eigen::Vector2d gap = (a.box_min_ - b.box_max_)
+                            .cwiseMax(b.box_min_ - a.box_max_)
+                            .cwiseMax(Eigen::Vector2d::Zero());
+  if (gap.norm() > range + inflation) {
+    pairs.clear();
+    return;
+  }
+
+  double start_dist = (a.positions_.front() - b.positions_.front()).norm();
+  double range_sq = (range + inflation) * (range + inflation);
+  auto cannot_interact = [&](const std::pair<unsigned int, unsigned int> &p) {
+    double reach =
+        a.max_vel_ * a.times_[p.first] + b.max_vel_ * b.times_[p.second];
+    if (start_dist > range + reach)
+      return true; // not reachable yet
+    return (a.positions_[p.first] - b.positions_[p.second]).squaredNorm() >
+           range_sq;
+  };
+  pairs.erase(std::remove_if(pairs.begin(), pairs.end(), cannot_interact),
+              pairs.end());
+}
+
+} // namespace teb_local_planner
@@ -0,0 +1,146 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Human prediction server for testing the planner without a tracker: the
+// humans walk on parallel lines with constant velocity and the predictions
+// can be delayed to simulate a slow server.
+// Parameters: ~no_humans (3), ~velocity (0.8 m/s), ~latency (0.0 s),
+// ~frame_id ("map")
+
+#include <teb_local_planner/human_prediction_client.h>
+
+#include <std_srvs/Empty.h>
+#include <std_srvs/SetBool.h>
+
+#include <cmath>
+
+#define LANE_LENGTH 10.0 // meters
+#define DEFAULT_PREDICT_TIME 5.0 // seconds
+#define DEFAULT_PREDICT_STEPS 10
+
+namespace {
+int no_humans;
+double velocity, latency;
+std::string frame_id;
+ros::Time start_time;
+
+//! Position of a human walking back and forth along its lane
+void humanState(int id, const ros::Time &time, double &x, double &y,
+                double &vy) {
+  double period = 2.0 * LANE_LENGTH / velocity;
+  double phase = std::fmod((time - start_time).toSec() + id * 1.7, period);
+  x = 1.5 * id;
+  if (phase * velocity < LANE_LENGTH) {
+    y = -LANE_LENGTH / 2.0 + phase * velocity;
+    vy = velocity;
+  } else {
+    y = LANE_LENGTH * 1.5 - phase * velocity;
+    vy = -velocity;
+  }
+}
+
+bool predict(hanp_prediction::HumanPosePredict::Request &req,
+             hanp_prediction::HumanPosePredict::Response &res) {
+  ros::Time now = ros::Time::now();
+  if (latency > 0.0)
+    ros::Duration(latency).sleep();
+
+  std::vector<double> predict_times = req.predict_times;
+  if (predict_times.empty())
+    for (int i = 0; i <= DEFAULT_PREDICT_STEPS; ++i)
+      predict_times.push_back(DEFAULT_PREDICT_TIME * i / DEFAULT_PREDICT_STEPS);
+
+  for (int id = 0; id < no_humans; ++id) {
+    hanp_prediction::PredictedPoses human;
+    human.id = id + 1;
+    double x, y, vy;
+    humanState(id, now, x, y, vy);
+    human.start_velocity.header.stamp = now;
+    human.start_velocity.header.frame_id = frame_id;
+    human.start_velocity.twist.linear.y = vy;
+    double yaw = vy > 0 ? M_PI_2 : -M_PI_2;
+
+    // constant velocity prediction, like the velocity obstacle mode
+    for (double t : predict_times) {
+      geometry_msgs::PoseWithCovarianceStamped pose;
+      pose.header.stamp = now + ros::Duration(t);
+      pose.header.frame_id = frame_id;
+      pose.pose.pose.position.x = x;
+      pose.pose.pose.position.y = y + vy * t;
+      pose.pose.pose.orientation.z = std::sin(yaw / 2.0);
+      pose.pose.pose.orientation.w = std::cos(yaw / 2.0);
+      human.poses.push_back(pose);
+    }
+    res.predicted_humans_poses.push_back(human);
+  }
+  return true;
+}
+
+bool reset(std_srvs::Empty::Request &, std_srvs::Empty::Response &) {
+  ROS_INFO("Prediction reset");
+  return true;
+}
+
+bool publishMarkers(std_srvs::SetBool::Request &req,
+                    std_srvs::SetBool::Response &res) {
+  ROS_INFO("Prediction markers %s", req.data ? "enabled" : "disabled");
+  res.success = true;
+  return true;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  ros::init(argc, argv, "mock_human_prediction");
+  ros::NodeHandle nh, private_nh("~");
+  private_nh.param("no_humans", no_humans, 3);
+  private_nh.param("velocity", velocity, 0.8);
+  private_nh.param("latency", latency, 0.0);
+  private_nh.param("frame_id", frame_id, std::string("map"));
+  if (velocity <= 0.0)
+    velocity = 0.8;
+  start_time = ros::Time::now();
+
+  ros::ServiceServer predict_server =
+      nh.advertiseService(PREDICT_SERVICE_NAME, predict);
+  ros::ServiceServer reset_server =
+      nh.advertiseService(RESET_PREDICTION_SERVICE_NAME, reset);
+  ros::ServiceServer markers_server =
+      nh.advertiseService(PUBLISH_MARKERS_SRV_NAME, publishMarkers);
+
+  ROS_INFO("Mock human prediction: %d humans, %.2f s latency", no_humans,
+           latency);
+  ros::spin();
+  return 0;
+}
@@ -0,0 +1,148 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/obstacle_arrays.h>
+
+#include <algorithm>
+
+namespace teb_local_planner {
+
+void ObstacleArrays::clear() {
+  refs_.clear();
+  point_x_.clear();
+  point_y_.clear();
+  line_start_x_.clear();
+  line_start_y_.clear();
+  line_end_x_.clear();
+  line_end_y_.clear();
+  vertex_x_.clear();
+  vertex_y_.clear();
+  polygon_start_.assign(1, 0);
+}
+
+void ObstacleArrays::fromContainer(const ObstContainer &obstacles) {
+  clear();
+  refs_.resize(obstacles.size());
+
+  for (std::size_t i = 0; i < obstacles.size(); ++i) {
+    const Obstacle *obstacle = obstacles[i].get();
+    if (obstacle->isDynamic())
+      continue;
+
+    const PointObstacle *pobst = dynamic_cast<const PointObstacle *>(obstacle);
+    if (pobst) {
+      refs_[i] = Ref(POINT, point_x_.size());
+      point_x_.push_back(pobst->x());
+      point_y_.push_back(pobst->y());
+      continue;
+    }
+
+    const LineObstacle *lobst = dynamic_cast<const LineObstacle *>(obstacle);
+    if (lobst) {
+      refs_[i] = Ref(LINE, line_start_x_.size());
+      line_start_x_.push_back(lobst->start().x());
+      line_start_y_.push_back(lobst->start().y());
+      line_end_x_.push_back(lobst->end().x());
+      line_end_y_.push_back(lobst->end().y());
+      continue;
+    }
+
+    const PolygonObstacle *polyobst =
+        dynamic_cast<const PolygonObstacle *>(obstacle);
+    if (polyobst && !polyobst->vertices().empty()) {
+      refs_[i] = Ref(POLYGON, polygon_start_.size() - 1);
+      for (const auto &vertex : polyobst->vertices()) {
+        vertex_x_.push_back(vertex.x());
+        vertex_y_.push_back(vertex.y());
+      }
+      polygon_start_.push_back(vertex_x_.size());
+    }
+  }
+}
+
+double ObstacleArrays::polygonDistance(int i,
+                                       const Eigen::Vector2d &position) const {
+  // same as distance_point_to_polygon_2d
+  int begin = polygon_start_[i];
+  int end = polygon_start_[i + 1];
+
+  if (end - begin == 1) {
+    double dx = position.x() - vertex_x_[begin];
+    double dy = position.y() - vertex_y_[begin];
+    return std::sqrt(dx * dx + dy * dy);
+  }
+
+  double dist = HUGE_VAL;
+  for (int k = begin; k < end - 1; ++k)
+    dist = std::min(dist, segmentDistance(k, k + 1, position));
+
+  if (end - begin > 2) // close the polygon
+    dist = std::min(dist, segmentDistance(end - 1, begin, position));
+
+  return dist;
+}
+
+Eigen::Vector2d
+ObstacleArrays::polygonClosestPoint(int i,
+                                    const Eigen::Vector2d &position) const {
+  int begin = polygon_start_[i];
+  int end = polygon_start_[i + 1];
+
+  if (end - begin == 1)
+    return Eigen::Vector2d(vertex_x_[begin], vertex_y_[begin]);
+
+  Eigen::Vector2d closest = position;
+  double sq_dist = HUGE_VAL;
+  auto checkSegment = [&](int start, int stop) {
+    Eigen::Vector2d point = closest_point_on_line_segment_2d(
+        position, Eigen::Vector2d(vertex_x_[start], vertex_y_[start]),
+        Eigen::Vector2d(vertex_x_[stop], vertex_y_[stop]));
+    double new_sq_dist = (point - position).squaredNorm();
+    if (new_sq_dist < sq_dist) {
+      sq_dist = new_sq_dist;
+      closest = point;
+    }
+  };
+
+  for (int k = begin; k < end - 1; ++k)
+    checkSegment(k, k + 1);
+
+  if (end - begin > 2) // close the polygon
+    checkSegment(end - 1, begin);
+
+  return closest;
+}
+
+} // namespace teb_local_planner
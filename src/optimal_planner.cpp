@@ -44,15 +44,32 @@
 
 #include <teb_local_planner/optimal_planner.h>
 
+#include <boost/bind.hpp>
+
 namespace teb_local_planner {
 
+namespace {
+//! Sum of the squared errors of a set of edges of the same type
+template <typename EdgeT>
+double sumOfSquaredErrors(const std::vector<EdgeT *> &edges) {
+  double sum = 0.0;
+  for (auto *edge : edges)
+    sum += edge->getError().squaredNorm();
+  return sum;
+}
+} // namespace
+
 // ============== Implementation ===================
 
 TebOptimalPlanner::TebOptimalPlanner()
-    : cfg_(NULL), obstacles_(NULL), via_points_(NULL), cost_(HUGE_VAL),
+    : cfg_(NULL), obstacles_(NULL), distance_field_(NULL), via_points_(NULL),
+      via_point_ids_(NULL), cost_(HUGE_VAL),
       robot_model_(new PointRobotFootprint()),
       human_model_(new CircularRobotFootprint()), initialized_(false),
-      optimized_(false) {}
+      optimized_(false), cancel_optimization_(false), optimization_time_(0.0),
+      time_budget_(0.0), outer_iterations_(0), inner_iterations_(0),
+      stop_reason_(STOP_COMPLETED), linear_solver_type_(SOLVER_AUTO),
+      linear_solver_(NULL), cost_decrease_(0.0), graph_modified_(true) {}
 
 TebOptimalPlanner::TebOptimalPlanner(
     const TebConfig &cfg, ObstContainer *obstacles,
@@ -79,14 +96,24 @@ void TebOptimalPlanner::initialize(
     const std::map<uint64_t, ViaPointContainer> *humans_via_points_map) {
   // init optimizer (set solver and block ordering settings)
   optimizer_ = initOptimizer();
+  optimizer_->setForceStopFlag(solver_deadline_.stopFlag());
+  optimizer_->addPostIterationAction(&solver_deadline_);
 
   cfg_ = &cfg;
   obstacles_ = obstacles;
+  distance_field_ = NULL;
   robot_model_ = robot_model;
   human_model_ = human_model;
   via_points_ = via_points;
+  via_point_ids_ = NULL;
   humans_via_points_map_ = humans_via_points_map;
   cost_ = HUGE_VAL;
+  cancel_optimization_ = false;
+  optimization_time_ = 0.0;
+  deadline_ = ros::WallTime();
+  time_budget_ = 0.0;
+  outer_iterations_ = inner_iterations_ = 0;
+  stop_reason_ = STOP_COMPLETED;
   setVisualization(visual);
 
   vel_start_.first = true;
@@ -98,6 +125,8 @@ void TebOptimalPlanner::initialize(
   robot_radius_ = robot_model_->getCircumscribedRadius();
   human_radius_ = human_model_->getCircumscribedRadius();
 
+  graph_modified_ = true;
+
   initialized_ = true;
 }
 
@@ -160,6 +189,8 @@ void TebOptimalPlanner::registerG2OTypes() {
       new g2o::HyperGraphElementCreator<EdgeKinematicsCarlike>);
   factory->registerType("EDGE_OBSTACLE",
                         new g2o::HyperGraphElementCreator<EdgeObstacle>);
+  factory->registerType("EDGE_DISTANCE_FIELD",
+                        new g2o::HyperGraphElementCreator<EdgeDistanceField>);
   factory->registerType("EDGE_DYNAMIC_OBSTACLE",
                         new g2o::HyperGraphElementCreator<EdgeDynamicObstacle>);
   factory->registerType("EDGE_VIA_POINT",
@@ -188,65 +219,182 @@ boost::shared_ptr<g2o::SparseOptimizer> TebOptimalPlanner::initOptimizer() {
   static boost::once_flag flag = BOOST_ONCE_INIT;
   boost::call_once(&registerG2OTypes, flag);
 
-  // allocating the optimizer
+  // allocating the optimizer, the backend is selected again for each graph
   boost::shared_ptr<g2o::SparseOptimizer> optimizer =
       boost::make_shared<g2o::SparseOptimizer>();
-  TEBLinearSolver *linearSolver =
-      new TEBLinearSolver(); // see typedef in optimization.h
-  linearSolver->setBlockOrdering(true);
-  TEBBlockSolver *blockSolver = new TEBBlockSolver(linearSolver);
-  g2o::OptimizationAlgorithmLevenberg *solver =
-      new g2o::OptimizationAlgorithmLevenberg(blockSolver);
-
-  optimizer->setAlgorithm(solver);
+  optimizer->setAlgorithm(createAlgorithm(SOLVER_CHOLMOD));
 
   optimizer->initMultiThreading(); // required for >Eigen 3.1
 
   return optimizer;
 }
 
+g2o::OptimizationAlgorithm *
+TebOptimalPlanner::createAlgorithm(LinearSolverType type) {
+  typedef TEBBlockSolver::PoseMatrixType PoseMatrixType;
+  g2o::LinearSolver<PoseMatrixType> *backend;
+  switch (type) {
+  case SOLVER_CSPARSE: {
+    auto *csparse = new g2o::LinearSolverCSparse<PoseMatrixType>();
+    csparse->setBlockOrdering(true);
+    backend = csparse;
+    break;
+  }
+  case SOLVER_EIGEN: {
+    auto *eigen = new g2o::LinearSolverEigen<PoseMatrixType>();
+    eigen->setBlockOrdering(true);
+    backend = eigen;
+    break;
+  }
+  case SOLVER_BANDED:
+    backend = new BandedLinearSolver<PoseMatrixType>();
+    break;
+  default: {
+    auto *cholmod = new g2o::LinearSolverCholmod<PoseMatrixType>();
+    cholmod->setBlockOrdering(true);
+    backend = cholmod;
+    type = SOLVER_CHOLMOD;
+    break;
+  }
+  }
+
+  linear_solver_ = new TEBLinearSolver(backend); // see typedef in
+                                                 // optimal_planner.h
+  linear_solver_type_ = type;
+  TEBBlockSolver *blockSolver = new TEBBlockSolver(linear_solver_);
+  return new g2o::OptimizationAlgorithmLevenberg(blockSolver);
+}
+
+TebOptimalPlanner::LinearSolverType
+TebOptimalPlanner::selectLinearSolver() const {
+  if (cfg_->optim.linear_solver > SOLVER_AUTO &&
+      cfg_->optim.linear_solver <= SOLVER_BANDED)
+    return static_cast<LinearSolverType>(cfg_->optim.linear_solver);
+
+  // the Hessian is ordered by vertex id, the widest id span of an edge
+  // bounds its bandwidth
+  int no_vertices = 0, max_span = 0;
+  for (const auto &vertex_kv : optimizer_->vertices())
+    if (!static_cast<g2o::OptimizableGraph::Vertex *>(vertex_kv.second)
+             ->fixed())
+      ++no_vertices;
+  for (auto *edge : optimizer_->edges()) {
+    int min_id = INT_MAX, max_id = INT_MIN;
+    for (auto *vertex : edge->vertices()) {
+      auto *v = static_cast<g2o::OptimizableGraph::Vertex *>(vertex);
+      if (!v || v->fixed())
+        continue;
+      min_id = std::min(min_id, v->id());
+      max_id = std::max(max_id, v->id());
+    }
+    if (max_id > min_id)
+      max_span = std::max(max_span, max_id - min_id);
+  }
+
+  if (max_span <= BANDED_SOLVER_MAX_ID_SPAN)
+    return SOLVER_BANDED;
+  return no_vertices < cfg_->optim.linear_solver_auto_vertices
+             ? SOLVER_EIGEN
+             : SOLVER_CHOLMOD;
+}
+
+void TebOptimalPlanner::setLinearSolver(LinearSolverType type) {
+  if (type == linear_solver_type_)
+    return;
+  g2o::OptimizationAlgorithm *previous = optimizer_->solver();
+  double time = linear_solver_->time(); // of the current optimizeTEB() call
+  optimizer_->setAlgorithm(createAlgorithm(type));
+  linear_solver_->reset(time);
+  delete previous; // deletes the previous linear solver
+  graph_modified_ = true;
+}
+
 bool TebOptimalPlanner::optimizeTEB(
     unsigned int iterations_innerloop, unsigned int iterations_outerloop,
     bool compute_cost_afterwards, double obst_cost_scale,
     double viapoint_cost_scale, bool alternative_time_cost,
     teb_local_planner::OptimizationCostArray *op_costs) {
+  TEB_PROFILE_SCOPE("planner/optimize_teb");
+  auto start_time = ros::WallTime::now();
+  optimization_time_ = 0.0;
+  time_budget_ = deadline_.isZero() ? 0.0 : (deadline_ - start_time).toSec();
+  outer_iterations_ = inner_iterations_ = 0;
+  linear_solver_->reset();
+  stop_reason_ = STOP_FAILED;
   if (cfg_->optim.optimization_activate == false)
     return false;
+  if (cancel_optimization_) {
+    stop_reason_ = STOP_CANCELLED;
+    return true; // keep the trajectory and the state of the last call
+  }
+
   bool success = false;
   optimized_ = false;
+  stop_reason_ = STOP_COMPLETED;
   for (unsigned int i = 0; i < iterations_outerloop; ++i) {
+    if (i > 0 && cancel_optimization_) {
+      stop_reason_ = STOP_CANCELLED;
+      break;
+    }
+
     if (cfg_->trajectory.teb_autosize) {
+      TEB_PROFILE_SCOPE("planner/auto_resize");
       teb_.autoResize(cfg_->trajectory.dt_ref, cfg_->trajectory.dt_hysteresis,
-                      cfg_->trajectory.min_samples);
+                      cfg_->trajectory.min_samples,
+                      cfg_->trajectory.teb_autosize_exact_dt);
 
       for (auto &human_teb_kv : humans_tebs_map_)
-        human_teb_kv.second.autoResize(cfg_->trajectory.dt_ref,
-                                       cfg_->trajectory.dt_hysteresis,
-                                       cfg_->trajectory.min_samples);
+        human_teb_kv.second.autoResize(
+            cfg_->trajectory.dt_ref, cfg_->trajectory.dt_hysteresis,
+            cfg_->trajectory.min_samples,
+            cfg_->trajectory.teb_autosize_exact_dt);
     }
 
-    success = buildGraph();
+    success = updateGraph();
     if (!success) {
       clearGraph();
+      stop_reason_ = STOP_FAILED;
+      optimization_time_ = (ros::WallTime::now() - start_time).toSec();
       return false;
     }
     success = optimizeGraph(iterations_innerloop, false);
     if (!success) {
       clearGraph();
+      stop_reason_ = STOP_FAILED;
+      optimization_time_ = (ros::WallTime::now() - start_time).toSec();
       return false;
     }
     optimized_ = true;
+    ++outer_iterations_;
+
+    // stop early if the next outer iteration, expected to take as long as
+    // the mean of the previous ones, would exceed the deadline
+    bool last_iteration = i == iterations_outerloop - 1;
+    ros::WallTime now = ros::WallTime::now();
+    if (solver_deadline_.stopped() ||
+        (!last_iteration && !deadline_.isZero() &&
+         now + (now - start_time) * (1.0 / outer_iterations_) > deadline_)) {
+      stop_reason_ = STOP_DEADLINE;
+      last_iteration = true;
+    } else if (!last_iteration && cfg_->optim.convergence_threshold > 0 &&
+               cost_decrease_ < cfg_->optim.convergence_threshold) {
+      stop_reason_ = STOP_CONVERGED;
+      last_iteration = true;
+    }
 
     if (compute_cost_afterwards &&
-        i ==
-            iterations_outerloop -
-                1) // compute cost vec only in the last iteration
+        last_iteration) // compute cost vec only in the last iteration
       computeCurrentCost(obst_cost_scale, viapoint_cost_scale,
                          alternative_time_cost, op_costs);
 
-    clearGraph();
+    if (!cfg_->optim.persistent_graph)
+      clearGraph();
+
+    if (last_iteration)
+      break;
   }
 
+  optimization_time_ = (ros::WallTime::now() - start_time).toSec();
   return true;
 }
 
@@ -314,8 +462,6 @@ bool TebOptimalPlanner::plan(
   auto prep_time = ros::Time::now() - prep_start_time;
 
   auto human_prep_time_start = ros::Time::now();
-  humans_vel_start_.clear();
-  humans_vel_goal_.clear();
 
   double current_human_robot_min_dist = std::numeric_limits<double>::max();
 
@@ -335,6 +481,9 @@ bool TebOptimalPlanner::plan(
 
     auto &rp = initial_plan.front().pose.position;
 
+    TEB_PROFILE_SCOPE("planner/update_human_tebs");
+    std::vector<ThreadPool::Task> human_teb_tasks;
+    human_teb_tasks.reserve(initial_human_plan_vel_map->size());
     for (auto &initial_human_plan_vel_kv : *initial_human_plan_vel_map) {
       auto &human_id = initial_human_plan_vel_kv.first;
       auto &initial_human_plan = initial_human_plan_vel_kv.second.plan;
@@ -356,38 +505,12 @@ bool TebOptimalPlanner::plan(
         current_human_robot_min_dist = dist;
       }
 
-      if (humans_tebs_map_.find(human_id) == humans_tebs_map_.end()) {
-        // create new human-teb for new human
-        humans_tebs_map_[human_id] = TimedElasticBand();
-        humans_tebs_map_[human_id].initTEBtoGoal(
-            initial_human_plan, cfg_->trajectory.dt_ref, true,
-            cfg_->trajectory.human_min_samples,
-            cfg_->trajectory.teb_init_skip_dist);
-      } else if (cfg_->optim.disable_warm_start) {
-        auto &human_teb = humans_tebs_map_[human_id];
-        human_teb.clearTimedElasticBand();
-        human_teb.initTEBtoGoal(initial_human_plan, cfg_->trajectory.dt_ref,
-                                true, cfg_->trajectory.human_min_samples,
-                                cfg_->trajectory.teb_init_skip_dist);
-      } else {
-        // modify human-teb for existing human
-        PoseSE2 human_start_(initial_human_plan.front().pose);
-        PoseSE2 human_goal_(initial_human_plan.back().pose);
-        auto &human_teb = humans_tebs_map_[human_id];
-        if (human_teb.sizePoses() > 0 &&
-            (human_goal_.position() - human_teb.BackPose().position()).norm() <
-                cfg_->trajectory.force_reinit_new_goal_dist)
-          human_teb.updateAndPruneTEB(human_start_, human_goal_,
-                                      cfg_->trajectory.human_min_samples);
-        else {
-          ROS_DEBUG("New goal: distance to existing goal is higher than the "
-                    "specified threshold. Reinitializing human trajectories.");
-          human_teb.clearTimedElasticBand();
-          human_teb.initTEBtoGoal(initial_human_plan, cfg_->trajectory.dt_ref,
-                                  true, cfg_->trajectory.human_min_samples,
-                                  cfg_->trajectory.teb_init_skip_dist);
-        }
-      }
+      // the map entries are created here, the trajectories are updated below
+      human_teb_tasks.push_back(
+          boost::bind(&TebOptimalPlanner::updateHumanTEB, this,
+                      boost::ref(humans_tebs_map_[human_id]),
+                      boost::cref(initial_human_plan)));
+
       // give start velocity for humans
       std::pair<bool, Eigen::Vector2d> human_start_vel;
       human_start_vel.first = true;
@@ -407,6 +530,18 @@ bool TebOptimalPlanner::plan(
       //     initial_human_plan_vel_kv.second.goal_vel.angular.z;
       // humans_vel_goal_[human_id] = human_goal_vel;
     }
+
+    unsigned int no_threads = cfg_->human.no_update_threads > 0
+                                  ? cfg_->human.no_update_threads
+                                  : boost::thread::hardware_concurrency();
+    if (human_teb_tasks.size() > 1 && no_threads > 1) {
+      if (!human_thread_pool_ || human_thread_pool_->size() != no_threads)
+        human_thread_pool_.reset(new ThreadPool(no_threads));
+      human_thread_pool_->run(human_teb_tasks);
+    } else {
+      for (auto &task : human_teb_tasks)
+        task();
+    }
     break;
   }
   case 2: {
@@ -430,6 +565,18 @@ bool TebOptimalPlanner::plan(
   default:
     humans_tebs_map_.clear();
   }
+
+  // drop velocities of vanished humans, existing entries are updated in place
+  // since acceleration edges of a persistent graph refer to them
+  for (auto *humans_vel : {&humans_vel_start_, &humans_vel_goal_}) {
+    auto itr = humans_vel->begin();
+    while (itr != humans_vel->end()) {
+      if (humans_tebs_map_.find(itr->first) == humans_tebs_map_.end())
+        itr = humans_vel->erase(itr);
+      else
+        ++itr;
+    }
+  }
   auto human_prep_time = ros::Time::now() - human_prep_time_start;
 
   // now optimize
@@ -461,6 +608,30 @@ bool TebOptimalPlanner::plan(
   return teb_opt_result;
 }
 
+void TebOptimalPlanner::updateHumanTEB(
+    TimedElasticBand &human_teb,
+    const std::vector<geometry_msgs::PoseStamped> &initial_human_plan) const {
+  if (human_teb.sizePoses() > 0 && !cfg_->optim.disable_warm_start) {
+    // modify human-teb for existing human
+    PoseSE2 human_start(initial_human_plan.front().pose);
+    PoseSE2 human_goal(initial_human_plan.back().pose);
+    if ((human_goal.position() - human_teb.BackPose().position()).norm() <
+        cfg_->trajectory.force_reinit_new_goal_dist) {
+      human_teb.updateAndPruneTEB(human_start, human_goal,
+                                  cfg_->trajectory.human_min_samples);
+      return;
+    }
+    ROS_DEBUG("New goal: distance to existing goal is higher than the "
+              "specified threshold. Reinitializing human trajectories.");
+  }
+
+  // create new human-teb for new human
+  human_teb.clearTimedElasticBand();
+  human_teb.initTEBtoGoal(initial_human_plan, cfg_->trajectory.dt_ref, true,
+                          cfg_->trajectory.human_min_samples,
+                          cfg_->trajectory.teb_init_skip_dist);
+}
+
 bool TebOptimalPlanner::plan(const tf::Pose &start, const tf::Pose &goal,
                              const geometry_msgs::Twist *start_vel,
                              bool free_goal_vel) {
@@ -532,6 +703,7 @@ bool TebOptimalPlanner::plan(const PoseSE2 &start, const PoseSE2 &goal,
 }
 
 bool TebOptimalPlanner::buildGraph() {
+  TEB_PROFILE_SCOPE("planner/build_graph");
   if (!optimizer_->edges().empty() || !optimizer_->vertices().empty()) {
     ROS_WARN("Cannot build graph, because it is not empty. Call graphClear()!");
     return false;
@@ -540,6 +712,8 @@ bool TebOptimalPlanner::buildGraph() {
   // add TEB vertices
   AddTEBVertices();
 
+  ReserveEdgePools();
+
   // add Edges (local cost functions)
   AddEdgesObstacles();
   AddEdgesDynamicObstacles();
@@ -574,21 +748,8 @@ bool TebOptimalPlanner::buildGraph() {
 
     AddEdgesKinematicsDiffDriveForHumans();
 
-    if (cfg_->optim.use_human_robot_safety_c) {
-      AddEdgesHumanRobotSafety();
-    }
-
-    if (cfg_->optim.use_human_human_safety_c) {
-      AddEdgesHumanHumanSafety();
-    }
-
-    if (cfg_->optim.use_human_robot_ttc_c) {
-      AddEdgesHumanRobotTTC();
-    }
-
-    if (cfg_->optim.use_human_robot_dir_c) {
-      AddEdgesHumanRobotDirectional();
-    }
+    findInteractions(interactions_);
+    AddEdgesHumanInteractions();
     break;
   case 2:
     AddVertexEdgesApproach();
@@ -597,10 +758,12 @@ bool TebOptimalPlanner::buildGraph() {
     break;
   }
 
+  graph_modified_ = true;
   return true;
 }
 
 bool TebOptimalPlanner::optimizeGraph(int no_iterations, bool clear_after) {
+  TEB_PROFILE_SCOPE("planner/optimize_graph");
   if (cfg_->robot.max_vel_x < 0.01) {
     ROS_WARN("optimizeGraph(): Robot Max Velocity is smaller than 0.01m/s. "
              "Optimizing aborted...");
@@ -618,15 +781,38 @@ bool TebOptimalPlanner::optimizeGraph(int no_iterations, bool clear_after) {
   }
 
   optimizer_->setVerbose(cfg_->optim.optimization_verbose);
-  optimizer_->initializeOptimization();
+  if (graph_modified_ || !cfg_->optim.persistent_graph ||
+      cfg_->optim.linear_solver != SOLVER_AUTO)
+    setLinearSolver(selectLinearSolver()); // might modify the graph
+  if (graph_modified_ || !cfg_->optim.persistent_graph) {
+    optimizer_->initializeOptimization();
+    graph_modified_ = false;
+  }
+
+  double chi2_before = 0.0;
+  if (cfg_->optim.convergence_threshold > 0) {
+    optimizer_->computeActiveErrors();
+    chi2_before = optimizer_->activeChi2();
+  }
 
+  solver_deadline_.start(deadline_);
   int iter = optimizer_->optimize(no_iterations);
+  inner_iterations_ += solver_deadline_.iterations();
+  TEB_PROFILE_COUNT("planner/solver_iterations", solver_deadline_.iterations());
 
   if (!iter) {
     ROS_ERROR("optimizeGraph(): Optimization failed! iter=%i", iter);
     return false;
   }
 
+  if (cfg_->optim.convergence_threshold > 0) {
+    // the errors of a rejected solver step may still be cached
+    optimizer_->computeActiveErrors();
+    double chi2_after = optimizer_->activeChi2();
+    cost_decrease_ =
+        chi2_before > 0 ? (chi2_before - chi2_after) / chi2_before : 0.0;
+  }
+
   if (clear_after)
     clearGraph();
 
@@ -634,15 +820,176 @@ bool TebOptimalPlanner::optimizeGraph(int no_iterations, bool clear_after) {
 }
 
 void TebOptimalPlanner::clearGraph() {
+  // detach edges from the vertices, the TEBs might already have deleted some
+  // of them if the graph was kept alive (persistent graph)
+  for (auto *edge : optimizer_->edges())
+    std::fill(edge->vertices().begin(), edge->vertices().end(),
+              (g2o::HyperGraph::Vertex *)NULL);
+  for (auto *pose : teb_.poses())
+    pose->edges().clear();
+  for (auto *timediff : teb_.timediffs())
+    timediff->edges().clear();
+  for (auto &human_teb_kv : humans_tebs_map_) {
+    for (auto *pose : human_teb_kv.second.poses())
+      pose->edges().clear();
+    for (auto *timediff : human_teb_kv.second.timediffs())
+      timediff->edges().clear();
+  }
+
   // optimizer.clear deletes edges!!! Therefore do not run
   // optimizer.edges().clear()
   optimizer_->vertices().clear(); // neccessary, because optimizer->clear
                                   // deletes pointer-targets (therefore it
                                   // deletes TEB states!)
   optimizer_->clear();
+
+  graph_edges_.clear();
+  graph_structure_.clear();
+  graph_obstacles_.clear();
+  graph_via_points_.clear();
+  graph_human_via_points_.clear();
+  graph_modified_ = true;
+}
+
+bool TebOptimalPlanner::updateGraph() {
+  TEB_PROFILE_SCOPE("planner/update_graph");
+  bool graph_empty =
+      optimizer_->vertices().empty() && optimizer_->edges().empty();
+
+  if (!cfg_->optim.persistent_graph || cfg_->planning_mode == 2) {
+    if (!graph_empty)
+      clearGraph();
+    return buildGraph();
+  }
+
+  GraphSignature structure, obstacles, via_points, human_via_points;
+  getGraphSignatures(structure, obstacles, via_points, human_via_points);
+
+  if (graph_empty || structure != graph_structure_) {
+    if (!graph_empty)
+      clearGraph();
+    if (!buildGraph())
+      return false;
+    graph_structure_ = structure;
+    graph_obstacles_ = obstacles;
+    graph_via_points_ = via_points;
+    graph_human_via_points_ = human_via_points;
+    return true;
+  }
+
+  if (obstacles != graph_obstacles_) {
+    removeEdges(graph_edges_.obstacle);
+    removeEdges(graph_edges_.indexed_obstacle);
+    removeEdges(graph_edges_.distance_field);
+    removeEdges(graph_edges_.dynamic_obstacle);
+    AddEdgesObstacles();
+    AddEdgesDynamicObstacles();
+    if (cfg_->planning_mode == 1)
+      AddEdgesObstaclesForHumans();
+    graph_obstacles_ = obstacles;
+    graph_modified_ = true;
+  } else if (obstacles_ != NULL) {
+    // same obstacles in the same order, only refresh their coordinates (e.g.
+    // of lines with an unchanged centroid), references remain valid
+    obstacle_arrays_.fromContainer(*obstacles_);
+  }
+
+  if (via_points != graph_via_points_) {
+    UpdateEdgesViaPoints();
+    graph_via_points_ = via_points;
+    graph_modified_ = true;
+  }
+
+  if (human_via_points != graph_human_via_points_) {
+    removeEdges(graph_edges_.human_via_point);
+    if (cfg_->planning_mode == 1)
+      AddEdgesViaPointsForHumans();
+    graph_human_via_points_ = human_via_points;
+    graph_modified_ = true;
+  }
+
+  // the poses that can interact change as the trajectories are optimized
+  if (cfg_->planning_mode == 1) {
+    Interactions interactions;
+    findInteractions(interactions);
+    if (interactions != interactions_) {
+      removeEdges(graph_edges_.human_robot_safety);
+      removeEdges(graph_edges_.human_human_safety);
+      removeEdges(graph_edges_.human_robot_ttc);
+      removeEdges(graph_edges_.human_robot_directional);
+      interactions_ = interactions;
+      AddEdgesHumanInteractions();
+      graph_modified_ = true;
+    }
+  }
+
+  return true;
+}
+
+void TebOptimalPlanner::getGraphSignatures(
+    GraphSignature &structure, GraphSignature &obstacles,
+    GraphSignature &via_points, GraphSignature &human_via_points) const {
+  // vertices and all edges that only depend on them
+  structure.ids.push_back(cfg_->revision());
+  structure.ids.push_back(cfg_->planning_mode);
+  structure.ids.push_back(teb_.structureRevision());
+  structure.ids.push_back(vel_start_.first);
+  structure.ids.push_back(vel_goal_.first);
+  structure.values.push_back(local_weight_optimaltime_);
+  if (cfg_->planning_mode == 1) {
+    for (auto &human_teb_kv : humans_tebs_map_) {
+      auto vel_start_it = humans_vel_start_.find(human_teb_kv.first);
+      auto vel_goal_it = humans_vel_goal_.find(human_teb_kv.first);
+      structure.ids.push_back(human_teb_kv.second.structureRevision());
+      structure.ids.push_back(vel_start_it != humans_vel_start_.end() &&
+                              vel_start_it->second.first);
+      structure.ids.push_back(vel_goal_it != humans_vel_goal_.end() &&
+                              vel_goal_it->second.first);
+    }
+  }
+
+  // the distance field edges only depend on the poses, the field is updated in
+  // place
+  obstacles.ids.push_back(useDistanceField());
+
+  // obstacle edges keep raw pointers, compare the centroids as well in case an
+  // address got reused by a new obstacle
+  if (obstacles_) {
+    for (const ObstaclePtr &obst : *obstacles_) {
+      obstacles.addresses.push_back(obst.get());
+      Eigen::Vector2d centroid = obst->getCentroid();
+      obstacles.values.push_back(centroid.x());
+      obstacles.values.push_back(centroid.y());
+    }
+  }
+
+  // via-point edges keep pointers into the containers
+  if (via_points_) {
+    via_points.ids.push_back(via_points_->size());
+    via_points.addresses.push_back(via_points_->data());
+    for (const Eigen::Vector2d &via_point : *via_points_) {
+      via_points.values.push_back(via_point.x());
+      via_points.values.push_back(via_point.y());
+    }
+    if (via_point_ids_)
+      via_points.ids.insert(via_points.ids.end(), via_point_ids_->begin(),
+                            via_point_ids_->end());
+  }
+  if (humans_via_points_map_ && cfg_->planning_mode == 1) {
+    for (auto &human_via_points_kv : *humans_via_points_map_) {
+      human_via_points.ids.push_back(human_via_points_kv.first);
+      human_via_points.ids.push_back(human_via_points_kv.second.size());
+      human_via_points.addresses.push_back(human_via_points_kv.second.data());
+      for (const Eigen::Vector2d &via_point : human_via_points_kv.second) {
+        human_via_points.values.push_back(via_point.x());
+        human_via_points.values.push_back(via_point.y());
+      }
+    }
+  }
 }
 
 void TebOptimalPlanner::AddTEBVertices() {
+  TEB_PROFILE_SCOPE("planner/graph/vertices");
   // add vertices to graph
   ROS_DEBUG_COND(cfg_->optim.optimization_verbose, "Adding TEB vertices ...");
   unsigned int id_counter = 0; // used for vertices ids
@@ -684,21 +1031,64 @@ void TebOptimalPlanner::AddTEBVertices() {
   }
 }
 
+void TebOptimalPlanner::ReserveEdgePools() {
+  // one edge per pose (upper bound for the edges between consecutive poses)
+  std::size_t robot_poses = teb_.sizePoses();
+  EdgePool<EdgeVelocity>::reserve(robot_poses);
+  EdgePool<EdgeAcceleration>::reserve(robot_poses);
+  EdgePool<EdgeTimeOptimal>::reserve(robot_poses);
+  if (cfg_->robot.min_turning_radius == 0 ||
+      cfg_->optim.weight_kinematics_turning_radius == 0)
+    EdgePool<EdgeKinematicsDiffDrive>::reserve(robot_poses);
+  else
+    EdgePool<EdgeKinematicsCarlike>::reserve(robot_poses);
+
+  if (cfg_->planning_mode != 1)
+    return;
+
+  std::size_t human_poses = 0;
+  for (auto &human_teb_kv : humans_tebs_map_)
+    human_poses += human_teb_kv.second.sizePoses();
+  EdgePool<EdgeVelocityHuman>::reserve(human_poses);
+  EdgePool<EdgeAccelerationHuman>::reserve(human_poses);
+  EdgePool<EdgeTimeOptimal>::reserve(human_poses);
+  EdgePool<EdgeKinematicsDiffDrive>::reserve(human_poses);
+}
+
 void TebOptimalPlanner::AddEdgesObstacles() {
-  if (cfg_->optim.weight_obstacle == 0 || obstacles_ == NULL)
+  TEB_PROFILE_SCOPE("planner/graph/obstacles");
+  if (cfg_->optim.weight_obstacle == 0)
     return; // if weight equals zero skip adding edges!
 
+  if (useDistanceField()) {
+    robot_model_->getCircleDecomposition(robot_field_circles_,
+                                         cfg_->obstacles.footprint_circles);
+    AddEdgesDistanceField(teb_, &robot_field_circles_);
+  }
+
+  if (obstacles_ == NULL)
+    return;
+
+  // index the poses once instead of searching all of them for each obstacle
+  robot_pose_grid_.build(teb_);
+
+  // the human obstacle edges use the arrays as well
+  obstacle_arrays_.fromContainer(*obstacles_);
+  const std::vector<std::pair<double, double>> *robot_circles =
+      robot_model_->getCircles(robot_circles_) ? &robot_circles_ : NULL;
+
   for (ObstContainer::const_iterator obst = obstacles_->begin();
        obst != obstacles_->end(); ++obst) {
     if ((*obst)->isDynamic()) // we handle dynamic obstacles differently below
       continue;
 
+    std::size_t obstacle_idx = obst - obstacles_->begin();
     unsigned int index;
 
     if (cfg_->obstacles.obstacle_poses_affected >= (int)teb_.sizePoses())
       index = teb_.sizePoses() / 2;
     else
-      index = teb_.findClosestTrajectoryPose(*(obst->get()));
+      index = robot_pose_grid_.findClosestPose(*(obst->get()), teb_);
 
     // check if obstacle is outside index-range between start and goal
     if ((index <= 1) ||
@@ -711,48 +1101,62 @@ void TebOptimalPlanner::AddEdgesObstacles() {
     Eigen::Matrix<double, 1, 1> information;
     information.fill(cfg_->optim.weight_obstacle);
 
-    EdgeObstacle *dist_bandpt_obst = new EdgeObstacle;
-    dist_bandpt_obst->setVertex(0, teb_.PoseVertex(index));
-    dist_bandpt_obst->setInformation(information);
-    dist_bandpt_obst->setParameters(*cfg_, robot_model_.get(), obst->get());
-    optimizer_->addEdge(dist_bandpt_obst);
+    AddEdgeObstacle(teb_.PoseVertex(index), obstacle_idx, robot_model_.get(),
+                    robot_circles, information);
 
     for (unsigned int neighbourIdx = 0;
          neighbourIdx < floor(cfg_->obstacles.obstacle_poses_affected / 2);
          neighbourIdx++) {
       if (index + neighbourIdx < teb_.sizePoses()) {
-        EdgeObstacle *dist_bandpt_obst_n_r = new EdgeObstacle;
-        dist_bandpt_obst_n_r->setVertex(0,
-                                        teb_.PoseVertex(index + neighbourIdx));
-        dist_bandpt_obst_n_r->setInformation(information);
-        dist_bandpt_obst_n_r->setParameters(*cfg_, robot_model_.get(),
-                                            obst->get());
-        optimizer_->addEdge(dist_bandpt_obst_n_r);
+        AddEdgeObstacle(teb_.PoseVertex(index + neighbourIdx), obstacle_idx,
+                        robot_model_.get(), robot_circles, information);
       }
       if ((int)index - (int)neighbourIdx >=
           0) // needs to be casted to int to allow negative values
       {
-        EdgeObstacle *dist_bandpt_obst_n_l = new EdgeObstacle;
-        dist_bandpt_obst_n_l->setVertex(0,
-                                        teb_.PoseVertex(index - neighbourIdx));
-        dist_bandpt_obst_n_l->setInformation(information);
-        dist_bandpt_obst_n_l->setParameters(*cfg_, robot_model_.get(),
-                                            obst->get());
-        optimizer_->addEdge(dist_bandpt_obst_n_l);
+        AddEdgeObstacle(teb_.PoseVertex(index - neighbourIdx), obstacle_idx,
+                        robot_model_.get(), robot_circles, information);
       }
     }
   }
 }
 
 void TebOptimalPlanner::AddEdgesObstaclesForHumans() {
-  if (cfg_->optim.weight_obstacle == 0 || obstacles_ == NULL)
+  TEB_PROFILE_SCOPE("planner/graph/human_obstacles");
+  if (cfg_->optim.weight_obstacle == 0)
+    return;
+
+  if (useDistanceField()) {
+    human_model_->getCircleDecomposition(human_field_circles_,
+                                         cfg_->obstacles.footprint_circles);
+    for (auto &human_teb_kv : humans_tebs_map_)
+      AddEdgesDistanceField(human_teb_kv.second, &human_field_circles_);
+  }
+
+  if (obstacles_ == NULL)
     return;
 
+  // index the poses of each human once, drop the ones of vanished humans
+  for (auto it = human_pose_grids_.begin(); it != human_pose_grids_.end();) {
+    if (humans_tebs_map_.find(it->first) == humans_tebs_map_.end())
+      it = human_pose_grids_.erase(it);
+    else
+      ++it;
+  }
+  for (auto &human_teb_kv : humans_tebs_map_)
+    human_pose_grids_[human_teb_kv.first].build(human_teb_kv.second);
+
+  const BaseRobotFootprintModel *human_model =
+      static_cast<CircularRobotFootprintPtr>(human_model_).get();
+  const std::vector<std::pair<double, double>> *human_circles =
+      human_model->getCircles(human_circles_) ? &human_circles_ : NULL;
+
   for (ObstContainer::const_iterator obst = obstacles_->begin();
        obst != obstacles_->end(); ++obst) {
     if ((*obst)->isDynamic()) // we handle dynamic obstacles differently below
       continue;
 
+    std::size_t obstacle_idx = obst - obstacles_->begin();
     unsigned int index;
 
     for (auto &human_teb_kv : humans_tebs_map_) {
@@ -761,7 +1165,8 @@ void TebOptimalPlanner::AddEdgesObstaclesForHumans() {
       if (cfg_->obstacles.obstacle_poses_affected >= (int)human_teb.sizePoses())
         index = human_teb.sizePoses() / 2;
       else
-        index = human_teb.findClosestTrajectoryPose(*(obst->get()));
+        index = human_pose_grids_[human_teb_kv.first].findClosestPose(
+            *(obst->get()), human_teb);
 
       if ((index <= 1) || (index > human_teb.sizePoses() - 1))
         continue;
@@ -769,44 +1174,75 @@ void TebOptimalPlanner::AddEdgesObstaclesForHumans() {
       Eigen::Matrix<double, 1, 1> information;
       information.fill(cfg_->optim.weight_obstacle);
 
-      EdgeObstacle *dist_bandpt_obst = new EdgeObstacle;
-      dist_bandpt_obst->setVertex(0, human_teb.PoseVertex(index));
-      dist_bandpt_obst->setInformation(information);
-      dist_bandpt_obst->setParameters(
-          *cfg_, static_cast<CircularRobotFootprintPtr>(human_model_).get(),
-          obst->get());
-      optimizer_->addEdge(dist_bandpt_obst);
+      AddEdgeObstacle(human_teb.PoseVertex(index), obstacle_idx, human_model,
+                      human_circles, information);
 
       for (unsigned int neighbourIdx = 0;
            neighbourIdx < floor(cfg_->obstacles.obstacle_poses_affected / 2);
            neighbourIdx++) {
         if (index + neighbourIdx < human_teb.sizePoses()) {
-          EdgeObstacle *dist_bandpt_obst_n_r = new EdgeObstacle;
-          dist_bandpt_obst_n_r->setVertex(
-              0, human_teb.PoseVertex(index + neighbourIdx));
-          dist_bandpt_obst_n_r->setInformation(information);
-          dist_bandpt_obst_n_r->setParameters(
-              *cfg_, static_cast<CircularRobotFootprintPtr>(human_model_).get(),
-              obst->get());
-          optimizer_->addEdge(dist_bandpt_obst_n_r);
+          AddEdgeObstacle(human_teb.PoseVertex(index + neighbourIdx),
+                          obstacle_idx, human_model, human_circles,
+                          information);
         }
         if ((int)index - (int)neighbourIdx >=
             0) { // TODO: may be > is enough instead of >=
-          EdgeObstacle *dist_bandpt_obst_n_l = new EdgeObstacle;
-          dist_bandpt_obst_n_l->setVertex(
-              0, human_teb.PoseVertex(index - neighbourIdx));
-          dist_bandpt_obst_n_l->setInformation(information);
-          dist_bandpt_obst_n_l->setParameters(
-              *cfg_, static_cast<CircularRobotFootprintPtr>(human_model_).get(),
-              obst->get());
-          optimizer_->addEdge(dist_bandpt_obst_n_l);
+          AddEdgeObstacle(human_teb.PoseVertex(index - neighbourIdx),
+                          obstacle_idx, human_model, human_circles,
+                          information);
         }
       }
     }
   }
 }
 
+void TebOptimalPlanner::AddEdgeObstacle(
+    VertexPose *pose, std::size_t obstacle_idx,
+    const BaseRobotFootprintModel *model,
+    const std::vector<std::pair<double, double>> *circles,
+    const Eigen::Matrix<double, 1, 1> &information) {
+  // obstacles of the arrays are handled without virtual calls
+  if (circles && obstacle_idx < obstacle_arrays_.size() &&
+      obstacle_arrays_.ref(obstacle_idx).type != ObstacleArrays::NONE) {
+    EdgeIndexedObstacle *dist_bandpt_obst = new EdgeIndexedObstacle;
+    dist_bandpt_obst->setVertex(0, pose);
+    dist_bandpt_obst->setInformation(information);
+    dist_bandpt_obst->setParameters(*cfg_, circles, &obstacle_arrays_,
+                                    obstacle_arrays_.ref(obstacle_idx));
+    optimizer_->addEdge(dist_bandpt_obst);
+    graph_edges_.indexed_obstacle.push_back(dist_bandpt_obst);
+    return;
+  }
+
+  EdgeObstacle *dist_bandpt_obst = new EdgeObstacle;
+  dist_bandpt_obst->setVertex(0, pose);
+  dist_bandpt_obst->setInformation(information);
+  dist_bandpt_obst->setParameters(*cfg_, model,
+                                  (*obstacles_)[obstacle_idx].get());
+  optimizer_->addEdge(dist_bandpt_obst);
+  graph_edges_.obstacle.push_back(dist_bandpt_obst);
+}
+
+void TebOptimalPlanner::AddEdgesDistanceField(TimedElasticBand &teb,
+                                              const FootprintCircles *circles) {
+  Eigen::Matrix<double, 1, 1> information;
+  information.fill(cfg_->optim.weight_obstacle);
+
+  for (unsigned int i = 0; i < teb.sizePoses(); ++i) {
+    if (teb.PoseVertex(i)->fixed())
+      continue;
+
+    EdgeDistanceField *dist_bandpt_field = new EdgeDistanceField;
+    dist_bandpt_field->setVertex(0, teb.PoseVertex(i));
+    dist_bandpt_field->setInformation(information);
+    dist_bandpt_field->setParameters(*cfg_, distance_field_, circles);
+    optimizer_->addEdge(dist_bandpt_field);
+    graph_edges_.distance_field.push_back(dist_bandpt_field);
+  }
+}
+
 void TebOptimalPlanner::AddEdgesDynamicObstacles() {
+  TEB_PROFILE_SCOPE("planner/graph/dynamic_obstacles");
   if (cfg_->optim.weight_obstacle == 0 || obstacles_ == NULL)
     return; // if weight equals zero skip adding edges!
 
@@ -827,11 +1263,13 @@ void TebOptimalPlanner::AddEdgesDynamicObstacles() {
       dynobst_edge->setMeasurement(obst->get());
       dynobst_edge->setTebConfig(*cfg_);
       optimizer_->addEdge(dynobst_edge);
+      graph_edges_.dynamic_obstacle.push_back(dynobst_edge);
     }
   }
 }
 
 void TebOptimalPlanner::AddEdgesDynamicObstaclesForHumans() {
+  TEB_PROFILE_SCOPE("planner/graph/human_dynamic_obstacles");
   if (cfg_->optim.weight_obstacle == 0 || obstacles_ == NULL)
     return;
 
@@ -854,12 +1292,14 @@ void TebOptimalPlanner::AddEdgesDynamicObstaclesForHumans() {
         dynobst_edge->setMeasurement(obst->get());
         dynobst_edge->setTebConfig(*cfg_);
         optimizer_->addEdge(dynobst_edge);
+        graph_edges_.dynamic_obstacle.push_back(dynobst_edge);
       }
     }
   }
 }
 
 void TebOptimalPlanner::AddEdgesViaPoints() {
+  TEB_PROFILE_SCOPE("planner/graph/via_points");
   if (cfg_->optim.weight_viapoint == 0 || via_points_ == NULL ||
       via_points_->empty())
     return; // if weight equals zero skip adding edges!
@@ -870,35 +1310,87 @@ void TebOptimalPlanner::AddEdgesViaPoints() {
   if (n < 3) // we do not have any degrees of freedom for reaching via-points
     return;
 
-  for (ViaPointContainer::const_iterator vp_it = via_points_->begin();
-       vp_it != via_points_->end(); ++vp_it) {
+  for (std::size_t i = 0; i < via_points_->size(); ++i)
+    AddEdgeViaPoint(i, start_pose_idx);
+}
 
-    int index = teb_.findClosestTrajectoryPose(*vp_it, NULL, start_pose_idx);
-    if (cfg_->trajectory.via_points_ordered)
-      start_pose_idx =
-          index +
-          2; // skip a point to have a DOF inbetween for further via-points
-
-    // check if point conicides with goal or is located behind it
-    if (index > n - 2)
-      index =
-          n - 2; // set to a pose before the goal, since we can move it away!
-    // check if point coincides with start or is located before it
-    if (index < 1)
-      index = 1;
+void TebOptimalPlanner::AddEdgeViaPoint(std::size_t i, int &start_pose_idx) {
+  const Eigen::Vector2d &via_point = (*via_points_)[i];
+  int n = (int)teb_.sizePoses();
 
-    Eigen::Matrix<double, 1, 1> information;
-    information.fill(cfg_->optim.weight_viapoint);
+  int index = teb_.findClosestTrajectoryPose(via_point, NULL, start_pose_idx);
+  // skip a point to have a DOF inbetween for further via-points
+  if (cfg_->trajectory.via_points_ordered)
+    start_pose_idx = index + 2;
+
+  // check if point conicides with goal or is located behind it
+  if (index > n - 2)
+    index = n - 2; // set to a pose before the goal, since we can move it away!
+  // check if point coincides with start or is located before it
+  if (index < 1)
+    index = 1;
+
+  Eigen::Matrix<double, 1, 1> information;
+  information.fill(cfg_->optim.weight_viapoint);
+
+  EdgeViaPoint *edge_viapoint = new EdgeViaPoint;
+  edge_viapoint->setVertex(0, teb_.PoseVertex(index));
+  edge_viapoint->setInformation(information);
+  edge_viapoint->setParameters(*cfg_, &via_point);
+  optimizer_->addEdge(edge_viapoint);
+  graph_edges_.via_point.push_back(edge_viapoint);
+  graph_edges_.via_point_id.push_back(via_point_ids_ ? (*via_point_ids_)[i]
+                                                     : 0);
+  graph_edges_.via_point_pose.push_back(index);
+}
+
+void TebOptimalPlanner::UpdateEdgesViaPoints() {
+  if (cfg_->optim.weight_viapoint == 0 || via_points_ == NULL ||
+      via_point_ids_ == NULL || via_point_ids_->size() != via_points_->size() ||
+      teb_.sizePoses() < 3) {
+    removeEdges(graph_edges_.via_point);
+    graph_edges_.via_point_id.clear();
+    graph_edges_.via_point_pose.clear();
+    AddEdgesViaPoints();
+    return;
+  }
+
+  TEB_PROFILE_SCOPE("planner/graph/via_points");
+  std::vector<EdgeViaPoint *> edges;
+  std::vector<uint64_t> ids;
+  std::vector<int> poses;
+  edges.swap(graph_edges_.via_point);
+  ids.swap(graph_edges_.via_point_id);
+  poses.swap(graph_edges_.via_point_pose);
+
+  // merge the ascending IDs of the edges and of the via-points
+  int start_pose_idx = 0;
+  std::size_t e = 0;
+  for (std::size_t i = 0; i < via_points_->size(); ++i) {
+    uint64_t id = (*via_point_ids_)[i];
+    for (; e < edges.size() && ids[e] < id; ++e)
+      optimizer_->removeEdge(edges[e]); // also deletes the edge
+
+    if (e == edges.size() || ids[e] != id) {
+      AddEdgeViaPoint(i, start_pose_idx);
+      continue;
+    }
 
-    EdgeViaPoint *edge_viapoint = new EdgeViaPoint;
-    edge_viapoint->setVertex(0, teb_.PoseVertex(index));
-    edge_viapoint->setInformation(information);
-    edge_viapoint->setParameters(*cfg_, &(*vp_it));
-    optimizer_->addEdge(edge_viapoint);
+    // the container may have been reallocated
+    edges[e]->setParameters(*cfg_, &(*via_points_)[i]);
+    if (cfg_->trajectory.via_points_ordered)
+      start_pose_idx = poses[e] + 2;
+    graph_edges_.via_point.push_back(edges[e]);
+    graph_edges_.via_point_id.push_back(id);
+    graph_edges_.via_point_pose.push_back(poses[e]);
+    ++e;
   }
+  for (; e < edges.size(); ++e)
+    optimizer_->removeEdge(edges[e]);
 }
 
 void TebOptimalPlanner::AddEdgesViaPointsForHumans() {
+  TEB_PROFILE_SCOPE("planner/graph/human_via_points");
   if (cfg_->optim.weight_human_viapoint == 0 || via_points_ == NULL ||
       via_points_->empty())
     return;
@@ -943,11 +1435,13 @@ void TebOptimalPlanner::AddEdgesViaPointsForHumans() {
       edge_viapoint->setInformation(information);
       edge_viapoint->setParameters(*cfg_, &(*vp_it));
       optimizer_->addEdge(edge_viapoint);
+      graph_edges_.human_via_point.push_back(edge_viapoint);
     }
   }
 }
 
 void TebOptimalPlanner::AddEdgesVelocity() {
+  TEB_PROFILE_SCOPE("planner/graph/velocity");
   if (cfg_->optim.weight_max_vel_x == 0 &&
       cfg_->optim.weight_max_vel_theta == 0)
     return; // if weight equals zero skip adding edges!
@@ -966,10 +1460,12 @@ void TebOptimalPlanner::AddEdgesVelocity() {
     velocity_edge->setInformation(information);
     velocity_edge->setTebConfig(*cfg_);
     optimizer_->addEdge(velocity_edge);
+    graph_edges_.robot_velocity.push_back(velocity_edge);
   }
 }
 
 void TebOptimalPlanner::AddEdgesVelocityForHumans() {
+  TEB_PROFILE_SCOPE("planner/graph/human_velocity");
   if (cfg_->optim.weight_max_human_vel_x == 0 &&
       cfg_->optim.weight_max_human_vel_theta == 0 &&
       cfg_->optim.weight_nominal_human_vel_x == 0)
@@ -993,11 +1489,13 @@ void TebOptimalPlanner::AddEdgesVelocityForHumans() {
       human_velocity_edge->setInformation(information);
       human_velocity_edge->setTebConfig(*cfg_);
       optimizer_->addEdge(human_velocity_edge);
+      graph_edges_.human_velocity.push_back(human_velocity_edge);
     }
   }
 }
 
 void TebOptimalPlanner::AddEdgesAcceleration() {
+  TEB_PROFILE_SCOPE("planner/graph/acceleration");
   if (cfg_->optim.weight_acc_lim_x == 0 &&
       cfg_->optim.weight_acc_lim_theta == 0)
     return; // if weight equals zero skip adding edges!
@@ -1031,6 +1529,7 @@ void TebOptimalPlanner::AddEdgesAcceleration() {
     acceleration_edge->setInformation(information);
     acceleration_edge->setTebConfig(*cfg_);
     optimizer_->addEdge(acceleration_edge);
+    graph_edges_.robot_acceleration.push_back(acceleration_edge);
   }
 
   // check if a goal velocity should be taken into account
@@ -1048,6 +1547,7 @@ void TebOptimalPlanner::AddEdgesAcceleration() {
 }
 
 void TebOptimalPlanner::AddEdgesAccelerationForHumans() {
+  TEB_PROFILE_SCOPE("planner/graph/human_acceleration");
   if (cfg_->optim.weight_human_acc_lim_x == 0 &&
       cfg_->optim.weight_human_acc_lim_theta == 0)
     return;
@@ -1087,6 +1587,7 @@ void TebOptimalPlanner::AddEdgesAccelerationForHumans() {
       human_acceleration_edge->setInformation(information);
       human_acceleration_edge->setTebConfig(*cfg_);
       optimizer_->addEdge(human_acceleration_edge);
+      graph_edges_.human_acceleration.push_back(human_acceleration_edge);
     }
 
     if (humans_vel_goal_[human_it].first) {
@@ -1108,6 +1609,7 @@ void TebOptimalPlanner::AddEdgesAccelerationForHumans() {
 }
 
 void TebOptimalPlanner::AddEdgesTimeOptimal() {
+  TEB_PROFILE_SCOPE("planner/graph/time_optimal");
   if (local_weight_optimaltime_ == 0)
     return; // if weight equals zero skip adding edges!
 
@@ -1121,10 +1623,12 @@ void TebOptimalPlanner::AddEdgesTimeOptimal() {
     timeoptimal_edge->setTebConfig(*cfg_);
     timeoptimal_edge->setInitialTime(teb_.TimeDiffVertex(i)->dt());
     optimizer_->addEdge(timeoptimal_edge);
+    graph_edges_.time_optimal.push_back(timeoptimal_edge);
   }
 }
 
 void TebOptimalPlanner::AddEdgesTimeOptimalForHumans() {
+  TEB_PROFILE_SCOPE("planner/graph/human_time_optimal");
   if (cfg_->optim.weight_human_optimaltime == 0) {
     return;
   }
@@ -1143,11 +1647,13 @@ void TebOptimalPlanner::AddEdgesTimeOptimalForHumans() {
       timeoptimal_edge->setTebConfig(*cfg_);
       timeoptimal_edge->setInitialTime(human_teb.TimeDiffVertex(i)->dt());
       optimizer_->addEdge(timeoptimal_edge);
+      graph_edges_.time_optimal.push_back(timeoptimal_edge);
     }
   }
 }
 
 void TebOptimalPlanner::AddEdgesKinematicsDiffDrive() {
+  TEB_PROFILE_SCOPE("planner/graph/kinematics");
   if (cfg_->optim.weight_kinematics_nh == 0 &&
       cfg_->optim.weight_kinematics_forward_drive == 0)
     return; // if weight equals zero skip adding edges!
@@ -1167,10 +1673,12 @@ void TebOptimalPlanner::AddEdgesKinematicsDiffDrive() {
     kinematics_edge->setInformation(information_kinematics);
     kinematics_edge->setTebConfig(*cfg_);
     optimizer_->addEdge(kinematics_edge);
+    graph_edges_.kinematics_dd.push_back(kinematics_edge);
   }
 }
 
 void TebOptimalPlanner::AddEdgesKinematicsDiffDriveForHumans() {
+  TEB_PROFILE_SCOPE("planner/graph/human_kinematics");
   if (cfg_->optim.weight_kinematics_nh == 0 &&
       cfg_->optim.weight_kinematics_forward_drive == 0)
     return; // if weight equals zero skip adding edges!
@@ -1190,11 +1698,13 @@ void TebOptimalPlanner::AddEdgesKinematicsDiffDriveForHumans() {
       kinematics_edge->setInformation(information_kinematics);
       kinematics_edge->setTebConfig(*cfg_);
       optimizer_->addEdge(kinematics_edge);
+      graph_edges_.kinematics_dd.push_back(kinematics_edge);
     }
   }
 }
 
 void TebOptimalPlanner::AddEdgesKinematicsCarlike() {
+  TEB_PROFILE_SCOPE("planner/graph/kinematics");
   if (cfg_->optim.weight_kinematics_nh == 0 &&
       cfg_->optim.weight_kinematics_turning_radius)
     return; // if weight equals zero skip adding edges!
@@ -1214,27 +1724,117 @@ void TebOptimalPlanner::AddEdgesKinematicsCarlike() {
     kinematics_edge->setInformation(information_kinematics);
     kinematics_edge->setTebConfig(*cfg_);
     optimizer_->addEdge(kinematics_edge);
+    graph_edges_.kinematics_cl.push_back(kinematics_edge);
   }
 }
 
-void TebOptimalPlanner::AddEdgesHumanRobotSafety() {
-  auto robot_teb_size = teb_.sizePoses();
+void TebOptimalPlanner::findInteractions(Interactions &interactions) const {
+  TEB_PROFILE_SCOPE("planner/graph/find_interactions");
+  interactions.robot_safety.clear();
+  interactions.robot_ttc.clear();
+  interactions.human_safety.clear();
+  interactions.culled_directional = 0;
+
+  bool cull = cfg_->human.cull_interactions;
+  double margin = cfg_->human.interaction_margin;
+  double robot_vel =
+      std::max(cfg_->robot.max_vel_x, cfg_->robot.max_vel_x_backwards);
+  double human_vel =
+      std::max(cfg_->human.max_vel_x, cfg_->human.max_vel_x_backwards);
+
+  // center distances beyond which the edges have no effect
+  double robot_safety_range = cfg_->human.min_human_robot_dist +
+                              cfg_->optim.penalty_epsilon + robot_radius_ +
+                              human_radius_;
+  double human_safety_range = cfg_->human.min_human_human_dist +
+                              cfg_->optim.penalty_epsilon + 2 * human_radius_;
+  // the distance between two poses shrinks at most at the sum of the
+  // velocities, directional edges are culled by the same range since their
+  // gradient vanishes with the distance
+  double robot_ttc_range =
+      robot_radius_ + human_radius_ +
+      (robot_vel + human_vel) *
+          (cfg_->human.ttc_threshold + cfg_->optim.penalty_epsilon);
+
+  // the cumulative pose times change with every outer iteration
+  TrajectorySweep robot_sweep;
+  std::map<uint64_t, TrajectorySweep> human_sweeps;
+  robot_sweep.build(teb_, robot_vel, margin);
+  for (auto &human_teb_kv : humans_tebs_map_)
+    human_sweeps[human_teb_kv.first].build(human_teb_kv.second, human_vel,
+                                           margin);
+
+  bool use_ttc =
+      cfg_->optim.use_human_robot_ttc_c || cfg_->optim.use_human_robot_dir_c;
+  for (auto &human_sweep_kv : human_sweeps) {
+    if (cfg_->optim.use_human_robot_safety_c) {
+      auto &pairs = interactions.robot_safety[human_sweep_kv.first];
+      associatePosesByTime(robot_sweep, human_sweep_kv.second, false, pairs);
+      if (cull)
+        filterInteractingPoses(robot_sweep, human_sweep_kv.second,
+                               robot_safety_range, pairs);
+    }
+    if (use_ttc) {
+      auto &pairs = interactions.robot_ttc[human_sweep_kv.first];
+      associatePosesByTime(robot_sweep, human_sweep_kv.second, true, pairs);
+      std::size_t no_pairs = pairs.size();
+      if (cull)
+        filterInteractingPoses(robot_sweep, human_sweep_kv.second,
+                               robot_ttc_range, pairs);
+      if (cfg_->optim.use_human_robot_dir_c)
+        interactions.culled_directional += no_pairs - pairs.size();
+    }
+  }
+
+  if (cfg_->optim.use_human_human_safety_c) {
+    for (auto oi = human_sweeps.begin(); oi != human_sweeps.end(); ++oi) {
+      for (auto ii = std::next(oi); ii != human_sweeps.end(); ++ii) {
+        auto &pairs =
+            interactions.human_safety[std::make_pair(oi->first, ii->first)];
+        associatePosesByIndex(oi->second, ii->second, pairs);
+        if (cull)
+          filterInteractingPoses(oi->second, ii->second, human_safety_range,
+                                 pairs);
+      }
+    }
+  }
+}
+
+void TebOptimalPlanner::AddEdgesHumanInteractions() {
+  TEB_PROFILE_SCOPE("planner/graph/human_interactions");
+  if (cfg_->optim.use_human_robot_safety_c) {
+    AddEdgesHumanRobotSafety();
+  }
+
+  if (cfg_->optim.use_human_human_safety_c) {
+    AddEdgesHumanHumanSafety();
+  }
 
+  if (cfg_->optim.use_human_robot_ttc_c) {
+    AddEdgesHumanRobotTTC();
+  }
+
+  if (cfg_->optim.use_human_robot_dir_c) {
+    AddEdgesHumanRobotDirectional();
+  }
+}
+
+void TebOptimalPlanner::AddEdgesHumanRobotSafety() {
   for (auto &human_teb_kv : humans_tebs_map_) {
     auto &human_teb = human_teb_kv.second;
 
-    for (unsigned int i = 0;
-         (i < human_teb.sizePoses()) && (i < robot_teb_size); i++) {
+    for (auto &pair : interactions_.robot_safety[human_teb_kv.first]) {
       Eigen::Matrix<double, 1, 1> information_human_robot;
       information_human_robot.fill(cfg_->optim.weight_human_robot_safety);
 
       EdgeHumanRobotSafety *human_robot_safety_edge = new EdgeHumanRobotSafety;
-      human_robot_safety_edge->setVertex(0, teb_.PoseVertex(i));
-      human_robot_safety_edge->setVertex(1, human_teb.PoseVertex(i));
+      human_robot_safety_edge->setVertex(0, teb_.PoseVertex(pair.first));
+      human_robot_safety_edge->setVertex(1, human_teb.PoseVertex(pair.second));
       human_robot_safety_edge->setInformation(information_human_robot);
       human_robot_safety_edge->setParameters(*cfg_, robot_model_.get(),
                                              human_radius_);
       optimizer_->addEdge(human_robot_safety_edge);
+      graph_edges_.human_robot_safety.push_back(human_robot_safety_edge);
     }
   }
 }
@@ -1242,21 +1842,25 @@ void TebOptimalPlanner::AddEdgesHumanRobotSafety() {
 void TebOptimalPlanner::AddEdgesHumanHumanSafety() {
   for (auto oi = humans_tebs_map_.begin(); oi != humans_tebs_map_.end();) {
     auto &human1_teb = oi->second;
+    uint64_t human1_id = oi->first;
     for (auto ii = ++oi; ii != humans_tebs_map_.end(); ii++) {
       auto &human2_teb = ii->second;
 
-      for (unsigned int k = 0;
-           (k < human1_teb.sizePoses()) && (k < human2_teb.sizePoses()); k++) {
+      for (auto &pair :
+           interactions_.human_safety[std::make_pair(human1_id, ii->first)]) {
         Eigen::Matrix<double, 1, 1> information_human_human;
         information_human_human.fill(cfg_->optim.weight_human_human_safety);
 
         EdgeHumanHumanSafety *human_human_safety_edge =
             new EdgeHumanHumanSafety;
-        human_human_safety_edge->setVertex(0, human1_teb.PoseVertex(k));
-        human_human_safety_edge->setVertex(1, human2_teb.PoseVertex(k));
+        human_human_safety_edge->setVertex(0,
+                                           human1_teb.PoseVertex(pair.first));
+        human_human_safety_edge->setVertex(1,
+                                           human2_teb.PoseVertex(pair.second));
         human_human_safety_edge->setInformation(information_human_human);
         human_human_safety_edge->setParameters(*cfg_, human_radius_);
         optimizer_->addEdge(human_human_safety_edge);
+        graph_edges_.human_human_safety.push_back(human_human_safety_edge);
       }
     }
   }
@@ -1266,24 +1870,24 @@ void TebOptimalPlanner::AddEdgesHumanRobotTTC() {
   Eigen::Matrix<double, 1, 1> information_human_robot_ttc;
   information_human_robot_ttc.fill(cfg_->optim.weight_human_robot_ttc);
 
-  auto robot_teb_size = teb_.sizePoses();
   for (auto &human_teb_kv : humans_tebs_map_) {
     auto &human_teb = human_teb_kv.second;
 
-    size_t human_teb_size = human_teb.sizePoses();
-    for (unsigned int i = 0;
-         (i < human_teb_size - 1) && (i < robot_teb_size - 1); i++) {
+    // pairs of segments (i, i+1) and (j, j+1)
+    for (auto &pair : interactions_.robot_ttc[human_teb_kv.first]) {
+      unsigned int i = pair.first, j = pair.second;
 
       EdgeHumanRobotTTC *human_robot_ttc_edge = new EdgeHumanRobotTTC;
       human_robot_ttc_edge->setVertex(0, teb_.PoseVertex(i));
       human_robot_ttc_edge->setVertex(1, teb_.PoseVertex(i + 1));
       human_robot_ttc_edge->setVertex(2, teb_.TimeDiffVertex(i));
-      human_robot_ttc_edge->setVertex(3, human_teb.PoseVertex(i));
-      human_robot_ttc_edge->setVertex(4, human_teb.PoseVertex(i + 1));
-      human_robot_ttc_edge->setVertex(5, human_teb.TimeDiffVertex(i));
+      human_robot_ttc_edge->setVertex(3, human_teb.PoseVertex(j));
+      human_robot_ttc_edge->setVertex(4, human_teb.PoseVertex(j + 1));
+      human_robot_ttc_edge->setVertex(5, human_teb.TimeDiffVertex(j));
       human_robot_ttc_edge->setInformation(information_human_robot_ttc);
       human_robot_ttc_edge->setParameters(*cfg_, robot_radius_, human_radius_);
       optimizer_->addEdge(human_robot_ttc_edge);
+      graph_edges_.human_robot_ttc.push_back(human_robot_ttc_edge);
     }
   }
 }
@@ -1292,30 +1896,31 @@ void TebOptimalPlanner::AddEdgesHumanRobotDirectional() {
   Eigen::Matrix<double, 1, 1> information_human_robot_directional;
   information_human_robot_directional.fill(cfg_->optim.weight_human_robot_dir);
 
-  auto robot_teb_size = teb_.sizePoses();
   for (auto &human_teb_kv : humans_tebs_map_) {
     auto &human_teb = human_teb_kv.second;
 
-    size_t human_teb_size = human_teb.sizePoses();
-    for (unsigned int i = 0;
-         (i < human_teb_size - 1) && (i < robot_teb_size - 1); i++) {
+    // pairs of segments (i, i+1) and (j, j+1)
+    for (auto &pair : interactions_.robot_ttc[human_teb_kv.first]) {
+      unsigned int i = pair.first, j = pair.second;
 
       EdgeHumanRobotDirectional *human_robot_dir_edge =
           new EdgeHumanRobotDirectional;
       human_robot_dir_edge->setVertex(0, teb_.PoseVertex(i));
       human_robot_dir_edge->setVertex(1, teb_.PoseVertex(i + 1));
       human_robot_dir_edge->setVertex(2, teb_.TimeDiffVertex(i));
-      human_robot_dir_edge->setVertex(3, human_teb.PoseVertex(i));
-      human_robot_dir_edge->setVertex(4, human_teb.PoseVertex(i + 1));
-      human_robot_dir_edge->setVertex(5, human_teb.TimeDiffVertex(i));
+      human_robot_dir_edge->setVertex(3, human_teb.PoseVertex(j));
+      human_robot_dir_edge->setVertex(4, human_teb.PoseVertex(j + 1));
+      human_robot_dir_edge->setVertex(5, human_teb.TimeDiffVertex(j));
       human_robot_dir_edge->setInformation(information_human_robot_directional);
       human_robot_dir_edge->setTebConfig(*cfg_);
       optimizer_->addEdge(human_robot_dir_edge);
+      graph_edges_.human_robot_directional.push_back(human_robot_dir_edge);
     }
   }
 }
 
 void TebOptimalPlanner::AddVertexEdgesApproach() {
+  TEB_PROFILE_SCOPE("planner/graph/approach");
   if (!approach_pose_vertex) {
     ROS_ERROR("approch pose vertex does not exist");
     return;
@@ -1331,6 +1936,7 @@ void TebOptimalPlanner::AddVertexEdgesApproach() {
     approach_edge->setInformation(information_approach);
     approach_edge->setParameters(*cfg_, robot_model_.get(), human_radius_);
     optimizer_->addEdge(approach_edge);
+    graph_edges_.human_robot_safety.push_back(approach_edge);
   }
 }
 
@@ -1338,6 +1944,7 @@ void TebOptimalPlanner::computeCurrentCost(
     double obst_cost_scale, double viapoint_cost_scale,
     bool alternative_time_cost,
     teb_local_planner::OptimizationCostArray *op_costs) {
+  TEB_PROFILE_SCOPE("planner/compute_cost");
   // check if graph is empty/exist  -> important if function is called between
   // buildGraph and optimizeGraph/clearGraph
   bool graph_exist_flag(false);
@@ -1369,121 +1976,43 @@ void TebOptimalPlanner::computeCurrentCost(
     // using an AutoResize Function with hysteresis.
   }
 
-  // now we need pointers to all edges -> calculate error for each edge-type
-  // since we aren't storing edge pointers, we need to check every edge
-  for (std::vector<g2o::OptimizableGraph::Edge *>::const_iterator it =
-           optimizer_->activeEdges().begin();
-       it != optimizer_->activeEdges().end(); it++) {
-    EdgeTimeOptimal *edge_time_optimal = dynamic_cast<EdgeTimeOptimal *>(*it);
-    if (edge_time_optimal != NULL && !alternative_time_cost) {
-      cost_ += edge_time_optimal->getError().squaredNorm();
-      time_opt_cost += edge_time_optimal->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeKinematicsDiffDrive *edge_kinematics_dd =
-        dynamic_cast<EdgeKinematicsDiffDrive *>(*it);
-    if (edge_kinematics_dd != NULL) {
-      cost_ += edge_kinematics_dd->getError().squaredNorm();
-      kinematics_dd_cost += edge_kinematics_dd->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeKinematicsCarlike *edge_kinematics_cl =
-        dynamic_cast<EdgeKinematicsCarlike *>(*it);
-    if (edge_kinematics_cl != NULL) {
-      cost_ += edge_kinematics_cl->getError().squaredNorm();
-      kinematics_cl_cost += edge_kinematics_cl->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeVelocity *edge_velocity = dynamic_cast<EdgeVelocity *>(*it);
-    if (edge_velocity != NULL) {
-      cost_ += edge_velocity->getError().squaredNorm();
-      robot_vel_cost += edge_velocity->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeVelocityHuman *edge_velocity_human =
-        dynamic_cast<EdgeVelocityHuman *>(*it);
-    if (edge_velocity_human != NULL) {
-      cost_ += edge_velocity_human->getError().squaredNorm();
-      human_vel_cost += edge_velocity_human->getError().squaredNorm();
-      continue;
-    }
-
-    // TODO: add cost of start and goal accelerations
-
-    EdgeAcceleration *edge_acceleration = dynamic_cast<EdgeAcceleration *>(*it);
-    if (edge_acceleration != NULL) {
-      cost_ += edge_acceleration->getError().squaredNorm();
-      robot_acc_cost += edge_acceleration->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeAccelerationHuman *edge_acceleration_human =
-        dynamic_cast<EdgeAccelerationHuman *>(*it);
-    if (edge_acceleration_human != NULL) {
-      cost_ += edge_acceleration_human->getError().squaredNorm();
-      human_acc_cost += edge_acceleration_human->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeObstacle *edge_obstacle = dynamic_cast<EdgeObstacle *>(*it);
-    if (edge_obstacle != NULL) {
-      cost_ += edge_obstacle->getError().squaredNorm() * obst_cost_scale;
-      obst_cost += edge_obstacle->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeDynamicObstacle *edge_dyn_obstacle =
-        dynamic_cast<EdgeDynamicObstacle *>(*it);
-    if (edge_dyn_obstacle != NULL) {
-      cost_ += edge_dyn_obstacle->getError().squaredNorm() * obst_cost_scale;
-      dyn_obst_cost += edge_dyn_obstacle->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeViaPoint *edge_viapoint = dynamic_cast<EdgeViaPoint *>(*it);
-    if (edge_viapoint != NULL) {
-      cost_ += edge_viapoint->getError().squaredNorm() * viapoint_cost_scale;
-      via_cost += edge_viapoint->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeHumanRobotSafety *edge_human_robot_safety =
-        dynamic_cast<EdgeHumanRobotSafety *>(*it);
-    if (edge_human_robot_safety != NULL) {
-      cost_ += edge_human_robot_safety->getError().squaredNorm();
-      hr_safety_cost += edge_human_robot_safety->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeHumanHumanSafety *edge_human_human_safety =
-        dynamic_cast<EdgeHumanHumanSafety *>(*it);
-    if (edge_human_human_safety != NULL) {
-      cost_ += edge_human_human_safety->getError().squaredNorm();
-      hh_safety_cost += edge_human_human_safety->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeHumanRobotTTC *edge_human_robot_ttc =
-        dynamic_cast<EdgeHumanRobotTTC *>(*it);
-    if (edge_human_robot_ttc != NULL) {
-      cost_ += edge_human_robot_ttc->getError().squaredNorm();
-      hr_ttc_cost += edge_human_robot_ttc->getError().squaredNorm();
-      continue;
-    }
-
-    EdgeHumanRobotDirectional *edge_human_robot_directional =
-        dynamic_cast<EdgeHumanRobotDirectional *>(*it);
-    if (edge_human_robot_directional != NULL) {
-      cost_ += edge_human_robot_directional->getError().squaredNorm();
-      hr_dir_cost += edge_human_robot_directional->getError().squaredNorm();
-      continue;
-    }
+  // calculate the error for each edge-type from the edges stored while
+  // building the graph
+  if (!alternative_time_cost)
+    time_opt_cost = sumOfSquaredErrors(graph_edges_.time_optimal);
+  kinematics_dd_cost = sumOfSquaredErrors(graph_edges_.kinematics_dd);
+  kinematics_cl_cost = sumOfSquaredErrors(graph_edges_.kinematics_cl);
+  robot_vel_cost = sumOfSquaredErrors(graph_edges_.robot_velocity);
+  human_vel_cost = sumOfSquaredErrors(graph_edges_.human_velocity);
+  // TODO: add cost of start and goal accelerations
+  robot_acc_cost = sumOfSquaredErrors(graph_edges_.robot_acceleration);
+  human_acc_cost = sumOfSquaredErrors(graph_edges_.human_acceleration);
+  obst_cost = sumOfSquaredErrors(graph_edges_.obstacle) +
+              sumOfSquaredErrors(graph_edges_.indexed_obstacle) +
+              sumOfSquaredErrors(graph_edges_.distance_field);
+  dyn_obst_cost = sumOfSquaredErrors(graph_edges_.dynamic_obstacle);
+  via_cost = sumOfSquaredErrors(graph_edges_.via_point) +
+             sumOfSquaredErrors(graph_edges_.human_via_point);
+  hr_safety_cost = sumOfSquaredErrors(graph_edges_.human_robot_safety);
+  hh_safety_cost = sumOfSquaredErrors(graph_edges_.human_human_safety);
+  hr_ttc_cost = sumOfSquaredErrors(graph_edges_.human_robot_ttc);
+  hr_dir_cost = sumOfSquaredErrors(graph_edges_.human_robot_directional);
+  if (cfg_->planning_mode == 1 && cfg_->optim.use_human_robot_dir_c) {
+    // the directional cost of far apart segments vanishes, but their edges
+    // keep the error of its lower bound: count it for the culled pairs, such
+    // that the cost is comparable between candidates with different culling
+    double culled_error =
+        cfg_->human.dir_cost_threshold + cfg_->optim.penalty_epsilon;
+    hr_dir_cost +=
+        interactions_.culled_directional * culled_error * culled_error;
   }
 
+  cost_ += time_opt_cost + kinematics_dd_cost + kinematics_cl_cost +
+           robot_vel_cost + human_vel_cost + robot_acc_cost + human_acc_cost +
+           (obst_cost + dyn_obst_cost) * obst_cost_scale +
+           via_cost * viapoint_cost_scale + hr_safety_cost + hh_safety_cost +
+           hr_ttc_cost + hr_dir_cost;
+
   if (op_costs) {
     op_costs->costs.clear();
 
@@ -0,0 +1,189 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/pose_grid_index.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace teb_local_planner {
+
+// keep the number of cells proportional to the number of poses
+#define MAX_CELLS_PER_POSE 4.0
+#define MIN_CELL_SIZE 1e-3 // meters
+
+PoseGridIndex::PoseGridIndex()
+    : origin_(Eigen::Vector2d::Zero()), cell_size_(1.0), cols_(0), rows_(0) {}
+
+void PoseGridIndex::clear() {
+  positions_.clear();
+  cell_start_.clear();
+  cell_poses_.clear();
+  cols_ = rows_ = 0;
+}
+
+void PoseGridIndex::build(const TimedElasticBand &teb) {
+  clear();
+  int n = teb.sizePoses();
+  if (n == 0)
+    return;
+
+  positions_.reserve(n);
+  Eigen::Vector2d min_corner = teb.Pose(0).position();
+  Eigen::Vector2d max_corner = min_corner;
+  double length = 0.0;
+  for (int i = 0; i < n; ++i) {
+    positions_.push_back(teb.Pose(i).position());
+    min_corner = min_corner.cwiseMin(positions_.back());
+    max_corner = max_corner.cwiseMax(positions_.back());
+    if (i > 0)
+      length += (positions_[i] - positions_[i - 1]).norm();
+  }
+
+  // cells of the size of the mean distance between consecutive poses
+  cell_size_ = n > 1 ? length / (n - 1) : 1.0;
+  cell_size_ = std::max(cell_size_, MIN_CELL_SIZE);
+  Eigen::Vector2d extent = max_corner - min_corner;
+  double cells = (std::floor(extent.x() / cell_size_) + 1) *
+                 (std::floor(extent.y() / cell_size_) + 1);
+  if (cells > MAX_CELLS_PER_POSE * n)
+    cell_size_ *= std::sqrt(cells / (MAX_CELLS_PER_POSE * n));
+
+  origin_ = min_corner;
+  cols_ = (int)std::floor(extent.x() / cell_size_) + 1;
+  rows_ = (int)std::floor(extent.y() / cell_size_) + 1;
+
+  // counting sort of the poses by cell
+  std::vector<int> pose_cells(n);
+  cell_start_.assign(cols_ * rows_ + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    int cx, cy;
+    cellOf(positions_[i], cx, cy);
+    pose_cells[i] = cy * cols_ + cx;
+    ++cell_start_[pose_cells[i] + 1];
+  }
+  for (std::size_t c = 1; c < cell_start_.size(); ++c)
+    cell_start_[c] += cell_start_[c - 1];
+
+  cell_poses_.resize(n);
+  std::vector<int> fill(cell_start_.begin(), cell_start_.end() - 1);
+  for (int i = 0; i < n; ++i) // poses stay in ascending order within cells
+    cell_poses_[fill[pose_cells[i]]++] = i;
+}
+
+void PoseGridIndex::cellOf(const Eigen::Ref<const Eigen::Vector2d> &point,
+                           int &cx, int &cy) const {
+  double fx = std::floor((point.x() - origin_.x()) / cell_size_);
+  double fy = std::floor((point.y() - origin_.y()) / cell_size_);
+  cx = (int)std::min(std::max(fx, 0.0), (double)(cols_ - 1));
+  cy = (int)std::min(std::max(fy, 0.0), (double)(rows_ - 1));
+}
+
+int PoseGridIndex::findClosestPose(
+    const Eigen::Ref<const Eigen::Vector2d> &ref_point,
+    double *distance) const {
+  if (positions_.empty())
+    return -1;
+
+  int cx, cy;
+  cellOf(ref_point, cx, cy);
+
+  int best = -1;
+  double best_sq_dist = std::numeric_limits<double>::infinity();
+  auto visitCell = [&](int x, int y) {
+    if (x < 0 || x >= cols_ || y < 0 || y >= rows_)
+      return;
+    int cell = y * cols_ + x;
+    for (int k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+      int i = cell_poses_[k];
+      double sq_dist = (positions_[i] - ref_point).squaredNorm();
+      // prefer the lower index on ties like the linear search does
+      if (sq_dist < best_sq_dist || (sq_dist == best_sq_dist && i < best)) {
+        best_sq_dist = sq_dist;
+        best = i;
+      }
+    }
+  };
+
+  // search rings of cells around the cell of the reference point until no
+  // closer pose can exist outside of the searched square
+  for (int r = 0;; ++r) {
+    for (int y = cy - r; y <= cy + r; ++y) {
+      if (y == cy - r || y == cy + r) {
+        for (int x = cx - r; x <= cx + r; ++x)
+          visitCell(x, y);
+      } else {
+        visitCell(cx - r, y);
+        visitCell(cx + r, y);
+      }
+    }
+
+    double bound = std::numeric_limits<double>::infinity();
+    if (cx - r > 0)
+      bound = std::min(bound,
+                       ref_point.x() - origin_.x() - (cx - r) * cell_size_);
+    if (cx + r < cols_ - 1)
+      bound = std::min(bound,
+                       origin_.x() + (cx + r + 1) * cell_size_ - ref_point.x());
+    if (cy - r > 0)
+      bound = std::min(bound,
+                       ref_point.y() - origin_.y() - (cy - r) * cell_size_);
+    if (cy + r < rows_ - 1)
+      bound = std::min(bound,
+                       origin_.y() + (cy + r + 1) * cell_size_ - ref_point.y());
+
+    if (std::isinf(bound)) // whole grid searched
+      break;
+    if (best >= 0 && best_sq_dist < bound * bound)
+      break;
+  }
+
+  if (distance)
+    *distance = std::sqrt(best_sq_dist);
+  return best;
+}
+
+int PoseGridIndex::findClosestPose(const Obstacle &obstacle,
+                                   const TimedElasticBand &teb,
+                                   double *distance) const {
+  const PointObstacle *pobst = dynamic_cast<const PointObstacle *>(&obstacle);
+  if (pobst && !positions_.empty())
+    return findClosestPose(pobst->position(), distance);
+
+  return teb.findClosestTrajectoryPose(obstacle, distance);
+}
+
+} // namespace teb_local_planner
@@ -0,0 +1,125 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/profiler.h>
+
+#include <algorithm>
+
+namespace teb_local_planner {
+
+std::atomic<bool> Profiler::enabled_(false);
+
+Histogram::Histogram(const std::string &name, Unit unit)
+    : name_(name), unit_(unit), count_(0), sum_(0), max_(0) {
+  for (auto &bucket : buckets_)
+    bucket.store(0, std::memory_order_relaxed);
+}
+
+double Histogram::bucketCenter(int bucket) {
+  if (bucket < 4)
+    return bucket;
+  int octave = bucket / 4 + 1;
+  double width = static_cast<double>(uint64_t(1) << (octave - 2));
+  return (4 + bucket % 4) * width + (width - 1.0) / 2.0;
+}
+
+Histogram::Summary Histogram::summarize(bool reset) {
+  // a snapshot of the counters, values added meanwhile may be split between
+  // this and the next period
+  uint64_t counts[NO_BUCKETS];
+  Summary summary;
+  summary.name = name_;
+  summary.unit = unit_;
+  summary.count = 0;
+  for (int i = 0; i < NO_BUCKETS; ++i) {
+    counts[i] = reset ? buckets_[i].exchange(0, std::memory_order_relaxed)
+                      : buckets_[i].load(std::memory_order_relaxed);
+    summary.count += counts[i];
+  }
+  uint64_t sum = reset ? sum_.exchange(0, std::memory_order_relaxed)
+                       : sum_.load(std::memory_order_relaxed);
+  uint64_t max = reset ? max_.exchange(0, std::memory_order_relaxed)
+                       : max_.load(std::memory_order_relaxed);
+  if (reset)
+    count_.store(0, std::memory_order_relaxed);
+
+  double scale = unit_ == SECONDS ? 1e-9 : 1.0;
+  summary.mean =
+      summary.count > 0 ? scale * static_cast<double>(sum) / summary.count : 0;
+  summary.max = scale * static_cast<double>(max);
+
+  const double quantiles[] = {0.5, 0.95, 0.99};
+  double *percentiles[] = {&summary.p50, &summary.p95, &summary.p99};
+  uint64_t cumulative = 0;
+  int q = 0;
+  for (int i = 0; i < NO_BUCKETS && q < 3; ++i) {
+    cumulative += counts[i];
+    while (q < 3 && summary.count > 0 &&
+           cumulative >= quantiles[q] * summary.count) {
+      *percentiles[q] =
+          std::min(scale * bucketCenter(i), summary.max); // bucket of the max
+      ++q;
+    }
+  }
+  for (; q < 3; ++q)
+    *percentiles[q] = 0.0;
+  return summary;
+}
+
+Profiler &Profiler::instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Histogram &Profiler::histogram(const std::string &name, Histogram::Unit unit) {
+  boost::mutex::scoped_lock l(mutex_);
+  std::unique_ptr<Histogram> &histogram = histograms_[name];
+  if (!histogram)
+    histogram.reset(new Histogram(name, unit));
+  return *histogram;
+}
+
+std::vector<Histogram::Summary> Profiler::summarize(bool reset) {
+  boost::mutex::scoped_lock l(mutex_);
+  std::vector<Histogram::Summary> summaries;
+  for (auto &histogram_kv : histograms_) {
+    Histogram::Summary summary = histogram_kv.second->summarize(reset);
+    if (summary.count > 0)
+      summaries.push_back(summary);
+  }
+  return summaries;
+}
+
+} // namespace teb_local_planner
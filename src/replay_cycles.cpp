@@ -0,0 +1,290 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Replays the planning cycles recorded by TebLocalPlannerROS (parameter
+// record_cycles) without a ROS master, e.g. to profile the planner or to
+// bisect a performance regression on the inputs of a field run.
+//
+// Usage: replay_cycles <ring file> [options]
+//   --first N           skip the records with a smaller sequence number
+//   --last N            stop after the record with this sequence number
+//   --runs N            replay the cycles N times (default 1)
+//   --param NAME VALUE  override a recorded parameter, e.g.
+//                       --param optim.no_inner_iterations 3
+//   --csv FILE          write the recorded and replayed results per cycle
+//   --verbose           print each cycle
+
+#include <teb_local_planner/cycle_recorder.h>
+#include <teb_local_planner/homotopy_class_planner.h>
+#include <teb_local_planner/optimal_planner.h>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace teb_local_planner;
+
+namespace {
+
+//! State the planner refers to, recreated with each configuration record
+struct Replay {
+  boost::shared_ptr<TebConfig> cfg;
+  RobotFootprintModelPtr robot_model;
+  ObstContainer obstacles;
+  ViaPointContainer via_points;
+  std::map<uint64_t, ViaPointContainer> humans_via_points;
+  PlannerInterfacePtr planner;
+
+  void applyConfig(const RecordedConfig &config,
+                   const std::map<std::string, double> &overrides) {
+    planner.reset(); // refers to the previous configuration
+    cfg = boost::make_shared<TebConfig>();
+    config.apply(*cfg);
+    RecordedConfig overridden;
+    overridden.parameters = overrides;
+    overridden.apply(*cfg);
+    robot_model = config.robot_model;
+  }
+
+  void createPlanner() {
+    if (cfg->hcp.enable_homotopy_class_planning) {
+      planner = PlannerInterfacePtr(new HomotopyClassPlanner(
+          *cfg, &obstacles, robot_model, TebVisualizationPtr(), &via_points));
+    } else {
+      planner = PlannerInterfacePtr(new TebOptimalPlanner(
+          *cfg, &obstacles, robot_model, TebVisualizationPtr(), &via_points,
+          boost::make_shared<CircularRobotFootprint>(
+              std::max(cfg->human.radius, 0.0)),
+          &humans_via_points));
+    }
+  }
+};
+
+struct CycleResult {
+  uint64_t sequence;
+  bool recorded_success, success;
+  double recorded_time, time; // [s]
+  double recorded_vx, recorded_omega, vx, omega;
+};
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty())
+    return 0.0;
+  std::size_t i = std::min(values.size() - 1,
+                           static_cast<std::size_t>(p * values.size()));
+  std::nth_element(values.begin(), values.begin() + i, values.end());
+  return values[i];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ros::Time::init(); // the planners use ros::Time without a master
+
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <ring file> [--first N] [--last N] "
+                         "[--runs N] [--param NAME VALUE] [--csv FILE] "
+                         "[--verbose]\n",
+                 argv[0]);
+    return 2;
+  }
+  std::string filename = argv[1];
+  uint64_t first = 0, last = UINT64_MAX;
+  int no_runs = 1;
+  bool verbose = false;
+  std::string csv_file;
+  std::map<std::string, double> overrides;
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--first" && i + 1 < argc)
+      first = std::strtoull(argv[++i], NULL, 10);
+    else if (arg == "--last" && i + 1 < argc)
+      last = std::strtoull(argv[++i], NULL, 10);
+    else if (arg == "--runs" && i + 1 < argc)
+      no_runs = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--param" && i + 2 < argc) {
+      overrides[argv[i + 1]] = std::atof(argv[i + 2]);
+      i += 2;
+    } else if (arg == "--csv" && i + 1 < argc)
+      csv_file = argv[++i];
+    else if (arg == "--verbose")
+      verbose = true;
+    else {
+      std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+      return 2;
+    }
+  }
+
+  std::vector<CycleResult> results;
+  for (int run = 0; run < no_runs; ++run) {
+    CycleReader reader;
+    if (!reader.open(filename)) {
+      std::fprintf(stderr, "cannot read the ring file %s\n", filename.c_str());
+      return 2;
+    }
+    if (run == 0)
+      std::printf("%s: %lu records\n", filename.c_str(),
+                  static_cast<unsigned long>(reader.size()));
+
+    Replay replay;
+    if (reader.hasConfig())
+      replay.applyConfig(reader.config(), overrides);
+    bool warned_distance_field = false;
+    for (CycleRecorder::RecordType type = reader.next();
+         type != CycleRecorder::WRAP && reader.sequence() <= last;
+         type = reader.next()) {
+      // configurations preceding the first cycle apply nevertheless
+      if (type == CycleRecorder::CONFIG) {
+        replay.applyConfig(reader.config(), overrides);
+        continue;
+      }
+      if (reader.sequence() < first)
+        continue;
+
+      if (type == CycleRecorder::RESET) {
+        if (replay.planner)
+          replay.planner->clearPlanner();
+        continue;
+      }
+
+      // CYCLE
+      if (!replay.cfg) {
+        std::fprintf(stderr, "cycle %lu has no recorded configuration, "
+                             "cannot replay it\n",
+                     static_cast<unsigned long>(reader.sequence()));
+        return 1;
+      }
+      if (replay.cfg->obstacles.obstacle_distance_field &&
+          !warned_distance_field) {
+        std::fprintf(stderr, "the costmap distance field is not recorded, "
+                             "only the recorded obstacles are replayed\n");
+        warned_distance_field = true;
+      }
+      if (!replay.planner)
+        replay.createPlanner();
+
+      const RecordedCycle &cycle = reader.cycle();
+      replay.obstacles = cycle.obstacles;
+      replay.via_points = cycle.via_points;
+      replay.humans_via_points = cycle.humans_via_points;
+      replay.planner->local_weight_optimaltime_ = cycle.weight_optimaltime;
+
+      CycleResult result;
+      result.sequence = reader.sequence();
+      result.recorded_success = cycle.success;
+      result.recorded_time = cycle.plan_time;
+      result.recorded_vx = cycle.vx;
+      result.recorded_omega = cycle.omega;
+      result.vx = result.omega = 0.0;
+
+      auto start = std::chrono::steady_clock::now();
+      result.success = replay.planner->plan(
+          cycle.plan, &cycle.start_vel, cycle.free_goal_vel,
+          &cycle.human_plans);
+      result.time = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+      if (result.success)
+        replay.planner->getVelocityCommand(result.vx, result.omega);
+      else
+        replay.planner->clearPlanner(); // as TebLocalPlannerROS does
+
+      if (verbose)
+        std::printf("cycle %8lu: %s %8.3f ms (recorded %s %8.3f ms), "
+                    "v %6.3f / %6.3f, omega %6.3f / %6.3f\n",
+                    static_cast<unsigned long>(result.sequence),
+                    result.success ? "ok    " : "failed", 1e3 * result.time,
+                    result.recorded_success ? "ok    " : "failed",
+                    1e3 * result.recorded_time, result.vx, result.recorded_vx,
+                    result.omega, result.recorded_omega);
+      results.push_back(result);
+    }
+  }
+
+  if (results.empty()) {
+    std::printf("no cycles to replay\n");
+    return 1;
+  }
+
+  std::vector<double> times, recorded_times;
+  int success_mismatches = 0;
+  double max_vx_diff = 0.0, max_omega_diff = 0.0;
+  for (const CycleResult &r : results) {
+    times.push_back(1e3 * r.time);
+    recorded_times.push_back(1e3 * r.recorded_time);
+    if (r.success != r.recorded_success)
+      ++success_mismatches;
+    else if (r.success) {
+      max_vx_diff = std::max(max_vx_diff, std::abs(r.vx - r.recorded_vx));
+      max_omega_diff =
+          std::max(max_omega_diff, std::abs(r.omega - r.recorded_omega));
+    }
+  }
+  std::printf("%lu cycles (%d runs)\n",
+              static_cast<unsigned long>(results.size()), no_runs);
+  std::printf("%-10s %10s %10s %10s %10s\n", "[ms]", "p50", "p95", "p99",
+              "max");
+  std::printf("%-10s %10.3f %10.3f %10.3f %10.3f\n", "replayed",
+              percentile(times, 0.5), percentile(times, 0.95),
+              percentile(times, 0.99), percentile(times, 1.0));
+  std::printf("%-10s %10.3f %10.3f %10.3f %10.3f\n", "recorded",
+              percentile(recorded_times, 0.5),
+              percentile(recorded_times, 0.95),
+              percentile(recorded_times, 0.99),
+              percentile(recorded_times, 1.0));
+  std::printf("success mismatches: %d, max command difference: v %.4f m/s, "
+              "omega %.4f rad/s\n",
+              success_mismatches, max_vx_diff, max_omega_diff);
+
+  if (!csv_file.empty()) {
+    std::ofstream csv(csv_file.c_str());
+    csv << "sequence,recorded_success,success,recorded_ms,ms,recorded_vx,vx,"
+           "recorded_omega,omega\n";
+    for (const CycleResult &r : results)
+      csv << r.sequence << "," << r.recorded_success << "," << r.success << ","
+          << 1e3 * r.recorded_time << "," << 1e3 * r.time << ","
+          << r.recorded_vx << "," << r.vx << "," << r.recorded_omega << ","
+          << r.omega << "\n";
+  }
+  return 0;
+}
@@ -53,6 +53,8 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle &nh) {
 
   // Trajectory
   nh.param("teb_autosize", trajectory.teb_autosize, trajectory.teb_autosize);
+  nh.param("teb_autosize_exact_dt", trajectory.teb_autosize_exact_dt,
+           trajectory.teb_autosize_exact_dt);
   nh.param("dt_ref", trajectory.dt_ref, trajectory.dt_ref);
   nh.param("dt_hysteresis", trajectory.dt_hysteresis, trajectory.dt_hysteresis);
   nh.param("min_samples", trajectory.min_samples, trajectory.min_samples);
@@ -118,6 +120,14 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle &nh) {
   nh.param("ttc_threshold", human.ttc_threshold, human.ttc_threshold);
   nh.param("human_pose_prediction_reset_time", human.pose_prediction_reset_time,
            human.pose_prediction_reset_time);
+  nh.param("human_prediction_rate", human.prediction_rate,
+           human.prediction_rate);
+  nh.param("cull_human_interactions", human.cull_interactions,
+           human.cull_interactions);
+  nh.param("human_interaction_margin", human.interaction_margin,
+           human.interaction_margin);
+  nh.param("no_human_update_threads", human.no_update_threads,
+           human.no_update_threads);
 
   // GoalTolerance
   nh.param("xy_goal_tolerance", goal_tolerance.xy_goal_tolerance,
@@ -143,6 +153,10 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle &nh) {
            obstacles.costmap_obstacles_behind_robot_dist);
   nh.param("obstacle_poses_affected", obstacles.obstacle_poses_affected,
            obstacles.obstacle_poses_affected);
+  nh.param("obstacle_distance_field", obstacles.obstacle_distance_field,
+           obstacles.obstacle_distance_field);
+  nh.param("footprint_circles", obstacles.footprint_circles,
+           obstacles.footprint_circles);
   nh.param("costmap_converter_plugin", obstacles.costmap_converter_plugin,
            obstacles.costmap_converter_plugin);
   nh.param("costmap_converter_spin_thread",
@@ -154,6 +168,10 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle &nh) {
            optim.no_inner_iterations);
   nh.param("no_outer_iterations", optim.no_outer_iterations,
            optim.no_outer_iterations);
+  nh.param("optimization_time_budget", optim.optimization_time_budget,
+           optim.optimization_time_budget);
+  nh.param("convergence_threshold", optim.convergence_threshold,
+           optim.convergence_threshold);
   nh.param("optimization_activate", optim.optimization_activate,
            optim.optimization_activate);
   nh.param("optimization_verbose", optim.optimization_verbose,
@@ -225,16 +243,25 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle &nh) {
            optim.disable_rapid_omega_chage);
   nh.param("omega_chage_time_seperation", optim.omega_chage_time_seperation,
            optim.omega_chage_time_seperation);
+  nh.param("persistent_graph", optim.persistent_graph, optim.persistent_graph);
+  nh.param("linear_solver", optim.linear_solver, optim.linear_solver);
+  nh.param("linear_solver_auto_vertices", optim.linear_solver_auto_vertices,
+           optim.linear_solver_auto_vertices);
 
   // Homotopy Class Planner
   nh.param("enable_homotopy_class_planning", hcp.enable_homotopy_class_planning,
            hcp.enable_homotopy_class_planning);
   nh.param("enable_multithreading", hcp.enable_multithreading,
            hcp.enable_multithreading);
+  nh.param("no_optimization_threads", hcp.no_optimization_threads,
+           hcp.no_optimization_threads);
+  nh.param("cancel_cost_ratio", hcp.cancel_cost_ratio, hcp.cancel_cost_ratio);
   nh.param("simple_exploration", hcp.simple_exploration,
            hcp.simple_exploration);
   nh.param("max_number_classes", hcp.max_number_classes,
            hcp.max_number_classes);
+  nh.param("exploration_time_budget", hcp.exploration_time_budget,
+           hcp.exploration_time_budget);
   nh.param("selection_obst_cost_scale", hcp.selection_obst_cost_scale,
            hcp.selection_obst_cost_scale);
   nh.param("selection_viapoint_cost_scale", hcp.selection_viapoint_cost_scale,
@@ -246,6 +273,8 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle &nh) {
            hcp.selection_alternative_time_cost);
   nh.param("roadmap_graph_samples", hcp.roadmap_graph_no_samples,
            hcp.roadmap_graph_no_samples);
+  nh.param("roadmap_graph_incremental", hcp.roadmap_graph_incremental,
+           hcp.roadmap_graph_incremental);
   nh.param("roadmap_graph_area_width", hcp.roadmap_graph_area_width,
            hcp.roadmap_graph_area_width);
   nh.param("h_signature_prescaler", hcp.h_signature_prescaler,
@@ -295,6 +324,17 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle &nh) {
   nh.param("approach_angle_tolerance", approach.approach_angle_tolerance,
            approach.approach_angle_tolerance);
 
+  // profiling
+  nh.param("enable_profiling", profiling.enable, profiling.enable);
+  nh.param("profiling_publish_period", profiling.publish_period,
+           profiling.publish_period);
+
+  // recorder
+  nh.param("record_cycles", recorder.enable, recorder.enable);
+  nh.param("record_file", recorder.file, recorder.file);
+  nh.param("record_size", recorder.size, recorder.size);
+
+  ++revision_;
   checkParameters();
   checkDeprecated(nh);
 }
@@ -304,6 +344,7 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig &cfg) {
 
   // Trajectory
   trajectory.teb_autosize = cfg.teb_autosize;
+  trajectory.teb_autosize_exact_dt = cfg.teb_autosize_exact_dt;
   trajectory.dt_ref = cfg.dt_ref;
   trajectory.dt_hysteresis = cfg.dt_hysteresis;
   trajectory.global_plan_overwrite_orientation =
@@ -345,6 +386,10 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig &cfg) {
   human.predict_human_behind_robot = cfg.predict_human_behind_robot;
   human.ttc_threshold = cfg.ttc_threshold;
   human.pose_prediction_reset_time = cfg.human_pose_prediction_reset_time;
+  human.prediction_rate = cfg.human_prediction_rate;
+  human.cull_interactions = cfg.cull_human_interactions;
+  human.interaction_margin = cfg.human_interaction_margin;
+  human.no_update_threads = cfg.no_human_update_threads;
 
   // GoalTolerance
   goal_tolerance.xy_goal_tolerance = cfg.xy_goal_tolerance;
@@ -359,10 +404,14 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig &cfg) {
   obstacles.costmap_obstacles_behind_robot_dist =
       cfg.costmap_obstacles_behind_robot_dist;
   obstacles.obstacle_poses_affected = cfg.obstacle_poses_affected;
+  obstacles.obstacle_distance_field = cfg.obstacle_distance_field;
+  obstacles.footprint_circles = cfg.footprint_circles;
 
   // Optimization
   optim.no_inner_iterations = cfg.no_inner_iterations;
   optim.no_outer_iterations = cfg.no_outer_iterations;
+  optim.optimization_time_budget = cfg.optimization_time_budget;
+  optim.convergence_threshold = cfg.convergence_threshold;
   optim.optimization_activate = cfg.optimization_activate;
   optim.optimization_verbose = cfg.optimization_verbose;
   optim.penalty_epsilon = cfg.penalty_epsilon;
@@ -400,11 +449,17 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig &cfg) {
   optim.disable_warm_start = cfg.disable_warm_start;
   optim.disable_rapid_omega_chage = cfg.disable_rapid_omega_chage;
   optim.omega_chage_time_seperation = cfg.omega_chage_time_seperation;
+  optim.persistent_graph = cfg.persistent_graph;
+  optim.linear_solver = cfg.linear_solver;
+  optim.linear_solver_auto_vertices = cfg.linear_solver_auto_vertices;
 
   // Homotopy Class Planner
   hcp.enable_multithreading = cfg.enable_multithreading;
+  hcp.no_optimization_threads = cfg.no_optimization_threads;
+  hcp.cancel_cost_ratio = cfg.cancel_cost_ratio;
   hcp.simple_exploration = cfg.simple_exploration;
   hcp.max_number_classes = cfg.max_number_classes;
+  hcp.exploration_time_budget = cfg.exploration_time_budget;
   hcp.selection_cost_hysteresis = cfg.selection_cost_hysteresis;
   hcp.selection_obst_cost_scale = cfg.selection_obst_cost_scale;
   hcp.selection_viapoint_cost_scale = cfg.selection_viapoint_cost_scale;
@@ -414,6 +469,7 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig &cfg) {
   hcp.obstacle_heading_threshold = cfg.obstacle_heading_threshold;
   hcp.roadmap_graph_no_samples = cfg.roadmap_graph_no_samples;
   hcp.roadmap_graph_area_width = cfg.roadmap_graph_area_width;
+  hcp.roadmap_graph_incremental = cfg.roadmap_graph_incremental;
   hcp.h_signature_prescaler = cfg.h_signature_prescaler;
   hcp.h_signature_threshold = cfg.h_signature_threshold;
   hcp.viapoints_all_candidates = cfg.viapoints_all_candidates;
@@ -441,6 +497,14 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig &cfg) {
   approach.approach_dist_tolerance = cfg.approach_dist_tolerance;
   approach.approach_angle_tolerance = cfg.approach_angle_tolerance;
 
+  // profiling
+  profiling.enable = cfg.enable_profiling;
+  profiling.publish_period = cfg.profiling_publish_period;
+
+  // recorder
+  recorder.enable = cfg.record_cycles;
+
+  ++revision_;
   checkParameters();
 }
 
@@ -496,6 +560,47 @@ void TebConfig::checkParameters() const {
              "'costmap_obstacles_behind_robot_dist' should be positive or "
              "zero.");
 
+  // human prediction requests
+  if (human.prediction_rate <= 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
+             "'human_prediction_rate' should be positive.");
+
+  // human interaction culling
+  if (human.interaction_margin < 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
+             "'human_interaction_margin' should be positive or zero.");
+
+  // human trajectory update threads
+  if (human.no_update_threads < 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
+             "'no_human_update_threads' should be positive or zero.");
+
+  // linear solver backend
+  if (optim.linear_solver < 0 || optim.linear_solver > 4)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter 'linear_solver' "
+             "should be in [0, 4]. The backend is selected automatically.");
+
+  // distance field footprint decomposition
+  if (obstacles.footprint_circles < 1)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
+             "'footprint_circles' should be at least 1.");
+
+  // hcp: exploration time budget
+  if (hcp.exploration_time_budget < 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
+             "'exploration_time_budget' should be positive or zero.");
+
+  // hcp: cancellation bound from converged candidates only
+  if (hcp.cancel_cost_ratio > 1.0 && optim.convergence_threshold <= 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
+             "'cancel_cost_ratio' has no effect unless "
+             "'convergence_threshold' is positive.");
+
+  // hcp: optimization threads
+  if (hcp.no_optimization_threads < 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
+             "'no_optimization_threads' should be positive or zero.");
+
   // hcp: obstacle heading threshold
   if (hcp.obstacle_keypoint_offset >= 1 || hcp.obstacle_keypoint_offset <= 0)
     ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
@@ -513,6 +618,16 @@ void TebConfig::checkParameters() const {
              "cmd_angle_instead_rotvel is non-zero but min_turning_radius is "
              "set to zero: undesired behavior. You are mixing a carlike and a "
              "diffdrive robot");
+
+  // profiling
+  if (profiling.enable && profiling.publish_period <= 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter "
+             "'profiling_publish_period' should be positive.");
+
+  // recorder
+  if (recorder.enable && recorder.size <= 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter 'record_size' "
+             "should be positive.");
 }
 
 void TebConfig::checkDeprecated(const ros::NodeHandle &nh) const {
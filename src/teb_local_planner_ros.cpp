@@ -40,14 +40,10 @@
  *          Harmish Khambhaita (harmish@laas.fr)
  *********************************************************************/
 
-#define PREDICT_SERVICE_NAME "/human_pose_prediction/predict_human_poses"
-#define RESET_PREDICTION_SERVICE_NAME                                          \
-  "/human_pose_prediction/reset_external_paths"
-#define PUBLISH_MARKERS_SRV_NAME                                               \
-  "/human_pose_prediction/publish_prediction_markers"
 #define OPTIMIZE_SRV_NAME "optimize"
 #define APPROACH_SRV_NAME "set_approach_id"
 #define OP_COSTS_TOPIC "optimization_costs"
+#define PROFILING_TOPIC "/diagnostics"
 #define DEFAULT_HUMAN_SEGMENT hanp_msgs::TrackedSegmentType::TORSO
 #define THROTTLE_RATE 5.0 // seconds
 
@@ -56,6 +52,11 @@
 #include <tf_conversions/tf_eigen.h>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/make_shared.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <set>
 
 // pluginlib macros
 #include <pluginlib/class_list_macros.h>
@@ -80,7 +81,7 @@ TebLocalPlannerROS::TebLocalPlannerROS()
       costmap_converter_loader_("costmap_converter",
                                 "costmap_converter::BaseCostmapToPolygons"),
       dynamic_recfg_(NULL), goal_reached_(false), horizon_reduced_(false),
-      initialized_(false) {}
+      initialized_(false), recorder_size_(0), recorded_config_revision_(0) {}
 
 TebLocalPlannerROS::~TebLocalPlannerROS() {}
 
@@ -108,6 +109,7 @@ void TebLocalPlannerROS::initialize(std::string name, tf::TransformListener *tf,
 
     // create robot footprint/contour model for optimization
     RobotFootprintModelPtr robot_model = getRobotFootprintFromParamServer(nh);
+    robot_model_ = robot_model;
 
     CircularRobotFootprintPtr human_model = NULL;
     auto human_radius = cfg_.human.radius;
@@ -123,12 +125,15 @@ void TebLocalPlannerROS::initialize(std::string name, tf::TransformListener *tf,
           cfg_, &obstacles_, robot_model, visualization_, &via_points_));
       ROS_INFO("Parallel planning in distinctive topologies enabled.");
     } else {
-      planner_ = PlannerInterfacePtr(new TebOptimalPlanner(
+      TebOptimalPlanner *optimal_planner = new TebOptimalPlanner(
           cfg_, &obstacles_, robot_model, visualization_, &via_points_,
-          human_model, &humans_via_points_map_));
+          human_model, &humans_via_points_map_);
+      optimal_planner->setDistanceField(&distance_field_);
+      planner_ = PlannerInterfacePtr(optimal_planner);
       planner_->local_weight_optimaltime_ = cfg_.optim.weight_optimaltime;
       ROS_INFO("Parallel planning in distinctive topologies disabled.");
     }
+    planner_->setViaPointIds(&via_point_ids_);
 
     // init other variables
     tf_ = tf;
@@ -183,6 +188,15 @@ void TebLocalPlannerROS::initialize(std::string name, tf::TransformListener *tf,
     // init the odom helper to receive the robot's velocity from odom messages
     odom_helper_.setOdomTopic(cfg_.odom_topic);
 
+    // the optimization deadline must not exceed the control period of
+    // move_base
+    ros::NodeHandle nh_move_base("~");
+    double controller_frequency = 20.0; // default of move_base
+    nh_move_base.param("controller_frequency", controller_frequency,
+                       controller_frequency);
+    controller_period_ =
+        controller_frequency > 0.0 ? 1.0 / controller_frequency : 0.0;
+
     // setup dynamic reconfigure
     dynamic_recfg_ = boost::make_shared<
         dynamic_reconfigure::Server<TebLocalPlannerReconfigureConfig>>(nh);
@@ -194,14 +208,8 @@ void TebLocalPlannerROS::initialize(std::string name, tf::TransformListener *tf,
     custom_obst_sub_ = nh.subscribe(
         "obstacles", 1, &TebLocalPlannerROS::customObstacleCB, this);
 
-    // setup human prediction client with persistent connection
-    predict_humans_client_ =
-        nh.serviceClient<hanp_prediction::HumanPosePredict>(
-            PREDICT_SERVICE_NAME, true);
-    reset_humans_prediction_client_ =
-        nh.serviceClient<std_srvs::Empty>(RESET_PREDICTION_SERVICE_NAME, true);
-    publish_predicted_markers_client_ =
-        nh.serviceClient<std_srvs::SetBool>(PUBLISH_MARKERS_SRV_NAME, true);
+    // request the human prediction in the background
+    prediction_client_.start(cfg_.human.prediction_rate);
 
     optimize_server_ = nh.advertiseService(
         OPTIMIZE_SRV_NAME, &TebLocalPlannerROS::optimizeStandalone, this);
@@ -210,6 +218,9 @@ void TebLocalPlannerROS::initialize(std::string name, tf::TransformListener *tf,
 
     op_costs_pub_ = nh.advertise<teb_local_planner::OptimizationCostArray>(
         OP_COSTS_TOPIC, 1);
+    profiling_pub_ =
+        nh.advertise<diagnostic_msgs::DiagnosticArray>(PROFILING_TOPIC, 1);
+    last_profiling_publish_ = ros::WallTime::now();
 
     last_call_time_ =
         ros::Time::now() - ros::Duration(cfg_.human.pose_prediction_reset_time);
@@ -238,8 +249,7 @@ bool TebLocalPlannerROS::setPlan(
   }
 
   // store the global plan
-  global_plan_.clear();
-  global_plan_ = orig_global_plan;
+  global_plan_.setPlan(orig_global_plan);
 
   // we do not clear the local planner here, since setPlan is called frequently
   // whenever the global planner updates the plan.
@@ -254,6 +264,7 @@ bool TebLocalPlannerROS::setPlan(
 
 bool TebLocalPlannerROS::computeVelocityCommands(
     geometry_msgs::Twist &cmd_vel) {
+  ros::WallTime cycle_start = ros::WallTime::now();
   auto start_time = ros::Time::now();
   if ((start_time - last_call_time_).toSec() >
       cfg_.human.pose_prediction_reset_time) {
@@ -268,54 +279,84 @@ bool TebLocalPlannerROS::computeVelocityCommands(
     return false;
   }
 
+  {
+    boost::mutex::scoped_lock cfg_lock(cfg_.configMutex());
+    Profiler::setEnabled(cfg_.profiling.enable);
+    publishProfiling();
+    updateCycleRecorder();
+  }
+  ScopedTimer total_timer(TEB_PROFILE_TIMING("ros/compute_velocity_commands"),
+                          true);
+
+  // the optimization stops early to meet the time budget, which counts from
+  // the start of this control cycle and is capped at the controller period
+  double time_budget = cfg_.optim.optimization_time_budget;
+  if (time_budget < 0 ||
+      (time_budget > 0 && controller_period_ > 0 &&
+       time_budget > controller_period_))
+    time_budget = controller_period_;
+  planner_->setDeadline(time_budget > 0
+                            ? cycle_start + ros::WallDuration(time_budget)
+                            : ros::WallTime());
+
   cmd_vel.linear.x = 0;
   cmd_vel.angular.z = 0;
   goal_reached_ = false;
 
   // Get robot pose
-  auto pose_get_start_time = ros::Time::now();
+  ScopedTimer pose_get_timer(TEB_PROFILE_TIMING("ros/get_robot_pose"), true);
   tf::Stamped<tf::Pose> robot_pose;
   costmap_ros_->getRobotPose(robot_pose);
   robot_pose_ = PoseSE2(robot_pose);
-  auto pose_get_time = ros::Time::now() - pose_get_start_time;
+  double pose_get_time = pose_get_timer.stop();
 
   // Get robot velocity
-  auto vel_get_start_time = ros::Time::now();
+  ScopedTimer vel_get_timer(TEB_PROFILE_TIMING("ros/get_robot_velocity"), true);
   tf::Stamped<tf::Pose> robot_vel_tf;
   odom_helper_.getRobotVel(robot_vel_tf);
   robot_vel_ = tfPoseToEigenVector2dTransRot(robot_vel_tf);
   geometry_msgs::Twist robot_vel_twist;
   robot_vel_twist.linear.x = robot_vel_[0];
   robot_vel_twist.angular.z = robot_vel_[1];
-  auto vel_get_time = ros::Time::now() - vel_get_start_time;
+  double vel_get_time = vel_get_timer.stop();
 
   // prune global plan to cut off parts of the past (spatially before the robot)
-  auto prune_start_time = ros::Time::now();
-  pruneGlobalPlan(*tf_, robot_pose, global_plan_);
-  auto prune_time = ros::Time::now() - prune_start_time;
+  ScopedTimer prune_timer(TEB_PROFILE_TIMING("ros/prune_global_plan"), true);
+  // the robot is expected within one local costmap ahead of the last pruned
+  // pose, otherwise the cursor is kept (findSlice() still searches from it)
+  pruneGlobalPlan(*tf_, robot_pose, global_plan_, 1,
+                  std::max(costmap_->getSizeInMetersX(),
+                           costmap_->getSizeInMetersY()));
+  double prune_time = prune_timer.stop();
 
   // Transform global plan to the frame of interest (w.r.t to the local costmap)
-  auto transform_start_time = ros::Time::now();
-  std::vector<geometry_msgs::PoseStamped> transformed_plan;
+  ScopedTimer transform_timer(TEB_PROFILE_TIMING("ros/transform_global_plan"),
+                              true);
+  std::vector<geometry_msgs::PoseStamped> &transformed_plan =
+      transformed_plan_;
   int goal_idx;
   tf::StampedTransform tf_plan_to_global;
+  std::size_t plan_first_idx;
   if (!transformGlobalPlan(*tf_, global_plan_, robot_pose, *costmap_,
                            global_frame_,
                            cfg_.trajectory.max_global_plan_lookahead_dist,
-                           transformed_plan, &goal_idx, &tf_plan_to_global)) {
+                           transformed_plan, &goal_idx, &tf_plan_to_global,
+                           &plan_first_idx)) {
     ROS_WARN(
         "Could not transform the global plan to the frame of the controller");
     return false;
   }
-  auto transform_time = ros::Time::now() - transform_start_time;
+  uint64_t plan_revision = global_plan_.revision();
+  double transform_time = transform_timer.stop();
 
   // Check if the horizon should be reduced this run
-  auto hr1_start_time = ros::Time::now();
+  ScopedTimer hr1_timer(TEB_PROFILE_TIMING("ros/reduce_horizon"), true);
   if (horizon_reduced_) {
     // reduce to 50 percent:
     // int horizon_reduction = goal_idx/2;
     int horizon_reduction =
-        (int)(goal_idx * cfg_.trajectory.horizon_reduction_amount);
+        (int)((goal_idx - (int)global_plan_.cursor()) *
+              cfg_.trajectory.horizon_reduction_amount);
     // we have a small overhead here, since we already transformed 50% more of
     // the trajectory.
     // But that's ok for now, since we do not need to make transformGlobalPlan
@@ -332,12 +373,12 @@ bool TebLocalPlannerROS::computeVelocityCommands(
       goal_idx +=
           horizon_reduction; // this should not happy, but safety first ;-)
   }
-  auto hr1_time = ros::Time::now() - hr1_start_time;
+  double hr1_time = hr1_timer.stop();
 
-  auto other_start_time = ros::Time::now();
+  ScopedTimer other_timer(TEB_PROFILE_TIMING("ros/check_goal"), true);
   // check if global goal is reached
   tf::Stamped<tf::Pose> global_goal;
-  tf::poseStampedMsgToTF(global_plan_.back(), global_goal);
+  tf::poseStampedMsgToTF(global_plan_.poses().back(), global_goal);
   global_goal.setData(tf_plan_to_global * global_goal);
   double dx = global_goal.getOrigin().getX() - robot_pose_.x();
   double dy = global_goal.getOrigin().getY() - robot_pose_.y();
@@ -372,11 +413,11 @@ bool TebLocalPlannerROS::computeVelocityCommands(
 
   // clear currently existing obstacles
   obstacles_.clear();
-  auto other_time = ros::Time::now() - other_start_time;
+  double other_time = other_timer.stop();
 
   // Update obstacle container with costmap information or polygons provided by
   // a costmap_converter plugin
-  auto cc_start_time = ros::Time::now();
+  ScopedTimer cc_timer(TEB_PROFILE_TIMING("ros/update_obstacles"), true);
   if (costmap_converter_)
     updateObstacleContainerWithCostmapConverter();
   else
@@ -385,13 +426,13 @@ bool TebLocalPlannerROS::computeVelocityCommands(
   // also consider custom obstacles (must be called after other updates, since
   // the container is not cleared)
   updateObstacleContainerWithCustomObstacles();
-  auto cc_time = ros::Time::now() - cc_start_time;
+  double cc_time = cc_timer.stop();
 
   // Do not allow config changes during the following optimization step
   boost::mutex::scoped_lock cfg_lock(cfg_.configMutex());
 
   // update humans
-  auto human_start_time = ros::Time::now();
+  ScopedTimer human_timer(TEB_PROFILE_TIMING("ros/update_humans"), true);
   std::vector<HumanPlanCombined> transformed_human_plans;
   HumanPlanVelMap transformed_human_plan_vel_map;
   switch (cfg_.planning_mode) {
@@ -418,54 +459,11 @@ bool TebLocalPlannerROS::computeVelocityCommands(
           hanp_prediction::HumanPosePredictRequest::VELOCITY_OBSTACLE;
     }
 
-    std_srvs::SetBool publish_predicted_markers_srv;
-    publish_predicted_markers_srv.request.data =
-        publish_predicted_human_markers_;
-    if (!publish_predicted_markers_client_ &&
-        publish_predicted_markers_client_.call(publish_predicted_markers_srv)) {
-      ROS_WARN("Failed to call %s service, is human prediction server running?",
-               PUBLISH_MARKERS_SRV_NAME);
-    }
-
-    if (predict_humans_client_ && predict_humans_client_.call(predict_srv)) {
-      tf::StampedTransform tf_human_plan_to_global;
-      for (auto predicted_humans_poses :
-           predict_srv.response.predicted_humans_poses) {
-        // transform human plans
-        HumanPlanCombined human_plan_combined;
-        auto &transformed_vel = predicted_humans_poses.start_velocity;
-        if (!transformHumanPlan(*tf_, robot_pose, *costmap_, global_frame_,
-                                predicted_humans_poses.poses,
-                                human_plan_combined, transformed_vel,
-                                &tf_human_plan_to_global)) {
-          ROS_WARN("Could not transform the human %ld plan to the frame of the "
-                   "controller",
-                   predicted_humans_poses.id);
-          continue;
-        }
-
-        human_plan_combined.id = predicted_humans_poses.id;
-        transformed_human_plans.push_back(human_plan_combined);
-
-        PlanStartVelGoalVel plan_start_vel_goal_vel;
-        plan_start_vel_goal_vel.plan = human_plan_combined.plan_to_optimize;
-        plan_start_vel_goal_vel.start_vel = transformed_vel.twist;
-        if (human_plan_combined.plan_after.size() > 0) {
-          plan_start_vel_goal_vel.goal_vel = transformed_vel.twist;
-        }
-        transformed_human_plan_vel_map[human_plan_combined.id] =
-            plan_start_vel_goal_vel;
-      }
-    } else {
-      ROS_WARN_THROTTLE(
-          THROTTLE_RATE,
-          "Failed to call %s service, is human prediction server running?",
-          PREDICT_SERVICE_NAME);
-
-      // re-initialize the service
-      // predict_humans_client_ =
-      // nh.serviceClient<hanp_prediction::HumanPosePredict>(PREDICT_SERVICE_NAME,
-      // true);
+    HumanPredictionClient::Predictions predicted_humans;
+    if (getHumansPrediction(predict_srv.request, predicted_humans)) {
+      transformHumanPlans(*tf_, robot_pose, *costmap_, global_frame_,
+                          predicted_humans, transformed_human_plans,
+                          transformed_human_plan_vel_map);
     }
     updateHumanViaPointsContainers(transformed_human_plan_vel_map,
                                    cfg_.trajectory.global_plan_viapoint_sep);
@@ -478,20 +476,10 @@ bool TebLocalPlannerROS::computeVelocityCommands(
     predict_srv.request.type =
         hanp_prediction::HumanPosePredictRequest::VELOCITY_OBSTACLE;
 
-    // setup marker publishing
-    std_srvs::SetBool publish_predicted_markers_srv;
-    publish_predicted_markers_srv.request.data =
-        publish_predicted_human_markers_;
-    if (!publish_predicted_markers_client_ &&
-        publish_predicted_markers_client_.call(publish_predicted_markers_srv)) {
-      ROS_WARN("Failed to call %s service, is human prediction server running?",
-               PUBLISH_MARKERS_SRV_NAME);
-    }
-
-    // call human prediction server
-    if (predict_humans_client_ && predict_humans_client_.call(predict_srv)) {
-      for (auto predicted_humans_poses :
-           predict_srv.response.predicted_humans_poses) {
+    // get the latest human prediction
+    HumanPredictionClient::Predictions predicted_humans;
+    if (getHumansPrediction(predict_srv.request, predicted_humans)) {
+      for (auto &predicted_humans_poses : predicted_humans) {
         if (predicted_humans_poses.id == cfg_.approach.approach_id) {
           geometry_msgs::PoseStamped transformed_human_pose;
           if (!transformHumanPose(*tf_, global_frame_,
@@ -550,32 +538,28 @@ bool TebLocalPlannerROS::computeVelocityCommands(
                 tf_plan_to_global.inverse() * tf_approach_pose;
             geometry_msgs::PoseStamped approach_pose_global;
             tf::poseTFToMsg(tf_approach_global, approach_pose_global.pose);
-            approach_pose_global.header = global_plan_.back().header;
+            approach_pose_global.header = global_plan_.poses().back().header;
 
             // prune and update global plan
-            auto global_plan_it = global_plan_.begin();
+            std::size_t global_plan_idx = global_plan_.cursor();
             double last_dist = std::numeric_limits<double>::infinity();
-            while (global_plan_it != global_plan_.end()) {
-              auto &p_pos = (*global_plan_it).pose.position;
+            while (global_plan_idx < global_plan_.size()) {
               auto &a_pos = approach_pose_global.pose.position;
-              double pa_dist = std::hypot(p_pos.x - a_pos.x, p_pos.y - a_pos.y);
+              double pa_dist =
+                  std::hypot(global_plan_.x(global_plan_idx) - a_pos.x,
+                             global_plan_.y(global_plan_idx) - a_pos.y);
               if (pa_dist > last_dist) {
                 break;
               }
               last_dist = pa_dist;
-              global_plan_it++;
+              global_plan_idx++;
             }
-            global_plan_.erase(global_plan_it, global_plan_.end());
-            global_plan_.push_back(approach_pose_global);
+            global_plan_.truncate(global_plan_idx);
+            global_plan_.append(approach_pose_global);
             ROS_DEBUG("Global plan modified for approach behavior");
           }
         }
       }
-    } else {
-      ROS_WARN_THROTTLE(
-          THROTTLE_RATE,
-          "Failed to call %s service, is human prediction server running?",
-          PREDICT_SERVICE_NAME);
     }
     // TODO: check if plan-map is not empty
     break;
@@ -583,25 +567,39 @@ bool TebLocalPlannerROS::computeVelocityCommands(
   default:
     break;
   }
-  auto human_time = ros::Time::now() - human_start_time;
+  double human_time = human_timer.stop();
 
   // update via-points container
-  auto via_start_time = ros::Time::now();
+  ScopedTimer via_timer(TEB_PROFILE_TIMING("ros/update_via_points"), true);
   // overwrite/update start of the transformed plan with the actual robot
   // position (allows using the plan as initial trajectory)
   tf::poseTFToMsg(robot_pose, transformed_plan.front().pose);
-  updateViaPointsContainer(transformed_plan,
-                           cfg_.trajectory.global_plan_viapoint_sep);
-  auto via_time = ros::Time::now() - via_start_time;
+  updateViaPointsContainer(
+      transformed_plan,
+      global_plan_.revision() == plan_revision ? &global_plan_ : NULL,
+      plan_first_idx, cfg_.trajectory.global_plan_viapoint_sep);
+  double via_time = via_timer.stop();
 
   // Now perform the actual planning
-  auto plan_start_time = ros::Time::now();
+  ScopedTimer plan_timer(TEB_PROFILE_TIMING("ros/plan"), true);
   // bool success = planner_->plan(robot_pose_, robot_goal_, robot_vel_,
   // cfg_.goal_tolerance.free_goal_vel); // straight line init
   teb_local_planner::OptimizationCostArray op_costs;
   bool success = planner_->plan(transformed_plan, &robot_vel_twist,
                                 cfg_.goal_tolerance.free_goal_vel,
                                 &transformed_human_plan_vel_map, &op_costs);
+  double plan_time = plan_timer.stop();
+  if (cycle_recorder_.isOpen()) {
+    double vx = 0.0, omega = 0.0;
+    if (success)
+      planner_->getVelocityCommand(vx, omega);
+    cycle_recorder_.recordCycle(
+        start_time, transformed_plan, robot_vel_twist,
+        cfg_.goal_tolerance.free_goal_vel, transformed_human_plan_vel_map,
+        obstacles_, via_points_, humans_via_points_map_,
+        planner_->local_weight_optimaltime_, success, plan_time, vx, omega,
+        op_costs);
+  }
   if (!success) {
     planner_->clearPlanner(); // force reinitialization for next time
     ROS_WARN("teb_local_planner was not able to obtain a local plan for the "
@@ -609,14 +607,14 @@ bool TebLocalPlannerROS::computeVelocityCommands(
     return false;
   }
   op_costs_pub_.publish(op_costs);
-  auto plan_time = ros::Time::now() - plan_start_time;
 
   // Now visualize everything
-  auto viz_start_time = ros::Time::now();
+  ScopedTimer viz_timer(TEB_PROFILE_TIMING("ros/visualize"), true);
   planner_->visualize();
   visualization_->publishObstacles(obstacles_);
   visualization_->publishViaPoints(via_points_);
-  visualization_->publishGlobalPlan(global_plan_);
+  visualization_->publishGlobalPlan(global_plan_.poses(),
+                                    global_plan_.cursor());
   if (cfg_.planning_mode == 1) {
     visualization_->publishHumansPlans(transformed_human_plans);
     std::vector<HumanPlanTrajCombined> human_plans_traj_array;
@@ -632,10 +630,10 @@ bool TebLocalPlannerROS::computeVelocityCommands(
     }
     visualization_->publishHumanTrajectories(human_plans_traj_array);
   }
-  auto viz_time = ros::Time::now() - viz_start_time;
+  double viz_time = viz_timer.stop();
 
   // Undo temporary horizon reduction
-  auto hr2_start_time = ros::Time::now();
+  ScopedTimer hr2_timer(TEB_PROFILE_TIMING("ros/restore_horizon"), true);
   if (horizon_reduced_ &&
       (ros::Time::now() - horizon_reduced_stamp_).toSec() >= 5 &&
       !planner_->isHorizonReductionAppropriate(
@@ -645,10 +643,10 @@ bool TebLocalPlannerROS::computeVelocityCommands(
     planner_->local_weight_optimaltime_ = cfg_.optim.weight_optimaltime;
     ROS_INFO("Switching back to full horizon length.");
   }
-  auto hr2_time = ros::Time::now() - hr2_start_time;
+  double hr2_time = hr2_timer.stop();
 
   // Check feasibility (but within the first few states only)
-  auto fsb_start_time = ros::Time::now();
+  ScopedTimer fsb_timer(TEB_PROFILE_TIMING("ros/check_feasibility"), true);
   bool feasible = planner_->isTrajectoryFeasible(
       costmap_model_.get(), footprint_spec_, robot_inscribed_radius_,
       robot_circumscribed_radius, cfg_.trajectory.feasibility_check_no_poses);
@@ -669,17 +667,19 @@ bool TebLocalPlannerROS::computeVelocityCommands(
     // now we reset everything to start again with the initialization of new
     // trajectories.
     planner_->clearPlanner();
+    cycle_recorder_.recordReset(ros::Time::now());
     ROS_WARN("TebLocalPlannerROS: trajectory is not feasible. Resetting "
              "planner...");
 
     return false;
   }
-  auto fsb_time = ros::Time::now() - fsb_start_time;
+  double fsb_time = fsb_timer.stop();
 
   // Get the velocity command for this sampling interval
-  auto vel_start_time = ros::Time::now();
+  ScopedTimer vel_timer(TEB_PROFILE_TIMING("ros/get_velocity_command"), true);
   if (!planner_->getVelocityCommand(cmd_vel.linear.x, cmd_vel.angular.z)) {
     planner_->clearPlanner();
+    cycle_recorder_.recordReset(ros::Time::now());
     ROS_WARN(
         "TebLocalPlannerROS: velocity command invalid. Resetting planner...");
     return false;
@@ -704,45 +704,48 @@ bool TebLocalPlannerROS::computeVelocityCommands(
     if (!std::isfinite(cmd_vel.angular.z)) {
       cmd_vel.linear.x = cmd_vel.angular.z = 0;
       planner_->clearPlanner();
+      cycle_recorder_.recordReset(ros::Time::now());
       ROS_WARN("TebLocalPlannerROS: Resulting steering angle is not finite. "
                "Resetting planner...");
       return false;
     }
   }
-  auto vel_time = ros::Time::now() - vel_start_time;
+  double vel_time = vel_timer.stop();
 
-  auto total_time = ros::Time::now() - start_time;
+  double total_time = total_timer.stop();
   ROS_DEBUG_STREAM_COND(
-      total_time.toSec() > 0.1,
+      total_time > 0.1,
       "\tcompute velocity times:\n"
           << "\t\ttotal time                   "
-          << std::to_string(total_time.toSec()) << "\n"
+          << std::to_string(total_time) << "\n"
           << "\t\tpose get time                "
-          << std::to_string(pose_get_time.toSec()) << "\n"
+          << std::to_string(pose_get_time) << "\n"
           << "\t\tvel get time                 "
-          << std::to_string(vel_get_time.toSec()) << "\n"
+          << std::to_string(vel_get_time) << "\n"
           << "\t\tprune time                   "
-          << std::to_string(prune_time.toSec()) << "\n"
+          << std::to_string(prune_time) << "\n"
           << "\t\ttransform time               "
-          << std::to_string(transform_time.toSec()) << "\n"
+          << std::to_string(transform_time) << "\n"
           << "\t\thorizon setup time           "
-          << std::to_string((hr1_time + hr2_time).toSec()) << "\n"
+          << std::to_string(hr1_time + hr2_time) << "\n"
           << "\t\tother time                   "
-          << std::to_string(other_time.toSec()) << "\n"
+          << std::to_string(other_time) << "\n"
           << "\t\tcostmap convert time         "
-          << std::to_string(cc_time.toSec()) << "\n"
+          << std::to_string(cc_time) << "\n"
           << "\t\tvia points time              "
-          << std::to_string(via_time.toSec()) << "\n"
+          << std::to_string(via_time) << "\n"
           << "\t\thuman time                   "
-          << std::to_string(human_time.toSec()) << "\n"
+          << std::to_string(human_time) << "\n"
+          << "\t\thuman prediction age         "
+          << std::to_string(prediction_age_) << "\n"
           << "\t\tplanning time                "
-          << std::to_string(plan_time.toSec()) << "\n"
+          << std::to_string(plan_time) << "\n"
           << "\t\tplan feasibility check time  "
-          << std::to_string(fsb_time.toSec()) << "\n"
+          << std::to_string(fsb_time) << "\n"
           << "\t\tvelocity extract time        "
-          << std::to_string(vel_time.toSec()) << "\n"
+          << std::to_string(vel_time) << "\n"
           << "\t\tvisualization publish time   "
-          << std::to_string(viz_time.toSec()) << "\n=========================");
+          << std::to_string(viz_time) << "\n=========================");
   return true;
 }
 
@@ -750,6 +753,7 @@ bool TebLocalPlannerROS::isGoalReached() {
   if (goal_reached_) {
     ROS_INFO("GOAL Reached!");
     planner_->clearPlanner();
+    cycle_recorder_.recordReset(ros::Time::now());
     resetHumansPrediction();
     return true;
   }
@@ -757,27 +761,88 @@ bool TebLocalPlannerROS::isGoalReached() {
 }
 
 void TebLocalPlannerROS::updateObstacleContainerWithCostmap() {
+  distance_field_.clear();
+
   // Add costmap obstacles if desired
   if (cfg_.obstacles.include_costmap_obstacles) {
     Eigen::Vector2d robot_orient = robot_pose_.orientationUnitVec();
-
-    for (unsigned int i = 0; i < costmap_->getSizeInCellsX() - 1; ++i) {
-      for (unsigned int j = 0; j < costmap_->getSizeInCellsY() - 1; ++j) {
-        if (costmap_->getCost(i, j) == costmap_2d::LETHAL_OBSTACLE) {
-          Eigen::Vector2d obs;
-          costmap_->mapToWorld(i, j, obs.coeffRef(0), obs.coeffRef(1));
-
-          // check if obstacle is interesting (e.g. not far behind the robot)
-          Eigen::Vector2d obs_dir = obs - robot_pose_.position();
+    double behind_robot_sq_dist =
+        cfg_.obstacles.costmap_obstacles_behind_robot_dist *
+        cfg_.obstacles.costmap_obstacles_behind_robot_dist;
+
+    const unsigned char *charmap = costmap_->getCharMap();
+    unsigned int size_x = costmap_->getSizeInCellsX();
+    unsigned int size_y = costmap_->getSizeInCellsY();
+    double resolution = costmap_->getResolution();
+    // world coordinates of the center of cell (0,0), see mapToWorld
+    double origin_x = costmap_->getOriginX() + 0.5 * resolution;
+    double origin_y = costmap_->getOriginY() + 0.5 * resolution;
+
+    // the homotopy class planner explores the topologies around obstacles,
+    // hence it always gets point obstacles
+    if (cfg_.obstacles.obstacle_distance_field &&
+        !cfg_.hcp.enable_homotopy_class_planning) {
+      // the lethal cells far behind the robot are removed from a copy of the
+      // costmap, like the point obstacles below
+      distance_field_grid_.assign(charmap, charmap + size_x * size_y);
+      for (unsigned int j = 0; size_x > 0 && j < size_y; ++j) {
+        unsigned char *row = distance_field_grid_.data() + j * size_x;
+        unsigned char *row_end = row + size_x;
+        unsigned char *cell = row;
+        while ((cell = static_cast<unsigned char *>(std::memchr(
+                    cell, costmap_2d::LETHAL_OBSTACLE, row_end - cell))) !=
+               NULL) {
+          Eigen::Vector2d obs_dir =
+              Eigen::Vector2d(origin_x + (cell - row) * resolution,
+                              origin_y + j * resolution) -
+              robot_pose_.position();
           if (obs_dir.dot(robot_orient) < 0 &&
-              obs_dir.norm() >
-                  cfg_.obstacles.costmap_obstacles_behind_robot_dist)
-            continue;
-
-          obstacles_.push_back(ObstaclePtr(new PointObstacle(obs)));
+              obs_dir.squaredNorm() > behind_robot_sq_dist)
+            *cell = costmap_2d::FREE_SPACE;
+          ++cell;
         }
       }
+      distance_field_.build(distance_field_grid_.data(), size_x, size_y,
+                            resolution, costmap_->getOriginX(),
+                            costmap_->getOriginY(),
+                            costmap_2d::LETHAL_OBSTACLE);
+      return;
     }
+
+    // reuse the storage of the last cycle only if none of its point obstacles
+    // is referenced anymore (obstacles_ has been cleared), otherwise the
+    // pointers that are still held would see overwritten obstacles
+    if (costmap_obstacles_ && costmap_obstacles_.unique())
+      costmap_obstacles_->clear();
+    else
+      costmap_obstacles_ = boost::make_shared<PointObstacleStore>();
+
+    // scan row by row for lethal cells, memchr compares many bytes at once
+    for (unsigned int j = 0; size_x > 0 && j + 1 < size_y; ++j) {
+      const unsigned char *row = charmap + j * size_x;
+      const unsigned char *row_end = row + size_x - 1;
+      const unsigned char *cell = row;
+      while ((cell = static_cast<const unsigned char *>(std::memchr(
+                  cell, costmap_2d::LETHAL_OBSTACLE, row_end - cell))) !=
+             NULL) {
+        Eigen::Vector2d obs(origin_x + (cell - row) * resolution,
+                            origin_y + j * resolution);
+        ++cell;
+
+        // check if obstacle is interesting (e.g. not far behind the robot)
+        Eigen::Vector2d obs_dir = obs - robot_pose_.position();
+        if (obs_dir.dot(robot_orient) < 0 &&
+            obs_dir.squaredNorm() > behind_robot_sq_dist)
+          continue;
+
+        costmap_obstacles_->push_back(PointObstacle(obs));
+      }
+    }
+
+    // share the ownership of the storage instead of allocating each obstacle
+    obstacles_.reserve(obstacles_.size() + costmap_obstacles_->size());
+    for (auto &obstacle : *costmap_obstacles_)
+      obstacles_.push_back(ObstaclePtr(costmap_obstacles_, &obstacle));
   }
 }
 
@@ -874,28 +939,47 @@ void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles() {
   }
 }
 
+namespace {
+//! Cumulative arc length of each pose of a plan
+void computeArcLength(const std::vector<geometry_msgs::PoseStamped> &plan,
+                      std::vector<double> &arc_length) {
+  arc_length.resize(plan.size());
+  for (std::size_t i = 0; i < plan.size(); ++i)
+    arc_length[i] = i == 0 ? 0.0
+                           : arc_length[i - 1] +
+                                 distance_points2d(plan[i - 1].pose.position,
+                                                   plan[i].pose.position);
+}
+} // namespace
+
 void TebLocalPlannerROS::updateViaPointsContainer(
     const std::vector<geometry_msgs::PoseStamped> &transformed_plan,
-    double min_separation) {
+    const GlobalPlanWindow *plan, std::size_t first, double min_separation) {
   via_points_.clear();
+  via_point_ids_.clear();
 
-  if (min_separation < 0)
-    return;
-
-  std::size_t prev_idx = 0;
-  for (std::size_t i = 1; i < transformed_plan.size();
-       ++i) // skip first one, since we do not need any point before the first
-            // min_separation [m]
-  {
-    // check separation to the previous via-point inserted
-    if (distance_points2d(transformed_plan[prev_idx].pose.position,
-                          transformed_plan[i].pose.position) < min_separation)
-      continue;
+  if (plan && first + transformed_plan.size() <= plan->size()) {
+    // only the via-points at both ends of the slice change
+    via_point_generator_.update(plan->revision(), plan->arcLengths(), first,
+                                first + transformed_plan.size(),
+                                min_separation);
+  } else {
+    // the transformed plan does not match the poses of a window (e.g. the
+    // approach pose has been added), start from scratch
+    computeArcLength(transformed_plan, via_point_arc_length_);
+    via_point_generator_.clear();
+    via_point_generator_.update(0, via_point_arc_length_, 0,
+                                transformed_plan.size(), min_separation);
+    first = 0;
+  }
 
-    // add via-point
-    via_points_.push_back(Eigen::Vector2d(transformed_plan[i].pose.position.x,
-                                          transformed_plan[i].pose.position.y));
-    prev_idx = i;
+  // the via-points start min_separation [m] ahead of the first pose, since we
+  // do not need any point before
+  for (std::size_t i = 0; i < via_point_generator_.size(); ++i) {
+    const geometry_msgs::Point &position =
+        transformed_plan[via_point_generator_.index(i) - first].pose.position;
+    via_points_.push_back(Eigen::Vector2d(position.x, position.y));
+    via_point_ids_.push_back(via_point_generator_.id(i));
   }
 }
 
@@ -905,40 +989,33 @@ void TebLocalPlannerROS::updateHumanViaPointsContainers(
   if (min_separation < 0)
     return;
 
-  // reset via-points for known humans, create via-points for new humans
-  for (auto &transformed_human_plan_vel_kv : transformed_human_plan_vel_map) {
-    auto &human_id = transformed_human_plan_vel_kv.first;
-    if (humans_via_points_map_.find(human_id) != humans_via_points_map_.end())
-      humans_via_points_map_[human_id].clear();
-    else
-      humans_via_points_map_[human_id] = ViaPointContainer();
-  }
-
   // remove human via-points for vanished humans
   auto itr = humans_via_points_map_.begin();
   while (itr != humans_via_points_map_.end()) {
-    if (transformed_human_plan_vel_map.find(itr->first) !=
+    if (transformed_human_plan_vel_map.find(itr->first) ==
         transformed_human_plan_vel_map.end())
       itr = humans_via_points_map_.erase(itr);
     else
       ++itr;
   }
 
-  std::size_t prev_idx;
+  // the predicted plans change every cycle, so the via-points are selected
+  // from scratch
+  ViaPointGenerator generator;
   for (auto &transformed_human_plan_vel_kv : transformed_human_plan_vel_map) {
-    prev_idx = 0;
     auto &human_id = transformed_human_plan_vel_kv.first;
     auto &transformed_human_plan = transformed_human_plan_vel_kv.second.plan;
-    for (std::size_t i = 1; i < transformed_human_plan.size(); ++i) {
-      if (distance_points2d(transformed_human_plan[prev_idx].pose.position,
-                            transformed_human_plan[i].pose.position) <
-          min_separation)
-        continue;
-
-      humans_via_points_map_[human_id].push_back(
-          Eigen::Vector2d(transformed_human_plan[i].pose.position.x,
-                          transformed_human_plan[i].pose.position.y));
-      prev_idx = i;
+    ViaPointContainer &human_via_points = humans_via_points_map_[human_id];
+    human_via_points.clear();
+
+    computeArcLength(transformed_human_plan, via_point_arc_length_);
+    generator.clear();
+    generator.update(human_id, via_point_arc_length_, 0,
+                     transformed_human_plan.size(), min_separation);
+    for (std::size_t i = 0; i < generator.size(); ++i) {
+      const geometry_msgs::Point &position =
+          transformed_human_plan[generator.index(i)].pose.position;
+      human_via_points.push_back(Eigen::Vector2d(position.x, position.y));
     }
   }
 }
@@ -955,8 +1032,8 @@ TebLocalPlannerROS::tfPoseToEigenVector2dTransRot(const tf::Pose &tf_vel) {
 
 bool TebLocalPlannerROS::pruneGlobalPlan(
     const tf::TransformListener &tf, const tf::Stamped<tf::Pose> &global_pose,
-    std::vector<geometry_msgs::PoseStamped> &global_plan,
-    double dist_behind_robot) {
+    GlobalPlanWindow &global_plan, double dist_behind_robot,
+    double max_search_length) {
   if (global_plan.empty())
     return true;
 
@@ -964,32 +1041,16 @@ bool TebLocalPlannerROS::pruneGlobalPlan(
     // transform robot pose into the plan frame (we do not wait here, since
     // pruning not crucial, if missed a few times)
     tf::StampedTransform global_to_plan_transform;
-    tf.lookupTransform(global_plan.front().header.frame_id,
+    tf.lookupTransform(global_plan.poses().front().header.frame_id,
                        global_pose.frame_id_, ros::Time(0),
                        global_to_plan_transform);
     tf::Stamped<tf::Pose> robot;
     robot.setData(global_to_plan_transform * global_pose);
 
-    double dist_thresh_sq = dist_behind_robot * dist_behind_robot;
-
-    // iterate plan until a pose close the robot is found
-    std::vector<geometry_msgs::PoseStamped>::iterator it = global_plan.begin();
-    std::vector<geometry_msgs::PoseStamped>::iterator erase_end = it;
-    while (it != global_plan.end()) {
-      double dx = robot.getOrigin().x() - it->pose.position.x;
-      double dy = robot.getOrigin().y() - it->pose.position.y;
-      double dist_sq = dx * dx + dy * dy;
-      if (dist_sq < dist_thresh_sq) {
-        erase_end = it;
-        break;
-      }
-      ++it;
-    }
-    if (erase_end == global_plan.end())
+    // advance the cursor to the first pose close to the robot
+    if (!global_plan.prune(robot.getOrigin().x(), robot.getOrigin().y(),
+                           dist_behind_robot, max_search_length))
       return false;
-
-    if (erase_end != global_plan.begin())
-      global_plan.erase(global_plan.begin(), erase_end);
   } catch (const tf::TransformException &ex) {
     ROS_DEBUG("Cannot prune path since no transform is available: %s\n",
               ex.what());
@@ -999,18 +1060,16 @@ bool TebLocalPlannerROS::pruneGlobalPlan(
 }
 
 bool TebLocalPlannerROS::transformGlobalPlan(
-    const tf::TransformListener &tf,
-    const std::vector<geometry_msgs::PoseStamped> &global_plan,
+    const tf::TransformListener &tf, const GlobalPlanWindow &global_plan,
     const tf::Stamped<tf::Pose> &global_pose,
     const costmap_2d::Costmap2D &costmap, const std::string &global_frame,
     double max_plan_length,
     std::vector<geometry_msgs::PoseStamped> &transformed_plan,
-    int *current_goal_idx, tf::StampedTransform *tf_plan_to_global) const {
+    int *current_goal_idx, tf::StampedTransform *tf_plan_to_global,
+    std::size_t *first_idx) const {
   // this method is a slightly modified version of
   // base_local_planner/goal_functions.h
 
-  const geometry_msgs::PoseStamped &plan_pose = global_plan[0];
-
   transformed_plan.clear();
 
   try {
@@ -1020,6 +1079,8 @@ bool TebLocalPlannerROS::transformGlobalPlan(
       return false;
     }
 
+    const geometry_msgs::PoseStamped &plan_pose = global_plan.poses()[0];
+
     // get plan_to_global_transform from plan frame to global_frame
     tf::StampedTransform plan_to_global_transform;
     // tf.waitForTransform(global_frame, ros::Time::now(),
@@ -1046,68 +1107,25 @@ bool TebLocalPlannerROS::transformGlobalPlan(
                             // incorporate point obstacle that are
                             // located on the border of the local costmap
 
-    int i = 0;
-    double sq_dist_threshold = dist_threshold * dist_threshold;
-    double sq_dist = 1e10;
-
-    // we need to loop to a point on the plan that is within a certain
-    // distance of the robot
-    while (i < (int)global_plan.size()) {
-      double x_diff =
-          robot_pose.getOrigin().x() - global_plan[i].pose.position.x;
-      double y_diff =
-          robot_pose.getOrigin().y() - global_plan[i].pose.position.y;
-      double new_sq_dist = x_diff * x_diff + y_diff * y_diff;
-      if (new_sq_dist > sq_dist &&
-          sq_dist < sq_dist_threshold) // find first distance that is greater
-      {
-        sq_dist = new_sq_dist;
-        break;
-      }
-      sq_dist = new_sq_dist;
-      ++i;
-    }
-
-    tf::Stamped<tf::Pose> tf_pose;
-    geometry_msgs::PoseStamped newer_pose;
-
-    double plan_length =
-        0; // check cumulative Euclidean distance along the plan
-
-    // now we'll transform until points are outside of our distance threshold
-    while (i < (int)global_plan.size() && sq_dist <= sq_dist_threshold &&
-           (max_plan_length <= 0 || plan_length <= max_plan_length)) {
-      const geometry_msgs::PoseStamped &pose = global_plan[i];
-      tf::poseStampedMsgToTF(pose, tf_pose);
-      tf_pose.setData(plan_to_global_transform * tf_pose);
-      tf_pose.stamp_ = plan_to_global_transform.stamp_;
-      tf_pose.frame_id_ = global_frame;
-      tf::poseStampedTFToMsg(tf_pose, newer_pose);
-
-      transformed_plan.push_back(newer_pose);
-
-      double x_diff =
-          robot_pose.getOrigin().x() - global_plan[i].pose.position.x;
-      double y_diff =
-          robot_pose.getOrigin().y() - global_plan[i].pose.position.y;
-      sq_dist = x_diff * x_diff + y_diff * y_diff;
-
-      // caclulate distance to previous pose
-      if (i > 0 && max_plan_length > 0)
-        plan_length += distance_points2d(global_plan[i - 1].pose.position,
-                                         global_plan[i].pose.position);
-
-      ++i;
-    }
+    // find the poses from the closest one to the robot until the first one
+    // outside of our distance threshold, and transform only those
+    std::size_t first, end;
+    global_plan.findSlice(robot_pose.getOrigin().x(),
+                          robot_pose.getOrigin().y(), dist_threshold,
+                          max_plan_length, first, end);
+    global_plan.transform(first, end, plan_to_global_transform,
+                          plan_to_global_transform.stamp_, global_frame,
+                          transformed_plan);
 
     // Modification for teb_local_planner:
     // Return the index of the current goal point (inside the distance
     // threshold)
     if (current_goal_idx)
-      *current_goal_idx =
-          i - 1; // minus 1, since i was increased once before leaving the loop
+      *current_goal_idx = (int)end - 1; // minus 1, since end is behind the goal
     if (tf_plan_to_global)
       *tf_plan_to_global = plan_to_global_transform;
+    if (first_idx)
+      *first_idx = first;
   } catch (tf::LookupException &ex) {
     ROS_ERROR("No Transform available Error: %s\n", ex.what());
     return false;
@@ -1119,7 +1137,7 @@ bool TebLocalPlannerROS::transformGlobalPlan(
     if (global_plan.size() > 0)
       ROS_ERROR("Global Frame: %s Plan Frame size %d: %s\n",
                 global_frame.c_str(), (unsigned int)global_plan.size(),
-                global_plan[0].header.frame_id.c_str());
+                global_plan.poses()[0].header.frame_id.c_str());
 
     return false;
   }
@@ -1148,19 +1166,9 @@ bool TebLocalPlannerROS::transformHumanPlan(
                        ros::Time(0), human_plan_to_global_transform);
 
     // transform the full plan to local planning frame
-    std::vector<geometry_msgs::PoseStamped> transformed_human_plan;
-    tf::Stamped<tf::Pose> tf_pose_stamped;
-    geometry_msgs::PoseStamped transformed_pose;
-    tf::Pose tf_pose;
-    for (auto &human_pose : human_plan) {
-      tf::poseMsgToTF(human_pose.pose.pose, tf_pose);
-      tf_pose_stamped.setData(human_plan_to_global_transform * tf_pose);
-      tf_pose_stamped.stamp_ = human_plan_to_global_transform.stamp_;
-      tf_pose_stamped.frame_id_ = global_frame;
-      tf::poseStampedTFToMsg(tf_pose_stamped, transformed_pose);
-
-      transformed_human_plan.push_back(transformed_pose);
-    }
+    transformHumanPlanPoses(human_plan_to_global_transform, robot_pose,
+                            costmap, global_frame, human_plan,
+                            transformed_human_plan_combined);
 
     // transform human twist to local planning frame
     geometry_msgs::Twist human_to_global_twist;
@@ -1170,60 +1178,6 @@ bool TebLocalPlannerROS::transformHumanPlan(
     transformed_human_twist.twist.linear.y -= human_to_global_twist.linear.y;
     transformed_human_twist.twist.angular.z -= human_to_global_twist.angular.z;
 
-    double dist_threshold =
-        std::max(costmap.getSizeInCellsX() * costmap.getResolution() / 2.0,
-                 costmap.getSizeInCellsY() * costmap.getResolution() / 2.0) *
-        0.85;
-    double sq_dist_threshold = dist_threshold * dist_threshold;
-    double x_diff, y_diff, sq_dist;
-
-    // get first point of human plan within threshold distance from robot
-    int start_index = transformed_human_plan.size(), end_index = 0;
-    for (int i = 0; i < transformed_human_plan.size(); i++) {
-      x_diff = robot_pose.getOrigin().x() -
-               transformed_human_plan[i].pose.position.x;
-      y_diff = robot_pose.getOrigin().y() -
-               transformed_human_plan[i].pose.position.y;
-      sq_dist = x_diff * x_diff + y_diff * y_diff;
-      if (sq_dist < sq_dist_threshold) {
-        start_index = i;
-        break;
-      }
-    }
-
-    // now get last point of human plan withing threshold distance from robot
-    for (int i = (transformed_human_plan.size() - 1); i >= 0; i--) {
-      x_diff = robot_pose.getOrigin().x() -
-               transformed_human_plan[i].pose.position.x;
-      y_diff = robot_pose.getOrigin().y() -
-               transformed_human_plan[i].pose.position.y;
-      sq_dist = x_diff * x_diff + y_diff * y_diff;
-      if (sq_dist < sq_dist_threshold) {
-        end_index = i;
-        break;
-      }
-    }
-
-    // ROS_INFO("start: %d, end: %d, full: %ld", start_index, end_index,
-    // transformed_human_plan.size());
-    transformed_human_plan_combined.plan_before.clear();
-    transformed_human_plan_combined.plan_to_optimize.clear();
-    transformed_human_plan_combined.plan_after.clear();
-    for (int i = 0; i < transformed_human_plan.size(); i++) {
-      if (i < start_index) {
-        transformed_human_plan_combined.plan_before.push_back(
-            transformed_human_plan[i]);
-      } else if (i >= start_index && i <= end_index) {
-        transformed_human_plan_combined.plan_to_optimize.push_back(
-            transformed_human_plan[i]);
-      } else if (i > end_index) {
-        transformed_human_plan_combined.plan_after.push_back(
-            transformed_human_plan[i]);
-      } else {
-        ROS_ERROR("Transform human plan indexing error");
-      }
-    }
-
     if (tf_human_plan_to_global)
       *tf_human_plan_to_global = human_plan_to_global_transform;
   } catch (tf::LookupException &ex) {
@@ -1245,6 +1199,151 @@ bool TebLocalPlannerROS::transformHumanPlan(
   return true;
 }
 
+void TebLocalPlannerROS::transformHumanPlans(
+    const tf::TransformListener &tf, const tf::Stamped<tf::Pose> &robot_pose,
+    const costmap_2d::Costmap2D &costmap, const std::string &global_frame,
+    std::vector<hanp_prediction::PredictedPoses> &predicted_humans,
+    std::vector<HumanPlanCombined> &transformed_human_plans,
+    HumanPlanVelMap &transformed_human_plan_vel_map) {
+  transformed_human_plans.reserve(transformed_human_plans.size() +
+                                  predicted_humans.size());
+
+  // transformations by source frame, failed lookups are not repeated
+  std::map<std::string, tf::StampedTransform> plan_transforms;
+  std::map<std::string, geometry_msgs::Twist> twist_transforms;
+  std::set<std::string> failed_frames;
+
+  for (auto &predicted_human : predicted_humans) {
+    auto &human_plan = predicted_human.poses;
+    auto &transformed_vel = predicted_human.start_velocity;
+    if (human_plan.empty()) {
+      ROS_ERROR("Received human %ld plan with zero length", predicted_human.id);
+      continue;
+    }
+
+    const std::string &plan_frame = human_plan.front().header.frame_id;
+    const std::string &twist_frame = transformed_vel.header.frame_id;
+    auto plan_tf = plan_transforms.find(plan_frame);
+    auto twist_tf = twist_transforms.find(twist_frame);
+    bool transformed =
+        !failed_frames.count(plan_frame) && !failed_frames.count(twist_frame);
+    if (transformed && plan_tf == plan_transforms.end()) {
+      try {
+        tf::StampedTransform plan_to_global;
+        tf.waitForTransform(global_frame, plan_frame, ros::Time(0),
+                            ros::Duration(0.5));
+        tf.lookupTransform(global_frame, plan_frame, ros::Time(0),
+                           plan_to_global);
+        plan_tf = plan_transforms.emplace(plan_frame, plan_to_global).first;
+      } catch (tf::TransformException &ex) {
+        ROS_ERROR("Could not look up the transformation from %s to %s: %s",
+                  plan_frame.c_str(), global_frame.c_str(), ex.what());
+        failed_frames.insert(plan_frame);
+        transformed = false;
+      }
+    }
+    if (transformed && twist_tf == twist_transforms.end()) {
+      try {
+        geometry_msgs::Twist twist_to_global;
+        tf.lookupTwist(global_frame, twist_frame, ros::Time(0),
+                       ros::Duration(0.1), twist_to_global);
+        twist_tf = twist_transforms.emplace(twist_frame, twist_to_global).first;
+      } catch (tf::TransformException &ex) {
+        ROS_ERROR("Could not look up the twist of %s in %s: %s",
+                  twist_frame.c_str(), global_frame.c_str(), ex.what());
+        failed_frames.insert(twist_frame);
+        transformed = false;
+      }
+    }
+    if (!transformed) {
+      ROS_WARN("Could not transform the human %ld plan to the frame of the "
+               "controller",
+               predicted_human.id);
+      continue;
+    }
+
+    transformed_human_plans.emplace_back();
+    HumanPlanCombined &human_plan_combined = transformed_human_plans.back();
+    transformHumanPlanPoses(plan_tf->second, robot_pose, costmap, global_frame,
+                            human_plan, human_plan_combined);
+    human_plan_combined.id = predicted_human.id;
+
+    transformed_vel.twist.linear.x -= twist_tf->second.linear.x;
+    transformed_vel.twist.linear.y -= twist_tf->second.linear.y;
+    transformed_vel.twist.angular.z -= twist_tf->second.angular.z;
+
+    PlanStartVelGoalVel &plan_start_vel_goal_vel =
+        transformed_human_plan_vel_map[human_plan_combined.id];
+    plan_start_vel_goal_vel.plan = human_plan_combined.plan_to_optimize;
+    plan_start_vel_goal_vel.start_vel = transformed_vel.twist;
+    if (human_plan_combined.plan_after.size() > 0) {
+      plan_start_vel_goal_vel.goal_vel = transformed_vel.twist;
+    }
+  }
+}
+
+void TebLocalPlannerROS::transformHumanPlanPoses(
+    const tf::StampedTransform &plan_to_global,
+    const tf::Stamped<tf::Pose> &robot_pose,
+    const costmap_2d::Costmap2D &costmap, const std::string &global_frame,
+    const std::vector<geometry_msgs::PoseWithCovarianceStamped> &human_plan,
+    HumanPlanCombined &transformed_human_plan_combined) const {
+  double dist_threshold =
+      std::max(costmap.getSizeInCellsX() * costmap.getResolution() / 2.0,
+               costmap.getSizeInCellsY() * costmap.getResolution() / 2.0) *
+      0.85;
+  double sq_dist_threshold = dist_threshold * dist_threshold;
+  // only the positions are transformed for the split, the poses are
+  // transformed right into the parts of the plan afterwards
+  auto withinThreshold =
+      [&](const geometry_msgs::PoseWithCovarianceStamped &pose) {
+        const geometry_msgs::Point &position = pose.pose.pose.position;
+        tf::Vector3 global_position =
+            plan_to_global * tf::Vector3(position.x, position.y, position.z);
+        double x_diff = robot_pose.getOrigin().x() - global_position.x();
+        double y_diff = robot_pose.getOrigin().y() - global_position.y();
+        return x_diff * x_diff + y_diff * y_diff < sq_dist_threshold;
+      };
+
+  // get first and last point of human plan within threshold distance from
+  // robot
+  int size = human_plan.size();
+  int start_index = size, end_index = 0;
+  for (int i = 0; i < size; i++) {
+    if (withinThreshold(human_plan[i])) {
+      start_index = i;
+      break;
+    }
+  }
+  for (int i = size - 1; i >= 0; i--) {
+    if (withinThreshold(human_plan[i])) {
+      end_index = i;
+      break;
+    }
+  }
+
+  // ROS_INFO("start: %d, end: %d, full: %d", start_index, end_index, size);
+  int optimize_end = std::max(start_index, end_index + 1);
+  tf::Stamped<tf::Pose> tf_pose_stamped;
+  tf::Pose tf_pose;
+  auto transformPoses = [&](int begin, int end,
+                            std::vector<geometry_msgs::PoseStamped> &part) {
+    part.resize(end - begin);
+    for (int i = begin; i < end; ++i) {
+      tf::poseMsgToTF(human_plan[i].pose.pose, tf_pose);
+      tf_pose_stamped.setData(plan_to_global * tf_pose);
+      tf_pose_stamped.stamp_ = plan_to_global.stamp_;
+      tf_pose_stamped.frame_id_ = global_frame;
+      tf::poseStampedTFToMsg(tf_pose_stamped, part[i - begin]);
+    }
+  };
+  transformPoses(0, start_index, transformed_human_plan_combined.plan_before);
+  transformPoses(start_index, optimize_end,
+                 transformed_human_plan_combined.plan_to_optimize);
+  transformPoses(optimize_end, size,
+                 transformed_human_plan_combined.plan_after);
+}
+
 bool TebLocalPlannerROS::transformHumanPose(
     const tf::TransformListener &tf, const std::string &global_frame,
     geometry_msgs::PoseWithCovarianceStamped &human_pose,
@@ -1282,7 +1381,7 @@ bool TebLocalPlannerROS::transformHumanPose(
 }
 
 double TebLocalPlannerROS::estimateLocalGoalOrientation(
-    const std::vector<geometry_msgs::PoseStamped> &global_plan,
+    const GlobalPlanWindow &global_plan,
     const tf::Stamped<tf::Pose> &local_goal, int current_goal_idx,
     const tf::StampedTransform &tf_plan_to_global,
     int moving_average_length) const {
@@ -1295,7 +1394,7 @@ double TebLocalPlannerROS::estimateLocalGoalOrientation(
       return tf::getYaw(local_goal.getRotation());
     } else {
       tf::Quaternion global_orientation;
-      tf::quaternionMsgToTF(global_plan.back().pose.orientation,
+      tf::quaternionMsgToTF(global_plan.poses().back().pose.orientation,
                             global_orientation);
       return tf::getYaw(tf_plan_to_global.getRotation() * global_orientation);
     }
@@ -1316,7 +1415,7 @@ double TebLocalPlannerROS::estimateLocalGoalOrientation(
   int range_end = current_goal_idx + moving_average_length;
   for (int i = current_goal_idx; i < range_end; ++i) {
     // Transform pose of the global plan to the planning frame
-    const geometry_msgs::PoseStamped &pose = global_plan.at(i + 1);
+    const geometry_msgs::PoseStamped &pose = global_plan.poses().at(i + 1);
     tf::poseStampedMsgToTF(pose, tf_pose_kp1);
     tf_pose_kp1.setData(tf_plan_to_global * tf_pose_kp1);
 
@@ -1601,21 +1700,132 @@ TebLocalPlannerROS::getNumberFromXMLRPC(XmlRpc::XmlRpcValue &value,
                                                          : (double)(value);
 }
 
+void TebLocalPlannerROS::publishProfiling() {
+  ros::WallTime now = ros::WallTime::now();
+  if (!cfg_.profiling.enable) {
+    last_profiling_publish_ = now;
+    return;
+  }
+  if ((now - last_profiling_publish_).toSec() < cfg_.profiling.publish_period)
+    return;
+
+  // histograms of the phases, in milliseconds or as counts
+  diagnostic_msgs::DiagnosticArray diagnostics;
+  diagnostics.header.stamp = ros::Time::now();
+  for (auto &summary : Profiler::instance().summarize(true)) {
+    double scale = summary.unit == Histogram::SECONDS ? 1e3 : 1.0;
+    const char *unit = summary.unit == Histogram::SECONDS ? " ms" : "";
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = "teb_local_planner: " + summary.name;
+    char message[128];
+    std::snprintf(message, sizeof(message), "p50 %.3f%s, p99 %.3f%s",
+                  scale * summary.p50, unit, scale * summary.p99, unit);
+    status.message = message;
+    const std::pair<const char *, double> values[] = {
+        {"mean", summary.mean}, {"p50", summary.p50}, {"p95", summary.p95},
+        {"p99", summary.p99},   {"max", summary.max}};
+    diagnostic_msgs::KeyValue key_value;
+    key_value.key = "count";
+    key_value.value = std::to_string(summary.count);
+    status.values.push_back(key_value);
+    for (auto &value : values) {
+      key_value.key = std::string(value.first) + unit;
+      key_value.value = std::to_string(scale * value.second);
+      status.values.push_back(key_value);
+    }
+    diagnostics.status.push_back(status);
+  }
+
+  // usage of the edge pools
+  for (auto &stats : EdgePoolRegistry::instance().statistics()) {
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = "teb_local_planner: edge_pool/" + stats.name;
+    status.message = "capacity " + std::to_string(stats.capacity);
+    const std::pair<const char *, std::size_t> values[] = {
+        {"live", stats.live}, {"peak", stats.peak},
+        {"capacity", stats.capacity}};
+    for (auto &value : values) {
+      diagnostic_msgs::KeyValue key_value;
+      key_value.key = value.first;
+      key_value.value = std::to_string(value.second);
+      status.values.push_back(key_value);
+    }
+    diagnostics.status.push_back(status);
+  }
+  profiling_pub_.publish(diagnostics);
+  last_profiling_publish_ = now;
+}
+
+void TebLocalPlannerROS::updateCycleRecorder() {
+  if (!cfg_.recorder.enable) {
+    if (cycle_recorder_.isOpen()) {
+      cycle_recorder_.close();
+      ROS_INFO("Stopped recording the planning cycles.");
+    }
+    return;
+  }
+
+  if (cycle_recorder_.isOpen() && (cfg_.recorder.file != recorder_file_ ||
+                                   cfg_.recorder.size != recorder_size_)) {
+    cycle_recorder_.close();
+    ROS_INFO("Stopped recording the planning cycles to '%s', the ring file "
+             "or its size changed.",
+             recorder_file_.c_str());
+  }
+
+  if (!cycle_recorder_.isOpen()) {
+    recorder_file_ = cfg_.recorder.file;
+    recorder_size_ = cfg_.recorder.size;
+    std::size_t capacity = std::size_t(std::max(cfg_.recorder.size, 1)) << 20;
+    if (!cycle_recorder_.open(cfg_.recorder.file, capacity)) {
+      ROS_ERROR_THROTTLE(10.0, "Cannot map the ring file '%s' to record the "
+                               "planning cycles.",
+                         cfg_.recorder.file.c_str());
+      return;
+    }
+    ROS_INFO("Recording the planning cycles to '%s'.",
+             cfg_.recorder.file.c_str());
+    recorded_config_revision_ = cfg_.revision() - 1;
+  }
+
+  if (recorded_config_revision_ != cfg_.revision()) {
+    cycle_recorder_.recordConfig(ros::Time::now(), cfg_, robot_model_);
+    recorded_config_revision_ = cfg_.revision();
+  }
+}
+
 void TebLocalPlannerROS::resetHumansPrediction() {
-  std_srvs::Empty empty_service;
-  ROS_INFO("Resetting human pose prediction");
-  if (!reset_humans_prediction_client_ ||
-      !reset_humans_prediction_client_.call(empty_service)) {
-    ROS_WARN_THROTTLE(
-        THROTTLE_RATE,
-        "Failed to call %s service, is human prediction server running?",
-        PREDICT_SERVICE_NAME);
-
-    // re-initialize the service
-    // reset_humans_prediction_client_ =
-    //     nh.serviceClient<std_srvs::Empty>(RESET_PREDICTION_SERVICE_NAME,
-    //     true);
+  prediction_client_.reset();
+}
+
+bool TebLocalPlannerROS::getHumansPrediction(
+    const hanp_prediction::HumanPosePredict::Request &request,
+    HumanPredictionClient::Predictions &predicted_humans) {
+  prediction_client_.setRate(cfg_.human.prediction_rate);
+  prediction_client_.setPublishMarkers(publish_predicted_human_markers_);
+  prediction_client_.setRequest(request);
+
+  HumanPredictionClient::Snapshot prediction;
+  if (!prediction_client_.latest(prediction)) {
+    prediction_age_ = -1.0;
+    ROS_WARN_THROTTLE(THROTTLE_RATE, "No human prediction received yet");
+    return false;
   }
+
+  prediction_age_ =
+      std::max((ros::Time::now() - prediction.stamp).toSec(), 0.0);
+  if (prediction_age_ > cfg_.human.pose_prediction_reset_time) {
+    ROS_WARN_THROTTLE(THROTTLE_RATE,
+                      "Human prediction is %.2f s old, ignoring the humans",
+                      prediction_age_);
+    return false;
+  }
+
+  predicted_humans.swap(prediction.humans);
+  HumanPredictionClient::extrapolate(*tf_, predicted_humans, prediction_age_);
+  return true;
 }
 
 bool TebLocalPlannerROS::optimizeStandalone(
@@ -1638,13 +1848,16 @@ bool TebLocalPlannerROS::optimizeStandalone(
 
   // transform global plan to the frame of local costmap
   ROS_INFO("transforming robot global plans");
+  GlobalPlanWindow robot_plan;
+  robot_plan.setPlan(req.robot_plan.poses);
   std::vector<geometry_msgs::PoseStamped> transformed_plan;
   int goal_idx;
   tf::StampedTransform tf_robot_plan_to_global;
+  std::size_t robot_plan_first_idx;
   if (!transformGlobalPlan(
-          *tf_, req.robot_plan.poses, robot_pose_tf, *costmap_, global_frame_,
+          *tf_, robot_plan, robot_pose_tf, *costmap_, global_frame_,
           cfg_.trajectory.max_global_plan_lookahead_dist, transformed_plan,
-          &goal_idx, &tf_robot_plan_to_global)) {
+          &goal_idx, &tf_robot_plan_to_global, &robot_plan_first_idx)) {
     res.success = false;
     res.message = "Could not transform the global plan to the local frame";
     return true;
@@ -1672,7 +1885,7 @@ bool TebLocalPlannerROS::optimizeStandalone(
 
   // update via-points container
   auto via_start_time = ros::Time::now();
-  updateViaPointsContainer(transformed_plan,
+  updateViaPointsContainer(transformed_plan, &robot_plan, robot_plan_first_idx,
                            cfg_.trajectory.global_plan_viapoint_sep);
   auto via_time = ros::Time::now() - via_start_time;
 
@@ -1754,7 +1967,8 @@ bool TebLocalPlannerROS::optimizeStandalone(
   planner_->visualize();
   visualization_->publishObstacles(obstacles_);
   visualization_->publishViaPoints(via_points_);
-  visualization_->publishGlobalPlan(global_plan_);
+  visualization_->publishGlobalPlan(global_plan_.poses(),
+                                    global_plan_.cursor());
   visualization_->publishHumansPlans(transformed_human_plans);
   std::vector<HumanPlanTrajCombined> human_plans_traj_array;
   for (auto &human_plan_combined : transformed_human_plans) {
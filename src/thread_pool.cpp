@@ -0,0 +1,108 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/thread_pool.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+
+namespace teb_local_planner {
+
+ThreadPool::ThreadPool(unsigned int no_threads)
+    : no_threads_(std::max(no_threads, 1u)), tasks_(NULL), next_task_(0),
+      no_running_(0), stop_(false) {
+  for (unsigned int i = 0; i < no_threads_; ++i)
+    threads_.create_thread(boost::bind(&ThreadPool::work, this));
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    boost::mutex::scoped_lock l(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  threads_.join_all();
+}
+
+void ThreadPool::run(const std::vector<Task> &tasks) {
+  if (tasks.empty())
+    return;
+
+  boost::mutex::scoped_lock l(mutex_);
+  tasks_ = &tasks;
+  next_task_ = 0;
+  error_ = std::exception_ptr();
+  work_available_.notify_all();
+
+  while (next_task_ < tasks.size() || no_running_ > 0)
+    batch_done_.wait(l);
+  tasks_ = NULL;
+
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = std::exception_ptr();
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::work() {
+  boost::mutex::scoped_lock l(mutex_);
+  while (true) {
+    while (!stop_ && (!tasks_ || next_task_ >= tasks_->size()))
+      work_available_.wait(l);
+    if (stop_)
+      return;
+
+    const Task &task = (*tasks_)[next_task_++];
+    ++no_running_;
+    l.unlock();
+    std::exception_ptr error;
+    try {
+      task();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    l.lock();
+    --no_running_;
+    if (error && !error_)
+      error_ = error;
+
+    if (next_task_ >= tasks_->size() && no_running_ == 0)
+      batch_done_.notify_all();
+  }
+}
+
+} // namespace teb_local_planner
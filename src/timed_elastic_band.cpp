@@ -42,12 +42,22 @@
 
 #include <teb_local_planner/timed_elastic_band.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
 
 namespace teb_local_planner
 {
 
+namespace
+{
+// shared by all bands, such that a revision never identifies two different pose sequences
+std::atomic<unsigned long> g_structure_revision_counter(0);
+}
 
-TimedElasticBand::TimedElasticBand()
+
+TimedElasticBand::TimedElasticBand() : structure_revision_(++g_structure_revision_counter)
 {
 }
 
@@ -60,29 +70,33 @@ TimedElasticBand::~TimedElasticBand()
 
 void TimedElasticBand::addPose(const PoseSE2& pose, bool fixed)
 {
-  VertexPose* pose_vertex = new VertexPose(pose, fixed);
+  VertexPose* pose_vertex = pose_pool_.create(pose, fixed);
   pose_vec_.push_back( pose_vertex );
+  markStructureModified();
   return;
 }
 
 void TimedElasticBand::addPose(const Eigen::Ref<const Eigen::Vector2d>& position, double theta, bool fixed)
 {
-  VertexPose* pose_vertex = new VertexPose(position, theta, fixed);
+  VertexPose* pose_vertex = pose_pool_.create(position, theta, fixed);
   pose_vec_.push_back( pose_vertex );
+  markStructureModified();
   return;
 }
 
  void TimedElasticBand::addPose(double x, double y, double theta, bool fixed)
 {
-  VertexPose* pose_vertex = new VertexPose(x, y, theta, fixed);
+  VertexPose* pose_vertex = pose_pool_.create(x, y, theta, fixed);
   pose_vec_.push_back( pose_vertex );
+  markStructureModified();
   return;
 }
 
 void TimedElasticBand::addTimeDiff(double dt, bool fixed)
 {
-  VertexTimeDiff* timediff_vertex = new VertexTimeDiff(dt, fixed);
+  VertexTimeDiff* timediff_vertex = timediff_pool_.create(dt, fixed);
   timediff_vec_.push_back( timediff_vertex );
+  markStructureModified();
   return;
 }
 
@@ -127,67 +141,84 @@ void TimedElasticBand::addPoseAndTimeDiff(const Eigen::Ref<const Eigen::Vector2d
 void TimedElasticBand::deletePose(unsigned int index)
 {
   ROS_ASSERT(index<pose_vec_.size());
-  delete pose_vec_.at(index);
+  pose_pool_.destroy(pose_vec_.at(index));
   pose_vec_.erase(pose_vec_.begin()+index);
+  markStructureModified();
 }
 
 void TimedElasticBand::deletePoses(unsigned int index, unsigned int number)
 {
 	ROS_ASSERT(index+number<=pose_vec_.size());
 	for (unsigned int i = index; i<index+number; ++i)
-		delete pose_vec_.at(i);
+		pose_pool_.destroy(pose_vec_.at(i));
 	pose_vec_.erase(pose_vec_.begin()+index, pose_vec_.begin()+index+number);
+	markStructureModified();
 }
 
 void TimedElasticBand::deleteTimeDiff(unsigned int index)
 {
   ROS_ASSERT(index<timediff_vec_.size());
-  delete timediff_vec_.at(index);
+  timediff_pool_.destroy(timediff_vec_.at(index));
   timediff_vec_.erase(timediff_vec_.begin()+index);
+  markStructureModified();
 }
 
 void TimedElasticBand::deleteTimeDiffs(unsigned int index, unsigned int number)
 {
 	ROS_ASSERT(index+number<=timediff_vec_.size());
 	for (unsigned int i = index; i<index+number; ++i)
-		delete timediff_vec_.at(i);
+		timediff_pool_.destroy(timediff_vec_.at(i));
 	timediff_vec_.erase(timediff_vec_.begin()+index, timediff_vec_.begin()+index+number);
+	markStructureModified();
 }
 
 inline void TimedElasticBand::insertPose(unsigned int index, const PoseSE2& pose)
 {
-  VertexPose* pose_vertex = new VertexPose(pose);
+  VertexPose* pose_vertex = pose_pool_.create(pose);
   pose_vec_.insert(pose_vec_.begin()+index, pose_vertex);
+  markStructureModified();
 }
 
 inline void TimedElasticBand::insertPose(unsigned int index, const Eigen::Ref<const Eigen::Vector2d>& position, double theta)
 {
-  VertexPose* pose_vertex = new VertexPose(position, theta);
+  VertexPose* pose_vertex = pose_pool_.create(position, theta);
   pose_vec_.insert(pose_vec_.begin()+index, pose_vertex);
+  markStructureModified();
 }
 
 inline void TimedElasticBand::insertPose(unsigned int index, double x, double y, double theta)
 {
-  VertexPose* pose_vertex = new VertexPose(x, y, theta);
+  VertexPose* pose_vertex = pose_pool_.create(x, y, theta);
   pose_vec_.insert(pose_vec_.begin()+index, pose_vertex);
+  markStructureModified();
 }
 
 inline void TimedElasticBand::insertTimeDiff(unsigned int index, double dt)
 {
-  VertexTimeDiff* timediff_vertex = new VertexTimeDiff(dt);
+  VertexTimeDiff* timediff_vertex = timediff_pool_.create(dt);
   timediff_vec_.insert(timediff_vec_.begin()+index, timediff_vertex);
+  markStructureModified();
+}
+
+
+void TimedElasticBand::markStructureModified()
+{
+  structure_revision_ = ++g_structure_revision_counter;
 }
 
 
 void TimedElasticBand::clearTimedElasticBand()
 {
-  for (PoseSequence::iterator pose_it = pose_vec_.begin(); pose_it != pose_vec_.end(); ++pose_it)
-    delete *pose_it;
+  // release in reverse order, such that a new trajectory gets ascending slots again
+  for (PoseSequence::reverse_iterator pose_it = pose_vec_.rbegin(); pose_it != pose_vec_.rend(); ++pose_it)
+    pose_pool_.destroy(*pose_it);
   pose_vec_.clear();
 
-  for (TimeDiffSequence::iterator dt_it = timediff_vec_.begin(); dt_it != timediff_vec_.end(); ++dt_it)
-    delete *dt_it;
+  for (TimeDiffSequence::reverse_iterator dt_it = timediff_vec_.rbegin(); dt_it != timediff_vec_.rend(); ++dt_it)
+    timediff_pool_.destroy(*dt_it);
   timediff_vec_.clear();
+
+  markStructureModified();
 }
 
 
@@ -195,44 +226,147 @@ void TimedElasticBand::setPoseVertexFixed(unsigned int index, bool status)
 {
   ROS_ASSERT(index<sizePoses());
   pose_vec_.at(index)->setFixed(status);
+  markStructureModified();
 }
 
 void TimedElasticBand::setTimeDiffVertexFixed(unsigned int index, bool status)
 {
   ROS_ASSERT(index<sizeTimeDiffs());
   timediff_vec_.at(index)->setFixed(status);
+  markStructureModified();
 }
 
 
-void TimedElasticBand::autoResize(double dt_ref, double dt_hysteresis, int min_samples)
+void TimedElasticBand::autoResize(double dt_ref, double dt_hysteresis, int min_samples, bool exact_dt)
 {
-  /// iterate through all TEB states only once and add/remove states!
-  for(unsigned int i=0; i < sizeTimeDiffs(); ++i) // TimeDiff connects Point(i) with Point(i+1)
+  std::size_t n = sizeTimeDiffs();
+  if (n == 0 || sizePoses() != n + 1)
+    return;
+
+  // find the first timediff that is split or merged, nothing is copied if there is none
+  std::size_t first = 0;
+  for (; first < n; ++first)
   {
-    if(TimeDiff(i) > dt_ref + dt_hysteresis)
-    {
-      //ROS_DEBUG("teb_local_planner: autoResize() inserting new bandpoint i=%u, #TimeDiffs=%lu",i,sizeTimeDiffs());
+    double dt = timediff_vec_[first]->dt();
+    if (dt > dt_ref + dt_hysteresis || (dt < dt_ref - dt_hysteresis && (int)n > min_samples && first < n - 1))
+      break;
+  }
+  if (first == n)
+    return;
 
-      double newtime = 0.5*TimeDiff(i);
+  if (exact_dt)
+  {
+    resampleUniformly(dt_ref, min_samples);
+    return;
+  }
 
-      TimeDiff(i) = newtime;
-      insertPose(i+1, PoseSE2::average(Pose(i),Pose(i+1)) );
-      insertTimeDiff(i+1,newtime);
+  /// iterate through all TEB states only once and build the new sequences, the result equals inserting and
+  /// deleting states one at a time: split intervals and the interval a deleted one is merged into are skipped.
+  resize_poses_.clear();
+  resize_timediffs_.clear();
+  resize_poses_.insert(resize_poses_.end(), pose_vec_.begin(), pose_vec_.begin() + first + 1);
+  resize_timediffs_.insert(resize_timediffs_.end(), timediff_vec_.begin(), timediff_vec_.begin() + first);
 
-      ++i; // skip the newly inserted pose
+  std::size_t size = n; // number of timediffs after the changes so far
+  std::size_t i = first;
+  while (i < n) // TimeDiff connects Point(i) with Point(i+1)
+  {
+    VertexTimeDiff* timediff = timediff_vec_[i];
+    double dt = timediff->dt();
+    if (dt > dt_ref + dt_hysteresis)
+    {
+      // insert a new bandpoint in the middle of the interval
+      double newtime = 0.5*dt;
+      timediff->dt() = newtime;
+      resize_timediffs_.push_back(timediff);
+      resize_poses_.push_back(pose_pool_.create(PoseSE2::average(Pose(i), Pose(i+1))));
+      resize_timediffs_.push_back(timediff_pool_.create(newtime));
+      resize_poses_.push_back(pose_vec_[i+1]);
+      ++size;
+      ++i;
     }
-    else if(TimeDiff(i) < dt_ref - dt_hysteresis && (int)sizeTimeDiffs()>min_samples) // only remove samples if size is larger than min_samples.
+    else if (dt < dt_ref - dt_hysteresis && (int)size > min_samples && i < n - 1) // only remove samples if size is larger than min_samples.
     {
-      //ROS_DEBUG("teb_local_planner: autoResize() deleting bandpoint i=%u, #TimeDiffs=%lu",i,sizeTimeDiffs());
-
-      if(i < (sizeTimeDiffs()-1))
-      {
-        TimeDiff(i+1) = TimeDiff(i+1) + TimeDiff(i);
-        deleteTimeDiff(i);
-        deletePose(i+1);
-      }
+      // delete the bandpoint at the end of the interval and merge the interval into the next one
+      VertexTimeDiff* next = timediff_vec_[i+1];
+      next->dt() += dt;
+      timediff_pool_.destroy(timediff);
+      pose_pool_.destroy(pose_vec_[i+1]);
+      resize_timediffs_.push_back(next);
+      resize_poses_.push_back(pose_vec_[i+2]);
+      --size;
+      i += 2;
+    }
+    else
+    {
+      resize_timediffs_.push_back(timediff);
+      resize_poses_.push_back(pose_vec_[i+1]);
+      ++i;
     }
   }
+
+  // the old sequences become the buffers of the next call
+  pose_vec_.swap(resize_poses_);
+  timediff_vec_.swap(resize_timediffs_);
+  markStructureModified();
+}
+
+void TimedElasticBand::resampleUniformly(double dt_ref, int min_samples)
+{
+  std::size_t n = sizeTimeDiffs();
+  double total_time = getSumOfAllTimeDiffs();
+  if (total_time <= 0)
+    return;
+
+  std::size_t m = std::max<long>(std::lround(total_time / dt_ref), std::max(min_samples, 1));
+  double dt = total_time / (double)m;
+
+  // copy the current states, since the vertices are overwritten
+  resample_poses_.resize(n + 1);
+  resample_times_.resize(n + 1);
+  resample_times_[0] = 0;
+  for (std::size_t i = 0; i <= n; ++i)
+  {
+    resample_poses_[i] = Pose(i);
+    if (i > 0)
+      resample_times_[i] = resample_times_[i-1] + TimeDiff(i-1);
+  }
+
+  // adjust the number of vertices, the start and goal vertices are kept
+  if (m != n)
+  {
+    VertexPose* goal = pose_vec_.back();
+    pose_vec_.pop_back();
+    for (; pose_vec_.size() > m; pose_vec_.pop_back())
+      pose_pool_.destroy(pose_vec_.back());
+    while (pose_vec_.size() < m)
+      pose_vec_.push_back(pose_pool_.create());
+    pose_vec_.push_back(goal);
+
+    for (; timediff_vec_.size() > m; timediff_vec_.pop_back())
+      timediff_pool_.destroy(timediff_vec_.back());
+    while (timediff_vec_.size() < m)
+      timediff_vec_.push_back(timediff_pool_.create());
+    markStructureModified();
+  }
+
+  for (std::size_t i = 0; i < m; ++i)
+    TimeDiff(i) = dt;
+
+  // interpolate the intermediate poses at the new sample times
+  std::size_t segment = 0;
+  for (std::size_t i = 1; i < m; ++i)
+  {
+    double time = (double)i * dt;
+    while (segment + 1 < n && resample_times_[segment+1] < time)
+      ++segment;
+    const PoseSE2& pose1 = resample_poses_[segment];
+    const PoseSE2& pose2 = resample_poses_[segment+1];
+    double duration = resample_times_[segment+1] - resample_times_[segment];
+    double s = duration > 0 ? std::min(std::max((time - resample_times_[segment]) / duration, 0.0), 1.0) : 0.0;
+    Pose(i) = PoseSE2(pose1.position() + s * (pose2.position() - pose1.position()),
+                      g2o::normalize_theta(pose1.theta() + s * g2o::normalize_theta(pose2.theta() - pose1.theta())));
+  }
 }
 
 
@@ -0,0 +1,114 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <teb_local_planner/via_point_generator.h>
+
+#include <algorithm>
+
+namespace teb_local_planner {
+
+ViaPointGenerator::ViaPointGenerator()
+    : key_(0), min_separation_(0.0), first_(0), scanned_(0), valid_(false),
+      next_id_(0) {}
+
+void ViaPointGenerator::clear() {
+  indices_.clear();
+  ids_.clear();
+  valid_ = false;
+}
+
+void ViaPointGenerator::update(uint64_t key,
+                               const std::vector<double> &arc_length,
+                               std::size_t first, std::size_t end,
+                               double min_separation) {
+  if (min_separation < 0) {
+    clear();
+    return;
+  }
+
+  if (end > arc_length.size())
+    end = arc_length.size();
+
+  if (!valid_ || key != key_ || min_separation != min_separation_ ||
+      first < first_) {
+    indices_.clear();
+    ids_.clear();
+    key_ = key;
+    min_separation_ = min_separation;
+    scanned_ = first;
+    valid_ = true;
+  }
+  first_ = first;
+  if (first >= end) {
+    indices_.clear();
+    ids_.clear();
+    scanned_ = first;
+    return;
+  }
+
+  double min_arc_length = arc_length[first] + min_separation;
+
+  // evict the via-points behind the slice
+  while (!indices_.empty() && (indices_.front() <= first ||
+                               arc_length[indices_.front()] < min_arc_length)) {
+    indices_.pop_front();
+    ids_.pop_front();
+  }
+
+  // evict the via-points beyond the slice
+  while (!indices_.empty() && indices_.back() >= end) {
+    indices_.pop_back();
+    ids_.pop_back();
+  }
+  if (scanned_ > end)
+    scanned_ = end;
+  // without a via-point left, the separation is measured from the first pose
+  // of the slice again and the skipped poses have to be scanned again
+  if (indices_.empty())
+    scanned_ = first;
+
+  // scan the poses added to the slice, a via-point is placed once the plan
+  // reaches the minimum separation from the last one
+  for (std::size_t i = std::max(scanned_, first + 1); i < end; ++i) {
+    std::size_t last = indices_.empty() ? first : indices_.back();
+    if (arc_length[i] - arc_length[last] < min_separation)
+      continue;
+    indices_.push_back(i);
+    ids_.push_back(next_id_++);
+  }
+  scanned_ = end;
+}
+
+} // namespace teb_local_planner
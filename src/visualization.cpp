@@ -119,12 +119,17 @@ void TebVisualization::initialize(ros::NodeHandle &nh, const TebConfig &cfg) {
 }
 
 void TebVisualization::publishGlobalPlan(
-    const std::vector<geometry_msgs::PoseStamped> &global_plan) const {
+    const std::vector<geometry_msgs::PoseStamped> &global_plan,
+    std::size_t first) const {
   if (printErrorWhenNotInitialized() ||
-      !cfg_->visualization.publish_robot_global_plan) {
+      !cfg_->visualization.publish_robot_global_plan ||
+      first >= global_plan.size()) {
     return;
   }
-  base_local_planner::publishPlan(global_plan, global_plan_pub_);
+  nav_msgs::Path gui_path;
+  gui_path.header = global_plan[first].header;
+  gui_path.poses.assign(global_plan.begin() + first, global_plan.end());
+  global_plan_pub_.publish(gui_path);
 }
 
 void TebVisualization::publishLocalPlan(
@@ -677,6 +682,12 @@ void TebVisualization::publishFeedbackMessage(
   msg.selected_trajectory_idx = selected_trajectory_idx;
 
   msg.trajectories.resize(teb_planners.size());
+  msg.optimization_times.resize(teb_planners.size());
+  msg.optimization_cancelled.resize(teb_planners.size());
+  msg.optimization_budgets.resize(teb_planners.size());
+  msg.outer_iterations.resize(teb_planners.size());
+  msg.inner_iterations.resize(teb_planners.size());
+  msg.stop_reasons.resize(teb_planners.size());
 
   // Iterate through teb pose sequence
   std::size_t idx_traj = 0;
@@ -684,6 +695,13 @@ void TebVisualization::publishFeedbackMessage(
        it_teb != teb_planners.end(); ++it_teb, ++idx_traj) {
     msg.trajectories[idx_traj].header = msg.header;
     it_teb->get()->getFullTrajectory(msg.trajectories[idx_traj].trajectory);
+    msg.optimization_times[idx_traj] = it_teb->get()->getOptimizationTime();
+    msg.optimization_cancelled[idx_traj] =
+        it_teb->get()->isOptimizationCancelled();
+    msg.optimization_budgets[idx_traj] = it_teb->get()->getTimeBudget();
+    msg.outer_iterations[idx_traj] = it_teb->get()->getOuterIterations();
+    msg.inner_iterations[idx_traj] = it_teb->get()->getInnerIterations();
+    msg.stop_reasons[idx_traj] = it_teb->get()->getStopReason();
   }
 
   // add obstacles
@@ -706,6 +724,12 @@ void TebVisualization::publishFeedbackMessage(
   msg.trajectories.resize(1);
   msg.trajectories.front().header = msg.header;
   teb_planner.getFullTrajectory(msg.trajectories.front().trajectory);
+  msg.optimization_times.push_back(teb_planner.getOptimizationTime());
+  msg.optimization_cancelled.push_back(teb_planner.isOptimizationCancelled());
+  msg.optimization_budgets.push_back(teb_planner.getTimeBudget());
+  msg.outer_iterations.push_back(teb_planner.getOuterIterations());
+  msg.inner_iterations.push_back(teb_planner.getInnerIterations());
+  msg.stop_reasons.push_back(teb_planner.getStopReason());
 
   // add obstacles
   msg.obstacles.resize(obstacles.size());
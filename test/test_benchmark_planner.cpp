@@ -0,0 +1,139 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Runs benchmark_planner on the scenarios of test/scenarios and checks its
+// --baseline regression gate: a baseline recorded in the same run passes,
+// a baseline that is much faster than any plan fails.
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define NO_RUNS 3         // warm-started plans per scenario
+#define NOISE_TOLERANCE 4 // allowed slowdown against the own baseline
+
+namespace {
+
+const char *SCENARIOS[] = {"corridor_passing", "doorway_crossing",
+                           "cluttered_turn"};
+
+class BenchmarkPlanner : public testing::TestWithParam<bool> {
+protected:
+  void SetUp() override {
+    char dir[] = "/tmp/test_benchmark_planner.XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != NULL);
+    dir_ = dir;
+  }
+
+  void TearDown() override {
+    std::system(("rm -rf '" + dir_ + "'").c_str());
+  }
+
+  // exit status of benchmark_planner with the scenarios and the options
+  int run(const std::string &options) const {
+    std::ostringstream command;
+    command << "'" << BENCHMARK_PLANNER << "' --runs " << NO_RUNS << " "
+            << (GetParam() ? "--hcp " : "") << options;
+    for (const char *scenario : SCENARIOS)
+      command << " '" << SCENARIO_DIR << "/" << scenario << ".txt'";
+    command << " > '" << dir_ << "/output.txt'";
+    int status = std::system(command.str().c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  }
+
+  // fields of each scenario of a csv written by benchmark_planner
+  std::map<std::string, std::vector<std::string>>
+  readCsv(const std::string &filename) const {
+    std::map<std::string, std::vector<std::string>> rows;
+    std::ifstream file(filename.c_str());
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line)) {
+      std::vector<std::string> fields;
+      std::istringstream in(line);
+      std::string field;
+      while (std::getline(in, field, ','))
+        fields.push_back(field);
+      if (!fields.empty())
+        rows[fields[0]] = fields;
+    }
+    return rows;
+  }
+
+  std::string dir_;
+};
+
+} // namespace
+
+TEST_P(BenchmarkPlanner, BaselineGate) {
+  const std::string csv = dir_ + "/results.csv";
+  ASSERT_EQ(0, run("--csv '" + csv + "'"));
+
+  std::map<std::string, std::vector<std::string>> rows = readCsv(csv);
+  for (const char *scenario : SCENARIOS) {
+    ASSERT_EQ(1u, rows.count(scenario)) << scenario;
+    ASSERT_GT(rows[scenario].size(), 5u) << scenario;
+    EXPECT_EQ("1", rows[scenario][3]) << scenario << " failed";
+  }
+
+  // the same build against its own timings passes the gate
+  std::ostringstream tolerance;
+  tolerance << NOISE_TOLERANCE;
+  EXPECT_EQ(0, run("--baseline '" + csv + "' --tolerance " + tolerance.str()));
+
+  // a baseline faster than any plan must be reported as a regression
+  const std::string fast = dir_ + "/fast.csv";
+  {
+    std::ofstream out(fast.c_str());
+    out << "name,humans,obstacles,success,cold_ms,warm_ms\n";
+    for (const char *scenario : SCENARIOS)
+      out << scenario << ",0,0,1,1e-9,1e-9\n";
+  }
+  EXPECT_EQ(1, run("--baseline '" + fast + "'"));
+}
+
+INSTANTIATE_TEST_CASE_P(Planners, BenchmarkPlanner, testing::Bool());
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
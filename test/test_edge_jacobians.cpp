@@ -0,0 +1,385 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017 LAAS/CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Compares the analytic Jacobians of the edges (linearizeOplus() with
+// USE_ANALYTIC_JACOBI) to the numeric differentiation of g2o at random vertex
+// states.
+
+#include <teb_local_planner/g2o_types/edge_acceleration.h>
+#include <teb_local_planner/g2o_types/edge_distance_field.h>
+#include <teb_local_planner/g2o_types/edge_dynamic_obstacle.h>
+#include <teb_local_planner/g2o_types/edge_human_human_safety.h>
+#include <teb_local_planner/g2o_types/edge_human_robot_directional.h>
+#include <teb_local_planner/g2o_types/edge_human_robot_safety.h>
+#include <teb_local_planner/g2o_types/edge_human_robot_ttc.h>
+#include <teb_local_planner/g2o_types/edge_kinematics.h>
+#include <teb_local_planner/g2o_types/edge_obstacle.h>
+#include <teb_local_planner/g2o_types/edge_time_optimal.h>
+#include <teb_local_planner/g2o_types/edge_velocity.h>
+#include <teb_local_planner/g2o_types/edge_via_point.h>
+
+#include <g2o/core/jacobian_workspace.h>
+
+#include <boost/make_shared.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace teb_local_planner;
+
+#define NO_SAMPLES 1000 // random states per edge
+#define TOLERANCE 1e-4  // relative to the magnitude of the derivative
+
+namespace {
+
+std::mt19937 generator(42);
+
+double uniform(double min, double max) {
+  return std::uniform_real_distribution<double>(min, max)(generator);
+}
+
+//! Random poses in a 4m x 4m square and time differences
+void randomizeVertices(g2o::HyperGraph::Edge *edge) {
+  for (auto *vertex : edge->vertices()) {
+    if (VertexPose *pose = dynamic_cast<VertexPose *>(vertex))
+      pose->setEstimate(PoseSE2(uniform(-2.0, 2.0), uniform(-2.0, 2.0),
+                                uniform(-M_PI, M_PI)));
+    else if (VertexTimeDiff *dt = dynamic_cast<VertexTimeDiff *>(vertex))
+      dt->setEstimate(uniform(0.05, 1.0));
+  }
+}
+
+//! Numeric Jacobians of g2o, i.e. the linearizeOplus() of the base class,
+//! written to the maps set up by the last linearizeOplus(workspace) call
+template <int D, typename E, typename VertexXi>
+void numericJacobians(g2o::BaseUnaryEdge<D, E, VertexXi> *edge) {
+  edge->g2o::BaseUnaryEdge<D, E, VertexXi>::linearizeOplus();
+}
+
+template <int D, typename E, typename VertexXi, typename VertexXj>
+void numericJacobians(g2o::BaseBinaryEdge<D, E, VertexXi, VertexXj> *edge) {
+  edge->g2o::BaseBinaryEdge<D, E, VertexXi, VertexXj>::linearizeOplus();
+}
+
+template <int D, typename E>
+void numericJacobians(g2o::BaseMultiEdge<D, E> *edge) {
+  edge->g2o::BaseMultiEdge<D, E>::linearizeOplus();
+}
+
+//! Maximum deviation between analytic and numeric Jacobians at the current
+//! vertex states
+template <typename Edge> double jacobianDeviation(Edge *edge) {
+  g2o::JacobianWorkspace workspace;
+  workspace.updateSize(edge);
+  workspace.allocate();
+  // the overload of the base class maps the Jacobians into the workspace
+  static_cast<g2o::OptimizableGraph::Edge *>(edge)->linearizeOplus(workspace);
+
+  std::vector<Eigen::MatrixXd> analytic;
+  for (std::size_t i = 0; i < edge->vertices().size(); ++i) {
+    int dim = static_cast<g2o::OptimizableGraph::Vertex *>(edge->vertex(i))
+                  ->dimension();
+    analytic.push_back(Eigen::Map<Eigen::MatrixXd>(
+        workspace.workspaceForVertex(i), Edge::Dimension, dim));
+  }
+
+  numericJacobians(edge);
+
+  double deviation = 0.0;
+  for (std::size_t i = 0; i < edge->vertices().size(); ++i) {
+    Eigen::Map<Eigen::MatrixXd> numeric(workspace.workspaceForVertex(i),
+                                        Edge::Dimension, analytic[i].cols());
+    for (int d = 0; d < numeric.cols(); ++d) {
+      double scale = std::max(1.0, numeric.col(d).cwiseAbs().maxCoeff());
+      deviation = std::max(
+          deviation,
+          (analytic[i].col(d) - numeric.col(d)).cwiseAbs().maxCoeff() / scale);
+    }
+  }
+  return deviation;
+}
+
+/**
+ * @brief Connect an edge to new vertices and compare its Jacobians at random
+ * states, the edge and its vertices are deleted afterwards
+ * @param name name reported on failure
+ * @param edge edge whose parameters have been set
+ * @param vertex_types one character per vertex: 'p' pose, 't' time difference
+ */
+template <typename Edge>
+void check(const std::string &name, Edge *edge,
+           const std::string &vertex_types) {
+  std::vector<g2o::OptimizableGraph::Vertex *> vertices;
+  for (std::size_t i = 0; i < vertex_types.size(); ++i) {
+    if (vertex_types[i] == 'p')
+      vertices.push_back(new VertexPose());
+    else
+      vertices.push_back(new VertexTimeDiff());
+    edge->setVertex(i, vertices.back());
+  }
+
+  double max_deviation = 0.0;
+  int failures = 0;
+  for (int s = 0; s < NO_SAMPLES; ++s) {
+    randomizeVertices(edge);
+    double deviation = jacobianDeviation(edge);
+    max_deviation = std::max(max_deviation, deviation);
+    if (!(deviation <= TOLERANCE))
+      ++failures;
+  }
+  EXPECT_EQ(0, failures) << name << ": " << failures << " of " << NO_SAMPLES
+                         << " states deviate, max deviation "
+                         << max_deviation;
+
+  delete edge;
+  for (auto *vertex : vertices)
+    delete vertex;
+}
+
+//! Configuration whose limits are violated by a part of the random states
+class EdgeJacobians : public ::testing::Test {
+protected:
+  EdgeJacobians() : start_vel(0.2, 0.1), goal_vel(0.0, 0.0) {
+    cfg.robot.min_turning_radius = 1.0;
+    cfg.human.dir_cost_threshold = 1.0;
+    cfg.human.min_human_robot_dist = 1.0;
+    cfg.human.min_human_human_dist = 1.0;
+
+    Point2dContainer polygon_footprint;
+    polygon_footprint.push_back(Eigen::Vector2d(0.3, 0.2));
+    polygon_footprint.push_back(Eigen::Vector2d(-0.3, 0.2));
+    polygon_footprint.push_back(Eigen::Vector2d(-0.3, -0.2));
+    polygon_footprint.push_back(Eigen::Vector2d(0.3, -0.2));
+    robot_models.push_back(boost::make_shared<PointRobotFootprint>());
+    robot_models.push_back(boost::make_shared<CircularRobotFootprint>(0.3));
+    robot_models.push_back(
+        boost::make_shared<TwoCirclesRobotFootprint>(0.3, 0.25, 0.2, 0.25));
+    robot_models.push_back(
+        boost::make_shared<PolygonRobotFootprint>(polygon_footprint));
+  }
+
+  TebConfig cfg;
+  Eigen::Vector2d start_vel, goal_vel;
+  std::vector<RobotFootprintModelPtr> robot_models;
+};
+
+const char *ROBOT_MODEL_NAMES[] = {"point", "circular", "two circles",
+                                   "polygon (numeric)"};
+const char *OBSTACLE_NAMES[] = {"point", "line", "polygon"};
+
+} // namespace
+
+TEST_F(EdgeJacobians, Velocity) {
+  EdgeVelocity *velocity = new EdgeVelocity();
+  velocity->setTebConfig(cfg);
+  check("EdgeVelocity", velocity, "ppt");
+
+  for (int elastic = 0; elastic < 2; ++elastic) {
+    cfg.optim.use_human_elastic_vel = elastic;
+    EdgeVelocityHuman *velocity_human = new EdgeVelocityHuman();
+    velocity_human->setTebConfig(cfg);
+    check(std::string("EdgeVelocityHuman") + (elastic ? " (elastic)" : ""),
+          velocity_human, "ppt");
+  }
+}
+
+TEST_F(EdgeJacobians, Acceleration) {
+  EdgeAcceleration *acceleration = new EdgeAcceleration();
+  acceleration->setTebConfig(cfg);
+  check("EdgeAcceleration", acceleration, "ppptt");
+
+  EdgeAccelerationStart *acceleration_start = new EdgeAccelerationStart();
+  acceleration_start->setTebConfig(cfg);
+  acceleration_start->setInitialVelocity(start_vel);
+  check("EdgeAccelerationStart", acceleration_start, "ppt");
+
+  EdgeAccelerationGoal *acceleration_goal = new EdgeAccelerationGoal();
+  acceleration_goal->setTebConfig(cfg);
+  acceleration_goal->setGoalVelocity(goal_vel);
+  check("EdgeAccelerationGoal", acceleration_goal, "ppt");
+
+  EdgeAccelerationHuman *acceleration_human = new EdgeAccelerationHuman();
+  acceleration_human->setTebConfig(cfg);
+  check("EdgeAccelerationHuman", acceleration_human, "ppptt");
+
+  EdgeAccelerationHumanStart *acceleration_human_start =
+      new EdgeAccelerationHumanStart();
+  acceleration_human_start->setTebConfig(cfg);
+  acceleration_human_start->setInitialVelocity(start_vel);
+  check("EdgeAccelerationHumanStart", acceleration_human_start, "ppt");
+
+  EdgeAccelerationHumanGoal *acceleration_human_goal =
+      new EdgeAccelerationHumanGoal();
+  acceleration_human_goal->setTebConfig(cfg);
+  acceleration_human_goal->setGoalVelocity(goal_vel);
+  check("EdgeAccelerationHumanGoal", acceleration_human_goal, "ppt");
+}
+
+TEST_F(EdgeJacobians, Kinematics) {
+  EdgeKinematicsDiffDrive *kinematics_diff_drive =
+      new EdgeKinematicsDiffDrive();
+  kinematics_diff_drive->setTebConfig(cfg);
+  check("EdgeKinematicsDiffDrive", kinematics_diff_drive, "pp");
+
+  EdgeKinematicsCarlike *kinematics_carlike = new EdgeKinematicsCarlike();
+  kinematics_carlike->setTebConfig(cfg);
+  check("EdgeKinematicsCarlike", kinematics_carlike, "pp");
+}
+
+TEST_F(EdgeJacobians, TimeOptimal) {
+  for (int capped = 0; capped < 2; ++capped) {
+    cfg.optim.cap_optimaltime_penalty = capped;
+    EdgeTimeOptimal *time_optimal = new EdgeTimeOptimal();
+    time_optimal->setTebConfig(cfg);
+    time_optimal->setInitialTime(0.5);
+    check(std::string("EdgeTimeOptimal") + (capped ? " (capped)" : ""),
+          time_optimal, "t");
+  }
+}
+
+TEST_F(EdgeJacobians, ViaPoint) {
+  Eigen::Vector2d via_point(0.5, -0.5);
+  EdgeViaPoint *via = new EdgeViaPoint();
+  via->setTebConfig(cfg);
+  via->setViaPoint(&via_point);
+  check("EdgeViaPoint", via, "p");
+}
+
+TEST_F(EdgeJacobians, Obstacle) {
+  ObstContainer obstacles;
+  obstacles.push_back(boost::make_shared<PointObstacle>(0.3, 0.2));
+  obstacles.push_back(boost::make_shared<LineObstacle>(-1.0, 1.0, 1.0, 0.5));
+  boost::shared_ptr<PolygonObstacle> polygon =
+      boost::make_shared<PolygonObstacle>();
+  polygon->pushBackVertex(-1.0, -1.0);
+  polygon->pushBackVertex(0.0, -1.5);
+  polygon->pushBackVertex(0.5, -0.5);
+  polygon->finalizePolygon();
+  obstacles.push_back(polygon);
+  ObstacleArrays obstacle_arrays;
+  obstacle_arrays.fromContainer(obstacles);
+
+  // 6m x 6m grid with two occupied blocks
+  const int grid_size = 60;
+  std::vector<unsigned char> grid(grid_size * grid_size, 0);
+  for (int y = 10; y < 15; ++y)
+    for (int x = 20; x < 40; ++x)
+      grid[y * grid_size + x] = 254;
+  for (int y = 35; y < 50; ++y)
+    for (int x = 40; x < 44; ++x)
+      grid[y * grid_size + x] = 254;
+  DistanceField distance_field;
+  distance_field.build(grid.data(), grid_size, grid_size, 0.1, -3.0, -3.0, 254);
+
+  for (int nonlinear = 0; nonlinear < 2; ++nonlinear) {
+    cfg.obstacles.use_nonlinear_obstacle_penalty = nonlinear;
+    std::string penalty = nonlinear ? ", nonlinear" : "";
+
+    for (std::size_t m = 0; m < robot_models.size(); ++m) {
+      for (std::size_t o = 0; o < obstacles.size(); ++o) {
+        EdgeObstacle *obstacle = new EdgeObstacle();
+        obstacle->setParameters(cfg, robot_models[m].get(),
+                                obstacles[o].get());
+        check(std::string("EdgeObstacle (") + ROBOT_MODEL_NAMES[m] + ", " +
+                  OBSTACLE_NAMES[o] + penalty + ")",
+              obstacle, "p");
+      }
+    }
+
+    std::vector<std::pair<double, double>> circles;
+    robot_models[2]->getCircles(circles);
+    for (std::size_t o = 0; o < obstacles.size(); ++o) {
+      EdgeIndexedObstacle *indexed_obstacle = new EdgeIndexedObstacle();
+      indexed_obstacle->setParameters(cfg, &circles, &obstacle_arrays,
+                                      obstacle_arrays.ref(o));
+      check(std::string("EdgeIndexedObstacle (") + OBSTACLE_NAMES[o] +
+                penalty + ")",
+            indexed_obstacle, "p");
+    }
+
+    FootprintCircles field_circles;
+    robot_models[2]->getCircleDecomposition(field_circles,
+                                            cfg.obstacles.footprint_circles);
+    EdgeDistanceField *field = new EdgeDistanceField();
+    field->setParameters(cfg, &distance_field, &field_circles);
+    check(std::string("EdgeDistanceField (two circles") + penalty + ")", field,
+          "p");
+  }
+}
+
+TEST_F(EdgeJacobians, DynamicObstacle) {
+  PointObstacle dynamic_obstacle(0.5, 0.5);
+  dynamic_obstacle.setCentroidVelocity(Eigen::Vector2d(-0.3, 0.2));
+  EdgeDynamicObstacle *dynamic = new EdgeDynamicObstacle(3);
+  dynamic->setTebConfig(cfg);
+  dynamic->setObstacle(&dynamic_obstacle);
+  check("EdgeDynamicObstacle", dynamic, "pt");
+}
+
+TEST_F(EdgeJacobians, HumanSafety) {
+  for (std::size_t m = 0; m < robot_models.size(); ++m) {
+    EdgeHumanRobotSafety *human_robot_safety = new EdgeHumanRobotSafety();
+    human_robot_safety->setParameters(cfg, robot_models[m].get(), 0.3);
+    check(std::string("EdgeHumanRobotSafety (") + ROBOT_MODEL_NAMES[m] + ")",
+          human_robot_safety, "pp");
+  }
+
+  EdgeHumanHumanSafety *human_human_safety = new EdgeHumanHumanSafety();
+  human_human_safety->setParameters(cfg, 0.3);
+  check("EdgeHumanHumanSafety", human_human_safety, "pp");
+}
+
+TEST_F(EdgeJacobians, HumanRobotInteraction) {
+  EdgeHumanRobotDirectional *directional = new EdgeHumanRobotDirectional();
+  directional->setTebConfig(cfg);
+  check("EdgeHumanRobotDirectional", directional, "pptppt");
+
+  for (int scaled = 0; scaled < 2; ++scaled) {
+    cfg.optim.scale_human_robot_ttc_c = scaled;
+    EdgeHumanRobotTTC *ttc = new EdgeHumanRobotTTC();
+    ttc->setParameters(cfg, 0.3, 0.3);
+    check(std::string("EdgeHumanRobotTTC") + (scaled ? " (scaled)" : ""), ttc,
+          "pptppt");
+  }
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}